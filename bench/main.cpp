@@ -0,0 +1,470 @@
+#include "loom/loom.h"
+#include "loom/audiobufferpool.h"
+#include "loom/time.h"
+
+#include <cstdlib>
+#include <functional>
+
+using namespace Loom;
+
+// Microbenchmarks of the core DSP and allocation paths, reported as JSON.
+// Configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+
+namespace
+{
+
+using BenchClock = std::chrono::steady_clock;
+
+struct BenchOptions
+{
+    BenchOptions()
+        : minTime(0.2)
+        , maxThreads(std::max(thread::hardware_concurrency(), 1u))
+        , outputPath(nullptr)
+        , filter(nullptr)
+    {
+    }
+
+    double minTime;
+    u32 maxThreads;
+    const char* outputPath;
+    const char* filter;
+};
+
+struct BenchResult
+{
+    string name;
+    string variant;
+    SampleFormat sampleFormat;
+    u32 frames;
+    u32 channels;
+    u32 threads;
+    u64 iterations;
+    double nsPerOpMin;
+    double nsPerOpMedian;
+    double nsPerOpMean;
+    // Samples processed per second over all threads, 0 when not relevant
+    double samplesPerSecond;
+    double opsPerSecond;
+};
+
+// Prevents the compiler from dropping computations whose result is otherwise unused
+volatile float BenchSink = 0.0f;
+
+const SampleFormat SampleFormats[] = {SampleFormat::Int16, SampleFormat::Int32, SampleFormat::Float32};
+const u32 FrameCounts[] = {64, 256, 1024, 4096};
+constexpr u32 Channels = 2;
+constexpr u32 Repetitions = 8;
+
+const char* SampleFormatToString(SampleFormat sampleFormat)
+{
+    switch (sampleFormat)
+    {
+        case SampleFormat::Int16: return "Int16";
+        case SampleFormat::Int32: return "Int32";
+        case SampleFormat::Float32: return "Float32";
+        default: return "Invalid";
+    }
+}
+
+double ElapsedNanoseconds(BenchClock::time_point start, BenchClock::time_point end)
+{
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+// Times batches of operations, the batch size calibrated so that all repetitions last about minTime
+void RunSingleThreaded(const BenchOptions& options, const std::function<void()>& operation, BenchResult& result)
+{
+    u64 batchSize = 1;
+    double batchTarget = options.minTime * NanosecondsPerSecond / Repetitions;
+    while (true)
+    {
+        BenchClock::time_point start = BenchClock::now();
+        for (u64 i = 0; i < batchSize; ++i)
+            operation();
+        double elapsed = ElapsedNanoseconds(start, BenchClock::now());
+        if (elapsed >= batchTarget / 10 || batchSize >= (1ull << 40))
+        {
+            batchSize = std::max<u64>(1, static_cast<u64>(batchSize * batchTarget / std::max(elapsed, 1.0)));
+            break;
+        }
+        batchSize *= 10;
+    }
+
+    vector<double> nsPerOp;
+    for (u32 repetition = 0; repetition < Repetitions; ++repetition)
+    {
+        BenchClock::time_point start = BenchClock::now();
+        for (u64 i = 0; i < batchSize; ++i)
+            operation();
+        nsPerOp.push_back(ElapsedNanoseconds(start, BenchClock::now()) / batchSize);
+    }
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+    result.threads = 1;
+    result.iterations = batchSize * Repetitions;
+    result.nsPerOpMin = nsPerOp.front();
+    result.nsPerOpMedian = nsPerOp[nsPerOp.size() / 2];
+    double sum = 0.0;
+    for (double value : nsPerOp)
+        sum += value;
+    result.nsPerOpMean = sum / nsPerOp.size();
+    result.opsPerSecond = NanosecondsPerSecond / result.nsPerOpMedian;
+}
+
+// Every thread runs the same number of operations, released together, timed until the last one is done.
+// Per operation times are per thread, the throughput is over all threads.
+void RunMultiThreaded(const BenchOptions& options, u32 threadCount, const std::function<void(u32)>& operation, BenchResult& result)
+{
+    u64 iterations = 1000;
+    vector<double> nsPerOp;
+    for (u32 repetition = 0; repetition <= Repetitions; ++repetition)
+    {
+        atomic<u32> readyThreads(0);
+        atomic<bool> go(false);
+        vector<thread> threads;
+        for (u32 threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+        {
+            threads.emplace_back([&, threadIndex]()
+            {
+                ++readyThreads;
+                while (!go.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+                for (u64 i = 0; i < iterations; ++i)
+                    operation(threadIndex);
+            });
+        }
+        while (readyThreads.load() < threadCount)
+            std::this_thread::yield();
+        BenchClock::time_point start = BenchClock::now();
+        go.store(true, std::memory_order_release);
+        for (thread& benchThread : threads)
+            benchThread.join();
+        double elapsed = ElapsedNanoseconds(start, BenchClock::now());
+        // The first run only calibrates the number of iterations
+        if (repetition == 0)
+        {
+            double target = options.minTime * NanosecondsPerSecond / Repetitions;
+            iterations = std::max<u64>(1, static_cast<u64>(iterations * target / std::max(elapsed, 1.0)));
+            continue;
+        }
+        nsPerOp.push_back(elapsed / iterations);
+    }
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+    result.threads = threadCount;
+    result.iterations = iterations * Repetitions * threadCount;
+    result.nsPerOpMin = nsPerOp.front();
+    result.nsPerOpMedian = nsPerOp[nsPerOp.size() / 2];
+    double sum = 0.0;
+    for (double value : nsPerOp)
+        sum += value;
+    result.nsPerOpMean = sum / nsPerOp.size();
+    result.opsPerSecond = threadCount * NanosecondsPerSecond / result.nsPerOpMedian;
+}
+
+class BenchSuite
+{
+public:
+    BenchSuite(const BenchOptions& options)
+        : _Options(options)
+    {
+    }
+
+    bool IsSelected(const string& name) const
+    {
+        return _Options.filter == nullptr || name.find(_Options.filter) != string::npos;
+    }
+
+    void Add(BenchResult&& result)
+    {
+        if (result.frames > 0)
+            result.samplesPerSecond = result.opsPerSecond * result.frames * result.channels;
+        fprintf(stderr, "%-24s %-10s %-8s %5u frames %2u threads %12.1f ns/op\n", result.name.c_str(), result.variant.c_str(),
+            result.frames > 0 ? SampleFormatToString(result.sampleFormat) : "-", result.frames, result.threads, result.nsPerOpMedian);
+        _Results.push_back(std::move(result));
+    }
+
+    BenchResult CreateResult(const char* name, const char* variant, SampleFormat sampleFormat, u32 frames, u32 channels) const
+    {
+        BenchResult result;
+        result.name = name;
+        result.variant = variant;
+        result.sampleFormat = sampleFormat;
+        result.frames = frames;
+        result.channels = channels;
+        result.threads = 1;
+        result.iterations = 0;
+        result.nsPerOpMin = 0.0;
+        result.nsPerOpMedian = 0.0;
+        result.nsPerOpMean = 0.0;
+        result.samplesPerSecond = 0.0;
+        result.opsPerSecond = 0.0;
+        return result;
+    }
+
+    const BenchOptions& GetOptions() const
+    {
+        return _Options;
+    }
+
+    Result WriteJson() const
+    {
+        FILE* file = _Options.outputPath != nullptr ? fopen(_Options.outputPath, "w") : stdout;
+        if (file == nullptr)
+            LOOM_RETURN_RESULT(Result::InvalidFile);
+        fprintf(file, "{\n  \"context\": {\n");
+#if defined(__OPTIMIZE__) || (defined(_MSC_VER) && defined(NDEBUG))
+        fprintf(file, "    \"optimized\": true,\n");
+#else
+        fprintf(file, "    \"optimized\": false,\n");
+#endif
+        fprintf(file, "    \"hardware_threads\": %u,\n", thread::hardware_concurrency());
+        fprintf(file, "    \"min_time\": %g,\n", _Options.minTime);
+        fprintf(file, "    \"repetitions\": %u\n  },\n  \"benchmarks\": [", Repetitions);
+        for (size_t i = 0; i < _Results.size(); ++i)
+        {
+            const BenchResult& result = _Results[i];
+            fprintf(file, "%s\n    {\"name\": \"%s\", \"variant\": \"%s\", \"sample_format\": \"%s\", \"frames\": %u, \"channels\": %u, \"threads\": %u, "
+                "\"iterations\": %llu, \"ns_per_op_min\": %.3f, \"ns_per_op_median\": %.3f, \"ns_per_op_mean\": %.3f, "
+                "\"ops_per_second\": %.1f, \"samples_per_second\": %.1f}",
+                i > 0 ? "," : "", result.name.c_str(), result.variant.c_str(), result.frames > 0 ? SampleFormatToString(result.sampleFormat) : "",
+                result.frames, result.channels, result.threads, static_cast<unsigned long long>(result.iterations),
+                result.nsPerOpMin, result.nsPerOpMedian, result.nsPerOpMean, result.opsPerSecond, result.samplesPerSecond);
+        }
+        fprintf(file, "\n  ]\n}\n");
+        if (file != stdout)
+            fclose(file);
+        return Result::Ok;
+    }
+
+private:
+    BenchOptions _Options;
+    vector<BenchResult> _Results;
+};
+
+AudioFormat CreateFormat(SampleFormat sampleFormat)
+{
+    AudioFormat format;
+    format.channels = Channels;
+    format.frameRate = AudioClock::DefaultFrameRate;
+    format.sampleFormat = sampleFormat;
+    return format;
+}
+
+vector<u8> CreateSamples(SampleFormat sampleFormat, u32 frames)
+{
+    AudioFormat format = CreateFormat(sampleFormat);
+    vector<u8> data(frames * format.GetFrameSize());
+    u32 samples = frames * Channels;
+    for (u32 i = 0; i < samples; ++i)
+    {
+        switch (sampleFormat)
+        {
+            case SampleFormat::Int16: reinterpret_cast<s16*>(data.data())[i] = static_cast<s16>(i % 7); break;
+            case SampleFormat::Int32: reinterpret_cast<s32*>(data.data())[i] = static_cast<s32>(i % 7); break;
+            case SampleFormat::Float32: reinterpret_cast<float*>(data.data())[i] = static_cast<float>(i % 7) * 0.001f; break;
+            default: break;
+        }
+    }
+    return data;
+}
+
+void BenchAddSamplesFrom(BenchSuite& suite)
+{
+    if (!suite.IsSelected("AddSamplesFrom"))
+        return;
+    for (SampleFormat sampleFormat : SampleFormats)
+    {
+        for (u32 frames : FrameCounts)
+        {
+            AudioFormat format = CreateFormat(sampleFormat);
+            // Silent sources keep the integer sums in range over the iterations
+            vector<u8> destinationData = CreateSamples(sampleFormat, frames);
+            vector<u8> sourceData(destinationData.size(), 0);
+            AudioBuffer destination(nullptr, format, destinationData.data(), static_cast<u32>(destinationData.size()));
+            AudioBuffer source(nullptr, format, sourceData.data(), static_cast<u32>(sourceData.size()));
+            destination.SetSize(static_cast<u32>(destinationData.size()));
+            source.SetSize(static_cast<u32>(sourceData.size()));
+            BenchResult result = suite.CreateResult("AddSamplesFrom", "", sampleFormat, frames, Channels);
+            RunSingleThreaded(suite.GetOptions(), [&]()
+            {
+                destination.AddSamplesFrom(source);
+            }, result);
+            suite.Add(std::move(result));
+        }
+    }
+}
+
+template <class T>
+void BenchMultiplySamplesBy(BenchSuite& suite, T multiplier)
+{
+    SampleFormat sampleFormat = TypeToSampleFormat<T>();
+    for (u32 frames : FrameCounts)
+    {
+        AudioFormat format = CreateFormat(sampleFormat);
+        vector<u8> data = CreateSamples(sampleFormat, frames);
+        AudioBuffer buffer(nullptr, format, data.data(), static_cast<u32>(data.size()));
+        buffer.SetSize(static_cast<u32>(data.size()));
+        BenchResult result = suite.CreateResult("MultiplySamplesBy", "", sampleFormat, frames, Channels);
+        RunSingleThreaded(suite.GetOptions(), [&]()
+        {
+            buffer.MultiplySamplesBy<T>(multiplier);
+        }, result);
+        suite.Add(std::move(result));
+    }
+}
+
+void BenchMultiplySamplesBy(BenchSuite& suite)
+{
+    if (!suite.IsSelected("MultiplySamplesBy"))
+        return;
+    // Integer samples are multiplied by -1 so that they stay in range
+    BenchMultiplySamplesBy<s16>(suite, -1);
+    BenchMultiplySamplesBy<s32>(suite, -1);
+    BenchMultiplySamplesBy<float>(suite, 0.5f);
+}
+
+template <class T>
+void BenchTransferBuffer(BenchSuite& suite, AudioSystem& system, const shared_ptr<AudioAsset>& asset)
+{
+    SampleFormat sampleFormat = TypeToSampleFormat<T>();
+    // A long fade keeps every iteration on the ramp
+    const char* variants[] = {"Steady", "Fade", "LoopFade"};
+    for (const char* variant : variants)
+    {
+        bool fade = strcmp(variant, "Fade") == 0;
+        bool loopFade = strcmp(variant, "LoopFade") == 0;
+        AssetReaderNode source(system, asset);
+        source.Play(fade ? 1000.0f : 0.0f);
+        for (u32 frames : FrameCounts)
+        {
+            vector<u8> sourceData = CreateSamples(sampleFormat, frames);
+            vector<u8> loopData = CreateSamples(sampleFormat, frames);
+            vector<u8> destinationData(sourceData.size());
+            u32 size = static_cast<u32>(sourceData.size());
+            BenchResult result = suite.CreateResult("TransferBuffer", variant, sampleFormat, frames, Channels);
+            RunSingleThreaded(suite.GetOptions(), [&]()
+            {
+                source.TransferBuffer<T>(destinationData.data(), sourceData.data(), size, Channels, 0,
+                    loopFade ? loopData.data() : nullptr, 0, loopFade ? frames : 0);
+            }, result);
+            suite.Add(std::move(result));
+        }
+    }
+}
+
+void BenchTransferBuffer(BenchSuite& suite, AudioSystem& system, const char* bankPath)
+{
+    if (!suite.IsSelected("TransferBuffer"))
+        return;
+    // Sources only play loaded assets, the samples themselves are not read
+    AudioAssetData data;
+    data.format = CreateFormat(SampleFormat::Float32);
+    data.frameCount = 1;
+    data.samples.resize(data.format.GetFrameSize());
+    SoundBankWriter writer;
+    shared_ptr<SoundBank> bank;
+    Result result = writer.AddAsset("bench", std::move(data));
+    if (Ok(result))
+        result = writer.Write(bankPath);
+    if (Ok(result))
+        result = system.LoadSoundBank(bankPath, bank);
+    shared_ptr<AudioAsset> asset = Ok(result) ? system.CreateAudioAsset("bench") : nullptr;
+    if (asset == nullptr)
+    {
+        LOOM_LOG_WARNING("Skipping TransferBuffer, unable to create the bench asset in %s.", bankPath);
+        return;
+    }
+    BenchTransferBuffer<s16>(suite, system, asset);
+    BenchTransferBuffer<s32>(suite, system, asset);
+    BenchTransferBuffer<float>(suite, system, asset);
+    system.UnloadSoundBank(bank);
+    std::remove(bankPath);
+}
+
+void BenchAudioBufferPool(BenchSuite& suite, AudioSystem& system)
+{
+    if (!suite.IsSelected("AudioBufferPool"))
+        return;
+    IAudioBufferProvider& bufferProvider = system.GetBufferProvider();
+    for (u32 threads = 1; threads <= suite.GetOptions().maxThreads; threads *= 2)
+    {
+        BenchResult result = suite.CreateResult("AudioBufferPool", "AllocateRelease", SampleFormat::Float32, 0, 0);
+        RunMultiThreaded(suite.GetOptions(), threads, [&](u32)
+        {
+            AudioBuffer buffer;
+            bufferProvider.AllocateBuffer(buffer);
+            buffer.Release();
+        }, result);
+        suite.Add(std::move(result));
+    }
+}
+
+void BenchAudioNodeParameter(BenchSuite& suite)
+{
+    if (!suite.IsSelected("AudioNodeParameter"))
+        return;
+    AudioNodeParameter parameter("Gain", AudioNodeParameterType::Float32, 1.0f, true, 0.0f, 10.0f);
+    for (u32 threads = 1; threads <= suite.GetOptions().maxThreads; threads *= 2)
+    {
+        BenchResult result = suite.CreateResult("AudioNodeParameter", "GetValue", SampleFormat::Float32, 0, 0);
+        RunMultiThreaded(suite.GetOptions(), threads, [&](u32)
+        {
+            float value = 0.0f;
+            parameter.GetValue<float>(value);
+            BenchSink = value;
+        }, result);
+        suite.Add(std::move(result));
+    }
+}
+
+void PrintUsage()
+{
+    fprintf(stderr,
+        "Usage: loom_bench [options]\n"
+        "  --filter <text>     Only runs the benchmarks whose name contains text\n"
+        "  --min-time <s>      Approximate time spent measuring each case (default 0.2)\n"
+        "  --max-threads <n>   Highest thread count of the multithreaded cases (default: hardware threads)\n"
+        "  --out <path>        Writes the JSON report to path instead of stdout\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--filter") == 0 && hasValue)
+            options.filter = argv[++i];
+        else if (strcmp(argv[i], "--min-time") == 0 && hasValue)
+            options.minTime = std::max(atof(argv[++i]), 0.001);
+        else if (strcmp(argv[i], "--max-threads") == 0 && hasValue)
+            options.maxThreads = std::max(atoi(argv[++i]), 1);
+        else if (strcmp(argv[i], "--out") == 0 && hasValue)
+            options.outputPath = argv[++i];
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    // Buffers of the pool are as large as the largest benchmarked buffer
+    AudioSystem system;
+    Result result = system.InitializeOffline(CreateFormat(SampleFormat::Float32), FrameCounts[sizeof(FrameCounts) / sizeof(FrameCounts[0]) - 1]);
+    if (!Ok(result))
+    {
+        LOOM_LOG_RESULT(result);
+        return 1;
+    }
+
+    BenchSuite suite(options);
+    BenchAddSamplesFrom(suite);
+    BenchMultiplySamplesBy(suite);
+    BenchTransferBuffer(suite, system, "loom_bench.bank");
+    BenchAudioBufferPool(suite, system);
+    BenchAudioNodeParameter(suite);
+    result = suite.WriteJson();
+    return Ok(result) ? 0 : 1;
+}
@@ -0,0 +1,349 @@
+#include "loom/loom.h"
+#include "loom/time.h"
+
+#include <cmath>
+#include <cstdlib>
+
+using namespace Loom;
+
+// Scenario benchmark: full graphs of looping voices mixed through submixes into a master,
+// rendered offline. For every thread count it searches the largest voice count whose
+// callback time percentile fits the buffer budget, each thread rendering its own system.
+// Configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+
+namespace
+{
+
+struct ScenarioOptions
+{
+    ScenarioOptions()
+        : frameRate(AudioClock::DefaultFrameRate)
+        , bufferFrames(256)
+        , budgetMilliseconds(0.0)
+        , seconds(1.0)
+        , maxThreads(std::max(thread::hardware_concurrency(), 1u))
+        , voicesPerSubmix(16)
+        , startVoices(64)
+        , maxVoices(65536)
+        , outputPath(nullptr)
+    {
+    }
+
+    u32 frameRate;
+    u32 bufferFrames;
+    // Defaults to the duration of a buffer, 5.3 ms for 256 frames at 48 kHz
+    double budgetMilliseconds;
+    double seconds;
+    u32 maxThreads;
+    u32 voicesPerSubmix;
+    u32 startVoices;
+    u32 maxVoices;
+    const char* outputPath;
+};
+
+struct ScenarioRun
+{
+    ScenarioRun()
+        : threads(0)
+        , voices(0)
+        , p50Milliseconds(0.0)
+        , p99Milliseconds(0.0)
+        , p999Milliseconds(0.0)
+        , maxMilliseconds(0.0)
+        , realtimeFactor(0.0)
+        , fits(false)
+        , result(Result::Ok)
+    {
+    }
+
+    u32 threads;
+    // Voices of each system, a system per thread
+    u32 voices;
+    double p50Milliseconds;
+    double p99Milliseconds;
+    double p999Milliseconds;
+    double maxMilliseconds;
+    double realtimeFactor;
+    bool fits;
+    Result result;
+};
+
+struct ScenarioScaling
+{
+    u32 threads;
+    // Largest voice count per thread that fits the budget, along with its percentiles
+    ScenarioRun run;
+};
+
+constexpr u32 Channels = 2;
+// The first buffers of a job pay for cold caches and first allocations
+constexpr u32 WarmupBuffers = 8;
+const char* const BankPath = "loom_scenario.bank";
+const char* const AssetName = "voice";
+
+AudioFormat CreateFormat(const ScenarioOptions& options)
+{
+    AudioFormat format;
+    format.channels = Channels;
+    format.frameRate = options.frameRate;
+    format.sampleFormat = SampleFormat::Float32;
+    return format;
+}
+
+// A second of low level noise, so that voices never read silence
+Result WriteBank(const ScenarioOptions& options)
+{
+    AudioAssetData data;
+    data.format = CreateFormat(options);
+    data.frameCount = options.frameRate;
+    data.samples.resize(data.frameCount * data.format.GetFrameSize());
+    float* samples = reinterpret_cast<float*>(data.samples.data());
+    u32 seed = 1;
+    for (u32 i = 0; i < data.frameCount * Channels; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        samples[i] = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 0.001f;
+    }
+    SoundBankWriter writer;
+    Result result = writer.AddAsset(AssetName, std::move(data));
+    LOOM_CHECK_RESULT(result);
+    return writer.Write(BankPath);
+}
+
+// Voices are spread over as many submixes as needed, all feeding the master
+Result BuildGraph(const ScenarioOptions& options, AudioSystem& system, u32 voices)
+{
+    Result result = system.InitializeOffline(CreateFormat(options), options.bufferFrames);
+    LOOM_CHECK_RESULT(result);
+    shared_ptr<SoundBank> bank;
+    result = system.LoadSoundBank(BankPath, bank);
+    LOOM_CHECK_RESULT(result);
+    shared_ptr<AudioAsset> asset = system.CreateAudioAsset(AssetName);
+    if (asset == nullptr)
+        LOOM_RETURN_RESULT(Result::CannotFind);
+
+    IAudioGraph& graph = system.GetGraph();
+    AudioNodePtr master = graph.CreateNode<MixerNode>();
+    AudioNodePtr submix;
+    for (u32 i = 0; i < voices; ++i)
+    {
+        if (i % options.voicesPerSubmix == 0)
+        {
+            submix = graph.CreateNode<MixerNode>();
+            result = graph.ConnectNodes(submix, master);
+            LOOM_CHECK_RESULT(result);
+        }
+        AudioNodePtr voice = graph.CreateNode<AssetReaderNode>(asset);
+        shared_ptr<AssetReaderNode> reader = shared_ptr_cast<AssetReaderNode>(voice);
+        if (reader == nullptr)
+            LOOM_RETURN_RESULT(Result::UnableToAddNode);
+        reader->SetLoop(true);
+        // Staggered starts keep the voices from reading the same frames
+        result = reader->SeekFrame((i * 997) % options.frameRate);
+        LOOM_CHECK_RESULT(result);
+        result = reader->Play();
+        LOOM_CHECK_RESULT(result);
+        result = graph.ConnectNodes(voice, submix);
+        LOOM_CHECK_RESULT(result);
+    }
+    return Result::Ok;
+}
+
+double Percentile(const vector<u64>& sortedTimes, double percentile)
+{
+    if (sortedTimes.empty())
+        return 0.0;
+    size_t index = static_cast<size_t>(std::ceil(percentile * sortedTimes.size()));
+    index = std::min(std::max<size_t>(index, 1), sortedTimes.size()) - 1;
+    return static_cast<double>(sortedTimes[index]) / (NanosecondsPerSecond / 1000);
+}
+
+ScenarioRun RunScenario(const ScenarioOptions& options, u32 threads, u32 voices)
+{
+    ScenarioRun run;
+    run.threads = threads;
+    run.voices = voices;
+
+    vector<unique_ptr<AudioSystem>> systems;
+    vector<OfflineRenderJob> jobs;
+    u64 frameCount = static_cast<u64>(options.seconds * options.frameRate) + WarmupBuffers * options.bufferFrames;
+    for (u32 i = 0; i < threads && Ok(run.result); ++i)
+    {
+        systems.push_back(std::make_unique<AudioSystem>());
+        run.result = BuildGraph(options, *systems.back(), voices);
+        // An empty callback saves copying the output, like a device would
+        jobs.emplace_back(*systems.back(), frameCount, [](const AudioBuffer&, u64, void*) {});
+        jobs.back().recordBufferTimes = true;
+    }
+    if (!Ok(run.result))
+        return run;
+
+    OfflineRenderer renderer(threads);
+    run.result = renderer.Render(jobs);
+    vector<u64> times;
+    for (OfflineRenderJob& job : jobs)
+    {
+        if (job.bufferNanoseconds.size() > WarmupBuffers)
+            times.insert(times.end(), job.bufferNanoseconds.begin() + WarmupBuffers, job.bufferNanoseconds.end());
+    }
+    std::sort(times.begin(), times.end());
+    run.p50Milliseconds = Percentile(times, 0.5);
+    run.p99Milliseconds = Percentile(times, 0.99);
+    run.p999Milliseconds = Percentile(times, 0.999);
+    run.maxMilliseconds = Percentile(times, 1.0);
+    run.realtimeFactor = renderer.GetStats().realtimeFactor;
+    run.fits = Ok(run.result) && !times.empty() && run.p999Milliseconds <= options.budgetMilliseconds;
+
+    fprintf(stderr, "%u threads %6u voices  p50 %8.3f ms  p99 %8.3f ms  p99.9 %8.3f ms  %s\n",
+        threads, voices, run.p50Milliseconds, run.p99Milliseconds, run.p999Milliseconds, run.fits ? "fits" : "over budget");
+    return run;
+}
+
+// Doubles the voice count until the budget is exceeded, then bisects down to a few percent
+ScenarioScaling FindMaxVoices(const ScenarioOptions& options, u32 threads, vector<ScenarioRun>& runs)
+{
+    ScenarioScaling scaling;
+    scaling.threads = threads;
+    u32 low = 0;
+    u32 high = 0;
+    for (u32 voices = options.startVoices; voices <= options.maxVoices; voices *= 2)
+    {
+        runs.push_back(RunScenario(options, threads, voices));
+        if (!runs.back().fits)
+        {
+            high = voices;
+            break;
+        }
+        low = voices;
+        scaling.run = runs.back();
+    }
+    while (high > 0 && high - low > std::max(1u, low / 32))
+    {
+        u32 voices = low + (high - low) / 2;
+        runs.push_back(RunScenario(options, threads, voices));
+        if (runs.back().fits)
+        {
+            low = voices;
+            scaling.run = runs.back();
+        }
+        else
+        {
+            high = voices;
+        }
+    }
+    scaling.run.threads = threads;
+    scaling.run.voices = low;
+    return scaling;
+}
+
+void WriteRun(FILE* file, const ScenarioRun& run)
+{
+    fprintf(file, "{\"threads\": %u, \"voices\": %u, \"total_voices\": %u, \"p50_ms\": %.4f, \"p99_ms\": %.4f, \"p999_ms\": %.4f, "
+        "\"max_ms\": %.4f, \"realtime_factor\": %.2f, \"fits\": %s}",
+        run.threads, run.voices, run.threads * run.voices, run.p50Milliseconds, run.p99Milliseconds, run.p999Milliseconds,
+        run.maxMilliseconds, run.realtimeFactor, run.fits ? "true" : "false");
+}
+
+Result WriteJson(const ScenarioOptions& options, const vector<ScenarioScaling>& scalings, const vector<ScenarioRun>& runs)
+{
+    FILE* file = options.outputPath != nullptr ? fopen(options.outputPath, "w") : stdout;
+    if (file == nullptr)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    fprintf(file, "{\n  \"context\": {\n");
+#if defined(__OPTIMIZE__) || (defined(_MSC_VER) && defined(NDEBUG))
+    fprintf(file, "    \"optimized\": true,\n");
+#else
+    fprintf(file, "    \"optimized\": false,\n");
+#endif
+    fprintf(file, "    \"hardware_threads\": %u,\n", thread::hardware_concurrency());
+    fprintf(file, "    \"frame_rate\": %u,\n", options.frameRate);
+    fprintf(file, "    \"buffer_frames\": %u,\n", options.bufferFrames);
+    fprintf(file, "    \"budget_ms\": %.4f,\n", options.budgetMilliseconds);
+    fprintf(file, "    \"budget_percentile\": \"p99.9\",\n");
+    fprintf(file, "    \"seconds\": %g,\n", options.seconds);
+    fprintf(file, "    \"voices_per_submix\": %u\n  },\n  \"scaling\": [", options.voicesPerSubmix);
+    for (size_t i = 0; i < scalings.size(); ++i)
+    {
+        fprintf(file, "%s\n    ", i > 0 ? "," : "");
+        WriteRun(file, scalings[i].run);
+    }
+    fprintf(file, "\n  ],\n  \"runs\": [");
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        fprintf(file, "%s\n    ", i > 0 ? "," : "");
+        WriteRun(file, runs[i]);
+    }
+    fprintf(file, "\n  ]\n}\n");
+    if (file != stdout)
+        fclose(file);
+    return Result::Ok;
+}
+
+void PrintUsage()
+{
+    fprintf(stderr,
+        "Usage: loom_scenario [options]\n"
+        "  --buffer-frames <n>     Frames rendered per callback (default 256)\n"
+        "  --frame-rate <n>        Frame rate of the rendered graphs (default 48000)\n"
+        "  --budget-ms <ms>        Callback budget (default: duration of a buffer)\n"
+        "  --seconds <s>           Audio rendered by each system per measurement (default 1)\n"
+        "  --max-threads <n>       Measures 1 to n threads (default: hardware threads)\n"
+        "  --voices-per-submix <n> Voices mixed by each submix (default 16)\n"
+        "  --start-voices <n>      First voice count of the search (default 64)\n"
+        "  --max-voices <n>        Highest voice count of the search (default 65536)\n"
+        "  --out <path>            Writes the JSON report to path instead of stdout\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // Every source added to a graph logs, stdout is left to the JSON report
+    Logger::SetOutput(stderr);
+    ScenarioOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--buffer-frames") == 0 && hasValue)
+            options.bufferFrames = std::max(atoi(argv[++i]), 1);
+        else if (strcmp(argv[i], "--frame-rate") == 0 && hasValue)
+            options.frameRate = std::max(atoi(argv[++i]), 1);
+        else if (strcmp(argv[i], "--budget-ms") == 0 && hasValue)
+            options.budgetMilliseconds = std::max(atof(argv[++i]), 0.0);
+        else if (strcmp(argv[i], "--seconds") == 0 && hasValue)
+            options.seconds = std::max(atof(argv[++i]), 0.01);
+        else if (strcmp(argv[i], "--max-threads") == 0 && hasValue)
+            options.maxThreads = std::max(atoi(argv[++i]), 1);
+        else if (strcmp(argv[i], "--voices-per-submix") == 0 && hasValue)
+            options.voicesPerSubmix = std::max(atoi(argv[++i]), 1);
+        else if (strcmp(argv[i], "--start-voices") == 0 && hasValue)
+            options.startVoices = std::max(atoi(argv[++i]), 1);
+        else if (strcmp(argv[i], "--max-voices") == 0 && hasValue)
+            options.maxVoices = std::max(atoi(argv[++i]), 1);
+        else if (strcmp(argv[i], "--out") == 0 && hasValue)
+            options.outputPath = argv[++i];
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (options.budgetMilliseconds <= 0.0)
+        options.budgetMilliseconds = 1000.0 * options.bufferFrames / options.frameRate;
+
+    Result result = WriteBank(options);
+    if (!Ok(result))
+    {
+        LOOM_LOG_RESULT(result);
+        return 1;
+    }
+
+    vector<ScenarioScaling> scalings;
+    vector<ScenarioRun> runs;
+    for (u32 threads = 1; threads <= options.maxThreads; ++threads)
+        scalings.push_back(FindMaxVoices(options, threads, runs));
+    std::remove(BankPath);
+
+    result = WriteJson(options, scalings, runs);
+    return Ok(result) ? 0 : 1;
+}
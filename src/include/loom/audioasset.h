@@ -1,7 +1,10 @@
 #pragma once
 
 #include "loom/audiobuffer.h"
+#include "loom/blockcodec.h"
 #include "loom/interfaces/iaudiosystem.h"
+#include "loom/interfaces/iaudiostreamer.h"
+#include "loom/interfaces/iaudioassetloader.h"
 
 namespace Loom
 {
@@ -15,16 +18,91 @@ enum class AudioAssetState
     Unloading
 };
 
-using AudioAssetCallback = void(*)();
+enum class AudioAssetStorage
+{
+    // Whole asset decoded in memory
+    Resident,
+    // Only the first frames are kept in memory, the rest is read from disk while playing
+    Streamed,
+    // Whole asset kept encoded in memory, decoded block by block while playing
+    Compressed,
+    // View into a memory mapped sound bank, PCM or encoded
+    Mapped
+};
 
-class AudioAsset
+// Decoded content of an asset
+struct AudioAssetData
+{
+    AudioAssetData()
+        : frameCount(0)
+        , encoding(SampleEncoding::Pcm)
+        , blockFrames(0)
+        , mappedSamples(nullptr)
+        , mappedSampleSize(0)
+        , mappedBlockOffsets(nullptr)
+    {
+    }
+
+    bool IsMapped() const
+    {
+        return mapping != nullptr;
+    }
+
+    const u8* GetSamples() const
+    {
+        return IsMapped() ? mappedSamples : samples.data();
+    }
+
+    u64 GetSampleSize() const
+    {
+        return IsMapped() ? mappedSampleSize : samples.size();
+    }
+
+    const u32* GetBlockOffsets() const
+    {
+        return IsMapped() ? mappedBlockOffsets : blockOffsets.data();
+    }
+
+    u32 GetBlockCount() const
+    {
+        return blockFrames == 0 ? 0 : (frameCount + blockFrames - 1) / blockFrames;
+    }
+
+    // Format of the decoded samples
+    AudioFormat format;
+    // Total frames of the asset, which can exceed the resident samples of a streamed asset
+    u32 frameCount;
+    vector<u8> samples;
+
+    // Encoded assets are split in blocks decoded independently,
+    // block i spans samples[blockOffsets[i]] to samples[blockOffsets[i + 1]]
+    SampleEncoding encoding;
+    u32 blockFrames;
+    vector<u32> blockOffsets;
+
+    // Views replacing the vectors above, into a memory mapped sound bank or data shared
+    // through the asset store. The mapping keeps them valid.
+    shared_ptr<const void> mapping;
+    const u8* mappedSamples;
+    u64 mappedSampleSize;
+    const u32* mappedBlockOffsets;
+};
+
+class AudioAsset : public enable_shared_from_this<AudioAsset>
 {
 public:
-    AudioAsset(IAudioSystem& system, const char* name, const char* filePath)
+    AudioAsset(IAudioSystem& system, const char* name, const char* filePath, AudioAssetStorage storage = AudioAssetStorage::Resident)
         : _System(system)
         , _Name(name)
         , _FilePath(filePath)
+        , _Storage(storage)
         , _State(AudioAssetState::Unloaded)
+        , _Duration(0.0f)
+        , _PinCount(0)
+        , _ResidentSize(0)
+        , _LastUse(NextUseTick())
+        , _LoopStartFrame(0)
+        , _LoopEndFrame(0)
     {
     }
 
@@ -35,16 +113,14 @@ public:
     {
     }
 
-    Result Load()
+    Result Load(AudioAssetLoadPriority priority = AudioAssetLoadPriority::Normal, AudioAssetCallback callback = nullptr, void* userData = nullptr)
     {
-        _System.LoadAsset(*this);
-        return Result::NotYetImplemented;
+        return _System.LoadAsset(*this, priority, callback, userData);
     }
 
     Result Unload()
     {
-        _System.UnloadAsset(*this);
-        return Result::NotYetImplemented;
+        return _System.UnloadAsset(*this);
     }
 
     const char* GetName() const
@@ -52,6 +128,33 @@ public:
         return _Name.c_str();
     }
 
+    const char* GetFilePath() const
+    {
+        return _FilePath.c_str();
+    }
+
+    AudioAssetStorage GetStorage() const
+    {
+        return _Storage;
+    }
+
+    bool IsStreamed() const
+    {
+        return _Storage == AudioAssetStorage::Streamed;
+    }
+
+    // Also false for compressed storage of a file that could not be encoded
+    bool IsEncoded() const
+    {
+        return _Data.encoding != SampleEncoding::Pcm;
+    }
+
+    // Loading and unloading do not apply to sound bank views
+    bool IsMapped() const
+    {
+        return _Storage == AudioAssetStorage::Mapped;
+    }
+
     float GetDuration() const
     {
         return _Duration;
@@ -59,29 +162,157 @@ public:
 
     u32 GetFrames() const
     {
-        u32 frameCount = _Buffer.GetFrameCount();
+        u32 frameCount = _Data.frameCount;
         if (frameCount == 0)
             LOOM_LOG_RESULT(Result::InvalidBufferFrameRateFormat);
         return frameCount;
     }
 
+    // For streamed assets, this only holds the resident first frames of the asset.
+    // For encoded assets, the format is the decoded one while the data holds the blocks.
     const AudioBuffer& GetBuffer() const
     {
         return _Buffer;
     }
 
+    const AudioAssetData& GetData() const
+    {
+        return _Data;
+    }
+
     AudioAssetState GetState() const
     {
-        return _State;
+        return _State.load(std::memory_order_acquire);
+    }
+
+    // A pinned asset is in use and cannot be evicted from the cache
+    void Pin()
+    {
+        _PinCount.fetch_add(1);
+        _LastUse.store(NextUseTick(), std::memory_order_relaxed);
+    }
+
+    void Unpin()
+    {
+        _LastUse.store(NextUseTick(), std::memory_order_relaxed);
+        _PinCount.fetch_sub(1);
+    }
+
+    bool IsPinned() const
+    {
+        return _PinCount.load() > 0;
+    }
+
+    // Bytes of samples kept in memory by the asset, including data shared with other systems,
+    // but not samples mapped from a sound bank
+    u64 GetResidentSize() const
+    {
+        return _ResidentSize.load(std::memory_order_relaxed);
+    }
+
+    u64 GetLastUse() const
+    {
+        return _LastUse.load(std::memory_order_relaxed);
+    }
+
+    // Region looped by sources that do not set their own, an end frame of 0 is the end of the asset
+    void SetLoopRegion(u32 startFrame, u32 endFrame)
+    {
+        _LoopStartFrame.store(startFrame, std::memory_order_relaxed);
+        _LoopEndFrame.store(endFrame, std::memory_order_relaxed);
+    }
+
+    u32 GetLoopStartFrame() const
+    {
+        return _LoopStartFrame.load(std::memory_order_relaxed);
+    }
+
+    u32 GetLoopEndFrame() const
+    {
+        return _LoopEndFrame.load(std::memory_order_relaxed);
     }
 
 private:
+    friend class AudioSystem;
+    friend class AudioStreamer;
+    friend class AudioAssetLoader;
+    friend class AudioAssetCache;
+    friend class SoundBank;
+
+    static u64 NextUseTick()
+    {
+        static atomic<u64> tick(0);
+        return tick.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    void SetData(AudioAssetData&& data)
+    {
+        _Data = std::move(data);
+        u32 size = static_cast<u32>(_Data.GetSampleSize());
+        _Buffer = AudioBuffer(nullptr, _Data.format, const_cast<u8*>(_Data.GetSamples()), size);
+        _Buffer.SetSize(size);
+        _Duration = _Data.format.frameRate > 0 ? static_cast<float>(_Data.frameCount) / _Data.format.frameRate : 0.0f;
+        // Sound bank samples are paged in and out by the OS
+        _ResidentSize.store(IsMapped() ? 0 : _Data.GetSampleSize(), std::memory_order_relaxed);
+        _LastUse.store(NextUseTick(), std::memory_order_relaxed);
+    }
+
+    void ReleaseData()
+    {
+        _Buffer = AudioBuffer();
+        _Data = AudioAssetData();
+        _Duration = 0.0f;
+        _ResidentSize.store(0, std::memory_order_relaxed);
+    }
+
+    // Pinning an asset while it is being evicted either cancels the eviction,
+    // or lets the user see the asset as not loaded anymore
+    bool TryEvict()
+    {
+        if (IsPinned() || !TransitionState(AudioAssetState::Loaded, AudioAssetState::Unloading))
+            return false;
+        if (IsPinned())
+        {
+            SetState(AudioAssetState::Loaded);
+            return false;
+        }
+        ReleaseData();
+        SetState(AudioAssetState::Unloaded);
+        return true;
+    }
+
+    // Sources pin their asset and read its samples from the audio thread without checking its
+    // state, so a pinned asset is not unloaded. Not being loaded is not an error.
+    Result TryUnload()
+    {
+        if (TryEvict() || GetState() != AudioAssetState::Loaded)
+            return Result::Ok;
+        LOOM_RETURN_RESULT(Result::Busy);
+    }
+
+    bool TransitionState(AudioAssetState from, AudioAssetState to)
+    {
+        return _State.compare_exchange_strong(from, to, std::memory_order_acq_rel);
+    }
+
+    void SetState(AudioAssetState state)
+    {
+        _State.store(state, std::memory_order_release);
+    }
+
     IAudioSystem& _System;
     string _Name;
     string _FilePath;
-    AudioAssetState _State;
+    AudioAssetStorage _Storage;
+    atomic<AudioAssetState> _State;
     float _Duration;
     AudioBuffer _Buffer;
+    AudioAssetData _Data;
+    atomic<u32> _PinCount;
+    atomic<u64> _ResidentSize;
+    atomic<u64> _LastUse;
+    atomic<u32> _LoopStartFrame;
+    atomic<u32> _LoopEndFrame;
 };
 
 
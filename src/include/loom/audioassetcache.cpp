@@ -0,0 +1,119 @@
+#include "loom/audioassetcache.h"
+#include "loom/audioasset.h"
+#include "loom/interfaces/iaudiosystem.h"
+
+namespace Loom
+{
+
+AudioAssetCache::AudioAssetCache(IAudioSystem& system)
+    : IAudioAssetCache(system)
+    , _Hits(0)
+    , _Misses(0)
+    , _Evictions(0)
+    , _EvictedBytes(0)
+{
+}
+
+const char* AudioAssetCache::GetName() const
+{
+    return "AudioAssetCache";
+}
+
+Result AudioAssetCache::Update()
+{
+    return Trim();
+}
+
+void AudioAssetCache::Shutdown()
+{
+    scoped_lock lock(_Mutex);
+    _Assets.clear();
+}
+
+Result AudioAssetCache::GetAsset(const char* filePath, AudioAssetStorage storage, shared_ptr<AudioAsset>& asset)
+{
+    if (filePath == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    scoped_lock lock(_Mutex);
+    auto it = _Assets.find(filePath);
+    if (it != _Assets.end() && it->second->GetStorage() == storage)
+    {
+        asset = it->second;
+        if (asset->GetState() == AudioAssetState::Loaded)
+            _Hits++;
+        else
+            _Misses++;
+        return Result::Ok;
+    }
+    if (it != _Assets.end())
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    _Misses++;
+    asset.reset(new AudioAsset(GetSystemInterface(), filePath, filePath, storage));
+    _Assets[filePath] = asset;
+    return Result::Ok;
+}
+
+Result AudioAssetCache::Trim()
+{
+    scoped_lock lock(_Mutex);
+    u64 budget = GetSystemInterface().GetConfig().assetCacheBudget;
+    u64 residentSize = GetResidentSize();
+    if (residentSize > budget)
+    {
+        _EvictionCandidates.clear();
+        for (auto& [filePath, asset] : _Assets)
+            if (!asset->IsPinned() && asset->GetResidentSize() > 0 && asset->GetState() == AudioAssetState::Loaded)
+                _EvictionCandidates.push_back(asset.get());
+        std::sort(_EvictionCandidates.begin(), _EvictionCandidates.end(), [](const AudioAsset* a, const AudioAsset* b)
+        {
+            return a->GetLastUse() < b->GetLastUse();
+        });
+        for (AudioAsset* asset : _EvictionCandidates)
+        {
+            if (residentSize <= budget)
+                break;
+            u64 size = asset->GetResidentSize();
+            if (!asset->TryEvict())
+                continue;
+            residentSize -= std::min(size, residentSize);
+            _Evictions++;
+            _EvictedBytes += size;
+        }
+        _EvictionCandidates.clear();
+    }
+
+    // Forget assets nobody else references once they hold no memory
+    for (auto it = _Assets.begin(); it != _Assets.end();)
+    {
+        AudioAssetState state = it->second->GetState();
+        bool released = state == AudioAssetState::Unloaded || state == AudioAssetState::InvalidPath;
+        if (released && it->second.use_count() == 1)
+            it = _Assets.erase(it);
+        else
+            ++it;
+    }
+    return Result::Ok;
+}
+
+Result AudioAssetCache::GetStats(AudioAssetCacheStats& stats) const
+{
+    scoped_lock lock(_Mutex);
+    stats.hits = _Hits;
+    stats.misses = _Misses;
+    stats.evictions = _Evictions;
+    stats.evictedBytes = _EvictedBytes;
+    stats.residentBytes = GetResidentSize();
+    stats.budgetBytes = GetSystemInterface().GetConfig().assetCacheBudget;
+    stats.assetCount = static_cast<u32>(_Assets.size());
+    return Result::Ok;
+}
+
+u64 AudioAssetCache::GetResidentSize() const
+{
+    u64 residentSize = 0;
+    for (const auto& [filePath, asset] : _Assets)
+        residentSize += asset->GetResidentSize();
+    return residentSize;
+}
+
+} // namespace Loom
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "loom/interfaces/iaudioassetcache.h"
+
+namespace Loom
+{
+
+// Owns the assets created by the system, keyed by file path.
+// Once the resident samples exceed the configured budget, loaded assets that
+// are not pinned get unloaded, least recently used first.
+class AudioAssetCache : public IAudioAssetCache
+{
+public:
+    AudioAssetCache(IAudioSystem& system);
+    const char* GetName() const override;
+    Result Update() override;
+    void Shutdown() override;
+    Result GetAsset(const char* filePath, AudioAssetStorage storage, shared_ptr<AudioAsset>& asset) override;
+    Result Trim() override;
+    Result GetStats(AudioAssetCacheStats& stats) const override;
+
+private:
+    u64 GetResidentSize() const;
+
+private:
+    mutable mutex _Mutex;
+    map<string, shared_ptr<AudioAsset>> _Assets;
+    vector<AudioAsset*> _EvictionCandidates;
+    u64 _Hits;
+    u64 _Misses;
+    u64 _Evictions;
+    u64 _EvictedBytes;
+};
+
+} // namespace Loom
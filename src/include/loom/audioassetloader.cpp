@@ -0,0 +1,272 @@
+#include "loom/audioassetloader.h"
+#include "loom/audioasset.h"
+#include "loom/audioassetstore.h"
+#include "loom/interfaces/iaudiosystem.h"
+#include "loom/interfaces/iaudiocodec.h"
+#include "loom/file.h"
+#include "loom/audiotracer.h"
+
+namespace Loom
+{
+
+AudioAssetLoader::AudioAssetLoader(IAudioSystem& system)
+    : IAudioAssetLoader(system)
+    , _Running(false)
+    , _Sequence(0)
+{
+}
+
+AudioAssetLoader::~AudioAssetLoader()
+{
+    Shutdown();
+}
+
+const char* AudioAssetLoader::GetName() const
+{
+    return "AudioAssetLoader";
+}
+
+Result AudioAssetLoader::Initialize()
+{
+    scoped_lock lock(_Mutex);
+    if (_Running)
+        return Result::Ok;
+    const AudioSystemConfig& config = GetSystemInterface().GetConfig();
+    _Running = true;
+    for (u32 i = 0; i < std::max(config.assetLoaderIoThreads, 1u); ++i)
+        _Threads.emplace_back(&AudioAssetLoader::IoThread, this);
+    for (u32 i = 0; i < std::max(config.assetLoaderDecodeThreads, 1u); ++i)
+        _Threads.emplace_back(&AudioAssetLoader::DecodeThread, this);
+    return Result::Ok;
+}
+
+void AudioAssetLoader::Shutdown()
+{
+    {
+        scoped_lock lock(_Mutex);
+        _Running = false;
+    }
+    _IoWakeUp.notify_all();
+    _DecodeWakeUp.notify_all();
+    for (thread& workerThread : _Threads)
+        if (workerThread.joinable())
+            workerThread.join();
+    _Threads.clear();
+
+    // Requests still queued will never be served
+    map<AudioAsset*, RequestPtr> requests;
+    {
+        scoped_lock lock(_Mutex);
+        requests.swap(_Requests);
+        _IoQueue = priority_queue<QueueEntry>();
+        _DecodeQueue = priority_queue<QueueEntry>();
+    }
+    for (auto& [asset, request] : requests)
+    {
+        request->stage = RequestStage::Canceled;
+        asset->SetState(AudioAssetState::Unloaded);
+        for (Completion& completion : request->completions)
+            completion.callback(*asset, Result::Canceled, completion.userData);
+    }
+}
+
+Result AudioAssetLoader::LoadAsset(AudioAsset& asset, AudioAssetLoadPriority priority, AudioAssetCallback callback, void* userData)
+{
+    if (asset.IsStreamed() || asset.IsMapped())
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    shared_ptr<AudioAsset> sharedAsset = asset.weak_from_this().lock();
+    if (sharedAsset == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    bool sharedDataFound = false;
+    {
+        scoped_lock lock(_Mutex);
+        auto it = _Requests.find(&asset);
+        if (it != _Requests.end())
+        {
+            RequestPtr& request = it->second;
+            if (callback != nullptr)
+                request->completions.push_back({callback, userData});
+            if (priority > request->priority)
+            {
+                // The stale queue entry is skipped once the request moves past its stage
+                request->priority = priority;
+                if (request->stage == RequestStage::Queued)
+                    PushRequest(_IoQueue, request);
+                else if (request->stage == RequestStage::Read)
+                    PushRequest(_DecodeQueue, request);
+            }
+            return Result::Ok;
+        }
+        if (asset.TransitionState(AudioAssetState::Unloaded, AudioAssetState::Loading)
+            || asset.TransitionState(AudioAssetState::InvalidPath, AudioAssetState::Loading))
+        {
+            AudioAssetData sharedData;
+            if (!FindSharedData(asset, sharedData))
+            {
+                RequestPtr request(new Request());
+                request->asset = sharedAsset;
+                request->priority = priority;
+                request->stage = RequestStage::Queued;
+                if (callback != nullptr)
+                    request->completions.push_back({callback, userData});
+                _Requests[&asset] = request;
+                PushRequest(_IoQueue, request);
+                _IoWakeUp.notify_one();
+                return Result::Ok;
+            }
+            asset.SetData(std::move(sharedData));
+            asset.SetState(AudioAssetState::Loaded);
+            sharedDataFound = true;
+        }
+    }
+    if (asset.GetState() != AudioAssetState::Loaded)
+        LOOM_RETURN_RESULT(Result::InvalidState);
+    if (callback != nullptr)
+        callback(asset, Result::Ok, userData);
+    if (sharedDataFound)
+        GetSystemInterface().GetAssetCache().Trim();
+    return Result::Ok;
+}
+
+Result AudioAssetLoader::CancelLoad(AudioAsset& asset)
+{
+    RequestPtr request;
+    {
+        scoped_lock lock(_Mutex);
+        auto it = _Requests.find(&asset);
+        if (it == _Requests.end())
+            return Result::Ok;
+        request = it->second;
+        _Requests.erase(it);
+        request->stage = RequestStage::Canceled;
+        asset.SetState(AudioAssetState::Unloaded);
+    }
+    for (Completion& completion : request->completions)
+        completion.callback(asset, Result::Canceled, completion.userData);
+    return Result::Ok;
+}
+
+Result AudioAssetLoader::UnloadAsset(AudioAsset& asset)
+{
+    Result result = CancelLoad(asset);
+    LOOM_CHECK_RESULT(result);
+    return asset.TryUnload();
+}
+
+void AudioAssetLoader::IoThread()
+{
+    LOOM_TRACE_THREAD_NAME("Loom asset io");
+    RequestPtr request;
+    while (WaitForRequest(_IoQueue, _IoWakeUp, RequestStage::Queued, RequestStage::Reading, request))
+    {
+        LOOM_TRACE_SCOPE("AssetLoader", "Read");
+        // Another system may have loaded the asset since the request was queued
+        AudioAssetData sharedData;
+        if (FindSharedData(*request->asset, sharedData))
+        {
+            CompleteRequest(request, Result::Ok, &sharedData);
+            continue;
+        }
+        vector<u8> fileData;
+        Result result = ReadFile(request->asset->GetFilePath(), fileData);
+        if (!Ok(result))
+        {
+            CompleteRequest(request, result, nullptr);
+            continue;
+        }
+        {
+            scoped_lock lock(_Mutex);
+            if (request->stage == RequestStage::Canceled)
+                continue;
+            request->fileData = std::move(fileData);
+            request->stage = RequestStage::Read;
+            PushRequest(_DecodeQueue, request);
+        }
+        _DecodeWakeUp.notify_one();
+    }
+}
+
+void AudioAssetLoader::DecodeThread()
+{
+    LOOM_TRACE_THREAD_NAME("Loom asset decode");
+    RequestPtr request;
+    while (WaitForRequest(_DecodeQueue, _DecodeWakeUp, RequestStage::Read, RequestStage::Decoding, request))
+    {
+        LOOM_TRACE_SCOPE("AssetLoader", "Decode");
+        AudioAssetData data;
+        const vector<u8>& fileData = request->fileData;
+        AudioAsset& asset = *request->asset;
+        Result result = GetSystemInterface().GetCodec().DecodeAsset(fileData.data(), fileData.size(), asset.GetStorage(), data);
+        if (Ok(result) && GetSystemInterface().GetConfig().shareAssets)
+            data = AudioAssetStore::CreateView(AudioAssetStore::GetInstance().Insert(asset.GetFilePath(), asset.GetStorage(), std::move(data)));
+        CompleteRequest(request, result, &data);
+    }
+}
+
+bool AudioAssetLoader::FindSharedData(const AudioAsset& asset, AudioAssetData& data) const
+{
+    if (!GetSystemInterface().GetConfig().shareAssets)
+        return false;
+    shared_ptr<const AudioAssetData> sharedData = AudioAssetStore::GetInstance().Find(asset.GetFilePath(), asset.GetStorage());
+    if (sharedData == nullptr)
+        return false;
+    data = AudioAssetStore::CreateView(sharedData);
+    return true;
+}
+
+bool AudioAssetLoader::WaitForRequest(priority_queue<QueueEntry>& queue, condition_variable& wakeUp, RequestStage stage, RequestStage nextStage, RequestPtr& request)
+{
+    request = nullptr;
+    mutex_lock lock(_Mutex);
+    while (true)
+    {
+        wakeUp.wait(lock, [this, &queue]()
+        {
+            return !_Running || !queue.empty();
+        });
+        if (!_Running)
+            return false;
+        RequestPtr candidate = queue.top().request;
+        queue.pop();
+        // Canceled, or already taken through an entry of higher priority
+        if (candidate->stage != stage)
+            continue;
+        candidate->stage = nextStage;
+        request = candidate;
+        return true;
+    }
+}
+
+void AudioAssetLoader::PushRequest(priority_queue<QueueEntry>& queue, const RequestPtr& request)
+{
+    queue.push({request, request->priority, _Sequence++});
+}
+
+void AudioAssetLoader::CompleteRequest(const RequestPtr& request, Result result, AudioAssetData* data)
+{
+    AudioAsset& asset = *request->asset;
+    {
+        scoped_lock lock(_Mutex);
+        if (request->stage == RequestStage::Canceled)
+            return;
+        request->stage = RequestStage::Completed;
+        request->fileData = vector<u8>();
+        _Requests.erase(&asset);
+        if (Ok(result) && data != nullptr)
+        {
+            asset.SetData(std::move(*data));
+            asset.SetState(AudioAssetState::Loaded);
+        }
+        else
+        {
+            LOOM_LOG_WARNING("Unable to load %s.", asset.GetName());
+            asset.SetState(AudioAssetState::InvalidPath);
+        }
+    }
+    for (Completion& completion : request->completions)
+        completion.callback(asset, result, completion.userData);
+    if (Ok(result))
+        GetSystemInterface().GetAssetCache().Trim();
+}
+
+} // namespace Loom
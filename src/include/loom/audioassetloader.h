@@ -0,0 +1,88 @@
+#pragma once
+
+#include "loom/interfaces/iaudioassetloader.h"
+
+namespace Loom
+{
+
+struct AudioAssetData;
+
+// Loads resident assets in the background.
+// Files are read by I/O threads then handed to decode threads, both serving
+// the most urgent requests first. Concurrent loads of an asset share a request.
+class AudioAssetLoader : public IAudioAssetLoader
+{
+public:
+    AudioAssetLoader(IAudioSystem& system);
+    ~AudioAssetLoader();
+    const char* GetName() const override;
+    Result Initialize() override;
+    void Shutdown() override;
+    Result LoadAsset(AudioAsset& asset, AudioAssetLoadPriority priority, AudioAssetCallback callback, void* userData) override;
+    Result CancelLoad(AudioAsset& asset) override;
+    // Busy while a source pins the asset
+    Result UnloadAsset(AudioAsset& asset) override;
+
+private:
+    enum class RequestStage
+    {
+        Queued,
+        Reading,
+        Read,
+        Decoding,
+        Completed,
+        Canceled
+    };
+
+    struct Completion
+    {
+        AudioAssetCallback callback;
+        void* userData;
+    };
+
+    struct Request
+    {
+        shared_ptr<AudioAsset> asset;
+        AudioAssetLoadPriority priority;
+        RequestStage stage;
+        vector<Completion> completions;
+        vector<u8> fileData;
+    };
+
+    using RequestPtr = shared_ptr<Request>;
+
+    struct QueueEntry
+    {
+        RequestPtr request;
+        AudioAssetLoadPriority priority;
+        u64 sequence;
+
+        // Highest priority first, then first come first served
+        bool operator<(const QueueEntry& other) const
+        {
+            if (priority != other.priority)
+                return priority < other.priority;
+            return sequence > other.sequence;
+        }
+    };
+
+    void IoThread();
+    void DecodeThread();
+    bool WaitForRequest(priority_queue<QueueEntry>& queue, condition_variable& wakeUp, RequestStage stage, RequestStage nextStage, RequestPtr& request);
+    void PushRequest(priority_queue<QueueEntry>& queue, const RequestPtr& request);
+    void CompleteRequest(const RequestPtr& request, Result result, AudioAssetData* data);
+    bool FindSharedData(const AudioAsset& asset, AudioAssetData& data) const;
+
+private:
+    bool _Running;
+    mutex _Mutex;
+    condition_variable _IoWakeUp;
+    condition_variable _DecodeWakeUp;
+    priority_queue<QueueEntry> _IoQueue;
+    priority_queue<QueueEntry> _DecodeQueue;
+    map<AudioAsset*, RequestPtr> _Requests;
+    u64 _Sequence;
+    vector<thread> _Threads;
+};
+
+} // namespace Loom
@@ -0,0 +1,76 @@
+#include "loom/audioassetstore.h"
+
+namespace Loom
+{
+
+AudioAssetStore& AudioAssetStore::GetInstance()
+{
+    static AudioAssetStore instance;
+    return instance;
+}
+
+shared_ptr<const AudioAssetData> AudioAssetStore::Find(const char* filePath, AudioAssetStorage storage) const
+{
+    if (filePath == nullptr)
+        return nullptr;
+    shared_lock lock(_Mutex);
+    auto it = _Data.find(Key(filePath, storage));
+    if (it == _Data.end())
+        return nullptr;
+    return it->second.lock();
+}
+
+shared_ptr<const AudioAssetData> AudioAssetStore::Insert(const char* filePath, AudioAssetStorage storage, AudioAssetData&& data)
+{
+    if (filePath == nullptr)
+        return nullptr;
+    unique_lock lock(_Mutex);
+    weak_ptr<const AudioAssetData>& entry = _Data[Key(filePath, storage)];
+    shared_ptr<const AudioAssetData> storedData = entry.lock();
+    if (storedData != nullptr)
+        return storedData;
+    storedData.reset(new AudioAssetData(std::move(data)));
+    entry = storedData;
+    RemoveExpiredData();
+    return storedData;
+}
+
+u32 AudioAssetStore::GetAssetCount() const
+{
+    shared_lock lock(_Mutex);
+    u32 count = 0;
+    for (auto& [key, data] : _Data)
+        if (!data.expired())
+            ++count;
+    return count;
+}
+
+AudioAssetData AudioAssetStore::CreateView(const shared_ptr<const AudioAssetData>& data)
+{
+    AudioAssetData view;
+    if (data == nullptr)
+        return view;
+    view.format = data->format;
+    view.frameCount = data->frameCount;
+    view.encoding = data->encoding;
+    view.blockFrames = data->blockFrames;
+    view.mappedSamples = data->GetSamples();
+    view.mappedSampleSize = data->GetSampleSize();
+    view.mappedBlockOffsets = data->GetBlockOffsets();
+    view.mapping = data;
+    return view;
+}
+
+// Expects the lock to be held exclusively
+void AudioAssetStore::RemoveExpiredData()
+{
+    for (auto it = _Data.begin(); it != _Data.end();)
+    {
+        if (it->second.expired())
+            it = _Data.erase(it);
+        else
+            ++it;
+    }
+}
+
+} // namespace Loom
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "loom/audioasset.h"
+
+namespace Loom
+{
+
+// Decoded asset data shared by every audio system of the process, keyed by file path and storage.
+// Stored data is immutable, assets reference it through views and read it without locking.
+// Data is released along with the last view referencing it.
+class AudioAssetStore
+{
+public:
+    static AudioAssetStore& GetInstance();
+
+    shared_ptr<const AudioAssetData> Find(const char* filePath, AudioAssetStorage storage) const;
+    // When the data was stored concurrently by another system, the stored data is returned instead
+    shared_ptr<const AudioAssetData> Insert(const char* filePath, AudioAssetStorage storage, AudioAssetData&& data);
+    u32 GetAssetCount() const;
+
+    static AudioAssetData CreateView(const shared_ptr<const AudioAssetData>& data);
+
+private:
+    AudioAssetStore() = default;
+    void RemoveExpiredData();
+
+private:
+    using Key = pair<string, AudioAssetStorage>;
+
+    mutable shared_mutex _Mutex;
+    map<Key, weak_ptr<const AudioAssetData>> _Data;
+};
+
+} // namespace Loom
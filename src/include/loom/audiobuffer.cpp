@@ -6,10 +6,10 @@ namespace Loom
 
 AudioBuffer::AudioBuffer(IAudioSystem* system, AudioFormat format, u8* data, u32 capacity)
     : _System(system)
-    , _Data(data)
+    , _Capacity(capacity)
     , _Size(0)
+    , _Data(data)
     , _Format(format)
-    , _Capacity(capacity)
     , _RefCount(nullptr)
 {
     if (_System != nullptr)
@@ -23,10 +23,10 @@ AudioBuffer::~AudioBuffer()
 
 AudioBuffer::AudioBuffer(const AudioBuffer& other)
     : _System(other._System)
-    , _Data(other._Data)
+    , _Capacity(other._Capacity)
     , _Size(other._Size)
+    , _Data(other._Data)
     , _Format(other._Format)
-    , _Capacity(other._Capacity)
     , _RefCount(other._RefCount)
 {
     if (_RefCount != nullptr)
@@ -184,4 +184,12 @@ u32 AudioBuffer::GetSize() const
     return _Size;
 }
 
+Result AudioBuffer::SetSize(u32 size)
+{
+    if (size > _Capacity)
+        LOOM_RETURN_RESULT(Result::BufferCapacityMismatch);
+    _Size = size;
+    return Result::Ok;
+}
+
 } // namespace Loom
@@ -29,6 +29,7 @@ public:
     SampleFormat GetSampleFormat() const;
     u32 GetSampleSize() const;
     u32 GetSize() const;
+    Result SetSize(u32 size);
     AudioFormat GetFormat() const;
 
     Result AddSamplesFrom(const AudioBuffer& other);
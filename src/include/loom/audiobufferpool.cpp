@@ -1,16 +1,19 @@
 #include "loom/audiobufferpool.h"
 #include "loom/audiobuffer.h"
+#include "loom/audiotracer.h"
 
 namespace Loom
 {
 
 AudioBufferPool::AudioBufferPool(IAudioSystem& system, AudioFormat audioFormat, u32 bufferCapacity)
     : IAudioBufferProvider(system)
-    , _AudioFormat(audioFormat)
     , _BufferCapacity(bufferCapacity)
-    , _Head(0)
+    , _AudioFormat(audioFormat)
+    , _Head(TailSentinel)
+    , _Blocks(MaxBlocks)
+    , _BlockCount(0)
 {
-    InitializeNewBlock();
+    ExpandPool();
 }
 
 const char* AudioBufferPool::GetName() const
@@ -20,14 +23,23 @@ const char* AudioBufferPool::GetName() const
 
 Result AudioBufferPool::AllocateBuffer(AudioBuffer& buffer)
 {
+    u64 head = _Head.load(std::memory_order_acquire);
     u32 currentIndex = TailSentinel;
-    do
+    while (true)
     {
-        currentIndex = _Head.load(std::memory_order_relaxed);
+        currentIndex = GetHeadIndex(head);
         if (currentIndex == TailSentinel)
-            ExpandPool(currentIndex);
+        {
+            if (!ExpandPool())
+                LOOM_RETURN_RESULT(Result::FailedAllocation);
+            head = _Head.load(std::memory_order_acquire);
+            continue;
+        }
+        // Stale when another thread took the buffer meanwhile, the exchange then fails
+        u32 nextIndex = GetNextIndex(currentIndex).load(std::memory_order_relaxed);
+        if (_Head.compare_exchange_weak(head, MakeHead(head, nextIndex), std::memory_order_acquire, std::memory_order_acquire))
+            break;
     }
-    while (!_Head.compare_exchange_strong(currentIndex, _NextBufferIndex[currentIndex]));
 
     u32 blockIndex = currentIndex / BlockSize;
     u32 bufferIndex = currentIndex % BlockSize;
@@ -49,43 +61,61 @@ Result AudioBufferPool::ReleaseBuffer(AudioBuffer& buffer)
     if(!FindBufferIndex(data, block, bufferIndex))
         LOOM_RETURN_RESULT(Result::BufferOutOfRange);
     u32 bufferPoolIndex = blockIndex * BlockSize + bufferIndex;
-    u32 currentHead = TailSentinel;
+    u64 head = _Head.load(std::memory_order_relaxed);
     do
     {
-        currentHead = _Head.load(std::memory_order_relaxed);
-        _Blocks[blockIndex]->buffers[bufferIndex].store(currentHead, std::memory_order_seq_cst);
+        block->buffers[bufferIndex].store(GetHeadIndex(head), std::memory_order_relaxed);
     }
-    while (!_Head.compare_exchange_strong(currentHead, bufferPoolIndex));
+    while (!_Head.compare_exchange_weak(head, MakeHead(head, bufferPoolIndex), std::memory_order_release, std::memory_order_relaxed));
     return Result::Ok;
 }
 
-void AudioBufferPool::ExpandPool(u32& currentIndex)
+u32 AudioBufferPool::GetHeadIndex(u64 head)
 {
-    scoped_lock lock(_ExpansionMutex);
-    if (_Head == TailSentinel)
-    {
-        u32 tailIndexFix = static_cast<u32>(_Blocks.size()) * BlockSize;
-        _NextBufferIndex[static_cast<u32>(_NextBufferIndex.size()) - 1] = tailIndexFix;
-        _Head = tailIndexFix;
-        currentIndex = tailIndexFix;
-        InitializeNewBlock();
-    }
+    return static_cast<u32>(head);
+}
+
+u64 AudioBufferPool::MakeHead(u64 previousHead, u32 index)
+{
+    return (((previousHead >> 32) + 1) << 32) | index;
 }
 
-typename AudioBufferPool::Block* AudioBufferPool::InitializeNewBlock()
+atomic<u32>& AudioBufferPool::GetNextIndex(u32 index)
 {
+    return _Blocks[index / BlockSize]->buffers[index % BlockSize];
+}
+
+bool AudioBufferPool::ExpandPool()
+{
+    LOOM_TRACE_SCOPE("BufferPool", "ExpandPool");
+    scoped_lock lock(_ExpansionMutex);
+    // Another thread expanded the pool, or buffers were released
+    if (GetHeadIndex(_Head.load(std::memory_order_acquire)) != TailSentinel)
+        return true;
+    u32 blockCount = _BlockCount.load(std::memory_order_relaxed);
+    if (blockCount == MaxBlocks)
+        return false;
     Block* block = new Block(_BufferCapacity);
-    _Blocks.emplace_back(block);
-    u32 baseIndex = BlockSize * (static_cast<u32>(_Blocks.size()) - 1);
-    for (u32 i = 0; i < BlockSize; ++i)
-        _NextBufferIndex.push_back(baseIndex + i + 1);
-    _NextBufferIndex[_NextBufferIndex.size() - 1] = TailSentinel;
-    return block;
+    u32 baseIndex = BlockSize * blockCount;
+    for (u32 i = 0; i + 1 < BlockSize; ++i)
+        block->buffers[i].store(baseIndex + i + 1, std::memory_order_relaxed);
+    _Blocks[blockCount].reset(block);
+    _BlockCount.store(blockCount + 1, std::memory_order_release);
+
+    // The new buffers are pushed in front of the ones released in the meantime
+    u64 head = _Head.load(std::memory_order_relaxed);
+    do
+    {
+        block->buffers[BlockSize - 1].store(GetHeadIndex(head), std::memory_order_relaxed);
+    }
+    while (!_Head.compare_exchange_weak(head, MakeHead(head, baseIndex), std::memory_order_release, std::memory_order_relaxed));
+    return true;
 }
 
 bool AudioBufferPool::FindBlockIndex(u8* pointer, Block*& block, u32& blockIndex)
 {
-    for (blockIndex = 0; blockIndex < static_cast<u32>(_Blocks.size()); ++blockIndex)
+    u32 blockCount = _BlockCount.load(std::memory_order_acquire);
+    for (blockIndex = 0; blockIndex < blockCount; ++blockIndex)
     {
         block= _Blocks[blockIndex].get();
         u8* blockStart = block->GetBufferData(0);
@@ -114,7 +144,7 @@ AudioBufferPool::Block::Block(u32 bufferSize)
     , _BufferSize(bufferSize)
 {
     if (_Data == nullptr)
-        LOOM_LOG_ERROR("Failed to allocate buffer block!");
+        LOOM_LOG_ERROR("Failed to allocate buffer block of %u bytes!", bufferSize * BlockSize);
 }
 
 AudioBufferPool::Block::~Block()
@@ -13,6 +13,7 @@ class AudioBufferPool : public IAudioBufferProvider
 {
 public:
     static constexpr u32 BlockSize = 32;
+    static constexpr u32 MaxBlocks = 1024;
 
     AudioBufferPool(IAudioSystem& system, AudioFormat audioFormat, u32 bufferCapacity);
     const char* GetName() const override;
@@ -25,6 +26,7 @@ private:
     class Block
     {
     public:
+        // Index of the next free buffer, for the free buffers of the block
         atomic<u32> buffers[BlockSize];
 
     public:
@@ -40,8 +42,12 @@ private:
         u32 _BufferSize;
     };
 
-    void ExpandPool(u32& currentIndex);
-    Block* InitializeNewBlock();
+    // The head of the free list holds an index in its low bits and a count of its updates in
+    // its high bits, so that a head popped and pushed back in between fails the exchange
+    static u32 GetHeadIndex(u64 head);
+    static u64 MakeHead(u64 previousHead, u32 index);
+    atomic<u32>& GetNextIndex(u32 index);
+    bool ExpandPool();
     bool FindBlockIndex(u8* pointer, Block*& block, u32& blockIndex);
     bool FindBufferIndex(u8* pointer, Block* block, u32& bufferIndex);
 
@@ -49,9 +55,10 @@ private:
     mutex _ExpansionMutex;
     u32 _BufferCapacity;
     AudioFormat _AudioFormat;
-    atomic<u32> _Head;
+    atomic<u64> _Head;
+    // Sized once, blocks are only ever added so the audio thread never sees the vector move
     vector<unique_ptr<Block>> _Blocks;
-    vector<u32> _NextBufferIndex;
+    atomic<u32> _BlockCount;
 };
 
 
@@ -0,0 +1,46 @@
+#include "loom/audioclock.h"
+
+namespace Loom
+{
+
+AudioClock::AudioClock()
+    : _FrameTime(0)
+    , _FrameRate(DefaultFrameRate)
+{
+}
+
+void AudioClock::SetFrameRate(u32 frameRate)
+{
+    if (frameRate > 0)
+        _FrameRate.store(frameRate, std::memory_order_relaxed);
+}
+
+u32 AudioClock::GetFrameRate() const
+{
+    return _FrameRate.load(std::memory_order_relaxed);
+}
+
+u64 AudioClock::GetFrameTime() const
+{
+    return _FrameTime.load(std::memory_order_acquire);
+}
+
+// Only called by the audio thread once a buffer is rendered
+void AudioClock::Advance(u32 frames)
+{
+    _FrameTime.fetch_add(frames, std::memory_order_release);
+}
+
+u64 AudioClock::SecondsToFrames(float seconds) const
+{
+    if (seconds <= 0.0f)
+        return 0;
+    return static_cast<u64>(std::llround(static_cast<double>(seconds) * GetFrameRate()));
+}
+
+float AudioClock::FramesToSeconds(u64 frames) const
+{
+    return static_cast<float>(static_cast<double>(frames) / GetFrameRate());
+}
+
+} // namespace Loom
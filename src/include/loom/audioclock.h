@@ -0,0 +1,33 @@
+#pragma once
+
+#include "loom/defines.h"
+#include "loom/types.h"
+
+namespace Loom
+{
+
+// Monotonic sample clock of a system, counting the frames rendered to the device.
+// Fades, scheduling and positions are expressed on it, which keeps them in step with
+// the rendered audio and avoids reading the wall clock from the audio thread.
+class AudioClock
+{
+public:
+    static constexpr u32 DefaultFrameRate = 48000;
+
+    AudioClock();
+
+    void SetFrameRate(u32 frameRate);
+    u32 GetFrameRate() const;
+    // Frame time of the first frame of the buffer being rendered, or of the next one
+    u64 GetFrameTime() const;
+    void Advance(u32 frames);
+
+    u64 SecondsToFrames(float seconds) const;
+    float FramesToSeconds(u64 frames) const;
+
+private:
+    atomic<u64> _FrameTime;
+    atomic<u32> _FrameRate;
+};
+
+} // namespace Loom
@@ -1,5 +1,3 @@
-#pragma once
-
 #include "loom/audioformat.h"
 
 namespace Loom
@@ -37,4 +35,20 @@ bool AudioFormat::operator==(const AudioFormat& other) const
         && sampleFormat == other.sampleFormat;
 }
 
+u32 AudioFormat::GetSampleSize() const
+{
+    switch (sampleFormat)
+    {
+        case SampleFormat::Int16: return sizeof(s16);
+        case SampleFormat::Int32: return sizeof(s32);
+        case SampleFormat::Float32: return sizeof(float);
+        default: return 0;
+    }
+}
+
+u32 AudioFormat::GetFrameSize() const
+{
+    return channels * GetSampleSize();
+}
+
 } // namespace Loom
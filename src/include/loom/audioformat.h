@@ -26,6 +26,8 @@ public:
     AudioFormat(const AudioFormat& other);
     AudioFormat& operator=(const AudioFormat& other);
     bool operator==(const AudioFormat& other) const;
+    u32 GetSampleSize() const;
+    u32 GetFrameSize() const;
 };
 
 template <class T>
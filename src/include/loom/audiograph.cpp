@@ -2,6 +2,9 @@
 #include "loom/nodes/audionode.h"
 #include "loom/interfaces/iaudiosystem.h"
 #include "loom/nodes/mixernode.h"
+#include "loom/time.h"
+#include "loom/audiotracer.h"
+#include "loom/realtimesanitizer.h"
 
 namespace Loom
 {
@@ -12,6 +15,13 @@ AudioGraph::AudioGraph(IAudioSystem& system)
 {
 }
 
+AudioGraph::~AudioGraph()
+{
+    // Connected nodes hold each other, the links are broken for them to be released
+    for (const AudioNodePtr& node : _Nodes)
+        DisconnectNode(node);
+}
+
 const char* AudioGraph::GetName() const
 {
     return "AudioGraph";
@@ -39,7 +49,7 @@ void AudioGraph::OnNodeInsertSuccess(AudioNodePtr& node)
     if (result != Result::Ok)
     {
         LOOM_LOG_RESULT(result);
-        LOOM_LOG_WARNING("Failed node %s (%llu) initialization.", node->GetName(), node->GetId());
+        LOOM_LOG_WARNING("Failed node %s (%llu) initialization.", node->GetName(), static_cast<unsigned long long>(node->GetId()));
     }
     _UpdateNodesMutex.unlock();
 }
@@ -99,18 +109,43 @@ Result AudioGraph::Execute(AudioBuffer& destinationBuffer)
     AudioGraphState idleState = AudioGraphState::Idle;
     if (!_State.compare_exchange_strong(idleState, AudioGraphState::Busy))
         LOOM_RETURN_RESULT(Result::Busy);
-    Result result = Result::Ok;
-    result = UpdateNodes();
-    LOOM_CHECK_RESULT(result);
-    return _OutputNode->Execute(destinationBuffer);
+    LOOM_REALTIME_SCOPE();
+    LOOM_TRACE_SCOPE("Graph", "Execute");
+    // The clock is only read when profiling, instrumentation costs nothing otherwise
+    bool profile = _Profiler.IsEnabled();
+    std::chrono::steady_clock::time_point startTime;
+    if (profile)
+        startTime = std::chrono::steady_clock::now();
+    Result result = UpdateNodes();
+    if (Ok(result))
+        result = _Profiler.ExecuteNode(*_OutputNode, destinationBuffer);
+    if (profile)
+    {
+        // The buffer has to be rendered within the time it lasts
+        AudioFormat format = destinationBuffer.GetFormat();
+        u64 frames = format.GetFrameSize() > 0 ? destinationBuffer.GetSize() / format.GetFrameSize() : 0;
+        u64 deadline = format.frameRate > 0 ? frames * NanosecondsPerSecond / format.frameRate : 0;
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime);
+        _Profiler.RecordCallback(elapsed.count(), deadline);
+    }
+    _State = AudioGraphState::Idle;
+    return result;
+}
+
+AudioProfiler& AudioGraph::GetProfiler()
+{
+    return _Profiler;
 }
 
 Result AudioGraph::UpdateNodes()
 {
+    LOOM_TRACE_SCOPE("Graph", "UpdateNodes");
     scoped_lock lock(_UpdateNodesMutex);
     for (const AudioNodePtr& node : _NodesToRemove)
     {
         node->Shutdown();
+        DisconnectNode(node);
+        _Profiler.ReleaseNode(*node);
         _Nodes.erase(node);
     }
     _NodesToRemove.clear();
@@ -123,7 +158,7 @@ Result AudioGraph::UpdateNodes()
         LOOM_RETURN_RESULT(Result::MissingOutputNode);
     }
     for (NodeConnection& connection : _NodesToConnect)
-        connection.sourceNode->AddOutput(connection.destinationNode);
+        ConnectNodeOutput(connection.sourceNode, connection.destinationNode);
     _NodesToConnect.clear();
 
     // Evaluate output node
@@ -169,11 +204,28 @@ Result AudioGraph::UpdateNodes()
             _Nodes.insert(_OutputNode);
         }
         for (AudioNodePtr node : outputNodes)
-            node->AddOutput(_OutputNode);
+            ConnectNodeOutput(node, _OutputNode);
     }
     return Result::Ok;
 }
 
+void AudioGraph::ConnectNodeOutput(const AudioNodePtr& sourceNode, const AudioNodePtr& destinationNode)
+{
+    // The destination pulls from its inputs, the source only needs to know where it leads
+    sourceNode->AddOutput(destinationNode);
+    destinationNode->AddInput(sourceNode);
+}
+
+void AudioGraph::DisconnectNode(const AudioNodePtr& node)
+{
+    for (const AudioNodePtr& inputNode : GetNodeInputNodes(node))
+        GetNodeOutputNodes(inputNode).erase(node);
+    for (const AudioNodePtr& outputNode : GetNodeOutputNodes(node))
+        GetNodeInputNodes(outputNode).erase(node);
+    GetNodeInputNodes(node).clear();
+    GetNodeOutputNodes(node).clear();
+}
+
 void AudioGraph::SearchOutputNodes(AudioNodePtr node, set<AudioNodePtr>& outputNodesSearchResult)
 {
     if (NodeWasVisited(node))
@@ -12,6 +12,7 @@ class AudioGraph : public IAudioGraph
 {
 public:
     AudioGraph(IAudioSystem& system);
+    ~AudioGraph();
     Result Execute(AudioBuffer& destinationBuffer) override;
     const char* GetName() const override;
     AudioGraphState GetState() const override;
@@ -22,6 +23,7 @@ public:
     Result RemoveNode(AudioNodePtr& node) override;
     Result ConnectNodes(AudioNodePtr& sourceNode, AudioNodePtr& destinationNode) override;
     Result ConnectNodes(initializer_list<AudioNodePtr>&& nodes) override;
+    AudioProfiler& GetProfiler() override;
 
 private:
     struct NodeConnection
@@ -37,6 +39,8 @@ private:
     };
 
     Result UpdateNodes();
+    void ConnectNodeOutput(const AudioNodePtr& sourceNode, const AudioNodePtr& destinationNode);
+    void DisconnectNode(const AudioNodePtr& node);
     void SearchOutputNodes(AudioNodePtr node, set<AudioNodePtr>& outputNodesSearchResult);
     void ClearNodesVisitedFlag();
 
@@ -48,6 +52,7 @@ private:
     set<AudioNodePtr> _NodesToRemove;
     vector<NodeConnection> _NodesToConnect;
     mutex _UpdateNodesMutex;
+    AudioProfiler _Profiler;
 };
 
 
@@ -0,0 +1,291 @@
+#include "loom/audioprofiler.h"
+#include "loom/nodes/audionode.h"
+#include "loom/audiobuffer.h"
+#include "loom/audiotracer.h"
+
+namespace Loom
+{
+
+namespace
+{
+
+u64 SteadyNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+u32 HighestBit(u64 value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    u32 bit = 0;
+    while (value >>= 1)
+        ++bit;
+    return bit;
+#endif
+}
+
+} // namespace
+
+AudioProfilerHistogram::AudioProfilerHistogram()
+    : _Count(0)
+    , _Total(0)
+    , _Max(0)
+{
+    for (atomic<u64>& bucket : _Buckets)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+void AudioProfilerHistogram::Record(u64 value)
+{
+    // A single writer, read-modify-writes are not needed
+    atomic<u64>& bucket = _Buckets[GetBucket(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    _Total.store(_Total.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    if (value > _Max.load(std::memory_order_relaxed))
+        _Max.store(value, std::memory_order_relaxed);
+    _Count.store(_Count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void AudioProfilerHistogram::Reset()
+{
+    for (atomic<u64>& bucket : _Buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    _Total.store(0, std::memory_order_relaxed);
+    _Max.store(0, std::memory_order_relaxed);
+    _Count.store(0, std::memory_order_release);
+}
+
+u64 AudioProfilerHistogram::GetPercentile(double percentile) const
+{
+    // Buckets are read one by one while being written, their sum is used instead of the count
+    u64 counts[BucketCount];
+    u64 count = 0;
+    for (u32 i = 0; i < BucketCount; ++i)
+    {
+        counts[i] = _Buckets[i].load(std::memory_order_relaxed);
+        count += counts[i];
+    }
+    if (count == 0)
+        return 0;
+    u64 rank = static_cast<u64>(std::ceil(std::clamp(percentile, 0.0, 1.0) * count));
+    rank = std::max<u64>(rank, 1);
+    u64 cumulated = 0;
+    for (u32 i = 0; i < BucketCount; ++i)
+    {
+        cumulated += counts[i];
+        if (cumulated >= rank)
+            return std::min(GetBucketUpperBound(i), GetMax());
+    }
+    return GetMax();
+}
+
+u64 AudioProfilerHistogram::GetCount() const
+{
+    return _Count.load(std::memory_order_acquire);
+}
+
+u64 AudioProfilerHistogram::GetTotal() const
+{
+    return _Total.load(std::memory_order_relaxed);
+}
+
+u64 AudioProfilerHistogram::GetMax() const
+{
+    return _Max.load(std::memory_order_relaxed);
+}
+
+u32 AudioProfilerHistogram::GetBucket(u64 value)
+{
+    if (value < 4)
+        return static_cast<u32>(value);
+    // The two bits below the highest one split every octave in four
+    u32 highestBit = HighestBit(value);
+    u32 subBucket = static_cast<u32>(value >> (highestBit - 2)) & 3;
+    return (highestBit - 1) * 4 + subBucket;
+}
+
+u64 AudioProfilerHistogram::GetBucketUpperBound(u32 bucket)
+{
+    if (bucket < 4)
+        return bucket;
+    if (bucket >= BucketCount - 5)
+        return UINT64_MAX;
+    u32 highestBit = bucket / 4 + 1;
+    u64 subBucket = bucket % 4;
+    return ((4 + subBucket + 1) << (highestBit - 2)) - 1;
+}
+
+AudioProfiler::NodeSlot::NodeSlot()
+    : sequence(0)
+    , nodeId(0)
+    , name(nullptr)
+{
+}
+
+AudioProfiler::AudioProfiler()
+    : _Enabled(false)
+    , _Slots(new NodeSlot[MaxNodes])
+    , _NextSlot(0)
+    , _DroppedNodes(0)
+    , _Overruns(0)
+    , _DeadlineNanoseconds(0)
+    , _StartCycles(ReadCycles())
+    , _StartNanoseconds(SteadyNanoseconds())
+{
+}
+
+void AudioProfiler::SetEnabled(bool enabled)
+{
+    _Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool AudioProfiler::IsEnabled() const
+{
+    return _Enabled.load(std::memory_order_relaxed);
+}
+
+Result AudioProfiler::ExecuteNode(AudioNode& node, AudioBuffer& buffer, AudioNode* parentNode)
+{
+    LOOM_TRACE_SCOPE("Node", node.GetName());
+    if (!IsEnabled())
+        return node.Execute(buffer);
+
+    node._ProfiledInputCycles = 0;
+    u64 startCycles = ReadCycles();
+    Result result = node.Execute(buffer);
+    u64 cycles = ReadCycles() - startCycles;
+    if (parentNode != nullptr)
+        parentNode->_ProfiledInputCycles += cycles;
+
+    NodeSlot* slot = node._ProfilerSlot < MaxNodes ? &_Slots[node._ProfilerSlot] : ClaimSlot(node);
+    if (slot == nullptr)
+    {
+        _DroppedNodes.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+    slot->total.Record(cycles);
+    slot->self.Record(cycles - std::min(cycles, node._ProfiledInputCycles));
+    return result;
+}
+
+void AudioProfiler::RecordCallback(u64 nanoseconds, u64 deadlineNanoseconds)
+{
+    _Callbacks.Record(nanoseconds);
+    _DeadlineNanoseconds.store(deadlineNanoseconds, std::memory_order_relaxed);
+    if (nanoseconds > deadlineNanoseconds)
+        _Overruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AudioProfiler::ReleaseNode(AudioNode& node)
+{
+    if (node._ProfilerSlot >= MaxNodes)
+        return;
+    NodeSlot& slot = _Slots[node._ProfilerSlot];
+    u32 sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.nodeId.store(0, std::memory_order_relaxed);
+    slot.name.store(nullptr, std::memory_order_relaxed);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    node._ProfilerSlot = AudioNode::NoProfilerSlot;
+}
+
+AudioProfiler::NodeSlot* AudioProfiler::ClaimSlot(AudioNode& node)
+{
+    for (u32 i = 0; i < MaxNodes; ++i)
+    {
+        u32 index = (_NextSlot + i) % MaxNodes;
+        NodeSlot& slot = _Slots[index];
+        if (slot.nodeId.load(std::memory_order_relaxed) != 0)
+            continue;
+        u32 sequence = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.self.Reset();
+        slot.total.Reset();
+        slot.nodeId.store(node.GetId(), std::memory_order_relaxed);
+        slot.name.store(node.GetName(), std::memory_order_relaxed);
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        node._ProfilerSlot = index;
+        _NextSlot = (index + 1) % MaxNodes;
+        return &slot;
+    }
+    return nullptr;
+}
+
+Result AudioProfiler::GetSnapshot(AudioProfilerSnapshot& snapshot) const
+{
+    snapshot = AudioProfilerSnapshot();
+    FillStats(_Callbacks, 1.0, snapshot.callbacks);
+    snapshot.overruns = _Overruns.load(std::memory_order_relaxed);
+    snapshot.deadlineNanoseconds = _DeadlineNanoseconds.load(std::memory_order_relaxed);
+    snapshot.droppedNodes = _DroppedNodes.load(std::memory_order_relaxed);
+
+    double nanosecondsPerCycle = GetNanosecondsPerCycle();
+    for (u32 i = 0; i < MaxNodes; ++i)
+    {
+        const NodeSlot& slot = _Slots[i];
+        u32 sequence = slot.sequence.load(std::memory_order_acquire);
+        if ((sequence & 1) != 0 || slot.nodeId.load(std::memory_order_relaxed) == 0)
+            continue;
+        AudioNodeProfile profile;
+        profile.nodeId = slot.nodeId.load(std::memory_order_relaxed);
+        profile.name = slot.name.load(std::memory_order_relaxed);
+        FillStats(slot.self, nanosecondsPerCycle, profile.self);
+        FillStats(slot.total, nanosecondsPerCycle, profile.total);
+        // Skipped when the slot changed hands while being read
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+            snapshot.nodes.push_back(profile);
+    }
+    return Result::Ok;
+}
+
+void AudioProfiler::Reset()
+{
+    _Callbacks.Reset();
+    _Overruns.store(0, std::memory_order_relaxed);
+    _DroppedNodes.store(0, std::memory_order_relaxed);
+    for (u32 i = 0; i < MaxNodes; ++i)
+    {
+        _Slots[i].self.Reset();
+        _Slots[i].total.Reset();
+    }
+}
+
+double AudioProfiler::GetNanosecondsPerCycle() const
+{
+#if defined(LOOM_PROFILER_RDTSC)
+    // The counter rate is measured against the steady clock since construction
+    constexpr u64 MinCalibrationNanoseconds = 1000000;
+    u64 nanoseconds = SteadyNanoseconds() - _StartNanoseconds;
+    if (nanoseconds < MinCalibrationNanoseconds)
+    {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(MinCalibrationNanoseconds - nanoseconds));
+        nanoseconds = SteadyNanoseconds() - _StartNanoseconds;
+    }
+    u64 cycles = ReadCycles() - _StartCycles;
+    return cycles > 0 ? static_cast<double>(nanoseconds) / cycles : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+void AudioProfiler::FillStats(const AudioProfilerHistogram& histogram, double nanosecondsPerUnit, AudioProfileStats& stats)
+{
+    auto toNanoseconds = [nanosecondsPerUnit](u64 value)
+    {
+        return static_cast<u64>(value * nanosecondsPerUnit);
+    };
+    stats.count = histogram.GetCount();
+    stats.totalNanoseconds = toNanoseconds(histogram.GetTotal());
+    stats.maxNanoseconds = toNanoseconds(histogram.GetMax());
+    stats.meanNanoseconds = stats.count > 0 ? static_cast<double>(stats.totalNanoseconds) / stats.count : 0.0;
+    stats.p50Nanoseconds = toNanoseconds(histogram.GetPercentile(0.5));
+    stats.p99Nanoseconds = toNanoseconds(histogram.GetPercentile(0.99));
+    stats.p999Nanoseconds = toNanoseconds(histogram.GetPercentile(0.999));
+}
+
+} // namespace Loom
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "loom/defines.h"
+#include "loom/types.h"
+#include "loom/result.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #define LOOM_PROFILER_RDTSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #include <x86intrin.h>
+    #define LOOM_PROFILER_RDTSC 1
+#endif
+
+namespace Loom
+{
+
+class AudioNode;
+class AudioBuffer;
+
+// Lock-free histogram of durations with four buckets per octave, written by a single
+// thread while any thread reads it. Values are in the unit of the recorder, cycles
+// for the nodes and nanoseconds for the callbacks.
+class AudioProfilerHistogram
+{
+public:
+    static constexpr u32 BucketCount = 256;
+
+    AudioProfilerHistogram();
+    void Record(u64 value);
+    void Reset();
+    // Upper bound of the bucket holding the percentile, in [0, 1]
+    u64 GetPercentile(double percentile) const;
+    u64 GetCount() const;
+    u64 GetTotal() const;
+    u64 GetMax() const;
+
+    static u32 GetBucket(u64 value);
+    static u64 GetBucketUpperBound(u32 bucket);
+
+private:
+    atomic<u64> _Buckets[BucketCount];
+    atomic<u64> _Count;
+    atomic<u64> _Total;
+    atomic<u64> _Max;
+};
+
+struct AudioProfileStats
+{
+    AudioProfileStats()
+        : count(0)
+        , totalNanoseconds(0)
+        , maxNanoseconds(0)
+        , meanNanoseconds(0.0)
+        , p50Nanoseconds(0)
+        , p99Nanoseconds(0)
+        , p999Nanoseconds(0)
+    {
+    }
+
+    u64 count;
+    u64 totalNanoseconds;
+    u64 maxNanoseconds;
+    double meanNanoseconds;
+    // Percentiles are rounded up to the histogram resolution, about 20%
+    u64 p50Nanoseconds;
+    u64 p99Nanoseconds;
+    u64 p999Nanoseconds;
+};
+
+struct AudioNodeProfile
+{
+    AudioNodeProfile()
+        : nodeId(0)
+        , name(nullptr)
+    {
+    }
+
+    u64 nodeId;
+    const char* name;
+    // Time spent in the node itself, without its inputs
+    AudioProfileStats self;
+    // Time spent in the node and all of its inputs
+    AudioProfileStats total;
+};
+
+struct AudioProfilerSnapshot
+{
+    AudioProfilerSnapshot()
+        : overruns(0)
+        , deadlineNanoseconds(0)
+        , droppedNodes(0)
+    {
+    }
+
+    // Graph executions, measured against the duration of the rendered buffer
+    AudioProfileStats callbacks;
+    u64 overruns;
+    u64 deadlineNanoseconds;
+    // Executions of nodes left unprofiled because every slot was taken
+    u64 droppedNodes;
+    vector<AudioNodeProfile> nodes;
+};
+
+// Optional instrumentation of the graph execution. The audio thread records into
+// preallocated slots without locking, GetSnapshot can be called from any thread.
+class AudioProfiler
+{
+public:
+    static constexpr u32 MaxNodes = 1024;
+
+    AudioProfiler();
+
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const;
+    Result GetSnapshot(AudioProfilerSnapshot& snapshot) const;
+    // Clears the histograms, the slots of the live nodes are kept
+    void Reset();
+
+    // Called by the audio thread only
+    Result ExecuteNode(AudioNode& node, AudioBuffer& buffer, AudioNode* parentNode = nullptr);
+    void RecordCallback(u64 nanoseconds, u64 deadlineNanoseconds);
+    void ReleaseNode(AudioNode& node);
+
+    static u64 ReadCycles();
+
+private:
+    struct NodeSlot
+    {
+        NodeSlot();
+
+        // Odd while the slot is being claimed or released
+        atomic<u32> sequence;
+        atomic<u64> nodeId;
+        atomic<const char*> name;
+        AudioProfilerHistogram self;
+        AudioProfilerHistogram total;
+    };
+
+    NodeSlot* ClaimSlot(AudioNode& node);
+    double GetNanosecondsPerCycle() const;
+    static void FillStats(const AudioProfilerHistogram& histogram, double nanosecondsPerUnit, AudioProfileStats& stats);
+
+private:
+    atomic<bool> _Enabled;
+    unique_ptr<NodeSlot[]> _Slots;
+    u32 _NextSlot;
+    atomic<u64> _DroppedNodes;
+    AudioProfilerHistogram _Callbacks;
+    atomic<u64> _Overruns;
+    atomic<u64> _DeadlineNanoseconds;
+    u64 _StartCycles;
+    u64 _StartNanoseconds;
+};
+
+inline u64 AudioProfiler::ReadCycles()
+{
+#if defined(LOOM_PROFILER_RDTSC)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+} // namespace Loom
@@ -0,0 +1,77 @@
+#include "loom/audioringbuffer.h"
+
+namespace Loom
+{
+
+AudioRingBuffer::AudioRingBuffer(u32 capacity)
+    : _Data(capacity)
+    , _Capacity(capacity)
+    , _ReadIndex(0)
+    , _WriteIndex(0)
+{
+}
+
+void AudioRingBuffer::Reset(u32 capacity)
+{
+    _Data.assign(capacity, 0);
+    _Capacity = capacity;
+    _ReadIndex.store(0, std::memory_order_relaxed);
+    _WriteIndex.store(0, std::memory_order_release);
+}
+
+u32 AudioRingBuffer::GetCapacity() const
+{
+    return _Capacity;
+}
+
+u32 AudioRingBuffer::GetWritableSize() const
+{
+    u64 readIndex = _ReadIndex.load(std::memory_order_acquire);
+    u64 writeIndex = _WriteIndex.load(std::memory_order_relaxed);
+    return _Capacity - static_cast<u32>(writeIndex - readIndex);
+}
+
+void AudioRingBuffer::GetWriteRegions(u8*& first, u32& firstSize, u8*& second, u32& secondSize)
+{
+    first = second = _Data.data();
+    firstSize = secondSize = 0;
+    if (_Capacity == 0)
+        return;
+    u32 writableSize = GetWritableSize();
+    u32 start = static_cast<u32>(_WriteIndex.load(std::memory_order_relaxed) % _Capacity);
+    first = _Data.data() + start;
+    firstSize = std::min(writableSize, _Capacity - start);
+    secondSize = writableSize - firstSize;
+}
+
+void AudioRingBuffer::CommitWrite(u32 size)
+{
+    _WriteIndex.fetch_add(size, std::memory_order_release);
+}
+
+u32 AudioRingBuffer::GetReadableSize() const
+{
+    u64 writeIndex = _WriteIndex.load(std::memory_order_acquire);
+    u64 readIndex = _ReadIndex.load(std::memory_order_relaxed);
+    return static_cast<u32>(writeIndex - readIndex);
+}
+
+void AudioRingBuffer::GetReadRegions(u32 size, const u8*& first, u32& firstSize, const u8*& second, u32& secondSize) const
+{
+    first = second = _Data.data();
+    firstSize = secondSize = 0;
+    if (_Capacity == 0)
+        return;
+    size = std::min(size, GetReadableSize());
+    u32 start = static_cast<u32>(_ReadIndex.load(std::memory_order_relaxed) % _Capacity);
+    first = _Data.data() + start;
+    firstSize = std::min(size, _Capacity - start);
+    secondSize = size - firstSize;
+}
+
+void AudioRingBuffer::CommitRead(u32 size)
+{
+    _ReadIndex.fetch_add(size, std::memory_order_release);
+}
+
+} // namespace Loom
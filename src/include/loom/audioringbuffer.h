@@ -0,0 +1,38 @@
+#pragma once
+
+#include "loom/defines.h"
+#include "loom/types.h"
+
+namespace Loom
+{
+
+// Single producer, single consumer byte ring buffer.
+// Reads and writes are done in place through regions to avoid extra copies.
+class AudioRingBuffer
+{
+public:
+    AudioRingBuffer(u32 capacity = 0);
+    AudioRingBuffer(const AudioRingBuffer&) = delete;
+    AudioRingBuffer& operator=(const AudioRingBuffer&) = delete;
+
+    void Reset(u32 capacity);
+    u32 GetCapacity() const;
+
+    // Producer side
+    u32 GetWritableSize() const;
+    void GetWriteRegions(u8*& first, u32& firstSize, u8*& second, u32& secondSize);
+    void CommitWrite(u32 size);
+
+    // Consumer side
+    u32 GetReadableSize() const;
+    void GetReadRegions(u32 size, const u8*& first, u32& firstSize, const u8*& second, u32& secondSize) const;
+    void CommitRead(u32 size);
+
+private:
+    vector<u8> _Data;
+    u32 _Capacity;
+    alignas(64) atomic<u64> _ReadIndex;
+    alignas(64) atomic<u64> _WriteIndex;
+};
+
+} // namespace Loom
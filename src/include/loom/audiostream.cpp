@@ -0,0 +1,180 @@
+#include "loom/audiostream.h"
+#include "loom/audioasset.h"
+
+namespace Loom
+{
+
+AudioStream::AudioStream(const shared_ptr<AudioAsset>& asset, u32 bufferFrames, u32 headFrames)
+    : _Asset(asset)
+    , _BufferFrames(bufferFrames)
+    , _HeadFrames(headFrames)
+    , _Ready(false)
+    , _LoopStartFrame(0)
+    , _LoopEndFrame(0)
+    , _LoopCount(0)
+    , _LoopsPlayed(0)
+    , _Closed(false)
+    , _EndOfStream(false)
+    , _SeekFrame(0)
+    , _SeekLoopsPlayed(0)
+    , _SeekRequest(0)
+    , _SeekDone(0)
+    , _Underruns(0)
+{
+}
+
+Result AudioStream::Open()
+{
+    if (_Asset == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    Result result = _Reader.Open(_Asset->GetFilePath());
+    LOOM_CHECK_RESULT(result);
+    result = _Reader.SeekFrame(std::min(_HeadFrames, _Reader.GetFrameCount()));
+    LOOM_CHECK_RESULT(result);
+    _RingBuffer.Reset(_BufferFrames * _Reader.GetFrameSize());
+    _Ready.store(true, std::memory_order_release);
+    return Result::Ok;
+}
+
+// Seeking only needs the byte offset of the frame in the file, no data is read up to it
+Result AudioStream::ApplySeek()
+{
+    u32 seekRequest = _SeekRequest.load(std::memory_order_acquire);
+    // Frames before the end of the head are read from the asset itself
+    u32 frameCount = _Reader.GetFrameCount();
+    u32 readerFrame = std::max(_SeekFrame.load(std::memory_order_relaxed), std::min(_HeadFrames, frameCount));
+    Result result = _Reader.SeekFrame(std::min(readerFrame, frameCount));
+    LOOM_CHECK_RESULT(result);
+    // The audio thread does not touch the ring buffer until the seek is done
+    _RingBuffer.Reset(_RingBuffer.GetCapacity());
+    _LoopsPlayed = _SeekLoopsPlayed.load(std::memory_order_relaxed);
+    _EndOfStream = false;
+    _SeekDone.store(seekRequest, std::memory_order_release);
+    return Result::Ok;
+}
+
+Result AudioStream::Fill()
+{
+    bool seeking = IsSeeking();
+    if (IsClosed() || (IsEndOfStream() && !seeking))
+        return Result::Ok;
+    if (!_Reader.IsOpen())
+    {
+        Result result = Open();
+        if (!Ok(result))
+        {
+            // Nothing will ever come out of this stream
+            _EndOfStream = true;
+            LOOM_RETURN_RESULT(result);
+        }
+    }
+    if (seeking)
+    {
+        Result result = ApplySeek();
+        LOOM_CHECK_RESULT(result);
+    }
+    u32 frameSize = _Reader.GetFrameSize();
+    u8* regions[2] = {};
+    u32 regionSizes[2] = {};
+    _RingBuffer.GetWriteRegions(regions[0], regionSizes[0], regions[1], regionSizes[1]);
+    for (u32 i = 0; i < 2; ++i)
+    {
+        u8* destination = regions[i];
+        u32 framesToRead = regionSizes[i] / frameSize;
+        while (framesToRead > 0)
+        {
+            // Reads stop on the loop end while loops are left, the end of the file otherwise
+            u32 frameCount = _Reader.GetFrameCount();
+            u32 framePosition = _Reader.GetFramePosition();
+            u32 loopStartFrame = _LoopStartFrame.load(std::memory_order_relaxed);
+            u32 loopEndFrame = _LoopEndFrame.load(std::memory_order_relaxed);
+            if (loopEndFrame == 0 || loopEndFrame > frameCount)
+                loopEndFrame = frameCount;
+            bool looping = _LoopsPlayed < _LoopCount.load(std::memory_order_relaxed)
+                && loopStartFrame < loopEndFrame
+                && loopEndFrame > std::min(_HeadFrames, frameCount)
+                && framePosition <= loopEndFrame;
+            u32 endFrame = looping ? loopEndFrame : frameCount;
+            if (framePosition >= endFrame)
+            {
+                if (!looping)
+                {
+                    _EndOfStream = true;
+                    return Result::Ok;
+                }
+                Result result = _Reader.SeekFrame(loopStartFrame);
+                LOOM_CHECK_RESULT(result);
+                ++_LoopsPlayed;
+                continue;
+            }
+            u32 framesRead = 0;
+            Result result = _Reader.ReadFrames(destination, std::min(framesToRead, endFrame - framePosition), framesRead);
+            _RingBuffer.CommitWrite(framesRead * frameSize);
+            destination += framesRead * frameSize;
+            framesToRead -= framesRead;
+            LOOM_CHECK_RESULT(result);
+        }
+    }
+    return Result::Ok;
+}
+
+bool AudioStream::IsClosed() const
+{
+    return _Closed.load(std::memory_order_acquire);
+}
+
+bool AudioStream::IsReady() const
+{
+    return _Ready.load(std::memory_order_acquire);
+}
+
+AudioRingBuffer& AudioStream::GetRingBuffer()
+{
+    return _RingBuffer;
+}
+
+bool AudioStream::IsEndOfStream() const
+{
+    return _EndOfStream.load(std::memory_order_acquire);
+}
+
+void AudioStream::CountUnderrun()
+{
+    _Underruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AudioStream::Seek(u32 frame, u32 loopsPlayed)
+{
+    _SeekFrame.store(frame, std::memory_order_relaxed);
+    _SeekLoopsPlayed.store(loopsPlayed, std::memory_order_relaxed);
+    _SeekRequest.fetch_add(1, std::memory_order_release);
+}
+
+bool AudioStream::IsSeeking() const
+{
+    return _SeekDone.load(std::memory_order_acquire) != _SeekRequest.load(std::memory_order_relaxed);
+}
+
+void AudioStream::Close()
+{
+    _Closed.store(true, std::memory_order_release);
+}
+
+void AudioStream::SetLoop(u32 startFrame, u32 endFrame, u32 count)
+{
+    _LoopStartFrame.store(startFrame, std::memory_order_relaxed);
+    _LoopEndFrame.store(endFrame, std::memory_order_relaxed);
+    _LoopCount.store(count, std::memory_order_relaxed);
+}
+
+u32 AudioStream::GetUnderrunCount() const
+{
+    return _Underruns.load(std::memory_order_relaxed);
+}
+
+const shared_ptr<AudioAsset>& AudioStream::GetAsset() const
+{
+    return _Asset;
+}
+
+} // namespace Loom
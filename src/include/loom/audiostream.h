@@ -0,0 +1,68 @@
+#pragma once
+
+#include "loom/audioringbuffer.h"
+#include "loom/wavfile.h"
+
+namespace Loom
+{
+
+class AudioAsset;
+
+// Per voice streaming state of a streamed AudioAsset.
+// The first frames of the asset stay resident in the asset itself, the
+// streamer thread fills the ring buffer with the frames following them.
+class AudioStream
+{
+public:
+    AudioStream(const shared_ptr<AudioAsset>& asset, u32 bufferFrames, u32 headFrames);
+    AudioStream(const AudioStream&) = delete;
+    AudioStream& operator=(const AudioStream&) = delete;
+
+    // Streamer thread
+    Result Fill();
+    bool IsClosed() const;
+
+    // Audio thread
+    bool IsReady() const;
+    AudioRingBuffer& GetRingBuffer();
+    bool IsEndOfStream() const;
+    void CountUnderrun();
+    // Frames already in the ring buffer are dropped, it refills from the new position
+    void Seek(u32 frame, u32 loopsPlayed);
+    bool IsSeeking() const;
+
+    // Any thread
+    void Close();
+    // Jumps back to the start frame when reaching the end frame, count times.
+    // An end frame of 0 is the end of the file, regions ending within the head are left to the reader.
+    void SetLoop(u32 startFrame, u32 endFrame, u32 count);
+    u32 GetUnderrunCount() const;
+    const shared_ptr<AudioAsset>& GetAsset() const;
+
+private:
+    Result Open();
+    Result ApplySeek();
+
+private:
+    shared_ptr<AudioAsset> _Asset;
+    WavFileReader _Reader;
+    AudioRingBuffer _RingBuffer;
+    u32 _BufferFrames;
+    u32 _HeadFrames;
+    atomic<bool> _Ready;
+    atomic<u32> _LoopStartFrame;
+    atomic<u32> _LoopEndFrame;
+    atomic<u32> _LoopCount;
+    // Loops already written to the ring buffer
+    u32 _LoopsPlayed;
+    atomic<bool> _Closed;
+    atomic<bool> _EndOfStream;
+    // The stream is seeking until the streamer caught up with the last request
+    atomic<u32> _SeekFrame;
+    atomic<u32> _SeekLoopsPlayed;
+    atomic<u32> _SeekRequest;
+    atomic<u32> _SeekDone;
+    atomic<u32> _Underruns;
+};
+
+} // namespace Loom
@@ -0,0 +1,185 @@
+#include "loom/audiostreamer.h"
+#include "loom/audiostream.h"
+#include "loom/audioasset.h"
+#include "loom/interfaces/iaudiosystem.h"
+#include "loom/audiotracer.h"
+
+namespace Loom
+{
+
+AudioStreamer::AudioStreamer(IAudioSystem& system)
+    : IAudioStreamer(system)
+    , _Running(false)
+{
+}
+
+AudioStreamer::~AudioStreamer()
+{
+    Shutdown();
+}
+
+const char* AudioStreamer::GetName() const
+{
+    return "AudioStreamer";
+}
+
+Result AudioStreamer::Initialize()
+{
+    bool running = false;
+    if (!_Running.compare_exchange_strong(running, true))
+        return Result::Ok;
+    _Thread = thread(&AudioStreamer::StreamingThread, this);
+    return Result::Ok;
+}
+
+void AudioStreamer::Shutdown()
+{
+    {
+        scoped_lock lock(_Mutex);
+        _Running = false;
+    }
+    _WakeUp.notify_all();
+    if (_Thread.joinable())
+        _Thread.join();
+}
+
+Result AudioStreamer::LoadStreamHead(AudioAsset& asset, AudioAssetCallback callback, void* userData)
+{
+    if (!asset.IsStreamed())
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    shared_ptr<AudioAsset> sharedAsset = asset.weak_from_this().lock();
+    if (sharedAsset == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    if (asset.GetState() == AudioAssetState::Loaded)
+    {
+        if (callback != nullptr)
+            callback(asset, Result::Ok, userData);
+        return Result::Ok;
+    }
+    bool read = asset.TransitionState(AudioAssetState::Unloaded, AudioAssetState::Loading)
+        || asset.TransitionState(AudioAssetState::InvalidPath, AudioAssetState::Loading);
+    if (!read && callback == nullptr)
+        return Result::Ok;
+    {
+        scoped_lock lock(_Mutex);
+        _PendingHeads.push_back({sharedAsset, callback, userData, read});
+    }
+    _WakeUp.notify_one();
+    return Result::Ok;
+}
+
+Result AudioStreamer::OpenStream(const shared_ptr<AudioAsset>& asset, shared_ptr<AudioStream>& stream)
+{
+    if (asset == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    if (!asset->IsStreamed())
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    const AudioSystemConfig& config = GetSystemInterface().GetConfig();
+    stream.reset(new AudioStream(asset, config.streamBufferFrames, config.streamHeadFrames));
+    {
+        scoped_lock lock(_Mutex);
+        _Streams.push_back(stream);
+    }
+    _WakeUp.notify_one();
+    return Result::Ok;
+}
+
+Result AudioStreamer::CloseStream(shared_ptr<AudioStream>& stream)
+{
+    if (stream == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    // The streaming thread drops closed streams on its next pass
+    stream->Close();
+    stream = nullptr;
+    return Result::Ok;
+}
+
+void AudioStreamer::StreamingThread()
+{
+    LOOM_TRACE_THREAD_NAME("Loom streamer");
+    while (_Running.load())
+    {
+        {
+            LOOM_TRACE_SCOPE("Streamer", "Fill");
+            LoadPendingHeads();
+            FillStreams();
+        }
+        mutex_lock lock(_Mutex);
+        _WakeUp.wait_for(lock, std::chrono::milliseconds(FillIntervalMs), [this]()
+        {
+            return !_Running.load() || !_PendingHeads.empty();
+        });
+    }
+}
+
+void AudioStreamer::LoadPendingHeads()
+{
+    vector<PendingHead> pendingHeads;
+    {
+        scoped_lock lock(_Mutex);
+        pendingHeads.swap(_PendingHeads);
+    }
+    // Heads are handled in request order, so callbacks of later requests see the completed read
+    for (PendingHead& pendingHead : pendingHeads)
+    {
+        AudioAsset& asset = *pendingHead.asset;
+        Result result = Result::Ok;
+        if (pendingHead.read)
+        {
+            result = ReadStreamHead(asset);
+            if (!Ok(result))
+            {
+                LOOM_LOG_WARNING("Unable to load stream head of %s.", asset.GetName());
+                asset.SetState(AudioAssetState::InvalidPath);
+            }
+        }
+        else if (asset.GetState() != AudioAssetState::Loaded)
+        {
+            result = Result::InvalidFile;
+        }
+        if (pendingHead.callback != nullptr)
+            pendingHead.callback(asset, result, pendingHead.userData);
+    }
+}
+
+void AudioStreamer::FillStreams()
+{
+    {
+        scoped_lock lock(_Mutex);
+        _Streams.erase(std::remove_if(_Streams.begin(), _Streams.end(), [](const shared_ptr<AudioStream>& stream)
+        {
+            return stream->IsClosed();
+        }), _Streams.end());
+        _StreamsSnapshot = _Streams;
+    }
+    for (shared_ptr<AudioStream>& stream : _StreamsSnapshot)
+    {
+        Result result = stream->Fill();
+        if (!Ok(result))
+            LOOM_LOG_WARNING("Failed to fill stream of %s.", stream->GetAsset()->GetName());
+    }
+    _StreamsSnapshot.clear();
+}
+
+Result AudioStreamer::ReadStreamHead(AudioAsset& asset)
+{
+    WavFileReader reader;
+    Result result = reader.Open(asset.GetFilePath());
+    LOOM_CHECK_RESULT(result);
+    AudioAssetData data;
+    data.format = reader.GetFormat();
+    data.frameCount = reader.GetFrameCount();
+    u32 headFrames = std::min(GetSystemInterface().GetConfig().streamHeadFrames, data.frameCount);
+    data.samples.resize(headFrames * reader.GetFrameSize());
+    if (headFrames > 0)
+    {
+        u32 framesRead = 0;
+        result = reader.ReadFrames(data.samples.data(), headFrames, framesRead);
+        LOOM_CHECK_RESULT(result);
+    }
+    asset.SetData(std::move(data));
+    asset.SetState(AudioAssetState::Loaded);
+    return Result::Ok;
+}
+
+} // namespace Loom
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "loom/interfaces/iaudiostreamer.h"
+
+namespace Loom
+{
+
+class AudioStreamer : public IAudioStreamer
+{
+public:
+    static constexpr u32 FillIntervalMs = 5;
+
+    AudioStreamer(IAudioSystem& system);
+    ~AudioStreamer();
+    const char* GetName() const override;
+    Result Initialize() override;
+    void Shutdown() override;
+    Result LoadStreamHead(AudioAsset& asset, AudioAssetCallback callback, void* userData) override;
+    Result OpenStream(const shared_ptr<AudioAsset>& asset, shared_ptr<AudioStream>& stream) override;
+    Result CloseStream(shared_ptr<AudioStream>& stream) override;
+
+private:
+    struct PendingHead
+    {
+        shared_ptr<AudioAsset> asset;
+        AudioAssetCallback callback;
+        void* userData;
+        // False when another request is already reading this head
+        bool read;
+    };
+
+    void StreamingThread();
+    void LoadPendingHeads();
+    void FillStreams();
+    Result ReadStreamHead(AudioAsset& asset);
+
+private:
+    thread _Thread;
+    atomic<bool> _Running;
+    mutex _Mutex;
+    condition_variable _WakeUp;
+    vector<PendingHead> _PendingHeads;
+    vector<shared_ptr<AudioStream>> _Streams;
+    vector<shared_ptr<AudioStream>> _StreamsSnapshot;
+};
+
+} // namespace Loom
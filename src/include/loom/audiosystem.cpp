@@ -1,49 +1,283 @@
 #include "loom/audiosystem.h"
 #include "loom/audiograph.h"
 #include "loom/audiobufferpool.h"
+#include "loom/audiostreamer.h"
+#include "loom/audioassetloader.h"
+#include "loom/audioassetcache.h"
+#include "loom/audiovoicemanager.h"
+#include "loom/nodes/assetreadernode.h"
+#include "loom/wavcodec.h"
+#include "loom/nullaudiodevicemanager.h"
+#include "loom/wavfiledevicemanager.h"
+#include "loom/audiotracer.h"
 
 namespace Loom
 {
 
-AudioSystem::AudioSystem()
-    : _Graph(new AudioGraph(GetInterface()))
+AudioSystem::AudioSystem(const AudioSystemConfig& config)
+    : _Config(config)
+    , _Graph(new AudioGraph(GetInterface()))
+    , _Decoder(new WavCodec(GetInterface()))
+    , _Streamer(new AudioStreamer(GetInterface()))
+    , _AssetLoader(new AudioAssetLoader(GetInterface()))
+    , _AssetCache(new AudioAssetCache(GetInterface()))
+    , _VoiceManager(new AudioVoiceManager(GetInterface()))
     //, _DeviceManager(new MiniAudioDeviceManager(GetInterface()))
 {
+    switch (_Config.deviceManager)
+    {
+    case AudioDeviceManagerType::Null:
+        _DeviceManager.reset(new NullAudioDeviceManager(GetInterface()));
+        break;
+    case AudioDeviceManagerType::WavFile:
+        _DeviceManager.reset(new WavFileDeviceManager(GetInterface(), _Config.deviceFilePath.c_str()));
+        break;
+    default:
+        break;
+    }
+    GetGraph().GetProfiler().SetEnabled(_Config.enableProfiler);
     Result result = GetGraph().Initialize();
     if (!Ok(result))
         LOOM_LOG_RESULT(result);
 }
 
+AudioSystem::~AudioSystem()
+{
+    Shutdown();
+}
+
 Result AudioSystem::Initialize()
 {
+    // Assets can be prepared before any device is available
+    Result result = GetStreamer().Initialize();
+    LOOM_CHECK_RESULT(result);
+    result = GetAssetLoader().Initialize();
+    LOOM_CHECK_RESULT(result);
+
     // Initialize device manager to get hardware audio format and buffer size
     IAudioDeviceManager& deviceManager = GetDeviceManager();
-    Result result = Result::Ok;
     result = deviceManager.Initialize();
     LOOM_CHECK_RESULT(result);
     result = deviceManager.SelectDefaultPlaybackDevice(_CurrentDevice);
     LOOM_CHECK_RESULT(result);
+    _Clock.SetFrameRate(_CurrentDevice.audioFormat.frameRate);
 
     // Setup buffer provider
     _BufferProvider.reset(new AudioBufferPool(GetInterface(), _CurrentDevice.audioFormat, _CurrentDevice.bufferSize));
     result = deviceManager.RegisterPlaybackCallback(PlaybackCallback, this);
     LOOM_CHECK_RESULT(result);
+    result = deviceManager.Start();
+    LOOM_CHECK_RESULT(result);
+    return result;
+}
+
+Result AudioSystem::InitializeOffline(const AudioFormat& format, u32 bufferFrames)
+{
+    if (format.GetFrameSize() == 0 || format.frameRate == 0 || bufferFrames == 0)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    Result result = GetStreamer().Initialize();
+    LOOM_CHECK_RESULT(result);
+    result = GetAssetLoader().Initialize();
+    LOOM_CHECK_RESULT(result);
 
+    _CurrentDevice.name = "Offline";
+    _CurrentDevice.defaultDevice = false;
+    _CurrentDevice.bufferSize = bufferFrames * format.GetFrameSize();
+    _CurrentDevice.audioFormat = format;
+    _CurrentDevice.deviceType = AudioDeviceType::Playback;
+    _Clock.SetFrameRate(format.frameRate);
+    _BufferProvider.reset(new AudioBufferPool(GetInterface(), format, _CurrentDevice.bufferSize));
+    return Result::Ok;
+}
 
+Result AudioSystem::Update()
+{
+    LOOM_TRACE_SCOPE("System", "Update");
+    Result result = GetVoiceManager().Update();
+    if (!Ok(result))
+        LOOM_LOG_RESULT(result);
+    return GetAssetCache().Update();
+}
 
-    return result;
+void AudioSystem::Shutdown()
+{
+    // The device stops calling back before the components it renders with go away
+    if (_DeviceManager != nullptr)
+    {
+        Result result = _DeviceManager->Stop();
+        if (!Ok(result))
+            LOOM_LOG_RESULT(result);
+    }
+    GetStreamer().Shutdown();
+    GetAssetLoader().Shutdown();
+}
+
+shared_ptr<AudioAsset> AudioSystem::CreateAudioAsset(const char* filePath, AudioAssetStorage storage)
+{
+    shared_ptr<AudioAsset> asset;
+    // Loaded sound banks take precedence over files, latest bank first
+    if (filePath != nullptr)
+    {
+        for (auto bank = _SoundBanks.rbegin(); bank != _SoundBanks.rend(); ++bank)
+        {
+            if (!(*bank)->Contains(filePath))
+                continue;
+            Result result = (*bank)->GetAsset(filePath, asset);
+            if (!Ok(result))
+            {
+                LOOM_LOG_RESULT(result);
+                return nullptr;
+            }
+            return asset;
+        }
+    }
+    Result result = GetAssetCache().GetAsset(filePath, storage, asset);
+    if (!Ok(result))
+    {
+        LOOM_LOG_RESULT(result);
+        return nullptr;
+    }
+    return asset;
+}
+
+Result AudioSystem::LoadAudioAsset(const shared_ptr<AudioAsset>& audioAsset, AudioAssetLoadPriority priority, AudioAssetCallback callback, void* userData)
+{
+    if (audioAsset == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    return LoadAsset(*audioAsset, priority, callback, userData);
+}
+
+Result AudioSystem::CancelAudioAssetLoad(const shared_ptr<AudioAsset>& audioAsset)
+{
+    if (audioAsset == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    if (audioAsset->IsStreamed() || audioAsset->IsMapped())
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    return GetAssetLoader().CancelLoad(*audioAsset);
+}
+
+Result AudioSystem::UnloadAudioAsset(const shared_ptr<AudioAsset> audioAsset)
+{
+    if (audioAsset == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    return UnloadAsset(*audioAsset);
+}
+
+shared_ptr<AssetReaderNode> AudioSystem::CreateAudioSource(const shared_ptr<AudioAsset> audioAsset, const AudioNodePtr inputNode)
+{
+    if (audioAsset == nullptr)
+    {
+        LOOM_LOG_RESULT(Result::Nullptr);
+        return nullptr;
+    }
+    AudioNodePtr node = GetGraph().CreateNode<AssetReaderNode>(audioAsset);
+    if (node == nullptr)
+        return nullptr;
+    if (inputNode != nullptr)
+    {
+        AudioNodePtr destinationNode = inputNode;
+        Result result = GetGraph().ConnectNodes(node, destinationNode);
+        if (!Ok(result))
+            LOOM_LOG_RESULT(result);
+    }
+    shared_ptr<AssetReaderNode> audioSource = shared_ptr_cast<AssetReaderNode>(node);
+    _AudioSources[audioAsset].insert(audioSource);
+    Result result = GetVoiceManager().AddSource(audioSource);
+    if (!Ok(result))
+        LOOM_LOG_RESULT(result);
+    return audioSource;
+}
+
+Result AudioSystem::DestroyAudioSource(const shared_ptr<AssetReaderNode> audioSource)
+{
+    if (audioSource == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    auto it = _AudioSources.find(audioSource->GetAsset());
+    if (it == _AudioSources.end() || it->second.erase(audioSource) == 0)
+        LOOM_RETURN_RESULT(Result::CannotFind);
+    if (it->second.empty())
+        _AudioSources.erase(it);
+    Result result = GetVoiceManager().RemoveSource(audioSource);
+    LOOM_CHECK_RESULT(result);
+    AudioNodePtr node = shared_ptr_cast<AudioNode>(audioSource);
+    return GetGraph().RemoveNode(node);
+}
+
+Result AudioSystem::LoadSoundBank(const char* filePath, shared_ptr<SoundBank>& soundBank)
+{
+    Result result = SoundBank::Open(*this, filePath, soundBank);
+    LOOM_CHECK_RESULT(result);
+    _SoundBanks.push_back(soundBank);
+    return Result::Ok;
+}
+
+// Assets created from the bank stay valid until released
+Result AudioSystem::UnloadSoundBank(const shared_ptr<SoundBank>& soundBank)
+{
+    auto it = std::find(_SoundBanks.begin(), _SoundBanks.end(), soundBank);
+    if (it == _SoundBanks.end())
+        LOOM_RETURN_RESULT(Result::CannotFind);
+    _SoundBanks.erase(it);
+    return Result::Ok;
+}
+
+Result AudioSystem::LoadAsset(AudioAsset& asset, AudioAssetLoadPriority priority, AudioAssetCallback callback, void* userData)
+{
+    if (asset.IsMapped())
+    {
+        if (callback != nullptr)
+            callback(asset, Result::Ok, userData);
+        return Result::Ok;
+    }
+    // Streamed assets only load their head, which is cheap enough to not need priorities
+    if (asset.IsStreamed())
+        return GetStreamer().LoadStreamHead(asset, callback, userData);
+    return GetAssetLoader().LoadAsset(asset, priority, callback, userData);
+}
+
+Result AudioSystem::UnloadAsset(AudioAsset& asset)
+{
+    // The mapping is released once the last view of the bank goes away
+    if (asset.IsMapped())
+        return Result::Ok;
+    // Readers copy from the resident head of a streamed asset while they hold it pinned
+    if (asset.IsStreamed())
+        return asset.TryUnload();
+    return GetAssetLoader().UnloadAsset(asset);
 }
 
 void AudioSystem::PlaybackCallback(AudioBuffer& destinationBuffer, void* userData)
 {
-    IAudioSystem* system = reinterpret_cast<IAudioSystem*>(userData);
+    AudioSystem* system = reinterpret_cast<AudioSystem*>(userData);
     if (system == nullptr)
     {
-        LOOM_LOG_ERROR("IAudioSystem not available in PlaybackCallback.");
+        LOOM_LOG_ERROR("IAudioSystem not available in PlaybackCallback (userData %p).", userData);
         return;
     }
-    IAudioGraph& graph = system->GetGraph();
-    graph.Execute(destinationBuffer);
+    LOOM_TRACE_SCOPE("Device", "PlaybackCallback");
+    Result result = system->Render(destinationBuffer);
+    if (!Ok(result))
+        LOOM_LOG_RESULT(result);
+}
+
+Result AudioSystem::Render(AudioBuffer& destinationBuffer)
+{
+    LOOM_TRACE_SCOPE("System", "Render");
+    Result result = GetGraph().Execute(destinationBuffer);
+    // Nothing playing renders silence, as does a lone source that is not rendering
+    if (result == Result::NoData || result == Result::MissingOutputNode || result == Result::NodeIsVirtual)
+    {
+        memset(destinationBuffer.GetData(), 0, destinationBuffer.GetSize());
+        result = Result::Ok;
+    }
+    // Nodes see the frame time of the first frame of the buffer they render
+    _Clock.Advance(destinationBuffer.GetFrameCount());
+    return result;
+}
+
+const AudioDeviceDescription& AudioSystem::GetCurrentDevice() const
+{
+    return _CurrentDevice;
 }
 
 const AudioSystemConfig& AudioSystem::GetConfig() const
@@ -51,6 +285,11 @@ const AudioSystemConfig& AudioSystem::GetConfig() const
     return _Config;
 }
 
+const AudioClock& AudioSystem::GetClock() const
+{
+    return _Clock;
+}
+
 IAudioGraph& AudioSystem::GetGraph() const
 {
     if (_Graph == nullptr)
@@ -93,4 +332,32 @@ IAudioBufferProvider& AudioSystem::GetBufferProvider() const
     return *_BufferProvider;
 }
 
+IAudioStreamer& AudioSystem::GetStreamer() const
+{
+    if (_Streamer == nullptr)
+        return AudioStreamerStub::GetInstance();
+    return *_Streamer;
+}
+
+IAudioAssetLoader& AudioSystem::GetAssetLoader() const
+{
+    if (_AssetLoader == nullptr)
+        return AudioAssetLoaderStub::GetInstance();
+    return *_AssetLoader;
+}
+
+IAudioAssetCache& AudioSystem::GetAssetCache() const
+{
+    if (_AssetCache == nullptr)
+        return AudioAssetCacheStub::GetInstance();
+    return *_AssetCache;
+}
+
+IAudioVoiceManager& AudioSystem::GetVoiceManager() const
+{
+    if (_VoiceManager == nullptr)
+        return AudioVoiceManagerStub::GetInstance();
+    return *_VoiceManager;
+}
+
 } // namespace Loom
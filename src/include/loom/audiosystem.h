@@ -8,58 +8,75 @@
 #include "loom/interfaces/iaudiocodec.h"
 #include "loom/interfaces/iaudioresampler.h"
 #include "loom/interfaces/iaudiochannelremapper.h"
+#include "loom/interfaces/iaudiostreamer.h"
+#include "loom/interfaces/iaudioassetloader.h"
+#include "loom/interfaces/iaudioassetcache.h"
+#include "loom/interfaces/iaudiovoicemanager.h"
+#include "loom/audioasset.h"
+#include "loom/soundbank.h"
 
 namespace Loom
 {
 
 class AudioNode;
 class AssetReaderNode;
-class AudioAsset;
 
 class AudioSystem : public IAudioSystem
 {
 public:
-    AudioSystem();
+    AudioSystem(const AudioSystemConfig& config = AudioSystemConfig());
+    ~AudioSystem();
 
     static void PlaybackCallback(AudioBuffer& destinationBuffer, void* userData);
     Result Initialize() override;
+    // Initializes the system without a device, buffers are rendered by calling Render
+    Result InitializeOffline(const AudioFormat& format, u32 bufferFrames);
+    Result Update() override;
+    void Shutdown() override;
+    // Renders the graph to the buffer and advances the clock past it
+    Result Render(AudioBuffer& destinationBuffer);
+    const AudioDeviceDescription& GetCurrentDevice() const;
 
-    shared_ptr<AudioAsset> CreateAudioAsset(const char* filePath)
-    {
-        // check the current device format
-        LOOM_UNUSED(filePath);
-        return nullptr;
-    }
-
-    Result LoadAudioAsset(AudioAsset& asset)
-    {
-        // check asset store if already loaded or loading
-        // start loading according to 
-    }
-
-
+    shared_ptr<AudioAsset> CreateAudioAsset(const char* filePath, AudioAssetStorage storage = AudioAssetStorage::Resident);
+    Result LoadAudioAsset(const shared_ptr<AudioAsset>& audioAsset, AudioAssetLoadPriority priority = AudioAssetLoadPriority::Normal, AudioAssetCallback callback = nullptr, void* userData = nullptr);
+    Result CancelAudioAssetLoad(const shared_ptr<AudioAsset>& audioAsset);
     Result UnloadAudioAsset(const shared_ptr<AudioAsset> audioAsset);
     shared_ptr<AssetReaderNode> CreateAudioSource(const shared_ptr<AudioAsset> audioAsset, const AudioNodePtr inputNode);
     Result DestroyAudioSource(const shared_ptr<AssetReaderNode> audioSource);
+    Result LoadSoundBank(const char* filePath, shared_ptr<SoundBank>& soundBank);
+    Result UnloadSoundBank(const shared_ptr<SoundBank>& soundBank);
 
     const AudioSystemConfig& GetConfig() const override;
+    const AudioClock& GetClock() const override;
     IAudioGraph& GetGraph() const override;
     IAudioCodec& GetCodec() const override;
     IAudioDeviceManager& GetDeviceManager() const override;
     IAudioResampler& GetResampler() const override;
     IAudioChannelRemapper& GetChannelRemapper() const override;
     IAudioBufferProvider& GetBufferProvider() const override;
+    IAudioStreamer& GetStreamer() const override;
+    IAudioAssetLoader& GetAssetLoader() const override;
+    IAudioAssetCache& GetAssetCache() const override;
+    IAudioVoiceManager& GetVoiceManager() const override;
+    Result LoadAsset(AudioAsset& asset, AudioAssetLoadPriority priority, AudioAssetCallback callback, void* userData) override;
+    Result UnloadAsset(AudioAsset& asset) override;
 
 private:
     AudioSystemConfig _Config;
     AudioDeviceDescription _CurrentDevice;
+    AudioClock _Clock;
     map<shared_ptr<AudioAsset>, set<shared_ptr<AssetReaderNode>>> _AudioSources;
+    vector<shared_ptr<SoundBank>> _SoundBanks;
     unique_ptr<IAudioGraph> _Graph;
     unique_ptr<IAudioCodec> _Decoder;
     unique_ptr<IAudioDeviceManager> _DeviceManager;
     unique_ptr<IAudioResampler> _Resampler;
     unique_ptr<IAudioChannelRemapper> _ChannelRemapper;
     unique_ptr<IAudioBufferProvider> _BufferProvider;
+    unique_ptr<IAudioStreamer> _Streamer;
+    unique_ptr<IAudioAssetLoader> _AssetLoader;
+    unique_ptr<IAudioAssetCache> _AssetCache;
+    unique_ptr<IAudioVoiceManager> _VoiceManager;
 };
 
 } // namespace Loom
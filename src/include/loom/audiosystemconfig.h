@@ -6,14 +6,60 @@
 namespace Loom
 {
 
+enum class AudioDeviceManagerType
+{
+    // Platform device manager
+    Default,
+    // Renders on a timer thread at the device rate, discarding the output
+    Null,
+    // Renders on a timer thread at the device rate, writing the output to a file
+    WavFile
+};
+
 struct AudioSystemConfig
 {
     AudioSystemConfig()
         : maxAudibleSources(0)
+        , streamBufferFrames(65536)
+        , streamHeadFrames(16384)
+        , assetLoaderIoThreads(1)
+        , assetLoaderDecodeThreads(2)
+        , assetCacheBudget(256 * 1024 * 1024)
+        , shareAssets(true)
+        , deviceManager(AudioDeviceManagerType::Default)
+        , deviceFrameRate(48000)
+        , deviceChannels(2)
+        , deviceBufferFrames(512)
+        , deviceFilePath("output.wav")
+        , enableProfiler(false)
     {
     }
 
     u32 maxAudibleSources;
+
+    // Streamed assets
+    u32 streamBufferFrames;
+    u32 streamHeadFrames;
+
+    // Resident assets loading
+    u32 assetLoaderIoThreads;
+    u32 assetLoaderDecodeThreads;
+
+    // Bytes of asset samples kept resident before unused assets get evicted
+    u64 assetCacheBudget;
+
+    // Decoded assets are shared with the other systems of the process
+    bool shareAssets;
+
+    // Headless devices, the platform device provides its own format
+    AudioDeviceManagerType deviceManager;
+    u32 deviceFrameRate;
+    u32 deviceChannels;
+    u32 deviceBufferFrames;
+    string deviceFilePath;
+
+    // Per node timings of the graph execution, see AudioProfiler
+    bool enableProfiler;
 };
 
 } // namespace Loom
@@ -0,0 +1,198 @@
+#include "loom/audiotracer.h"
+#include "loom/realtimesanitizer.h"
+
+namespace Loom
+{
+
+namespace
+{
+
+u64 SteadyNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void WriteEscaped(FILE* file, const char* text)
+{
+    for (const char* c = text != nullptr ? text : ""; *c != '\0'; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', file);
+        if (static_cast<unsigned char>(*c) >= 0x20)
+            fputc(*c, file);
+    }
+}
+
+struct TraceEvent
+{
+    u64 timestamp;
+    const char* category;
+    const char* name;
+    AudioTraceEventType type;
+};
+
+} // namespace
+
+thread_local AudioTracer::ThreadHandle AudioTracer::_ThreadHandle;
+
+AudioTracer::Event::Event()
+    : timestamp(0)
+    , category(nullptr)
+    , name(nullptr)
+    , type(AudioTraceEventType::Begin)
+{
+}
+
+AudioTracer::ThreadBuffer::ThreadBuffer(u32 threadId)
+    : threadId(threadId)
+    , threadName(nullptr)
+    , inUse(true)
+    , head(0)
+    , events(new Event[EventsPerThread])
+{
+}
+
+AudioTracer::ThreadHandle::ThreadHandle()
+    : buffer(nullptr)
+    , threadName(nullptr)
+{
+}
+
+AudioTracer::ThreadHandle::~ThreadHandle()
+{
+    if (buffer != nullptr)
+        buffer->inUse.store(false, std::memory_order_release);
+}
+
+AudioTracer::AudioTracer()
+    : _Enabled(false)
+    , _StartNanoseconds(SteadyNanoseconds())
+{
+}
+
+AudioTracer& AudioTracer::GetInstance()
+{
+    static AudioTracer instance;
+    return instance;
+}
+
+void AudioTracer::Start()
+{
+    _Enabled.store(true, std::memory_order_relaxed);
+}
+
+void AudioTracer::Stop()
+{
+    _Enabled.store(false, std::memory_order_relaxed);
+}
+
+void AudioTracer::Clear()
+{
+    scoped_lock lock(_Mutex);
+    for (unique_ptr<ThreadBuffer>& buffer : _Buffers)
+        buffer->head.store(0, std::memory_order_relaxed);
+    _StartNanoseconds.store(SteadyNanoseconds(), std::memory_order_relaxed);
+}
+
+void AudioTracer::Record(AudioTraceEventType type, const char* category, const char* name)
+{
+    ThreadBuffer* buffer = _ThreadHandle.buffer != nullptr ? _ThreadHandle.buffer : AcquireThreadBuffer();
+    if (buffer == nullptr)
+        return;
+    // Published by the head, a reader discards the slots overwritten while it copies them
+    u64 head = buffer->head.load(std::memory_order_relaxed);
+    Event& event = buffer->events[head % EventsPerThread];
+    event.timestamp.store(SteadyNanoseconds(), std::memory_order_relaxed);
+    event.category.store(category, std::memory_order_relaxed);
+    event.name.store(name, std::memory_order_relaxed);
+    event.type.store(type, std::memory_order_relaxed);
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void AudioTracer::SetThreadName(const char* name)
+{
+    _ThreadHandle.threadName = name;
+    if (_ThreadHandle.buffer != nullptr)
+        _ThreadHandle.buffer->threadName.store(name, std::memory_order_relaxed);
+}
+
+AudioTracer::ThreadBuffer* AudioTracer::AcquireThreadBuffer()
+{
+    // Once per thread, the lock is never taken again by the recording thread
+    LOOM_REALTIME_EXEMPT_SCOPE();
+    scoped_lock lock(_Mutex);
+    ThreadBuffer* buffer = nullptr;
+    for (unique_ptr<ThreadBuffer>& candidate : _Buffers)
+    {
+        // The events of an exited thread are kept until the next Clear
+        if (!candidate->inUse.load(std::memory_order_acquire) && candidate->head.load(std::memory_order_relaxed) == 0)
+        {
+            buffer = candidate.get();
+            buffer->inUse.store(true, std::memory_order_relaxed);
+            break;
+        }
+    }
+    if (buffer == nullptr)
+    {
+        _Buffers.emplace_back(new ThreadBuffer(static_cast<u32>(_Buffers.size() + 1)));
+        buffer = _Buffers.back().get();
+    }
+    buffer->threadName.store(_ThreadHandle.threadName, std::memory_order_relaxed);
+    _ThreadHandle.buffer = buffer;
+    return buffer;
+}
+
+Result AudioTracer::WriteChromeTrace(const char* filePath) const
+{
+    FILE* file = fopen(filePath, "w");
+    if (file == nullptr)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+
+    scoped_lock lock(_Mutex);
+    u64 startNanoseconds = _StartNanoseconds.load(std::memory_order_relaxed);
+    vector<TraceEvent> events;
+    bool first = true;
+    fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+    for (const unique_ptr<ThreadBuffer>& buffer : _Buffers)
+    {
+        const char* threadName = buffer->threadName.load(std::memory_order_relaxed);
+        if (threadName != nullptr)
+        {
+            fprintf(file, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"", first ? "" : ",", buffer->threadId);
+            WriteEscaped(file, threadName);
+            fprintf(file, "\"}}");
+            first = false;
+        }
+
+        u64 head = buffer->head.load(std::memory_order_acquire);
+        u64 begin = head > EventsPerThread ? head - EventsPerThread : 0;
+        events.clear();
+        for (u64 i = begin; i < head; ++i)
+        {
+            const Event& event = buffer->events[i % EventsPerThread];
+            events.push_back({event.timestamp.load(std::memory_order_relaxed), event.category.load(std::memory_order_relaxed),
+                event.name.load(std::memory_order_relaxed), event.type.load(std::memory_order_relaxed)});
+        }
+        // The slot being written when the copy ended may hold a torn event
+        std::atomic_thread_fence(std::memory_order_acquire);
+        u64 newHead = buffer->head.load(std::memory_order_relaxed);
+        u64 validBegin = newHead + 1 > EventsPerThread ? newHead + 1 - EventsPerThread : 0;
+        for (u64 i = std::max(begin, validBegin); i < head; ++i)
+        {
+            const TraceEvent& event = events[i - begin];
+            double microseconds = event.timestamp > startNanoseconds ? (event.timestamp - startNanoseconds) / 1000.0 : 0.0;
+            fprintf(file, "%s\n{\"name\": \"", first ? "" : ",");
+            WriteEscaped(file, event.name);
+            fprintf(file, "\", \"cat\": \"");
+            WriteEscaped(file, event.category);
+            fprintf(file, "\", \"ph\": \"%s\", \"ts\": %.3f, \"pid\": 1, \"tid\": %u}",
+                event.type == AudioTraceEventType::Begin ? "B" : "E", microseconds, buffer->threadId);
+            first = false;
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    return Result::Ok;
+}
+
+} // namespace Loom
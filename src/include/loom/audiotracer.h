@@ -0,0 +1,117 @@
+#pragma once
+
+#include "loom/defines.h"
+#include "loom/types.h"
+#include "loom/result.h"
+
+// Category and name must be static strings, they are only read when the trace is written
+#define LOOM_TRACE_SCOPE(category, name) AudioTraceScope LOOM_CONCAT(_TraceScope, __LINE__)(category, name)
+#define LOOM_TRACE_THREAD_NAME(name) AudioTracer::SetThreadName(name)
+
+namespace Loom
+{
+
+enum class AudioTraceEventType : u32
+{
+    Begin,
+    End
+};
+
+// Opt-in timeline capture. Every thread records begin and end events into a ring buffer
+// of its own without locking, the oldest events being overwritten. The rings are dumped
+// to the Chrome trace format, readable by chrome://tracing and Perfetto.
+class AudioTracer
+{
+public:
+    static constexpr u32 EventsPerThread = 16384;
+
+    static AudioTracer& GetInstance();
+
+    void Start();
+    void Stop();
+    bool IsEnabled() const;
+    // Drops the recorded events, called while tracing is stopped
+    void Clear();
+    Result WriteChromeTrace(const char* filePath) const;
+
+    void Record(AudioTraceEventType type, const char* category, const char* name);
+    static void SetThreadName(const char* name);
+
+private:
+    struct Event
+    {
+        Event();
+
+        atomic<u64> timestamp;
+        atomic<const char*> category;
+        atomic<const char*> name;
+        atomic<AudioTraceEventType> type;
+    };
+
+    // Written by its thread only, buffers of exited threads are reused by new threads once cleared
+    struct ThreadBuffer
+    {
+        ThreadBuffer(u32 threadId);
+
+        u32 threadId;
+        atomic<const char*> threadName;
+        atomic<bool> inUse;
+        atomic<u64> head;
+        unique_ptr<Event[]> events;
+    };
+
+    struct ThreadHandle
+    {
+        ThreadHandle();
+        ~ThreadHandle();
+
+        ThreadBuffer* buffer;
+        const char* threadName;
+    };
+
+    AudioTracer();
+    ThreadBuffer* AcquireThreadBuffer();
+
+private:
+    atomic<bool> _Enabled;
+    mutable mutex _Mutex;
+    vector<unique_ptr<ThreadBuffer>> _Buffers;
+    atomic<u64> _StartNanoseconds;
+    static thread_local ThreadHandle _ThreadHandle;
+};
+
+class AudioTraceScope
+{
+public:
+    AudioTraceScope(const char* category, const char* name);
+    ~AudioTraceScope();
+
+private:
+    const char* _Category;
+    const char* _Name;
+};
+
+inline bool AudioTracer::IsEnabled() const
+{
+    return _Enabled.load(std::memory_order_relaxed);
+}
+
+inline AudioTraceScope::AudioTraceScope(const char* category, const char* name)
+    : _Category(nullptr)
+    , _Name(name)
+{
+    AudioTracer& tracer = AudioTracer::GetInstance();
+    if (!tracer.IsEnabled())
+        return;
+    // Remembered so that the end is recorded even when tracing stops meanwhile
+    _Category = category;
+    tracer.Record(AudioTraceEventType::Begin, category, name);
+}
+
+inline AudioTraceScope::~AudioTraceScope()
+{
+    if (_Category != nullptr)
+        AudioTracer::GetInstance().Record(AudioTraceEventType::End, _Category, _Name);
+}
+
+} // namespace Loom
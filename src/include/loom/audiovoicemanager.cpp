@@ -0,0 +1,111 @@
+#include "loom/audiovoicemanager.h"
+#include "loom/interfaces/iaudiosystem.h"
+#include "loom/nodes/assetreadernode.h"
+
+namespace Loom
+{
+
+AudioVoiceManager::AudioVoiceManager(IAudioSystem& system)
+    : IAudioVoiceManager(system)
+    , _BudgetIsFull(false)
+{
+}
+
+const char* AudioVoiceManager::GetName() const
+{
+    return "AudioVoiceManager";
+}
+
+Result AudioVoiceManager::Update()
+{
+    scoped_lock lock(_Mutex);
+    _Candidates.clear();
+    for (const shared_ptr<AssetReaderNode>& source : _Sources)
+    {
+        if (!source->WantsToPlay())
+            continue;
+        float score = static_cast<float>(source->GetPriority() + 1) * source->GetAudibility();
+        if (source->IsAudible())
+            score *= AudibleScoreBonus;
+        _Candidates.push_back({source.get(), score});
+    }
+    std::stable_sort(_Candidates.begin(), _Candidates.end(), [](const Candidate& a, const Candidate& b)
+    {
+        return a.score > b.score;
+    });
+
+    // No limit when the budget is left to 0
+    u32 maxAudibleSources = GetSystemInterface().GetConfig().maxAudibleSources;
+    if (maxAudibleSources == 0)
+        maxAudibleSources = UINT32_MAX;
+    u32 audibleCount = 0;
+    for (Candidate& candidate : _Candidates)
+    {
+        bool isVirtual = audibleCount >= maxAudibleSources || candidate.score <= 0.0f;
+        candidate.source->SetVirtual(isVirtual);
+        if (!isVirtual)
+            ++audibleCount;
+    }
+
+    // Sources played before the next update start virtual once the budget is used up
+    _BudgetIsFull = audibleCount >= maxAudibleSources;
+    Result result = Result::Ok;
+    _Stats = AudioVoiceManagerStats();
+    for (const shared_ptr<AssetReaderNode>& source : _Sources)
+    {
+        if (!source->WantsToPlay())
+            source->SetVirtual(_BudgetIsFull);
+        Result updateResult = source->Update();
+        if (!Ok(updateResult))
+            result = updateResult;
+        ++_Stats.sourceCount;
+        if (source->WantsToPlay())
+            ++_Stats.playingCount;
+        if (source->IsAudible())
+            ++_Stats.audibleCount;
+        else if (source->WantsToPlay())
+            ++_Stats.virtualCount;
+    }
+    return result;
+}
+
+void AudioVoiceManager::Shutdown()
+{
+    scoped_lock lock(_Mutex);
+    _Sources.clear();
+    _Candidates.clear();
+    _Stats = AudioVoiceManagerStats();
+    _BudgetIsFull = false;
+}
+
+Result AudioVoiceManager::AddSource(const shared_ptr<AssetReaderNode>& source)
+{
+    if (source == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    scoped_lock lock(_Mutex);
+    if (std::find(_Sources.begin(), _Sources.end(), source) != _Sources.end())
+        return Result::Ok;
+    source->SetVirtual(_BudgetIsFull);
+    _Sources.push_back(source);
+    _Candidates.reserve(_Sources.size());
+    return Result::Ok;
+}
+
+Result AudioVoiceManager::RemoveSource(const shared_ptr<AssetReaderNode>& source)
+{
+    scoped_lock lock(_Mutex);
+    auto it = std::find(_Sources.begin(), _Sources.end(), source);
+    if (it == _Sources.end())
+        LOOM_RETURN_RESULT(Result::CannotFind);
+    _Sources.erase(it);
+    return Result::Ok;
+}
+
+Result AudioVoiceManager::GetStats(AudioVoiceManagerStats& stats) const
+{
+    scoped_lock lock(_Mutex);
+    stats = _Stats;
+    return Result::Ok;
+}
+
+} // namespace Loom
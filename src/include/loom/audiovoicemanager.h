@@ -0,0 +1,39 @@
+#pragma once
+
+#include "loom/interfaces/iaudiovoicemanager.h"
+
+namespace Loom
+{
+
+// Caps the sources rendering at once to AudioSystemConfig::maxAudibleSources.
+// On every update, sources that want to play are ranked by priority and audibility,
+// the best ones render while the others are virtualized, with short fades in between.
+class AudioVoiceManager : public IAudioVoiceManager
+{
+public:
+    // Keeps sources of close scores from swapping places on every update
+    static constexpr float AudibleScoreBonus = 1.1f;
+
+    AudioVoiceManager(IAudioSystem& system);
+    const char* GetName() const override;
+    Result Update() override;
+    void Shutdown() override;
+    Result AddSource(const shared_ptr<AssetReaderNode>& source) override;
+    Result RemoveSource(const shared_ptr<AssetReaderNode>& source) override;
+    Result GetStats(AudioVoiceManagerStats& stats) const override;
+
+private:
+    struct Candidate
+    {
+        AssetReaderNode* source;
+        float score;
+    };
+
+    mutable mutex _Mutex;
+    vector<shared_ptr<AssetReaderNode>> _Sources;
+    vector<Candidate> _Candidates;
+    AudioVoiceManagerStats _Stats;
+    bool _BudgetIsFull;
+};
+
+} // namespace Loom
@@ -0,0 +1,289 @@
+#include "loom/biquad.h"
+#include "loom/simd.h"
+
+namespace Loom
+{
+
+namespace
+{
+
+constexpr u32 Lanes = FloatVector::Lanes;
+
+// States decaying towards zero would otherwise end up as slow denormals
+float FlushDenormal(float value)
+{
+    return std::abs(value) < 1e-15f ? 0.0f : value;
+}
+
+struct CoefficientVectors
+{
+    FloatVector b0;
+    FloatVector b1;
+    FloatVector b2;
+    FloatVector a1;
+    FloatVector a2;
+};
+
+FloatVector Step(const CoefficientVectors& c, FloatVector x, FloatVector& z1, FloatVector& z2)
+{
+    FloatVector y = c.b0 * x + z1;
+    z1 = c.b1 * x - c.a1 * y + z2;
+    z2 = c.b2 * x - c.a2 * y;
+    return y;
+}
+
+} // namespace
+
+BiquadCoefficients BiquadCoefficients::Compute(BiquadFilterType type, float frameRate, float frequency, float q, float gainDB)
+{
+    BiquadCoefficients coefficients;
+    if (frameRate <= 0.0f)
+        return coefficients;
+    constexpr double Pi = 3.14159265358979323846;
+    double w0 = 2.0 * Pi * std::clamp<double>(frequency, 1.0, 0.49 * frameRate) / frameRate;
+    double cosW0 = std::cos(w0);
+    double alpha = std::sin(w0) / (2.0 * std::max(q, 0.01f));
+    double a = std::pow(10.0, gainDB / 40.0);
+    double shelfAlpha = 2.0 * std::sqrt(a) * alpha;
+    double b0 = 1.0, b1 = 0.0, b2 = 0.0, a0 = 1.0, a1 = 0.0, a2 = 0.0;
+    switch (type)
+    {
+        case BiquadFilterType::LowPass:
+            b0 = (1.0 - cosW0) / 2.0;
+            b1 = 1.0 - cosW0;
+            b2 = b0;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * cosW0;
+            a2 = 1.0 - alpha;
+            break;
+        case BiquadFilterType::HighPass:
+            b0 = (1.0 + cosW0) / 2.0;
+            b1 = -(1.0 + cosW0);
+            b2 = b0;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * cosW0;
+            a2 = 1.0 - alpha;
+            break;
+        case BiquadFilterType::BandPass:
+            // 0 dB at the center frequency
+            b0 = alpha;
+            b1 = 0.0;
+            b2 = -alpha;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * cosW0;
+            a2 = 1.0 - alpha;
+            break;
+        case BiquadFilterType::Notch:
+            b0 = 1.0;
+            b1 = -2.0 * cosW0;
+            b2 = 1.0;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * cosW0;
+            a2 = 1.0 - alpha;
+            break;
+        case BiquadFilterType::LowShelf:
+            b0 = a * ((a + 1.0) - (a - 1.0) * cosW0 + shelfAlpha);
+            b1 = 2.0 * a * ((a - 1.0) - (a + 1.0) * cosW0);
+            b2 = a * ((a + 1.0) - (a - 1.0) * cosW0 - shelfAlpha);
+            a0 = (a + 1.0) + (a - 1.0) * cosW0 + shelfAlpha;
+            a1 = -2.0 * ((a - 1.0) + (a + 1.0) * cosW0);
+            a2 = (a + 1.0) + (a - 1.0) * cosW0 - shelfAlpha;
+            break;
+        case BiquadFilterType::HighShelf:
+            b0 = a * ((a + 1.0) + (a - 1.0) * cosW0 + shelfAlpha);
+            b1 = -2.0 * a * ((a - 1.0) + (a + 1.0) * cosW0);
+            b2 = a * ((a + 1.0) + (a - 1.0) * cosW0 - shelfAlpha);
+            a0 = (a + 1.0) - (a - 1.0) * cosW0 + shelfAlpha;
+            a1 = 2.0 * ((a - 1.0) - (a + 1.0) * cosW0);
+            a2 = (a + 1.0) - (a - 1.0) * cosW0 - shelfAlpha;
+            break;
+        case BiquadFilterType::Peak:
+            b0 = 1.0 + alpha * a;
+            b1 = -2.0 * cosW0;
+            b2 = 1.0 - alpha * a;
+            a0 = 1.0 + alpha / a;
+            a1 = -2.0 * cosW0;
+            a2 = 1.0 - alpha / a;
+            break;
+        default:
+            return coefficients;
+    }
+    coefficients.b0 = static_cast<float>(b0 / a0);
+    coefficients.b1 = static_cast<float>(b1 / a0);
+    coefficients.b2 = static_cast<float>(b2 / a0);
+    coefficients.a1 = static_cast<float>(a1 / a0);
+    coefficients.a2 = static_cast<float>(a2 / a0);
+    return coefficients;
+}
+
+BiquadFilter::BiquadFilter()
+{
+    Reset();
+}
+
+void BiquadFilter::SetCoefficients(const BiquadCoefficients& coefficients)
+{
+    _Coefficients = coefficients;
+}
+
+const BiquadCoefficients& BiquadFilter::GetCoefficients() const
+{
+    return _Coefficients;
+}
+
+void BiquadFilter::Reset()
+{
+    std::fill(std::begin(_Z1), std::end(_Z1), 0.0f);
+    std::fill(std::begin(_Z2), std::end(_Z2), 0.0f);
+}
+
+Result BiquadFilter::Process(float* samples, u32 frames, u32 channels)
+{
+    if (samples == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    if (channels == 0 || channels > MaxChannels)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    CoefficientVectors c;
+    c.b0 = FloatVector::Broadcast(_Coefficients.b0);
+    c.b1 = FloatVector::Broadcast(_Coefficients.b1);
+    c.b2 = FloatVector::Broadcast(_Coefficients.b2);
+    c.a1 = FloatVector::Broadcast(_Coefficients.a1);
+    c.a2 = FloatVector::Broadcast(_Coefficients.a2);
+    // The states are padded to MaxChannels, the lanes past the last channel filter silence
+    for (u32 firstChannel = 0; firstChannel < channels; firstChannel += Lanes)
+    {
+        u32 lanes = std::min(Lanes, channels - firstChannel);
+        FloatVector z1 = FloatVector::Load(_Z1 + firstChannel);
+        FloatVector z2 = FloatVector::Load(_Z2 + firstChannel);
+        float* frame = samples + firstChannel;
+        if (lanes == Lanes)
+        {
+            for (u32 i = 0; i < frames; ++i, frame += channels)
+                Step(c, FloatVector::Load(frame), z1, z2).Store(frame);
+        }
+        else
+        {
+            float lane[Lanes] = {};
+            for (u32 i = 0; i < frames; ++i, frame += channels)
+            {
+                std::copy(frame, frame + lanes, lane);
+                Step(c, FloatVector::Load(lane), z1, z2).Store(lane);
+                std::copy(lane, lane + lanes, frame);
+            }
+        }
+        z1.Store(_Z1 + firstChannel);
+        z2.Store(_Z2 + firstChannel);
+        for (u32 channel = firstChannel; channel < firstChannel + Lanes; ++channel)
+        {
+            _Z1[channel] = FlushDenormal(_Z1[channel]);
+            _Z2[channel] = FlushDenormal(_Z2[channel]);
+        }
+    }
+    return Result::Ok;
+}
+
+BiquadFilterBank::BiquadFilterBank(u32 voiceCapacity)
+    : _VoiceCapacity(voiceCapacity)
+{
+    // Whole lane groups, the padding voices are never processed
+    u32 paddedCapacity = (voiceCapacity + Lanes - 1) / Lanes * Lanes;
+    _B0.assign(paddedCapacity, 1.0f);
+    _B1.assign(paddedCapacity, 0.0f);
+    _B2.assign(paddedCapacity, 0.0f);
+    _A1.assign(paddedCapacity, 0.0f);
+    _A2.assign(paddedCapacity, 0.0f);
+    _Z1.assign(paddedCapacity, 0.0f);
+    _Z2.assign(paddedCapacity, 0.0f);
+}
+
+u32 BiquadFilterBank::GetVoiceCapacity() const
+{
+    return _VoiceCapacity;
+}
+
+Result BiquadFilterBank::SetCoefficients(u32 voice, const BiquadCoefficients& coefficients)
+{
+    if (voice >= _VoiceCapacity)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    _B0[voice] = coefficients.b0;
+    _B1[voice] = coefficients.b1;
+    _B2[voice] = coefficients.b2;
+    _A1[voice] = coefficients.a1;
+    _A2[voice] = coefficients.a2;
+    return Result::Ok;
+}
+
+Result BiquadFilterBank::ResetVoice(u32 voice)
+{
+    if (voice >= _VoiceCapacity)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    _Z1[voice] = 0.0f;
+    _Z2[voice] = 0.0f;
+    return Result::Ok;
+}
+
+Result BiquadFilterBank::Process(float* const* voiceSamples, u32 voiceCount, u32 frames)
+{
+    if (voiceSamples == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    if (voiceCount > _VoiceCapacity)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    const float silence[Lanes] = {};
+    for (u32 firstVoice = 0; firstVoice < voiceCount; firstVoice += Lanes)
+    {
+        u32 lanes = std::min(Lanes, voiceCount - firstVoice);
+        float* voices[Lanes] = {};
+        for (u32 lane = 0; lane < lanes; ++lane)
+        {
+            voices[lane] = voiceSamples[firstVoice + lane];
+            if (voices[lane] == nullptr)
+                LOOM_RETURN_RESULT(Result::Nullptr);
+        }
+        CoefficientVectors c;
+        c.b0 = FloatVector::Load(&_B0[firstVoice]);
+        c.b1 = FloatVector::Load(&_B1[firstVoice]);
+        c.b2 = FloatVector::Load(&_B2[firstVoice]);
+        c.a1 = FloatVector::Load(&_A1[firstVoice]);
+        c.a2 = FloatVector::Load(&_A2[firstVoice]);
+        FloatVector z1 = FloatVector::Load(&_Z1[firstVoice]);
+        FloatVector z2 = FloatVector::Load(&_Z2[firstVoice]);
+
+        // Blocks of four frames of four voices are transposed, so that a vector holds one frame of every voice
+        u32 frame = 0;
+        for (; frame + Lanes <= frames; frame += Lanes)
+        {
+            FloatVector rows[Lanes];
+            for (u32 lane = 0; lane < Lanes; ++lane)
+                rows[lane] = FloatVector::Load(lane < lanes ? voices[lane] + frame : silence);
+            FloatVector::Transpose(rows[0], rows[1], rows[2], rows[3]);
+            for (FloatVector& row : rows)
+                row = Step(c, row, z1, z2);
+            FloatVector::Transpose(rows[0], rows[1], rows[2], rows[3]);
+            for (u32 lane = 0; lane < lanes; ++lane)
+                rows[lane].Store(voices[lane] + frame);
+        }
+        for (; frame < frames; ++frame)
+        {
+            float lane[Lanes] = {};
+            for (u32 i = 0; i < lanes; ++i)
+                lane[i] = voices[i][frame];
+            Step(c, FloatVector::Load(lane), z1, z2).Store(lane);
+            for (u32 i = 0; i < lanes; ++i)
+                voices[i][frame] = lane[i];
+        }
+
+        // Only the states of the processed voices are written back
+        float z1Lanes[Lanes];
+        float z2Lanes[Lanes];
+        z1.Store(z1Lanes);
+        z2.Store(z2Lanes);
+        for (u32 lane = 0; lane < lanes; ++lane)
+        {
+            _Z1[firstVoice + lane] = FlushDenormal(z1Lanes[lane]);
+            _Z2[firstVoice + lane] = FlushDenormal(z2Lanes[lane]);
+        }
+    }
+    return Result::Ok;
+}
+
+} // namespace Loom
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "loom/defines.h"
+#include "loom/types.h"
+#include "loom/result.h"
+
+namespace Loom
+{
+
+enum class BiquadFilterType : u32
+{
+    LowPass,
+    HighPass,
+    BandPass,
+    Notch,
+    LowShelf,
+    HighShelf,
+    Peak
+};
+
+// Normalized by a0, the default coefficients pass the signal through
+struct BiquadCoefficients
+{
+    BiquadCoefficients()
+        : b0(1.0f)
+        , b1(0.0f)
+        , b2(0.0f)
+        , a1(0.0f)
+        , a2(0.0f)
+    {
+    }
+
+    // Audio EQ cookbook designs, gain is only used by the shelves and the peak
+    static BiquadCoefficients Compute(BiquadFilterType type, float frameRate, float frequency, float q, float gainDB = 0.0f);
+
+    float b0;
+    float b1;
+    float b2;
+    float a1;
+    float a2;
+};
+
+// Filters interleaved channels in place, four channels per SIMD lane group.
+// Transposed direct form II, the state of each channel is kept between buffers.
+class BiquadFilter
+{
+public:
+    static constexpr u32 MaxChannels = 16;
+
+    BiquadFilter();
+
+    void SetCoefficients(const BiquadCoefficients& coefficients);
+    const BiquadCoefficients& GetCoefficients() const;
+    void Reset();
+    Result Process(float* samples, u32 frames, u32 channels);
+
+private:
+    BiquadCoefficients _Coefficients;
+    float _Z1[MaxChannels];
+    float _Z2[MaxChannels];
+};
+
+// Runs one biquad per voice over many mono voices at once, vectorized across voices.
+// Coefficients and states are stored as arrays per term, so every voice can have its
+// own cutoff, like an occlusion filter, for the cost of a quarter of the scalar loops.
+class BiquadFilterBank
+{
+public:
+    BiquadFilterBank(u32 voiceCapacity);
+
+    u32 GetVoiceCapacity() const;
+    Result SetCoefficients(u32 voice, const BiquadCoefficients& coefficients);
+    Result ResetVoice(u32 voice);
+    // Voice i filters the frames of voiceSamples[i] in place, voices past voiceCount are left untouched
+    Result Process(float* const* voiceSamples, u32 voiceCount, u32 frames);
+
+private:
+    u32 _VoiceCapacity;
+    vector<float> _B0;
+    vector<float> _B1;
+    vector<float> _B2;
+    vector<float> _A1;
+    vector<float> _A2;
+    vector<float> _Z1;
+    vector<float> _Z2;
+};
+
+} // namespace Loom
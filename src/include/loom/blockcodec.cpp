@@ -0,0 +1,447 @@
+#include "loom/blockcodec.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LOOM_BLOCKCODEC_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LOOM_BLOCKCODEC_NEON
+#endif
+
+namespace Loom
+{
+
+namespace
+{
+
+constexpr s32 ImaStepTable[89] =
+{
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+constexpr s32 ImaIndexTable[16] =
+{
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+constexpr s32 MsAdaptationTable[16] =
+{
+    230, 230, 230, 230, 307, 409, 512, 614,
+    768, 614, 512, 409, 307, 230, 230, 230
+};
+
+constexpr s32 MsCoefficients[7][2] =
+{
+    {256, 0}, {512, -256}, {0, 0}, {192, 64}, {240, 0}, {460, -208}, {392, -232}
+};
+
+constexpr u32 MaxChannels = 8;
+constexpr u32 MaxLosslessOrder = 2;
+
+s16 ClampSample(s32 sample)
+{
+    return static_cast<s16>(std::clamp(sample, -32768, 32767));
+}
+
+s16 ReadS16(const u8* bytes)
+{
+    return static_cast<s16>(bytes[0] | (bytes[1] << 8));
+}
+
+struct ImaChannelState
+{
+    s32 predictor;
+    s32 stepIndex;
+
+    s16 Decode(u32 nibble)
+    {
+        s32 step = ImaStepTable[stepIndex];
+        s32 difference = step >> 3;
+        if (nibble & 1)
+            difference += step >> 2;
+        if (nibble & 2)
+            difference += step >> 1;
+        if (nibble & 4)
+            difference += step;
+        predictor += (nibble & 8) ? -difference : difference;
+        predictor = ClampSample(predictor);
+        stepIndex = std::clamp(stepIndex + ImaIndexTable[nibble], 0, 88);
+        return static_cast<s16>(predictor);
+    }
+};
+
+struct MsChannelState
+{
+    s32 coefficient1;
+    s32 coefficient2;
+    s32 delta;
+    s32 sample1;
+    s32 sample2;
+
+    s16 Decode(u32 nibble)
+    {
+        s32 predicted = (sample1 * coefficient1 + sample2 * coefficient2) >> 8;
+        s32 signedNibble = nibble >= 8 ? static_cast<s32>(nibble) - 16 : static_cast<s32>(nibble);
+        s32 sample = ClampSample(predicted + signedNibble * delta);
+        sample2 = sample1;
+        sample1 = sample;
+        delta = std::max((MsAdaptationTable[nibble] * delta) >> 8, 16);
+        return static_cast<s16>(sample);
+    }
+};
+
+u32 ZigZagEncode(s32 value)
+{
+    return (static_cast<u32>(value) << 1) ^ static_cast<u32>(value >> 31);
+}
+
+// Residuals are stored zigzag encoded, turn them back to signed values in place
+void ZigZagDecode(s32* values, u32 count)
+{
+    u32 i = 0;
+#if defined(LOOM_BLOCKCODEC_SSE2)
+    const __m128i one = _mm_set1_epi32(1);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        __m128i sign = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(value, one));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), _mm_xor_si128(_mm_srli_epi32(value, 1), sign));
+    }
+#elif defined(LOOM_BLOCKCODEC_NEON)
+    const uint32x4_t one = vdupq_n_u32(1);
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32x4_t value = vld1q_u32(reinterpret_cast<const uint32_t*>(values + i));
+        uint32x4_t sign = vreinterpretq_u32_s32(vnegq_s32(vreinterpretq_s32_u32(vandq_u32(value, one))));
+        vst1q_s32(values + i, vreinterpretq_s32_u32(veorq_u32(vshrq_n_u32(value, 1), sign)));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        u32 value = static_cast<u32>(values[i]);
+        values[i] = static_cast<s32>((value >> 1) ^ (0u - (value & 1)));
+    }
+}
+
+// Inverse of one differencing pass of the fixed predictor
+void PrefixSum(s32* values, u32 count)
+{
+    u32 i = 0;
+#if defined(LOOM_BLOCKCODEC_SSE2)
+    __m128i carry = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        value = _mm_add_epi32(value, _mm_slli_si128(value, 4));
+        value = _mm_add_epi32(value, _mm_slli_si128(value, 8));
+        value = _mm_add_epi32(value, carry);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), value);
+        carry = _mm_shuffle_epi32(value, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    s32 sum = _mm_cvtsi128_si32(carry);
+#elif defined(LOOM_BLOCKCODEC_NEON)
+    int32x4_t carry = vdupq_n_s32(0);
+    const int32x4_t zero = vdupq_n_s32(0);
+    for (; i + 4 <= count; i += 4)
+    {
+        int32x4_t value = vld1q_s32(values + i);
+        value = vaddq_s32(value, vextq_s32(zero, value, 3));
+        value = vaddq_s32(value, vextq_s32(zero, value, 2));
+        value = vaddq_s32(value, carry);
+        vst1q_s32(values + i, value);
+        carry = vdupq_n_s32(vgetq_lane_s32(value, 3));
+    }
+    s32 sum = vgetq_lane_s32(carry, 0);
+#else
+    s32 sum = 0;
+#endif
+    for (; i < count; ++i)
+    {
+        sum = static_cast<s32>(static_cast<u32>(sum) + static_cast<u32>(values[i]));
+        values[i] = sum;
+    }
+}
+
+void Difference(s32* values, u32 count)
+{
+    for (u32 i = count; i-- > 1;)
+        values[i] = static_cast<s32>(static_cast<u32>(values[i]) - static_cast<u32>(values[i - 1]));
+}
+
+u32 GetBitWidth(u32 value)
+{
+    u32 width = 0;
+    while (value != 0)
+    {
+        ++width;
+        value >>= 1;
+    }
+    return width;
+}
+
+class BitWriter
+{
+public:
+    BitWriter(vector<u8>& destination)
+        : _Destination(destination)
+        , _Bits(0)
+        , _BitCount(0)
+    {
+    }
+
+    void Write(u32 value, u32 width)
+    {
+        if (width == 0)
+            return;
+        _Bits |= static_cast<u64>(value) << _BitCount;
+        _BitCount += width;
+        while (_BitCount >= 8)
+        {
+            _Destination.push_back(static_cast<u8>(_Bits));
+            _Bits >>= 8;
+            _BitCount -= 8;
+        }
+    }
+
+    void Flush()
+    {
+        if (_BitCount > 0)
+            _Destination.push_back(static_cast<u8>(_Bits));
+        _Bits = 0;
+        _BitCount = 0;
+    }
+
+private:
+    vector<u8>& _Destination;
+    u64 _Bits;
+    u32 _BitCount;
+};
+
+} // namespace
+
+u32 GetAdpcmBlockFrames(SampleEncoding encoding, u32 blockSize, u32 channels)
+{
+    if (channels == 0)
+        return 0;
+    switch (encoding)
+    {
+    case SampleEncoding::ImaAdpcm:
+        // 4 bytes header per channel holding the first sample, then groups of 4 bytes per channel
+        // holding 8 samples each. Only mono blocks can end on a partial group.
+        if (blockSize < 4 * channels)
+            return 0;
+        if (channels == 1)
+            return (blockSize - 4) * 2 + 1;
+        return (blockSize - 4 * channels) / (4 * channels) * 8 + 1;
+    case SampleEncoding::MsAdpcm:
+        // 7 bytes header per channel holding the first 2 samples, then 2 samples per byte
+        if (blockSize < 7 * channels)
+            return 0;
+        return (blockSize - 7 * channels) * 2 / channels + 2;
+    default:
+        return 0;
+    }
+}
+
+Result DecodeBlock(SampleEncoding encoding, const u8* block, u32 blockSize, u32 channels, s16* destination, u32 frames)
+{
+    switch (encoding)
+    {
+    case SampleEncoding::ImaAdpcm:
+        return DecodeImaAdpcmBlock(block, blockSize, channels, destination, frames);
+    case SampleEncoding::MsAdpcm:
+        return DecodeMsAdpcmBlock(block, blockSize, channels, destination, frames);
+    case SampleEncoding::Lossless:
+        return DecodeLosslessBlock(block, blockSize, channels, destination, frames);
+    default:
+        LOOM_RETURN_RESULT(Result::UnsupportedFormat);
+    }
+}
+
+Result DecodeImaAdpcmBlock(const u8* block, u32 blockSize, u32 channels, s16* destination, u32 frames)
+{
+    if (block == nullptr || destination == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    if (channels == 0 || channels > MaxChannels || frames > GetAdpcmBlockFrames(SampleEncoding::ImaAdpcm, blockSize, channels))
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    if (frames == 0)
+        return Result::Ok;
+
+    ImaChannelState states[MaxChannels];
+    for (u32 channel = 0; channel < channels; ++channel)
+    {
+        const u8* header = block + channel * 4;
+        states[channel].predictor = ReadS16(header);
+        states[channel].stepIndex = std::min<s32>(header[2], 88);
+        destination[channel] = static_cast<s16>(states[channel].predictor);
+    }
+
+    // Each channel has 4 bytes holding its next 8 samples, low nibble first
+    const u8* data = block + channels * 4;
+    for (u32 frame = 1; frame < frames; frame += 8)
+    {
+        u32 groupFrames = std::min(8u, frames - frame);
+        for (u32 channel = 0; channel < channels; ++channel)
+        {
+            ImaChannelState& state = states[channel];
+            for (u32 i = 0; i < groupFrames; ++i)
+            {
+                u32 nibble = (data[i >> 1] >> ((i & 1) * 4)) & 0x0F;
+                destination[(frame + i) * channels + channel] = state.Decode(nibble);
+            }
+            data += 4;
+        }
+    }
+    return Result::Ok;
+}
+
+Result DecodeMsAdpcmBlock(const u8* block, u32 blockSize, u32 channels, s16* destination, u32 frames)
+{
+    if (block == nullptr || destination == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    if (channels == 0 || channels > MaxChannels || frames > GetAdpcmBlockFrames(SampleEncoding::MsAdpcm, blockSize, channels))
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    if (frames == 0)
+        return Result::Ok;
+
+    // Header fields are grouped by field, each holding one value per channel
+    MsChannelState states[MaxChannels];
+    for (u32 channel = 0; channel < channels; ++channel)
+    {
+        u32 predictor = std::min<u32>(block[channel], 6);
+        MsChannelState& state = states[channel];
+        state.coefficient1 = MsCoefficients[predictor][0];
+        state.coefficient2 = MsCoefficients[predictor][1];
+        state.delta = ReadS16(block + channels + channel * 2);
+        state.sample1 = ReadS16(block + channels * 3 + channel * 2);
+        state.sample2 = ReadS16(block + channels * 5 + channel * 2);
+        destination[channel] = static_cast<s16>(state.sample2);
+        if (frames > 1)
+            destination[channels + channel] = static_cast<s16>(state.sample1);
+    }
+
+    // Nibbles are interleaved across channels, high nibble first
+    const u8* data = block + channels * 7;
+    u32 sampleCount = (frames > 2 ? frames - 2 : 0) * channels;
+    s16* output = destination + 2 * channels;
+    for (u32 i = 0; i < sampleCount; ++i)
+    {
+        u32 nibble = (i & 1) ? data[i >> 1] & 0x0F : data[i >> 1] >> 4;
+        output[i] = states[i % channels].Decode(nibble);
+    }
+    return Result::Ok;
+}
+
+Result DecodeLosslessBlock(const u8* block, u32 blockSize, u32 channels, s16* destination, u32 frames)
+{
+    if (block == nullptr || destination == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    if (channels == 0 || frames > LosslessBlockFrames)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+
+    // Channels are stored one after the other, each as
+    // [order:u8][bit width:u8][order x warm-up:s32][residuals, bit packed]
+    s32 values[LosslessBlockFrames];
+    const u8* data = block;
+    const u8* end = block + blockSize;
+    for (u32 channel = 0; channel < channels; ++channel)
+    {
+        if (end - data < 2)
+            LOOM_RETURN_RESULT(Result::InvalidFile);
+        u32 order = std::min(static_cast<u32>(data[0]), frames);
+        u32 bitWidth = data[1];
+        data += 2;
+        if (order > MaxLosslessOrder || bitWidth > 32 || static_cast<u64>(end - data) < order * sizeof(s32))
+            LOOM_RETURN_RESULT(Result::InvalidFile);
+        memcpy(values, data, order * sizeof(s32));
+        data += order * sizeof(s32);
+
+        u32 residualCount = frames - order;
+        u64 packedSize = (static_cast<u64>(residualCount) * bitWidth + 7) / 8;
+        if (static_cast<u64>(end - data) < packedSize)
+            LOOM_RETURN_RESULT(Result::InvalidFile);
+        s32* residuals = values + order;
+        if (bitWidth == 0)
+        {
+            memset(residuals, 0, residualCount * sizeof(s32));
+        }
+        else
+        {
+            u64 bits = 0;
+            u32 bitCount = 0;
+            const u8* packed = data;
+            u64 mask = (u64(1) << bitWidth) - 1;
+            for (u32 i = 0; i < residualCount; ++i)
+            {
+                while (bitCount < bitWidth)
+                {
+                    bits |= static_cast<u64>(*packed++) << bitCount;
+                    bitCount += 8;
+                }
+                residuals[i] = static_cast<s32>(static_cast<u32>(bits & mask));
+                bits >>= bitWidth;
+                bitCount -= bitWidth;
+            }
+            ZigZagDecode(residuals, residualCount);
+        }
+        data += packedSize;
+
+        for (u32 pass = 0; pass < order; ++pass)
+            PrefixSum(values, frames);
+        for (u32 frame = 0; frame < frames; ++frame)
+            destination[frame * channels + channel] = static_cast<s16>(values[frame]);
+    }
+    return Result::Ok;
+}
+
+Result EncodeLosslessBlock(const s16* source, u32 frames, u32 channels, vector<u8>& destination)
+{
+    if (source == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    if (channels == 0 || frames > LosslessBlockFrames)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+
+    s32 values[LosslessBlockFrames];
+    s32 candidate[LosslessBlockFrames];
+    for (u32 channel = 0; channel < channels; ++channel)
+    {
+        // Pick the fixed predictor order needing the fewest bits per residual
+        for (u32 frame = 0; frame < frames; ++frame)
+            candidate[frame] = source[frame * channels + channel];
+        u32 bestOrder = 0;
+        u32 bestWidth = 33;
+        for (u32 order = 0; order <= std::min(MaxLosslessOrder, frames); ++order)
+        {
+            if (order > 0)
+                Difference(candidate, frames);
+            u32 maxResidual = 0;
+            for (u32 frame = order; frame < frames; ++frame)
+                maxResidual |= ZigZagEncode(candidate[frame]);
+            u32 width = GetBitWidth(maxResidual);
+            if (width < bestWidth)
+            {
+                bestOrder = order;
+                bestWidth = width;
+                memcpy(values, candidate, frames * sizeof(s32));
+            }
+        }
+
+        destination.push_back(static_cast<u8>(bestOrder));
+        destination.push_back(static_cast<u8>(bestWidth));
+        const u8* warmUp = reinterpret_cast<const u8*>(values);
+        destination.insert(destination.end(), warmUp, warmUp + bestOrder * sizeof(s32));
+        BitWriter writer(destination);
+        for (u32 frame = bestOrder; frame < frames; ++frame)
+            writer.Write(ZigZagEncode(values[frame]), bestWidth);
+        writer.Flush();
+    }
+    return Result::Ok;
+}
+
+} // namespace Loom
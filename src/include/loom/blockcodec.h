@@ -0,0 +1,33 @@
+#pragma once
+
+#include "loom/audioformat.h"
+
+namespace Loom
+{
+
+// How the samples of an asset are stored in memory
+enum class SampleEncoding
+{
+    Pcm,
+    ImaAdpcm,
+    MsAdpcm,
+    Lossless
+};
+
+// Frames per block of the lossless codec, which bounds the decoding cost of a block
+constexpr u32 LosslessBlockFrames = 1024;
+
+// Frames held by an ADPCM block of the given size
+u32 GetAdpcmBlockFrames(SampleEncoding encoding, u32 blockSize, u32 channels);
+
+// Decodes a block to interleaved 16 bit samples.
+// ADPCM blocks hold a fixed amount of frames, a short final block decodes fewer.
+Result DecodeBlock(SampleEncoding encoding, const u8* block, u32 blockSize, u32 channels, s16* destination, u32 frames);
+Result DecodeImaAdpcmBlock(const u8* block, u32 blockSize, u32 channels, s16* destination, u32 frames);
+Result DecodeMsAdpcmBlock(const u8* block, u32 blockSize, u32 channels, s16* destination, u32 frames);
+Result DecodeLosslessBlock(const u8* block, u32 blockSize, u32 channels, s16* destination, u32 frames);
+
+// Appends the encoded block of at most LosslessBlockFrames interleaved frames
+Result EncodeLosslessBlock(const s16* source, u32 frames, u32 channels, vector<u8>& destination);
+
+} // namespace Loom
@@ -0,0 +1,296 @@
+#include "loom/convolution.h"
+#include "loom/audiotracer.h"
+
+namespace Loom
+{
+
+namespace
+{
+
+constexpr u32 WorkerWaitMs = 1;
+
+bool IsPowerOfTwo(u32 value)
+{
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+} // namespace
+
+Convolver::Segment::Segment()
+    : blockFrames(0)
+    , partitionCount(0)
+    , delayLinePosition(0)
+{
+}
+
+void Convolver::Segment::Initialize(const RealFFT& fft, const float* impulse, u32 impulseFrames, u32 blockFrames)
+{
+    this->blockFrames = blockFrames;
+    partitionCount = std::max<u32>(1, (impulseFrames + blockFrames - 1) / blockFrames);
+    delayLinePosition = 0;
+    u32 spectrumSize = 2 * fft.GetBinCount();
+    partitions.assign(partitionCount * spectrumSize, 0.0f);
+    delayLine.assign(partitionCount * spectrumSize, 0.0f);
+    input.assign(2 * blockFrames, 0.0f);
+    accumulator.assign(spectrumSize, 0.0f);
+    output.assign(2 * blockFrames, 0.0f);
+
+    // Zero padded to twice the block, the normalization of the inverse transform is folded in the partitions
+    vector<float> padded(2 * blockFrames);
+    float scale = 1.0f / fft.GetSize();
+    for (u32 partition = 0; partition < partitionCount; ++partition)
+    {
+        std::fill(padded.begin(), padded.end(), 0.0f);
+        u32 first = partition * blockFrames;
+        u32 frames = std::min(blockFrames, impulseFrames - std::min(first, impulseFrames));
+        for (u32 i = 0; i < frames; ++i)
+            padded[i] = impulse[first + i] * scale;
+        fft.Forward(padded.data(), &partitions[partition * spectrumSize]);
+    }
+}
+
+void Convolver::Segment::Process(const RealFFT& fft, const float* block, float* blockOutput)
+{
+    // Overlap-save, the transform covers the previous and the current blocks
+    std::copy(input.begin() + blockFrames, input.end(), input.begin());
+    std::copy(block, block + blockFrames, input.begin() + blockFrames);
+    u32 spectrumSize = static_cast<u32>(accumulator.size());
+    fft.Forward(input.data(), &delayLine[delayLinePosition * spectrumSize]);
+
+    std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+    float* sum = accumulator.data();
+    for (u32 partition = 0; partition < partitionCount; ++partition)
+    {
+        // The partition k applies to the input block received k blocks ago
+        u32 slot = (delayLinePosition + partitionCount - partition) % partitionCount;
+        const float* spectrum = &delayLine[slot * spectrumSize];
+        const float* response = &partitions[partition * spectrumSize];
+        for (u32 i = 0; i < spectrumSize; i += 2)
+        {
+            sum[i] += spectrum[i] * response[i] - spectrum[i + 1] * response[i + 1];
+            sum[i + 1] += spectrum[i] * response[i + 1] + spectrum[i + 1] * response[i];
+        }
+    }
+    delayLinePosition = (delayLinePosition + 1) % partitionCount;
+
+    fft.Inverse(accumulator.data(), output.data());
+    std::copy(output.begin() + blockFrames, output.end(), blockOutput);
+}
+
+Convolver::TailJob::TailJob()
+    : index(0)
+    , state(TailJobState::Idle)
+{
+}
+
+Convolver::Convolver()
+    : _Channels(0)
+    , _BlockFrames(0)
+    , _TailBlockFrames(0)
+    , _Initialized(false)
+    , _HasTail(false)
+    , _BlockPosition(0)
+    , _BlockIndex(0)
+    , _NextTailJob(0)
+    , _WorkerRunning(false)
+{
+}
+
+Convolver::~Convolver()
+{
+    Shutdown();
+}
+
+Result Convolver::Initialize(const float* impulse, u32 impulseFrames, u32 impulseChannels, u32 channels, u32 blockFrames, bool backgroundTail)
+{
+    if (impulse == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    if (impulseFrames == 0 || impulseChannels == 0 || impulseChannels > MaxChannels || channels == 0 || channels > MaxChannels)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    if (!IsPowerOfTwo(blockFrames) || blockFrames < 2 || blockFrames > MaxBlockFrames)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    Shutdown();
+
+    _Channels = channels;
+    _BlockFrames = blockFrames;
+    _TailBlockFrames = blockFrames * TailBlockRatio;
+    u32 headFrames = std::min(impulseFrames, 2 * _TailBlockFrames);
+    u32 tailFrames = impulseFrames - headFrames;
+    _HasTail = tailFrames > 0;
+    Result result = _HeadFFT.Initialize(2 * _BlockFrames);
+    if (Ok(result) && _HasTail)
+        result = _TailFFT.Initialize(2 * _TailBlockFrames);
+    LOOM_CHECK_RESULT(result);
+
+    _Head.assign(channels, Segment());
+    _Tail.assign(_HasTail ? channels : 0, Segment());
+    vector<float> channelImpulse(impulseFrames);
+    for (u32 channel = 0; channel < channels; ++channel)
+    {
+        u32 impulseChannel = channel % impulseChannels;
+        for (u32 frame = 0; frame < impulseFrames; ++frame)
+            channelImpulse[frame] = impulse[frame * impulseChannels + impulseChannel];
+        _Head[channel].Initialize(_HeadFFT, channelImpulse.data(), headFrames, _BlockFrames);
+        if (_HasTail)
+            _Tail[channel].Initialize(_TailFFT, channelImpulse.data() + headFrames, tailFrames, _TailBlockFrames);
+    }
+
+    _InputBlock.assign(channels * _BlockFrames, 0.0f);
+    _OutputBlock.assign(channels * _BlockFrames, 0.0f);
+    _BlockPosition = 0;
+    _BlockIndex = 0;
+    _TailInput.assign(_HasTail ? channels * _TailBlockFrames : 0, 0.0f);
+    for (TailJob& job : _TailJobs)
+    {
+        job.index = 0;
+        job.state = TailJobState::Idle;
+        job.input.assign(_TailInput.size(), 0.0f);
+        job.output.assign(_TailInput.size(), 0.0f);
+    }
+    _NextTailJob = 0;
+    if (_HasTail && backgroundTail)
+    {
+        _WorkerRunning = true;
+        _Worker = thread(&Convolver::TailWorker, this);
+    }
+    _Initialized = true;
+    return Result::Ok;
+}
+
+void Convolver::Shutdown()
+{
+    _WorkerRunning = false;
+    _WorkerCondition.notify_all();
+    if (_Worker.joinable())
+        _Worker.join();
+    _Initialized = false;
+}
+
+bool Convolver::IsInitialized() const
+{
+    return _Initialized;
+}
+
+u32 Convolver::GetChannels() const
+{
+    return _Channels;
+}
+
+u32 Convolver::GetLatency() const
+{
+    return _BlockFrames;
+}
+
+Result Convolver::Process(float* samples, u32 frames)
+{
+    if (!_Initialized)
+        LOOM_RETURN_RESULT(Result::NotReady);
+    if (samples == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    u32 processed = 0;
+    while (processed < frames)
+    {
+        u32 count = std::min(_BlockFrames - _BlockPosition, frames - processed);
+        for (u32 channel = 0; channel < _Channels; ++channel)
+        {
+            float* input = &_InputBlock[channel * _BlockFrames + _BlockPosition];
+            const float* output = &_OutputBlock[channel * _BlockFrames + _BlockPosition];
+            float* sample = samples + processed * _Channels + channel;
+            for (u32 i = 0; i < count; ++i, sample += _Channels)
+            {
+                input[i] = *sample;
+                *sample = output[i];
+            }
+        }
+        processed += count;
+        _BlockPosition += count;
+        if (_BlockPosition == _BlockFrames)
+        {
+            ProcessBlock();
+            _BlockPosition = 0;
+        }
+    }
+    return Result::Ok;
+}
+
+void Convolver::ProcessBlock()
+{
+    LOOM_TRACE_SCOPE("Convolution", "Head");
+    for (u32 channel = 0; channel < _Channels; ++channel)
+        _Head[channel].Process(_HeadFFT, &_InputBlock[channel * _BlockFrames], &_OutputBlock[channel * _BlockFrames]);
+
+    if (_HasTail)
+    {
+        u64 tailBlock = _BlockIndex / TailBlockRatio;
+        u32 offset = static_cast<u32>(_BlockIndex % TailBlockRatio) * _BlockFrames;
+        // The tail starts two tail blocks into the response, the output of a tail block
+        // is added to the blocks received two tail blocks after its input
+        if (tailBlock >= 2)
+        {
+            const TailJob* job = GetTailOutput(tailBlock - 2);
+            for (u32 channel = 0; channel < _Channels; ++channel)
+            {
+                const float* tail = &job->output[channel * _TailBlockFrames + offset];
+                float* output = &_OutputBlock[channel * _BlockFrames];
+                for (u32 i = 0; i < _BlockFrames; ++i)
+                    output[i] += tail[i];
+            }
+        }
+
+        for (u32 channel = 0; channel < _Channels; ++channel)
+            std::copy_n(&_InputBlock[channel * _BlockFrames], _BlockFrames, &_TailInput[channel * _TailBlockFrames + offset]);
+        if (offset + _BlockFrames == _TailBlockFrames)
+        {
+            // The slot was last used three tail blocks ago, its output is consumed
+            TailJob& job = _TailJobs[tailBlock % TailJobSlots];
+            LOOM_DEBUG_ASSERT(job.state != TailJobState::Pending && job.state != TailJobState::Running, "Convolution tail job %llu still queued.", static_cast<unsigned long long>(job.index));
+            std::copy(_TailInput.begin(), _TailInput.end(), job.input.begin());
+            job.index = tailBlock;
+            job.state.store(TailJobState::Pending, std::memory_order_release);
+            _WorkerCondition.notify_one();
+        }
+    }
+    ++_BlockIndex;
+}
+
+Convolver::TailJob* Convolver::GetTailOutput(u64 index)
+{
+    // Computed here when there is no worker or when the worker is late
+    while (_NextTailJob.load(std::memory_order_acquire) <= index)
+    {
+        if (!RunTailJob(index))
+            std::this_thread::yield();
+    }
+    return &_TailJobs[index % TailJobSlots];
+}
+
+bool Convolver::RunTailJob(u64 index)
+{
+    TailJob& job = _TailJobs[index % TailJobSlots];
+    TailJobState pending = TailJobState::Pending;
+    if (_NextTailJob.load(std::memory_order_acquire) != index || job.state.load(std::memory_order_acquire) != pending || job.index != index)
+        return false;
+    if (!job.state.compare_exchange_strong(pending, TailJobState::Running, std::memory_order_acquire))
+        return false;
+    LOOM_TRACE_SCOPE("Convolution", "Tail");
+    for (u32 channel = 0; channel < _Channels; ++channel)
+        _Tail[channel].Process(_TailFFT, &job.input[channel * _TailBlockFrames], &job.output[channel * _TailBlockFrames]);
+    job.state.store(TailJobState::Done, std::memory_order_release);
+    _NextTailJob.store(index + 1, std::memory_order_release);
+    return true;
+}
+
+void Convolver::TailWorker()
+{
+    LOOM_TRACE_THREAD_NAME("Loom convolution tail");
+    while (_WorkerRunning)
+    {
+        if (RunTailJob(_NextTailJob.load(std::memory_order_acquire)))
+            continue;
+        // Notified without the lock by the audio thread, a missed notification only delays the job
+        mutex_lock lock(_WorkerMutex);
+        _WorkerCondition.wait_for(lock, std::chrono::milliseconds(WorkerWaitMs));
+    }
+}
+
+} // namespace Loom
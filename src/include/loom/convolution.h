@@ -0,0 +1,113 @@
+#pragma once
+
+#include "loom/defines.h"
+#include "loom/types.h"
+#include "loom/result.h"
+#include "loom/fft.h"
+
+namespace Loom
+{
+
+// Convolution with long impulse responses, split in two uniformly partitioned segments.
+// The head of the response uses partitions of the block size, so every block costs a
+// small transform. The tail uses partitions TailBlockRatio times larger, computed once
+// every TailBlockRatio blocks by a worker thread. The tail starts two tail blocks into
+// the response, so a tail block has about TailBlockRatio blocks of time to complete.
+// The output is delayed by one block.
+class Convolver
+{
+public:
+    static constexpr u32 DefaultBlockFrames = 128;
+    static constexpr u32 TailBlockRatio = 16;
+    static constexpr u32 MaxChannels = 8;
+    static constexpr u32 MaxBlockFrames = FFT::MaxSize / TailBlockRatio / 2;
+
+    Convolver();
+    ~Convolver();
+
+    // The impulse response holds interleaved frames, channel c is convolved with its channel c modulo impulseChannels.
+    // Without a background tail, the tail blocks are computed by the processing thread when needed.
+    Result Initialize(const float* impulse, u32 impulseFrames, u32 impulseChannels, u32 channels, u32 blockFrames = DefaultBlockFrames, bool backgroundTail = true);
+    void Shutdown();
+    bool IsInitialized() const;
+    u32 GetChannels() const;
+    u32 GetLatency() const;
+    // Replaces interleaved frames by their convolution
+    Result Process(float* samples, u32 frames);
+
+private:
+    // One uniformly partitioned segment of the response for one channel. The spectra of the
+    // last input blocks are kept in a delay line, each one multiplied by its partition.
+    struct Segment
+    {
+        Segment();
+
+        void Initialize(const RealFFT& fft, const float* impulse, u32 impulseFrames, u32 blockFrames);
+        void Process(const RealFFT& fft, const float* block, float* output);
+
+        u32 blockFrames;
+        u32 partitionCount;
+        u32 delayLinePosition;
+        vector<float> partitions;
+        vector<float> delayLine;
+        vector<float> input;
+        vector<float> accumulator;
+        vector<float> output;
+    };
+
+    enum class TailJobState : u32
+    {
+        Idle,
+        Pending,
+        Running,
+        Done
+    };
+
+    // Consumed for TailBlockRatio blocks while the next job is computed, a third slot is being posted
+    static constexpr u32 TailJobSlots = 3;
+
+    struct TailJob
+    {
+        TailJob();
+
+        u64 index;
+        atomic<TailJobState> state;
+        vector<float> input;
+        vector<float> output;
+    };
+
+    void ProcessBlock();
+    TailJob* GetTailOutput(u64 index);
+    bool RunTailJob(u64 index);
+    void TailWorker();
+
+private:
+    u32 _Channels;
+    u32 _BlockFrames;
+    u32 _TailBlockFrames;
+    bool _Initialized;
+
+    RealFFT _HeadFFT;
+    RealFFT _TailFFT;
+    vector<Segment> _Head;
+    vector<Segment> _Tail;
+    bool _HasTail;
+
+    // Deinterleaved blocks, the output being the result of the previous input block
+    vector<float> _InputBlock;
+    vector<float> _OutputBlock;
+    u32 _BlockPosition;
+    u64 _BlockIndex;
+
+    vector<float> _TailInput;
+    TailJob _TailJobs[TailJobSlots];
+    // Jobs run in order, the tail delay lines depend on the previous job
+    atomic<u64> _NextTailJob;
+
+    thread _Worker;
+    mutex _WorkerMutex;
+    condition_variable _WorkerCondition;
+    atomic<bool> _WorkerRunning;
+};
+
+} // namespace Loom
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "loom/logger.h"
+
 #if defined(_MSC_VER)
     #define LOOM_DEBUG_BREAK() __debugbreak()
     #define LOOM_FUNCTION __FUNCSIG__
@@ -11,23 +13,43 @@
     #define LOOM_FUNCTION __FUNCTION__
 #endif
 
-#define LOOM_LOG(format, ...) printf(format "\n", ##__VA_ARGS__);
-#define LOOM_LOG_WARNING(format, ...) printf("[WARNING] {%s}" format "\n", LOOM_FUNCTION, ##__VA_ARGS__);
-#define LOOM_LOG_ERROR(format, ...) printf("[ERROR] {%s}" format " [%s l.%d]\n", LOOM_FUNCTION, ##__VA_ARGS__, __FILE__, __LINE__);
+// Queued to the logger thread, see Logger
+#if LOOM_LOG_LEVEL <= LOOM_LOG_LEVEL_INFO
+    #define LOOM_LOG(format, ...) LOOM_LOG_WRITE(::Loom::LogLevel::Info, format, ##__VA_ARGS__)
+#else
+    #define LOOM_LOG(format, ...) LOOM_LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+#if LOOM_LOG_LEVEL <= LOOM_LOG_LEVEL_WARNING
+    #define LOOM_LOG_WARNING(format, ...) LOOM_LOG_WRITE(::Loom::LogLevel::Warning, "[WARNING] {%s}" format, LOOM_FUNCTION, ##__VA_ARGS__)
+#else
+    #define LOOM_LOG_WARNING(format, ...) LOOM_LOG_DISCARD("[WARNING] {%s}" format, LOOM_FUNCTION, ##__VA_ARGS__)
+#endif
+#if LOOM_LOG_LEVEL <= LOOM_LOG_LEVEL_ERROR
+    #define LOOM_LOG_ERROR(format, ...) LOOM_LOG_WRITE(::Loom::LogLevel::Error, "[ERROR] {%s}" format " [%s l.%d]", LOOM_FUNCTION, ##__VA_ARGS__, __FILE__, __LINE__)
+#else
+    #define LOOM_LOG_ERROR(format, ...) LOOM_LOG_DISCARD("[ERROR] {%s}" format " [%s l.%d]", LOOM_FUNCTION, ##__VA_ARGS__, __FILE__, __LINE__)
+#endif
 
 #define LOOM_LOG_RESULT(result) { LOOM_LOG_WARNING("Returned %s (%d).", ResultToString(result), static_cast<u32>(result)) }
 #define LOOM_RETURN_RESULT(result) { LOOM_LOG_RESULT(result); return result; }
 #define LOOM_CHECK_RESULT(result) if (result != Result::Ok) { LOOM_RETURN_RESULT(result); }
 
+// Printed directly, the process stops before the logger thread would print it
 #define LOOM_DEBUG_ASSERT(condition, format, ...) \
 if (!(condition)) \
 { \
-    LOOM_LOG("[ASSERT] " format "\n", ##__VA_ARGS__); \
+    ::Loom::Logger::Flush(); \
+    printf("[ASSERT] " format "\n", ##__VA_ARGS__); \
+    fflush(stdout); \
     LOOM_DEBUG_BREAK(); \
 }
 
 #define LOOM_UNUSED(variable) (void)(variable)
 
+// Unique names for the variables declared by scope macros
+#define LOOM_CONCAT_INNER(a, b) a##b
+#define LOOM_CONCAT(a, b) LOOM_CONCAT_INNER(a, b)
+
 // Flags declaration helper
 #define LOOM_DECLARE_FLAG_ENUM(EnumName, UnderlyingType) \
 enum class EnumName : UnderlyingType; \
@@ -0,0 +1,160 @@
+#include "loom/fade.h"
+#include "loom/simd.h"
+
+namespace Loom
+{
+
+namespace
+{
+
+struct FadeTables
+{
+    FadeTables()
+    {
+        constexpr float HalfPi = 1.57079632679f;
+        constexpr float ExponentialSlope = 5.0f;
+        const float exponentialRange = std::exp(ExponentialSlope) - 1.0f;
+        for (u32 i = 0; i <= FadeTableSize; ++i)
+        {
+            float x = static_cast<float>(i) / FadeTableSize;
+            linear[i] = x;
+            equalPower[i] = std::sin(x * HalfPi);
+            exponential[i] = (std::exp(x * ExponentialSlope) - 1.0f) / exponentialRange;
+            sCurve[i] = x * x * (3.0f - 2.0f * x);
+        }
+    }
+
+    float linear[FadeTableSize + 1];
+    float equalPower[FadeTableSize + 1];
+    float exponential[FadeTableSize + 1];
+    float sCurve[FadeTableSize + 1];
+};
+
+const FadeTables& GetFadeTables()
+{
+    static const FadeTables tables;
+    return tables;
+}
+
+} // namespace
+
+const float* GetFadeTable(FadeCurve curve)
+{
+    const FadeTables& tables = GetFadeTables();
+    switch (curve)
+    {
+    case FadeCurve::EqualPower:
+        return tables.equalPower;
+    case FadeCurve::Exponential:
+        return tables.exponential;
+    case FadeCurve::SCurve:
+        return tables.sCurve;
+    case FadeCurve::Linear:
+    default:
+        return tables.linear;
+    }
+}
+
+Fade::Fade()
+    : _Active(false)
+    , _StartGain(1.0f)
+    , _TargetGain(1.0f)
+    , _StartFrame(0)
+    , _EndFrame(0)
+    , _Table(GetFadeTable(FadeCurve::Linear))
+{
+}
+
+// Tables are static arrays built on first use, starting a fade never allocates
+void Fade::Start(float startGain, float targetGain, u64 startFrame, u64 endFrame, FadeCurve curve)
+{
+    _Active = true;
+    _StartGain = startGain;
+    _TargetGain = targetGain;
+    _StartFrame = startFrame;
+    _EndFrame = std::max(startFrame, endFrame);
+    _Table = GetFadeTable(curve);
+}
+
+void Fade::Stop()
+{
+    _Active = false;
+}
+
+bool Fade::IsActive() const
+{
+    return _Active;
+}
+
+bool Fade::IsComplete(u64 frame) const
+{
+    return frame >= _EndFrame;
+}
+
+float Fade::GetStartGain() const
+{
+    return _StartGain;
+}
+
+float Fade::GetTargetGain() const
+{
+    return _TargetGain;
+}
+
+u64 Fade::GetStartFrame() const
+{
+    return _StartFrame;
+}
+
+u64 Fade::GetEndFrame() const
+{
+    return _EndFrame;
+}
+
+float Fade::GetGain(u64 frame) const
+{
+    if (frame >= _EndFrame)
+        return _TargetGain;
+    if (frame <= _StartFrame)
+        return _StartGain;
+    return GetCurveGain(frame);
+}
+
+void Fade::GetGains(u64 frame, u32 frames, float* gains, float scale) const
+{
+    if (frames == 0)
+        return;
+    float startGain = GetCurveGain(frame) * scale;
+    float step = (GetCurveGain(frame + frames) * scale - startGain) / static_cast<float>(frames);
+    FloatVector index = FloatVector::Set(0.0f, 1.0f, 2.0f, 3.0f);
+    FloatVector indexStep = FloatVector::Broadcast(static_cast<float>(FloatVector::Lanes));
+    FloatVector startGains = FloatVector::Broadcast(startGain);
+    FloatVector steps = FloatVector::Broadcast(step);
+    u32 i = 0;
+    for (; i + FloatVector::Lanes <= frames; i += FloatVector::Lanes)
+    {
+        (startGains + index * steps).Store(gains + i);
+        index = index + indexStep;
+    }
+    for (; i < frames; ++i)
+        gains[i] = startGain + static_cast<float>(i) * step;
+}
+
+float Fade::GetCurveGain(u64 frame) const
+{
+    frame = std::min(std::max(frame, _StartFrame), _EndFrame);
+    if (_EndFrame == _StartFrame)
+        return _TargetGain;
+    float position = static_cast<float>(frame - _StartFrame) * FadeTableSize / static_cast<float>(_EndFrame - _StartFrame);
+    bool rising = _TargetGain >= _StartGain;
+    if (!rising)
+        position = FadeTableSize - position;
+    float fromGain = rising ? _StartGain : _TargetGain;
+    float gainRange = rising ? _TargetGain - _StartGain : _StartGain - _TargetGain;
+    u32 index = std::min(static_cast<u32>(position), FadeTableSize - 1);
+    float fraction = position - static_cast<float>(index);
+    float shape = _Table[index] + (_Table[index + 1] - _Table[index]) * fraction;
+    return fromGain + gainRange * shape;
+}
+
+} // namespace Loom
@@ -1,41 +1,59 @@
 #pragma once
 
 #include "loom/types.h"
-#include "loom/time.h"
 
 namespace Loom
 {
 
-using FadeFunction = void(*)(float&, u64, u64);
-
-void LinearFade(float& gain, float targetGain, u64 startTime, u64 endTime)
+enum class FadeCurve
 {
-    u64 now = Now();
-    if (now >= endTime)
-    {
-        gain = targetGain;
-        return;
-    }
-    else if (now <= startTime)
-    {
-        return;
-    }
-    float fadeRange = static_cast<float>(endTime - startTime);
-    float fadeProgress = static_cast<float>(now - startTime);
-    float fadeRatio = fadeProgress / fadeRange;
-    float gainRange = targetGain - gain;
-    gain += gainRange * fadeRatio;
-
+    Linear,
+    // Constant power across a crossfade of two uncorrelated sources
+    EqualPower,
+    Exponential,
+    SCurve
 };
 
-void FadeIn(float& gain, u64 startTime, u64 endTime)
-{
-    LinearFade(gain, 1.0f, startTime, endTime);
-};
+// Curves are sampled in tables, the gain of a frame is interpolated between two entries
+constexpr u32 FadeTableSize = 1024;
+// Frames of gains computed at once while ramping
+constexpr u32 FadeChunkFrames = 64;
+
+// Curve shape rising from 0 to 1, FadeTableSize + 1 entries
+const float* GetFadeTable(FadeCurve curve);
 
-void FadeOut(float& gain, u64 startTime, u64 endTime)
+// Gain ramp between two frames of the audio clock.
+// Falling ramps use the curve mirrored in time, so a fade out is the reverse of a fade in.
+class Fade
 {
-    LinearFade(gain, 0.0f, startTime, endTime);
+public:
+    Fade();
+
+    void Start(float startGain, float targetGain, u64 startFrame, u64 endFrame, FadeCurve curve = FadeCurve::Linear);
+    void Stop();
+    bool IsActive() const;
+    bool IsComplete(u64 frame) const;
+
+    float GetStartGain() const;
+    float GetTargetGain() const;
+    u64 GetStartFrame() const;
+    u64 GetEndFrame() const;
+
+    float GetGain(u64 frame) const;
+    // Gains of consecutive frames, all of them within the ramp, multiplied by scale.
+    // The curve is read at both ends and followed linearly in between,
+    // callers render ramps in FadeChunkFrames segments.
+    void GetGains(u64 frame, u32 frames, float* gains, float scale = 1.0f) const;
+
+private:
+    float GetCurveGain(u64 frame) const;
+
+    bool _Active;
+    float _StartGain;
+    float _TargetGain;
+    u64 _StartFrame;
+    u64 _EndFrame;
+    const float* _Table;
 };
 
-}
+} // namespace Loom
@@ -0,0 +1,305 @@
+#include "loom/fft.h"
+#include "loom/simd.h"
+
+namespace Loom
+{
+
+namespace
+{
+
+constexpr double Pi = 3.14159265358979323846;
+
+bool IsPowerOfTwo(u32 value)
+{
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+// Product of the twiddle, conjugated for inverse transforms, and a complex value
+template <bool Inverse, class T>
+void MultiplyTwiddle(T wr, T wi, T xr, T xi, T& r, T& i)
+{
+    if constexpr (Inverse)
+    {
+        r = wr * xr + wi * xi;
+        i = wr * xi - wi * xr;
+    }
+    else
+    {
+        r = wr * xr - wi * xi;
+        i = wr * xi + wi * xr;
+    }
+}
+
+// Two radix-2 stages over the values k, k + h, k + 2h and k + 3h of a group of 4h values.
+// v holds the real and imaginary parts of the four values, either floats or vectors of four butterflies.
+template <bool Inverse, class T>
+void Radix4Butterfly(T* v, T w1r, T w1i, T w2r, T w2i)
+{
+    T tr;
+    T ti;
+    // Stage of span 2h, twiddle e^(-2 pi i k / 2h)
+    MultiplyTwiddle<Inverse>(w1r, w1i, v[2], v[3], tr, ti);
+    T b0r = v[0] + tr;
+    T b0i = v[1] + ti;
+    T b1r = v[0] - tr;
+    T b1i = v[1] - ti;
+    MultiplyTwiddle<Inverse>(w1r, w1i, v[6], v[7], tr, ti);
+    T b2r = v[4] + tr;
+    T b2i = v[5] + ti;
+    T b3r = v[4] - tr;
+    T b3i = v[5] - ti;
+    // Stage of span 4h, twiddle e^(-2 pi i k / 4h), times -i for the second half, +i when inverse
+    MultiplyTwiddle<Inverse>(w2r, w2i, b2r, b2i, tr, ti);
+    v[0] = b0r + tr;
+    v[1] = b0i + ti;
+    v[4] = b0r - tr;
+    v[5] = b0i - ti;
+    MultiplyTwiddle<Inverse>(w2r, w2i, b3r, b3i, tr, ti);
+    if constexpr (Inverse)
+    {
+        v[2] = b1r - ti;
+        v[3] = b1i + tr;
+        v[6] = b1r + ti;
+        v[7] = b1i - tr;
+    }
+    else
+    {
+        v[2] = b1r + ti;
+        v[3] = b1i - tr;
+        v[6] = b1r - ti;
+        v[7] = b1i + tr;
+    }
+}
+
+// e^(-2 pi i k / size) for k below count, interleaved
+void ComputeTwiddles(vector<float>& twiddles, u32 size, u32 count)
+{
+    twiddles.resize(2 * count);
+    for (u32 k = 0; k < count; ++k)
+    {
+        double angle = -2.0 * Pi * k / size;
+        twiddles[2 * k] = static_cast<float>(std::cos(angle));
+        twiddles[2 * k + 1] = static_cast<float>(std::sin(angle));
+    }
+}
+
+} // namespace
+
+FFT::FFT()
+    : _Size(0)
+    , _Radix2Pass(false)
+{
+}
+
+Result FFT::Initialize(u32 size)
+{
+    if (!IsPowerOfTwo(size) || size > MaxSize)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    _Size = size;
+    u32 bits = 0;
+    while ((1u << bits) < size)
+        ++bits;
+    _Radix2Pass = (bits % 2) == 1;
+
+    _Twiddles.clear();
+    for (u32 quarter = _Radix2Pass ? 2 : 1; 4 * quarter <= size; quarter *= 4)
+    {
+        size_t offset = _Twiddles.size();
+        _Twiddles.resize(offset + 4 * quarter);
+        float* twiddles = &_Twiddles[offset];
+        for (u32 k = 0; k < quarter; ++k)
+        {
+            double half = -2.0 * Pi * k / (2 * quarter);
+            double full = -2.0 * Pi * k / (4 * quarter);
+            twiddles[k] = static_cast<float>(std::cos(half));
+            twiddles[quarter + k] = static_cast<float>(std::sin(half));
+            twiddles[2 * quarter + k] = static_cast<float>(std::cos(full));
+            twiddles[3 * quarter + k] = static_cast<float>(std::sin(full));
+        }
+    }
+
+    _BitReversalSwaps.clear();
+    for (u32 i = 0; i < size; ++i)
+    {
+        u32 reversed = 0;
+        for (u32 bit = 0; bit < bits; ++bit)
+            reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+        if (i < reversed)
+            _BitReversalSwaps.emplace_back(i, reversed);
+    }
+    return Result::Ok;
+}
+
+u32 FFT::GetSize() const
+{
+    return _Size;
+}
+
+void FFT::Forward(float* data) const
+{
+    Transform<false>(data);
+}
+
+void FFT::Inverse(float* data) const
+{
+    Transform<true>(data);
+}
+
+template <bool Inverse>
+void FFT::Transform(float* data) const
+{
+    for (const pair<u32, u32>& swap : _BitReversalSwaps)
+    {
+        std::swap(data[2 * swap.first], data[2 * swap.second]);
+        std::swap(data[2 * swap.first + 1], data[2 * swap.second + 1]);
+    }
+
+    if (_Radix2Pass)
+    {
+        for (u32 i = 0; i < _Size; i += 2)
+        {
+            float* a = data + 2 * i;
+            float br = a[2];
+            float bi = a[3];
+            a[2] = a[0] - br;
+            a[3] = a[1] - bi;
+            a[0] += br;
+            a[1] += bi;
+        }
+    }
+
+    const float* twiddles = _Twiddles.data();
+    for (u32 quarter = _Radix2Pass ? 2 : 1; 4 * quarter <= _Size; quarter *= 4)
+    {
+        const float* w1r = twiddles;
+        const float* w1i = twiddles + quarter;
+        const float* w2r = twiddles + 2 * quarter;
+        const float* w2i = twiddles + 3 * quarter;
+        for (u32 group = 0; group < _Size; group += 4 * quarter)
+        {
+            float* x0 = data + 2 * group;
+            float* x1 = x0 + 2 * quarter;
+            float* x2 = x1 + 2 * quarter;
+            float* x3 = x2 + 2 * quarter;
+            u32 k = 0;
+            // Four butterflies at once, the complex values being split in real and imaginary vectors
+            for (; k + FloatVector::Lanes <= quarter; k += FloatVector::Lanes)
+            {
+                FloatVector v[8];
+                FloatVector::Deinterleave(FloatVector::Load(x0 + 2 * k), FloatVector::Load(x0 + 2 * k + 4), v[0], v[1]);
+                FloatVector::Deinterleave(FloatVector::Load(x1 + 2 * k), FloatVector::Load(x1 + 2 * k + 4), v[2], v[3]);
+                FloatVector::Deinterleave(FloatVector::Load(x2 + 2 * k), FloatVector::Load(x2 + 2 * k + 4), v[4], v[5]);
+                FloatVector::Deinterleave(FloatVector::Load(x3 + 2 * k), FloatVector::Load(x3 + 2 * k + 4), v[6], v[7]);
+                Radix4Butterfly<Inverse>(v, FloatVector::Load(w1r + k), FloatVector::Load(w1i + k), FloatVector::Load(w2r + k), FloatVector::Load(w2i + k));
+                float* outputs[4] = {x0, x1, x2, x3};
+                for (u32 i = 0; i < 4; ++i)
+                {
+                    FloatVector low;
+                    FloatVector high;
+                    FloatVector::Interleave(v[2 * i], v[2 * i + 1], low, high);
+                    low.Store(outputs[i] + 2 * k);
+                    high.Store(outputs[i] + 2 * k + 4);
+                }
+            }
+            for (; k < quarter; ++k)
+            {
+                float v[8] = {x0[2 * k], x0[2 * k + 1], x1[2 * k], x1[2 * k + 1], x2[2 * k], x2[2 * k + 1], x3[2 * k], x3[2 * k + 1]};
+                Radix4Butterfly<Inverse>(v, w1r[k], w1i[k], w2r[k], w2i[k]);
+                float* outputs[4] = {x0, x1, x2, x3};
+                for (u32 i = 0; i < 4; ++i)
+                {
+                    outputs[i][2 * k] = v[2 * i];
+                    outputs[i][2 * k + 1] = v[2 * i + 1];
+                }
+            }
+        }
+        twiddles += 4 * quarter;
+    }
+}
+
+RealFFT::RealFFT()
+    : _Size(0)
+{
+}
+
+Result RealFFT::Initialize(u32 size)
+{
+    if (!IsPowerOfTwo(size) || size < 4 || size > FFT::MaxSize)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    Result result = _HalfSize.Initialize(size / 2);
+    LOOM_CHECK_RESULT(result);
+    _Size = size;
+    ComputeTwiddles(_Twiddles, size, size / 2);
+    return Result::Ok;
+}
+
+u32 RealFFT::GetSize() const
+{
+    return _Size;
+}
+
+u32 RealFFT::GetBinCount() const
+{
+    return _Size / 2 + 1;
+}
+
+void RealFFT::Forward(const float* input, float* spectrum) const
+{
+    // Even samples as real parts and odd samples as imaginary parts
+    if (input != spectrum)
+        std::copy(input, input + _Size, spectrum);
+    _HalfSize.Forward(spectrum);
+
+    u32 half = _Size / 2;
+    float dcReal = spectrum[0];
+    float dcImaginary = spectrum[1];
+    spectrum[0] = dcReal + dcImaginary;
+    spectrum[1] = 0.0f;
+    spectrum[_Size] = dcReal - dcImaginary;
+    spectrum[_Size + 1] = 0.0f;
+    // Bins k and half - k are split into their even and odd sample spectra together
+    for (u32 k = 1; k <= half / 2; ++k)
+    {
+        u32 j = half - k;
+        float ar = spectrum[2 * k];
+        float ai = spectrum[2 * k + 1];
+        float br = spectrum[2 * j];
+        float bi = spectrum[2 * j + 1];
+        float evenReal = 0.5f * (ar + br);
+        float evenImaginary = 0.5f * (ai - bi);
+        float oddReal = 0.5f * (ai + bi);
+        float oddImaginary = -0.5f * (ar - br);
+        float wr = _Twiddles[2 * k];
+        float wi = _Twiddles[2 * k + 1];
+        float tr = wr * oddReal - wi * oddImaginary;
+        float ti = wr * oddImaginary + wi * oddReal;
+        spectrum[2 * k] = evenReal + tr;
+        spectrum[2 * k + 1] = evenImaginary + ti;
+        spectrum[2 * j] = evenReal - tr;
+        spectrum[2 * j + 1] = ti - evenImaginary;
+    }
+}
+
+void RealFFT::Inverse(const float* spectrum, float* output) const
+{
+    u32 half = _Size / 2;
+    for (u32 k = 0; k < half; ++k)
+    {
+        u32 j = half - k;
+        float ar = spectrum[2 * k];
+        float ai = spectrum[2 * k + 1];
+        float br = spectrum[2 * j];
+        float bi = spectrum[2 * j + 1];
+        float differenceReal = ar - br;
+        float differenceImaginary = ai + bi;
+        float wr = _Twiddles[2 * k];
+        float wi = _Twiddles[2 * k + 1];
+        float oddReal = differenceReal * wr + differenceImaginary * wi;
+        float oddImaginary = differenceImaginary * wr - differenceReal * wi;
+        output[2 * k] = (ar + br) - oddImaginary;
+        output[2 * k + 1] = (ai - bi) + oddReal;
+    }
+    _HalfSize.Inverse(output);
+}
+
+} // namespace Loom
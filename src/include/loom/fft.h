@@ -0,0 +1,61 @@
+#pragma once
+
+#include "loom/defines.h"
+#include "loom/types.h"
+#include "loom/result.h"
+
+namespace Loom
+{
+
+// Power-of-two complex transform, the plan holds the twiddles of every pass and the bit
+// reversal swaps, computed once by Initialize. Complex values are interleaved real and
+// imaginary floats. Radix-4 passes, preceded by a radix-2 pass for odd powers of two,
+// process four butterflies per SIMD vector once the butterflies span four values.
+// Transforms are unnormalized, an inverse of a forward transform scales by the size.
+class FFT
+{
+public:
+    static constexpr u32 MaxSize = 65536;
+
+    FFT();
+
+    Result Initialize(u32 size);
+    u32 GetSize() const;
+    void Forward(float* data) const;
+    void Inverse(float* data) const;
+
+private:
+    template <bool Inverse>
+    void Transform(float* data) const;
+
+private:
+    u32 _Size;
+    bool _Radix2Pass;
+    // Per radix-4 pass of quarter span h: h real and h imaginary parts of the twiddles of the
+    // two merged radix-2 stages, e^(-2 pi i k / 2h) then e^(-2 pi i k / 4h)
+    vector<float> _Twiddles;
+    vector<pair<u32, u32>> _BitReversalSwaps;
+};
+
+// Transform of size real samples, computed as a complex transform of half the size.
+// The spectrum holds the size / 2 + 1 bins from DC to Nyquist.
+class RealFFT
+{
+public:
+    RealFFT();
+
+    Result Initialize(u32 size);
+    u32 GetSize() const;
+    u32 GetBinCount() const;
+    // Spectrum holds size + 2 floats
+    void Forward(const float* input, float* spectrum) const;
+    // Output holds size floats, the samples scaled by the size
+    void Inverse(const float* spectrum, float* output) const;
+
+private:
+    u32 _Size;
+    FFT _HalfSize;
+    vector<float> _Twiddles;
+};
+
+} // namespace Loom
@@ -0,0 +1,37 @@
+#include "loom/file.h"
+
+namespace Loom
+{
+
+namespace
+{
+
+constexpr size_t ReadChunkSize = 1 << 20;
+
+} // namespace
+
+Result ReadFile(const char* filePath, vector<u8>& fileData)
+{
+    if (filePath == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    FILE* file = fopen(filePath, "rb");
+    if (file == nullptr)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    size_t fileSize = 0;
+    while (true)
+    {
+        fileData.resize(fileSize + ReadChunkSize);
+        size_t bytesRead = fread(fileData.data() + fileSize, 1, ReadChunkSize, file);
+        fileSize += bytesRead;
+        if (bytesRead < ReadChunkSize)
+            break;
+    }
+    bool failed = ferror(file) != 0;
+    fclose(file);
+    fileData.resize(fileSize);
+    if (failed)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    return Result::Ok;
+}
+
+} // namespace Loom
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "loom/defines.h"
+#include "loom/types.h"
+#include "loom/result.h"
+
+namespace Loom
+{
+
+// Reads a whole file in memory
+Result ReadFile(const char* filePath, vector<u8>& fileData);
+
+} // namespace Loom
@@ -0,0 +1,49 @@
+#include "loom/interfaces/iaudioassetcache.h"
+#include "loom/interfaces/iaudiosystem.h"
+
+namespace Loom
+{
+
+IAudioAssetCache::IAudioAssetCache(IAudioSystem& system)
+    : IAudioSystemComponent(system)
+{
+}
+
+AudioSystemComponentType IAudioAssetCache::GetType() const
+{
+    return AudioSystemComponentType::AssetCache;
+}
+
+AudioAssetCacheStub::AudioAssetCacheStub()
+    : IAudioAssetCache(IAudioSystem::GetStub())
+{
+}
+
+AudioAssetCacheStub& AudioAssetCacheStub::GetInstance()
+{
+    static AudioAssetCacheStub instance;
+    return instance;
+}
+
+const char* AudioAssetCacheStub::GetName() const
+{
+    LOOM_LOG_RESULT(Result::CallingStub);
+    return "IAudioAssetCache stub";
+}
+
+Result AudioAssetCacheStub::GetAsset(const char*, AudioAssetStorage, shared_ptr<AudioAsset>&)
+{
+    LOOM_RETURN_RESULT(Result::CallingStub);
+}
+
+Result AudioAssetCacheStub::Trim()
+{
+    LOOM_RETURN_RESULT(Result::CallingStub);
+}
+
+Result AudioAssetCacheStub::GetStats(AudioAssetCacheStats&) const
+{
+    LOOM_RETURN_RESULT(Result::CallingStub);
+}
+
+} // namespace Loom
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "loom/interfaces/iaudiosystemcomponent.h"
+
+namespace Loom
+{
+
+class AudioAsset;
+enum class AudioAssetStorage;
+
+struct AudioAssetCacheStats
+{
+    AudioAssetCacheStats()
+        : hits(0)
+        , misses(0)
+        , evictions(0)
+        , evictedBytes(0)
+        , residentBytes(0)
+        , budgetBytes(0)
+        , assetCount(0)
+    {
+    }
+
+    u64 hits;
+    u64 misses;
+    u64 evictions;
+    u64 evictedBytes;
+    u64 residentBytes;
+    u64 budgetBytes;
+    u32 assetCount;
+};
+
+class IAudioAssetCache : public IAudioSystemComponent
+{
+public:
+    IAudioAssetCache(IAudioSystem& system);
+    AudioSystemComponentType GetType() const final override;
+    virtual Result GetAsset(const char* filePath, AudioAssetStorage storage, shared_ptr<AudioAsset>& asset) = 0;
+    virtual Result Trim() = 0;
+    virtual Result GetStats(AudioAssetCacheStats& stats) const = 0;
+};
+
+class AudioAssetCacheStub : public IAudioAssetCache
+{
+public:
+    AudioAssetCacheStub();
+    static AudioAssetCacheStub& GetInstance();
+    const char* GetName() const final override;
+    Result GetAsset(const char*, AudioAssetStorage, shared_ptr<AudioAsset>&) final override;
+    Result Trim() final override;
+    Result GetStats(AudioAssetCacheStats&) const final override;
+};
+
+} // namespace Loom
@@ -0,0 +1,49 @@
+#include "loom/interfaces/iaudioassetloader.h"
+#include "loom/interfaces/iaudiosystem.h"
+
+namespace Loom
+{
+
+IAudioAssetLoader::IAudioAssetLoader(IAudioSystem& system)
+    : IAudioSystemComponent(system)
+{
+}
+
+AudioSystemComponentType IAudioAssetLoader::GetType() const
+{
+    return AudioSystemComponentType::AssetLoader;
+}
+
+AudioAssetLoaderStub::AudioAssetLoaderStub()
+    : IAudioAssetLoader(IAudioSystem::GetStub())
+{
+}
+
+AudioAssetLoaderStub& AudioAssetLoaderStub::GetInstance()
+{
+    static AudioAssetLoaderStub instance;
+    return instance;
+}
+
+const char* AudioAssetLoaderStub::GetName() const
+{
+    LOOM_LOG_RESULT(Result::CallingStub);
+    return "IAudioAssetLoader stub";
+}
+
+Result AudioAssetLoaderStub::LoadAsset(AudioAsset&, AudioAssetLoadPriority, AudioAssetCallback, void*)
+{
+    LOOM_RETURN_RESULT(Result::CallingStub);
+}
+
+Result AudioAssetLoaderStub::CancelLoad(AudioAsset&)
+{
+    LOOM_RETURN_RESULT(Result::CallingStub);
+}
+
+Result AudioAssetLoaderStub::UnloadAsset(AudioAsset&)
+{
+    LOOM_RETURN_RESULT(Result::CallingStub);
+}
+
+} // namespace Loom
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "loom/interfaces/iaudiosystemcomponent.h"
+
+namespace Loom
+{
+
+class AudioAsset;
+
+enum class AudioAssetLoadPriority : u32
+{
+    Low,
+    Normal,
+    High,
+    Critical
+};
+
+// Invoked from a loader thread once the asset is loaded, failed to load or got canceled.
+// Loading an asset that is already loaded invokes it immediately from the calling thread.
+using AudioAssetCallback = void(*)(AudioAsset& asset, Result result, void* userData);
+
+class IAudioAssetLoader : public IAudioSystemComponent
+{
+public:
+    IAudioAssetLoader(IAudioSystem& system);
+    AudioSystemComponentType GetType() const final override;
+    virtual Result LoadAsset(AudioAsset& asset, AudioAssetLoadPriority priority, AudioAssetCallback callback, void* userData) = 0;
+    virtual Result CancelLoad(AudioAsset& asset) = 0;
+    virtual Result UnloadAsset(AudioAsset& asset) = 0;
+};
+
+class AudioAssetLoaderStub : public IAudioAssetLoader
+{
+public:
+    AudioAssetLoaderStub();
+    static AudioAssetLoaderStub& GetInstance();
+    const char* GetName() const final override;
+    Result LoadAsset(AudioAsset&, AudioAssetLoadPriority, AudioAssetCallback, void*) final override;
+    Result CancelLoad(AudioAsset&) final override;
+    Result UnloadAsset(AudioAsset&) final override;
+};
+
+} // namespace Loom
@@ -1,5 +1,3 @@
-#pragma once
-
 #include "loom/interfaces/iaudiocodec.h"
 #include "loom/interfaces/iaudiosystem.h"
 
@@ -33,7 +31,12 @@ const char* AudioCodecStub::GetName() const
     return "IAudioCodec stub";
 }
 
-Result AudioCodecStub::LoadAsset(const char*, AudioAsset&) 
+Result AudioCodecStub::LoadAsset(const char*, AudioAssetStorage, AudioAssetData&)
+{
+    LOOM_RETURN_RESULT(Result::CallingStub);
+}
+
+Result AudioCodecStub::DecodeAsset(const u8*, u64, AudioAssetStorage, AudioAssetData&)
 {
     LOOM_RETURN_RESULT(Result::CallingStub);
 }
@@ -6,14 +6,16 @@ namespace Loom
 {
 
 class AudioBuffer;
-class AudioAsset;
+struct AudioAssetData;
+enum class AudioAssetStorage;
 
 class IAudioCodec : public IAudioSystemComponent
 {
 public:
     IAudioCodec(IAudioSystem& system);
     AudioSystemComponentType GetType() const final override;
-    virtual Result LoadAsset(const char* filePath, AudioAsset& audioFile) = 0;
+    virtual Result LoadAsset(const char* filePath, AudioAssetStorage storage, AudioAssetData& assetData) = 0;
+    virtual Result DecodeAsset(const u8* fileData, u64 fileSize, AudioAssetStorage storage, AudioAssetData& assetData) = 0;
 };
 
 class AudioCodecStub : public IAudioCodec
@@ -22,7 +24,8 @@ public:
     AudioCodecStub();
     static AudioCodecStub& GetInstance();
     const char* GetName() const final override;
-    Result LoadAsset(const char* filePath, AudioAsset& audioFile) final override;
+    Result LoadAsset(const char*, AudioAssetStorage, AudioAssetData&) final override;
+    Result DecodeAsset(const u8*, u64, AudioAssetStorage, AudioAssetData&) final override;
 };
 
 
@@ -1,5 +1,3 @@
-#pragma once
-
 #include "loom/interfaces/iaudiodevicemanager.h"
 #include "loom/interfaces/iaudiosystem.h"
 
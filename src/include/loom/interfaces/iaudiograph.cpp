@@ -103,5 +103,12 @@ Result AudioGraphStub::ConnectNodes(initializer_list<AudioNodePtr>&&)
     LOOM_RETURN_RESULT(Result::CallingStub);
 }
 
+AudioProfiler& AudioGraphStub::GetProfiler()
+{
+    LOOM_LOG_RESULT(Result::CallingStub);
+    static AudioProfiler profiler;
+    return profiler;
+}
+
 
 } // namespace Loom
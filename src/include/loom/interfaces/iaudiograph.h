@@ -2,6 +2,7 @@
 
 #include "loom/interfaces/iaudiosystemcomponent.h"
 #include "loom/nodes/audionode.h"
+#include "loom/audioprofiler.h"
 
 namespace Loom
 {
@@ -26,13 +27,14 @@ public:
     virtual Result RemoveNode(AudioNodePtr& node) = 0;
     virtual Result ConnectNodes(AudioNodePtr& sourceNode, AudioNodePtr& destinationNode) = 0;
     virtual Result ConnectNodes(initializer_list<AudioNodePtr>&& nodes) = 0;
+    virtual AudioProfiler& GetProfiler() = 0;
 
     template <class NodeType, class... Args>
     AudioNodePtr CreateNode(Args&&... args)
     {
         static_assert(std::is_base_of_v<AudioNode, NodeType>, "NodeType must be derived from AudioNode");
 
-        AudioNodePtr node = shared_ptr_cast<AudioNode>(make_shared<NodeType>(GetSystemInterface(), std::forward<Args>(args)...));
+        AudioNodePtr node = shared_ptr_cast<AudioNode>(Loom::make_shared<NodeType>(GetSystemInterface(), std::forward<Args>(args)...));
         if (node != nullptr)
         {
             Result result = InsertNode(node);
@@ -76,6 +78,7 @@ public:
     Result RemoveNode(AudioNodePtr& node) final override;
     Result ConnectNodes(AudioNodePtr& sourceNode, AudioNodePtr& destinationNode) final override;
     Result ConnectNodes(initializer_list<AudioNodePtr>&& nodes) final override;
+    AudioProfiler& GetProfiler() final override;
 };
 
 } // namespace Loom
@@ -1,5 +1,3 @@
-#pragma once
-
 #include "loom/interfaces/iaudioresampler.h"
 #include "loom/interfaces/iaudiosystem.h"
 
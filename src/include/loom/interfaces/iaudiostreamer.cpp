@@ -0,0 +1,49 @@
+#include "loom/interfaces/iaudiostreamer.h"
+#include "loom/interfaces/iaudiosystem.h"
+
+namespace Loom
+{
+
+IAudioStreamer::IAudioStreamer(IAudioSystem& system)
+    : IAudioSystemComponent(system)
+{
+}
+
+AudioSystemComponentType IAudioStreamer::GetType() const
+{
+    return AudioSystemComponentType::Streamer;
+}
+
+AudioStreamerStub::AudioStreamerStub()
+    : IAudioStreamer(IAudioSystem::GetStub())
+{
+}
+
+AudioStreamerStub& AudioStreamerStub::GetInstance()
+{
+    static AudioStreamerStub instance;
+    return instance;
+}
+
+const char* AudioStreamerStub::GetName() const
+{
+    LOOM_LOG_RESULT(Result::CallingStub);
+    return "IAudioStreamer stub";
+}
+
+Result AudioStreamerStub::LoadStreamHead(AudioAsset&, AudioAssetCallback, void*)
+{
+    LOOM_RETURN_RESULT(Result::CallingStub);
+}
+
+Result AudioStreamerStub::OpenStream(const shared_ptr<AudioAsset>&, shared_ptr<AudioStream>&)
+{
+    LOOM_RETURN_RESULT(Result::CallingStub);
+}
+
+Result AudioStreamerStub::CloseStream(shared_ptr<AudioStream>&)
+{
+    LOOM_RETURN_RESULT(Result::CallingStub);
+}
+
+} // namespace Loom
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "loom/interfaces/iaudioassetloader.h"
+
+namespace Loom
+{
+
+class AudioAsset;
+class AudioStream;
+
+class IAudioStreamer : public IAudioSystemComponent
+{
+public:
+    IAudioStreamer(IAudioSystem& system);
+    AudioSystemComponentType GetType() const final override;
+    virtual Result LoadStreamHead(AudioAsset& asset, AudioAssetCallback callback, void* userData) = 0;
+    virtual Result OpenStream(const shared_ptr<AudioAsset>& asset, shared_ptr<AudioStream>& stream) = 0;
+    virtual Result CloseStream(shared_ptr<AudioStream>& stream) = 0;
+};
+
+class AudioStreamerStub : public IAudioStreamer
+{
+public:
+    AudioStreamerStub();
+    static AudioStreamerStub& GetInstance();
+    const char* GetName() const final override;
+    Result LoadStreamHead(AudioAsset&, AudioAssetCallback, void*) final override;
+    Result OpenStream(const shared_ptr<AudioAsset>&, shared_ptr<AudioStream>&) final override;
+    Result CloseStream(shared_ptr<AudioStream>&) final override;
+};
+
+} // namespace Loom
@@ -6,6 +6,7 @@
 #include "loom/interfaces/iaudiobufferprovider.h"
 #include "loom/interfaces/iaudiodevicemanager.h"
 #include "loom/interfaces/iaudiochannelremapper.h"
+#include "loom/interfaces/iaudiostreamer.h"
 
 namespace Loom
 {
@@ -52,6 +53,13 @@ const AudioSystemConfig& AudioSystemStub::GetConfig() const
     return dummyConfig;
 }
 
+const AudioClock& AudioSystemStub::GetClock() const
+{
+    static AudioClock dummyClock;
+    LOOM_LOG_RESULT(Result::CallingStub);
+    return dummyClock;
+}
+
 IAudioGraph& AudioSystemStub::GetGraph() const
 {
     LOOM_LOG_RESULT(Result::CallingStub);
@@ -88,4 +96,38 @@ IAudioBufferProvider& AudioSystemStub::GetBufferProvider() const
     return AudioBufferProviderStub::GetInstance();
 }
 
+IAudioStreamer& AudioSystemStub::GetStreamer() const
+{
+    LOOM_LOG_RESULT(Result::CallingStub);
+    return AudioStreamerStub::GetInstance();
+}
+
+IAudioAssetLoader& AudioSystemStub::GetAssetLoader() const
+{
+    LOOM_LOG_RESULT(Result::CallingStub);
+    return AudioAssetLoaderStub::GetInstance();
+}
+
+IAudioAssetCache& AudioSystemStub::GetAssetCache() const
+{
+    LOOM_LOG_RESULT(Result::CallingStub);
+    return AudioAssetCacheStub::GetInstance();
+}
+
+IAudioVoiceManager& AudioSystemStub::GetVoiceManager() const
+{
+    LOOM_LOG_RESULT(Result::CallingStub);
+    return AudioVoiceManagerStub::GetInstance();
+}
+
+Result AudioSystemStub::LoadAsset(AudioAsset&, AudioAssetLoadPriority, AudioAssetCallback, void*)
+{
+    LOOM_RETURN_RESULT(Result::CallingStub);
+}
+
+Result AudioSystemStub::UnloadAsset(AudioAsset&)
+{
+    LOOM_RETURN_RESULT(Result::CallingStub);
+}
+
 } // namespace Loom
@@ -1,7 +1,11 @@
 #pragma once
 
 #include "loom/audiosystemconfig.h"
+#include "loom/audioclock.h"
 #include "loom/interfaces/iaudiosystemcomponent.h"
+#include "loom/interfaces/iaudioassetloader.h"
+#include "loom/interfaces/iaudioassetcache.h"
+#include "loom/interfaces/iaudiovoicemanager.h"
 
 namespace Loom
 {
@@ -12,6 +16,8 @@ class IAudioDeviceManager;
 class IAudioResampler;
 class IAudioChannelRemapper;
 class IAudioBufferProvider;
+class IAudioStreamer;
+class AudioAsset;
 
 class IAudioSystem : public IAudioSystemComponent
 {
@@ -24,12 +30,19 @@ public:
     const char* GetName() const override;
 
     virtual const AudioSystemConfig& GetConfig() const = 0;
+    virtual const AudioClock& GetClock() const = 0;
     virtual IAudioGraph& GetGraph() const = 0;
     virtual IAudioCodec& GetCodec() const = 0;
     virtual IAudioDeviceManager& GetDeviceManager() const = 0;
     virtual IAudioResampler& GetResampler() const = 0;
     virtual IAudioChannelRemapper& GetChannelRemapper() const = 0;
     virtual IAudioBufferProvider& GetBufferProvider() const = 0;
+    virtual IAudioStreamer& GetStreamer() const = 0;
+    virtual IAudioAssetLoader& GetAssetLoader() const = 0;
+    virtual IAudioAssetCache& GetAssetCache() const = 0;
+    virtual IAudioVoiceManager& GetVoiceManager() const = 0;
+    virtual Result LoadAsset(AudioAsset& asset, AudioAssetLoadPriority priority, AudioAssetCallback callback, void* userData) = 0;
+    virtual Result UnloadAsset(AudioAsset& asset) = 0;
 };
 
 class AudioSystemStub : public IAudioSystem
@@ -37,12 +50,19 @@ class AudioSystemStub : public IAudioSystem
 public:
     static IAudioSystem& GetInstance();
     const AudioSystemConfig& GetConfig() const;
+    const AudioClock& GetClock() const final override;
     IAudioGraph& GetGraph() const final override;
     IAudioCodec& GetCodec() const final override;
     IAudioDeviceManager& GetDeviceManager() const final override;
     IAudioResampler& GetResampler() const final override;
     IAudioChannelRemapper& GetChannelRemapper() const final override;
     IAudioBufferProvider& GetBufferProvider() const final override;
+    IAudioStreamer& GetStreamer() const final override;
+    IAudioAssetLoader& GetAssetLoader() const final override;
+    IAudioAssetCache& GetAssetCache() const final override;
+    IAudioVoiceManager& GetVoiceManager() const final override;
+    Result LoadAsset(AudioAsset&, AudioAssetLoadPriority, AudioAssetCallback, void*) final override;
+    Result UnloadAsset(AudioAsset&) final override;
 };
 
 } // namespace Loom
@@ -1,5 +1,3 @@
-#pragma once
-
 #include "loom/interfaces/iaudiosystemcomponent.h"
 #include "loom/interfaces/iaudiosystem.h"
 
@@ -34,4 +32,9 @@ IAudioSystem& IAudioSystemComponent::GetSystemInterface()
     return _System;
 }
 
+const IAudioSystem& IAudioSystemComponent::GetSystemInterface() const
+{
+    return _System;
+}
+
 } // namespace Loom
@@ -15,7 +15,11 @@ enum class AudioSystemComponentType
     Resampler,
     ChannelRemapper,
     DeviceManager,
-    BufferProvider
+    BufferProvider,
+    Streamer,
+    AssetLoader,
+    AssetCache,
+    VoiceManager
 };
 
 class IAudioSystem;
@@ -35,6 +39,7 @@ public:
 
 protected:
     IAudioSystem& GetSystemInterface();
+    const IAudioSystem& GetSystemInterface() const;
 
 private:
     IAudioSystem& _System;
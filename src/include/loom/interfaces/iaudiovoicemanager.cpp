@@ -0,0 +1,49 @@
+#include "loom/interfaces/iaudiovoicemanager.h"
+#include "loom/interfaces/iaudiosystem.h"
+
+namespace Loom
+{
+
+IAudioVoiceManager::IAudioVoiceManager(IAudioSystem& system)
+    : IAudioSystemComponent(system)
+{
+}
+
+AudioSystemComponentType IAudioVoiceManager::GetType() const
+{
+    return AudioSystemComponentType::VoiceManager;
+}
+
+AudioVoiceManagerStub::AudioVoiceManagerStub()
+    : IAudioVoiceManager(IAudioSystem::GetStub())
+{
+}
+
+AudioVoiceManagerStub& AudioVoiceManagerStub::GetInstance()
+{
+    static AudioVoiceManagerStub instance;
+    return instance;
+}
+
+const char* AudioVoiceManagerStub::GetName() const
+{
+    LOOM_LOG_RESULT(Result::CallingStub);
+    return "IAudioVoiceManager stub";
+}
+
+Result AudioVoiceManagerStub::AddSource(const shared_ptr<AssetReaderNode>&)
+{
+    LOOM_RETURN_RESULT(Result::CallingStub);
+}
+
+Result AudioVoiceManagerStub::RemoveSource(const shared_ptr<AssetReaderNode>&)
+{
+    LOOM_RETURN_RESULT(Result::CallingStub);
+}
+
+Result AudioVoiceManagerStub::GetStats(AudioVoiceManagerStats&) const
+{
+    LOOM_RETURN_RESULT(Result::CallingStub);
+}
+
+} // namespace Loom
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "loom/interfaces/iaudiosystemcomponent.h"
+
+namespace Loom
+{
+
+class AssetReaderNode;
+
+struct AudioVoiceManagerStats
+{
+    AudioVoiceManagerStats()
+        : sourceCount(0)
+        , playingCount(0)
+        , audibleCount(0)
+        , virtualCount(0)
+    {
+    }
+
+    u32 sourceCount;
+    u32 playingCount;
+    u32 audibleCount;
+    u32 virtualCount;
+};
+
+class IAudioVoiceManager : public IAudioSystemComponent
+{
+public:
+    IAudioVoiceManager(IAudioSystem& system);
+    AudioSystemComponentType GetType() const final override;
+    virtual Result AddSource(const shared_ptr<AssetReaderNode>& source) = 0;
+    virtual Result RemoveSource(const shared_ptr<AssetReaderNode>& source) = 0;
+    virtual Result GetStats(AudioVoiceManagerStats& stats) const = 0;
+};
+
+class AudioVoiceManagerStub : public IAudioVoiceManager
+{
+public:
+    AudioVoiceManagerStub();
+    static AudioVoiceManagerStub& GetInstance();
+    const char* GetName() const final override;
+    Result AddSource(const shared_ptr<AssetReaderNode>&) final override;
+    Result RemoveSource(const shared_ptr<AssetReaderNode>&) final override;
+    Result GetStats(AudioVoiceManagerStats&) const final override;
+};
+
+} // namespace Loom
@@ -0,0 +1,196 @@
+#include "loom/logger.h"
+
+namespace Loom
+{
+
+namespace
+{
+
+constexpr u32 DrainIntervalMs = 5;
+
+// Set once the logger is destroyed, messages logged from later static destructors are printed directly
+atomic<bool> LoggerDestroyed(false);
+
+atomic<FILE*> LogOutput(nullptr);
+
+FILE* GetOutput()
+{
+    FILE* output = LogOutput.load(std::memory_order_relaxed);
+    return output != nullptr ? output : stdout;
+}
+
+u64 SteadyNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* GetSuppressedSuffix(u32 suppressed, char* buffer, size_t size)
+{
+    if (suppressed == 0)
+        return "";
+    snprintf(buffer, size, " (%u similar messages suppressed)", suppressed);
+    return buffer;
+}
+
+// Started before main, so that the first message does not start a thread on the audio thread
+Logger& StartupLogger = Logger::GetInstance();
+
+} // namespace
+
+bool LogRateLimiter::Acquire(u64 now, u32& suppressed)
+{
+    u64 windowStart = _WindowStart.load(std::memory_order_relaxed);
+    if (now - windowStart >= WindowNanoseconds && _WindowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed))
+        _Count.store(0, std::memory_order_relaxed);
+    if (_Count.fetch_add(1, std::memory_order_relaxed) < MaxMessagesPerWindow)
+    {
+        suppressed = _Suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+    _Suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+Logger::Record::Record()
+    : sequence(0)
+    , level(LogLevel::Info)
+    , suppressed(0)
+{
+    text[0] = '\0';
+}
+
+Logger::Logger()
+    : _Records(new Record[QueueCapacity])
+    , _WritePosition(0)
+    , _ReadPosition(0)
+    , _Dropped(0)
+    , _ReportedDropped(0)
+    , _Running(true)
+{
+    for (u32 i = 0; i < QueueCapacity; ++i)
+        _Records[i].sequence.store(i, std::memory_order_relaxed);
+    _Thread = thread(&Logger::DrainThread, this);
+}
+
+Logger::~Logger()
+{
+    _Running = false;
+    if (_Thread.joinable())
+        _Thread.join();
+    LoggerDestroyed = true;
+}
+
+Logger& Logger::GetInstance()
+{
+    static Logger instance;
+    return instance;
+}
+
+void Logger::Write(LogRateLimiter& rateLimiter, LogLevel level, const char* format, ...)
+{
+    u32 suppressed = 0;
+    if (!rateLimiter.Acquire(SteadyNanoseconds(), suppressed))
+        return;
+    va_list arguments;
+    va_start(arguments, format);
+    if (LoggerDestroyed.load(std::memory_order_relaxed))
+    {
+        char suffix[64];
+        vfprintf(GetOutput(), format, arguments);
+        fprintf(GetOutput(), "%s\n", GetSuppressedSuffix(suppressed, suffix, sizeof(suffix)));
+    }
+    else
+    {
+        GetInstance().Push(level, suppressed, format, arguments);
+    }
+    va_end(arguments);
+}
+
+void Logger::Flush()
+{
+    if (LoggerDestroyed.load(std::memory_order_relaxed))
+        return;
+    Logger& logger = GetInstance();
+    u64 writePosition = logger._WritePosition.load(std::memory_order_acquire);
+    while (logger._Running.load(std::memory_order_relaxed) && logger._ReadPosition.load(std::memory_order_acquire) < writePosition)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void Logger::SetOutput(FILE* output)
+{
+    LogOutput.store(output, std::memory_order_relaxed);
+}
+
+u64 Logger::GetDroppedCount() const
+{
+    return _Dropped.load(std::memory_order_relaxed);
+}
+
+void Logger::Push(LogLevel level, u32 suppressed, const char* format, va_list arguments)
+{
+    // Bounded multi-producer queue, a slot is claimed by moving the write position past it
+    u64 position = _WritePosition.load(std::memory_order_relaxed);
+    Record* record = nullptr;
+    while (record == nullptr)
+    {
+        Record& candidate = _Records[position % QueueCapacity];
+        u64 sequence = candidate.sequence.load(std::memory_order_acquire);
+        if (sequence == position)
+        {
+            if (_WritePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                record = &candidate;
+        }
+        else if (sequence < position)
+        {
+            // Full, the slot still holds a message not printed yet
+            _Dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            position = _WritePosition.load(std::memory_order_relaxed);
+        }
+    }
+    record->level = level;
+    record->suppressed = suppressed;
+    vsnprintf(record->text, MaxMessageLength, format, arguments);
+    record->sequence.store(position + 1, std::memory_order_release);
+}
+
+bool Logger::Pop()
+{
+    u64 position = _ReadPosition.load(std::memory_order_relaxed);
+    Record& record = _Records[position % QueueCapacity];
+    if (record.sequence.load(std::memory_order_acquire) != position + 1)
+        return false;
+    char suffix[64];
+    fprintf(GetOutput(), "%s%s\n", record.text, GetSuppressedSuffix(record.suppressed, suffix, sizeof(suffix)));
+    record.sequence.store(position + QueueCapacity, std::memory_order_release);
+    _ReadPosition.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+void Logger::DrainThread()
+{
+    while (true)
+    {
+        bool running = _Running.load();
+        bool printed = false;
+        while (Pop())
+            printed = true;
+        u64 dropped = _Dropped.load(std::memory_order_relaxed);
+        if (dropped != _ReportedDropped)
+        {
+            fprintf(GetOutput(), "[WARNING] {Logger} %llu messages dropped, the queue was full.\n", static_cast<unsigned long long>(dropped - _ReportedDropped));
+            _ReportedDropped = dropped;
+            printed = true;
+        }
+        if (printed)
+            fflush(GetOutput());
+        if (!running)
+            return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(DrainIntervalMs));
+    }
+}
+
+} // namespace Loom
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "loom/types.h"
+
+#include <cstdarg>
+
+#define LOOM_LOG_LEVEL_INFO 0
+#define LOOM_LOG_LEVEL_WARNING 1
+#define LOOM_LOG_LEVEL_ERROR 2
+#define LOOM_LOG_LEVEL_NONE 3
+
+// Messages below this level are compiled out, their arguments still being type checked
+#ifndef LOOM_LOG_LEVEL
+    #define LOOM_LOG_LEVEL LOOM_LOG_LEVEL_INFO
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define LOOM_PRINTF_FORMAT(formatIndex, firstArgument) __attribute__((format(printf, formatIndex, firstArgument)))
+#else
+    #define LOOM_PRINTF_FORMAT(formatIndex, firstArgument)
+#endif
+
+namespace Loom
+{
+
+enum class LogLevel : u32
+{
+    Info,
+    Warning,
+    Error
+};
+
+// Lets a call site log a burst of messages per window, the following ones being
+// counted and reported along with the next message that goes through.
+class LogRateLimiter
+{
+public:
+    static constexpr u32 MaxMessagesPerWindow = 10;
+    static constexpr u64 WindowNanoseconds = 1000000000;
+
+    // Constant initialized, a static limiter does not need a guarded initialization
+    constexpr LogRateLimiter()
+        : _WindowStart(0)
+        , _Count(0)
+        , _Suppressed(0)
+    {
+    }
+
+    bool Acquire(u64 now, u32& suppressed);
+
+private:
+    atomic<u64> _WindowStart;
+    atomic<u32> _Count;
+    atomic<u32> _Suppressed;
+};
+
+// Realtime-safe logging: messages are formatted by the calling thread into a slot of a
+// bounded lock-free queue and printed by a background thread. When the queue is full the
+// message is dropped rather than blocking, and the drops are reported later on.
+class Logger
+{
+public:
+    static constexpr u32 MaxMessageLength = 256;
+    static constexpr u32 QueueCapacity = 1024;
+
+    static Logger& GetInstance();
+    ~Logger();
+
+    static void Write(LogRateLimiter& rateLimiter, LogLevel level, const char* format, ...) LOOM_PRINTF_FORMAT(3, 4);
+    // Waits for the queued messages to be printed
+    static void Flush();
+    // Messages are printed to stdout unless set otherwise, e.g. when stdout carries a report
+    static void SetOutput(FILE* output);
+    u64 GetDroppedCount() const;
+
+    // Never called, lets disabled log calls check their format
+    static void CheckFormat(const char*, ...) LOOM_PRINTF_FORMAT(1, 2) {}
+
+private:
+    struct Record
+    {
+        Record();
+
+        // Equal to the write position once the record is filled, see Push
+        atomic<u64> sequence;
+        LogLevel level;
+        u32 suppressed;
+        char text[MaxMessageLength];
+    };
+
+    Logger();
+    void Push(LogLevel level, u32 suppressed, const char* format, va_list arguments);
+    bool Pop();
+    void DrainThread();
+
+private:
+    unique_ptr<Record[]> _Records;
+    atomic<u64> _WritePosition;
+    atomic<u64> _ReadPosition;
+    atomic<u64> _Dropped;
+    u64 _ReportedDropped;
+    atomic<bool> _Running;
+    thread _Thread;
+};
+
+} // namespace Loom
+
+#define LOOM_LOG_WRITE(level, ...) \
+{ \
+    static ::Loom::LogRateLimiter _LogRateLimiter; \
+    ::Loom::Logger::Write(_LogRateLimiter, level, __VA_ARGS__); \
+}
+
+#define LOOM_LOG_DISCARD(...) { if (false) ::Loom::Logger::CheckFormat(__VA_ARGS__); }
@@ -10,8 +10,26 @@
 #include "loom/interfaces/iaudiodevicemanager.h"
 #include "loom/interfaces/iaudiochannelremapper.h"
 #include "loom/interfaces/iaudiobufferprovider.h"
+#include "loom/interfaces/iaudiostreamer.h"
+#include "loom/interfaces/iaudioassetloader.h"
+#include "loom/interfaces/iaudioassetcache.h"
+#include "loom/interfaces/iaudiovoicemanager.h"
 #include "loom/nodes/audionode.h"
 #include "loom/audioasset.h"
+#include "loom/soundbank.h"
+#include "loom/audioassetstore.h"
 #include "loom/nodes/audionodeparameter.h"
 #include "loom/nodes/assetreadernode.h"
 #include "loom/nodes/mixernode.h"
+#include "loom/nodes/biquadfilternode.h"
+#include "loom/nodes/biquadfilterbanknode.h"
+#include "loom/nodes/convolutionnode.h"
+#include "loom/nodes/spectrumanalyzernode.h"
+#include "loom/nodes/spatializernode.h"
+#include "loom/spatializer.h"
+#include "loom/offlinerenderer.h"
+#include "loom/audioprofiler.h"
+#include "loom/audiotracer.h"
+#include "loom/realtimesanitizer.h"
+#include "loom/nullaudiodevicemanager.h"
+#include "loom/wavfiledevicemanager.h"
@@ -1,5 +1,3 @@
-#pragma once
-
 #include "loom/nodes/assetreadernode.h"
 #include "loom/interfaces/iaudiosystem.h"
 #include "loom/audioasset.h"
@@ -8,27 +6,97 @@ namespace Loom
 {
     AssetReaderNode::AssetReaderNode(IAudioSystem& system, shared_ptr<AudioAsset> asset)
         : AudioNode(system)
+        , _FramePosition(0)
+        , _Priority(0)
+        , _Volume(1.0f)
+        , _Virtual(false)
+        , _Position("Position", AudioNodeParameterType::Vector3, Vector3{0.0f, 0.0f, 0.0f})
+        , _Velocity("Velocity", AudioNodeParameterType::Vector3, Vector3{0.0f, 0.0f, 0.0f})
         , _Asset(asset)
-        , _State(Initializing)
+        , _LoopCount(0)
+        , _HasLoopRegion(false)
+        , _LoopStartFrame(0)
+        , _LoopEndFrame(0)
+        , _LoopCrossfadeFrames(0)
+        , _LoopsPlayed(0)
+        , _PendingSeekFrame(NoSeek)
+        , _SeekFadeFrame(SeekFadeFrames)
+        , _StreamSeekGap(false)
+        , _StreamHead(true)
+        , _ScheduledStartFrame(NotScheduled)
+        , _ScheduledStopFrame(NotScheduled)
+        , _VirtualFrameTime(0)
+        , _VirtualFramePosition(0)
+        , _VirtualLoopsPlayed(0)
         , _PendingEvent(NoEvent)
+        , _State(Initializing)
         , _FadeGain(0.0f)
+        , _FadeInDuration(0.0f)
+        , _FadeOutDuration(0.0f)
+        , _FadeCurve(FadeCurve::Linear)
+        , _RenderFrameTime(0)
+    {
+        _Block.index = InvalidBlock;
+        _LoopBlock.index = InvalidBlock;
+        // The asset stays resident for as long as a source can play it
+        if (_Asset != nullptr)
+            _Asset->Pin();
+    }
+
+    AssetReaderNode::~AssetReaderNode()
+    {
+        if (_Asset != nullptr)
+            _Asset->Unpin();
+    }
+
+    Result AssetReaderNode::Initialize()
+    {
+        if (_Asset != nullptr && _Asset->IsStreamed() && _Stream == nullptr)
+        {
+            Result result = GetSystem().GetStreamer().OpenStream(_Asset, _Stream);
+            LOOM_CHECK_RESULT(result);
+            UpdateStreamLoop();
+        }
+        return Result::Ok;
+    }
+
+    Result AssetReaderNode::Shutdown()
     {
+        if (_Stream != nullptr)
+            return GetSystem().GetStreamer().CloseStream(_Stream);
+        return Result::Ok;
     }
 
     Result AssetReaderNode::Play(float fade)
     {
-        _PendingEvent = PlayRequest;
-        _FadeInDuration = fade;
-        return Update();
+        return PlayAt(NotScheduled, fade);
     }
 
     Result AssetReaderNode::Stop(float fade)
     {
+        _ScheduledStopFrame = NotScheduled;
         _PendingEvent = StopRequest;
         _FadeOutDuration = fade;
         return Update();
     }
 
+    // Silence is rendered up to the start frame, the fade in begins with it
+    Result AssetReaderNode::PlayAt(u64 frameTime, float fade)
+    {
+        _ScheduledStartFrame = frameTime;
+        _PendingEvent = PlayRequest;
+        _FadeInDuration = fade;
+        return Update();
+    }
+
+    // Keeps playing until the fade out has to begin for rendering to end on the stop frame
+    Result AssetReaderNode::StopAt(u64 frameTime, float fade)
+    {
+        _FadeOutDuration = fade;
+        _ScheduledStopFrame = frameTime;
+        return Result::Ok;
+    }
+
     Result AssetReaderNode::LoadAsset(bool& loaded)
     {
         if (_Asset != nullptr)
@@ -65,10 +133,15 @@ namespace Loom
                 LOOM_CHECK_RESULT(result);
                 if (assetIsLoaded)
                 {
+                    PrepareBuffers();
                     if (PlayIsRequested())
                     {
-                        ConfigureFade(FadeIn, _FadeInDuration);
-                        _State = Playing;
+                        ConsumeEvent();
+                        StartFade(0.0f, 1.0f, _FadeInDuration);
+                        if (IsVirtual())
+                            EnterVirtual();
+                        else
+                            _State = Playing;
                     }
                     else
                         _State = Stopped;
@@ -80,36 +153,82 @@ namespace Loom
             }
             return Result::Ok;
         case Playing:
-            if (IsVirtual())
-            {
-                ConfigureFade(FadeOut, VirtualFadeDuration);
-                _State = Virtualizing;
-            }
             if (StopIsRequested())
             {
-                ConfigureFade(FadeOut, _FadeOutDuration);
+                ConsumeEvent();
+                StartFade(1.0f, 0.0f, _FadeOutDuration);
                 _State = Stopping;
             }
+            else if (IsVirtual())
+            {
+                ContinueFade(0.0f, VirtualFadeDuration);
+                _State = Virtualizing;
+            }
             return Result::Ok;
         case Stopping:
         case Stopped:
             if (PlayIsRequested())
             {
-                ConfigureFade(FadeIn, _FadeInDuration);
-                _State = Playing;
+                // Sources played over the voice budget start virtual and never render
+                ConsumeEvent();
+                StartFade(0.0f, 1.0f, _FadeInDuration);
+                if (IsVirtual())
+                    EnterVirtual();
+                else
+                    _State = Playing;
             }
             return Result::Ok;
         case Virtualizing:
         case Virtual:
-            if (!IsVirtual())
+            if (StopIsRequested())
+            {
+                ConsumeEvent();
+                if (_State == Virtual)
+                {
+                    _State = Stopped;
+                }
+                else
+                {
+                    ContinueFade(0.0f, _FadeOutDuration);
+                    _State = Stopping;
+                }
+            }
+            else if (_State == Virtual && VirtualPlaybackEnded())
+            {
+                _ScheduledStopFrame = NotScheduled;
+                ResetPosition();
+                _State = Stopped;
+            }
+            else if (_State == Virtual && ScheduledStopReached())
+            {
+                _ScheduledStopFrame = NotScheduled;
+                _State = Stopped;
+            }
+            else if (!IsVirtual())
+            {
+                // The audio thread does not touch the position of a virtual source, it can be moved from here
+                if (_State == Virtual)
+                {
+                    bool ended = false;
+                    u32 framePosition = GetVirtualFramePosition(_LoopsPlayed, ended);
+                    SetFramePosition(framePosition);
+                }
+                ContinueFade(1.0f, VirtualFadeDuration);
                 _State = Devirtualizing;
+            }
             return Result::Ok;
         case Devirtualizing:
             if (StopIsRequested())
             {
-                ConfigureFade(FadeOut, _FadeOutDuration);
+                ConsumeEvent();
+                ContinueFade(0.0f, _FadeOutDuration);
                 _State = Stopping;
             }
+            else if (IsVirtual())
+            {
+                ContinueFade(0.0f, VirtualFadeDuration);
+                _State = Virtualizing;
+            }
             return Result::Ok;
         case Unloading:
         case Unloaded:
@@ -122,6 +241,7 @@ namespace Loom
 
     Result AssetReaderNode::Execute(AudioBuffer& destinationBuffer)
     {
+        ApplyFadeRequest();
         switch(_State)
         {
         case Initializing:
@@ -140,7 +260,7 @@ namespace Loom
         case Virtualizing:
             if (_FadeGain == 0.0f)
             {
-                _State = Virtual;
+                EnterVirtual();
                 return Result::NodeIsVirtual;
             }
             break;
@@ -154,54 +274,437 @@ namespace Loom
         default:
             LOOM_RETURN_RESULT(Result::InvalidState);
         }
-        AudioBuffer assetBuffer = _Asset->GetBuffer();
+        const AudioBuffer& assetBuffer = _Asset->GetBuffer();
         if (!assetBuffer.FormatMatches(destinationBuffer))
         {
             // TODO: poke system for resampling of the asset,
             //       return to the loading state
             LOOM_RETURN_RESULT(Result::BufferFormatMismatch);
         }
-        u32 offset = _FramePosition * assetBuffer.GetChannels() * assetBuffer.GetSampleSize();
-        u32 sizeBeforeWrapAround = destinationBuffer.GetSize();
-        u32 sizeAfterWrapAround = 0;
-        u32 sizeLeftToRead = assetBuffer.GetSize() - offset;
-        if (sizeBeforeWrapAround > sizeLeftToRead)
+        const AudioClock& clock = GetSystem().GetClock();
+        u64 frameTime = clock.GetFrameTime();
+        u32 bufferFrames = destinationBuffer.GetFrameCount();
+        u64 bufferEndFrame = frameTime + bufferFrames;
+
+        // Scheduled start and stop fall at a frame offset inside the buffer
+        u32 firstFrame = 0;
+        u32 endFrame = bufferFrames;
+        u64 startFrame = _ScheduledStartFrame.load(std::memory_order_relaxed);
+        if (startFrame != NotScheduled)
+        {
+            if (startFrame >= bufferEndFrame)
+                return Result::NodeIsVirtual;
+            if (startFrame > frameTime)
+                firstFrame = static_cast<u32>(startFrame - frameTime);
+            _ScheduledStartFrame = NotScheduled;
+        }
+        bool stopReached = false;
+        u64 stopFrame = _ScheduledStopFrame.load(std::memory_order_relaxed);
+        if (stopFrame != NotScheduled)
+        {
+            u64 fadeFrames = clock.SecondsToFrames(_FadeOutDuration);
+            u64 fadeStartFrame = stopFrame > fadeFrames ? stopFrame - fadeFrames : 0;
+            if (fadeFrames > 0 && fadeStartFrame < bufferEndFrame && _State != Stopping)
+            {
+                _Fade.Start(_FadeGain, 0.0f, fadeStartFrame, stopFrame, _FadeCurve);
+                _State = Stopping;
+            }
+            if (stopFrame < bufferEndFrame)
+            {
+                endFrame = stopFrame > frameTime ? static_cast<u32>(stopFrame - frameTime) : 0;
+                endFrame = std::max(endFrame, firstFrame);
+                stopReached = true;
+            }
+        }
+
+        u32 frameSize = destinationBuffer.GetChannels() * destinationBuffer.GetSampleSize();
+        u8* destinationData = destinationBuffer.GetData();
+        if (firstFrame > 0)
+            memset(destinationData, 0, firstFrame * frameSize);
+        if (endFrame < bufferFrames)
+            memset(destinationData + endFrame * frameSize, 0, (bufferFrames - endFrame) * frameSize);
+        bool ended = false;
+        if (endFrame > firstFrame)
+        {
+            Result result = Result::Ok;
+            _RenderFrameTime = frameTime + firstFrame;
+            if (_PendingSeekFrame.load(std::memory_order_relaxed) != NoSeek)
+                ApplySeek(_PendingSeekFrame.exchange(NoSeek), destinationBuffer.GetFormat());
+            if (firstFrame == 0 && endFrame == bufferFrames)
+            {
+                result = Read(destinationBuffer, ended);
+                if (Ok(result))
+                    result = CrossfadeSeek(destinationBuffer);
+            }
+            else
+            {
+                AudioBuffer renderedBuffer(nullptr, destinationBuffer.GetFormat(), destinationData + firstFrame * frameSize, (endFrame - firstFrame) * frameSize);
+                renderedBuffer.SetSize((endFrame - firstFrame) * frameSize);
+                result = Read(renderedBuffer, ended);
+                if (Ok(result))
+                    result = CrossfadeSeek(renderedBuffer);
+            }
+            LOOM_CHECK_RESULT(result);
+        }
+        UpdateFadeGain(bufferEndFrame);
+        if (_State == Devirtualizing && !_Fade.IsActive())
+            _State = Playing;
+        if (stopReached || ended)
         {
-            sizeAfterWrapAround = sizeBeforeWrapAround - sizeLeftToRead;
-            sizeBeforeWrapAround = sizeLeftToRead;
+            // Playing again after the end of the asset starts over
+            if (ended)
+                ResetPosition();
+            _ScheduledStopFrame = NotScheduled;
+            _Fade.Stop();
+            _FadeGain = 0.0f;
+            _State = Stopped;
         }
+        return Result::Ok;
+    }
+
+    Result AssetReaderNode::Read(AudioBuffer& destinationBuffer, bool& ended)
+    {
+        if (_Asset->IsStreamed())
+            return ReadStream(destinationBuffer, ended);
+        return ReadAsset(destinationBuffer, ended);
+    }
+
+    Result AssetReaderNode::ReadAsset(AudioBuffer& destinationBuffer, bool& ended)
+    {
+        u32 writtenFrames = 0;
+        Result result = ReadResidentFrames(destinationBuffer, _Asset->GetData().frameCount, writtenFrames, ended);
+        u32 frameSize = destinationBuffer.GetChannels() * destinationBuffer.GetSampleSize();
+        u32 writtenSize = writtenFrames * frameSize;
+        if (writtenSize < destinationBuffer.GetSize())
+            memset(destinationBuffer.GetData() + writtenSize, 0, destinationBuffer.GetSize() - writtenSize);
+        return result;
+    }
+
+    // Renders from the position until the buffer is full or the position reaches the resident frames,
+    // looping in place. Frames before the loop end are crossfaded with the frames before the loop start,
+    // so the seam continues the material leading to it, or with the loop head when there are too few.
+    Result AssetReaderNode::ReadResidentFrames(AudioBuffer& destinationBuffer, u32 residentFrames, u32& writtenFrames, bool& ended)
+    {
+        u32 assetFrames = _Asset->GetData().frameCount;
+        u32 frameSize = destinationBuffer.GetChannels() * destinationBuffer.GetSampleSize();
+        u32 loopStartFrame = 0;
+        u32 loopEndFrame = 0;
+        GetLoopRegion(loopStartFrame, loopEndFrame);
+        u32 loopFadeInFrame = 0;
+        u32 loopFadeFrames = GetLoopCrossfadeFrames(loopStartFrame, loopEndFrame, loopFadeInFrame);
+        u32 loopCount = _LoopCount.load(std::memory_order_relaxed);
+        u32 destinationFrames = destinationBuffer.GetFrameCount();
+        while (writtenFrames < destinationFrames)
+        {
+            bool looping = _LoopsPlayed < loopCount && loopStartFrame < loopEndFrame && _FramePosition <= loopEndFrame;
+            if (looping && _FramePosition == loopEndFrame)
+            {
+                // Past the frames already faded in
+                _FramePosition = loopFadeInFrame + loopFadeFrames;
+                ++_LoopsPlayed;
+                continue;
+            }
+            // Nothing is read past the end of the asset
+            if (_FramePosition >= assetFrames)
+            {
+                ended = true;
+                return Result::Ok;
+            }
+            if (_FramePosition >= residentFrames)
+                return Result::Ok;
+            u32 endFrame = std::min(looping ? loopEndFrame : assetFrames, residentFrames);
+            u32 frames = std::min(destinationFrames - writtenFrames, endFrame - _FramePosition);
+            const u8* loopData = nullptr;
+            u32 loopFadeFrame = 0;
+            if (looping && loopFadeFrames > 0)
+            {
+                u32 loopFadeStartFrame = loopEndFrame - loopFadeFrames;
+                if (_FramePosition < loopFadeStartFrame)
+                {
+                    frames = std::min(frames, loopFadeStartFrame - _FramePosition);
+                }
+                else
+                {
+                    loopFadeFrame = _FramePosition - loopFadeStartFrame;
+                    Result result = GetAssetFrames(loopFadeInFrame + loopFadeFrame, frames, _LoopBlock, loopData);
+                    LOOM_CHECK_RESULT(result);
+                }
+            }
+            const u8* sourceData = nullptr;
+            Result result = GetAssetFrames(_FramePosition, frames, _Block, sourceData);
+            LOOM_CHECK_RESULT(result);
+            result = TransferRegion(destinationBuffer, writtenFrames * frameSize, sourceData, frames * frameSize, loopData, loopFadeFrame, loopFadeFrames);
+            LOOM_CHECK_RESULT(result);
+            writtenFrames += frames;
+            _FramePosition += frames;
+        }
+        return Result::Ok;
+    }
+
+    // The streamer loops regions ending past the resident head, the ones within it are looped here
+    Result AssetReaderNode::ReadStream(AudioBuffer& destinationBuffer, bool& ended)
+    {
+        if (_Stream == nullptr)
+            LOOM_RETURN_RESULT(Result::NotReady);
+        u32 frameSize = destinationBuffer.GetChannels() * destinationBuffer.GetSampleSize();
+        u32 destinationSize = destinationBuffer.GetSize();
+        u32 writtenFrames = 0;
+
+        // Resident first frames cover the time the streamer needs to fill the ring buffer
+        if (_StreamHead)
+        {
+            u32 headFrames = _Asset->GetBuffer().GetFrameCount();
+            Result result = ReadResidentFrames(destinationBuffer, headFrames, writtenFrames, ended);
+            if (!Ok(result) || ended)
+            {
+                memset(destinationBuffer.GetData() + writtenFrames * frameSize, 0, destinationSize - writtenFrames * frameSize);
+                return result;
+            }
+            _StreamHead = _FramePosition < headFrames;
+        }
+        u32 writtenSize = writtenFrames * frameSize;
+
+        // Must be checked before reading, the streamer might complete the stream in between
+        bool seeking = _Stream->IsSeeking();
+        bool endOfStream = !seeking && _Stream->IsEndOfStream();
+        if (writtenSize < destinationSize && !_StreamHead && _Stream->IsReady() && !seeking)
+        {
+            if (_StreamSeekGap)
+            {
+                // Fades in from the silence rendered while the stream was refilled
+                _StreamSeekGap = false;
+                memset(_SeekBuffer.data(), 0, _SeekBuffer.size());
+                _SeekFadeFrame = 0;
+            }
+            AudioRingBuffer& ringBuffer = _Stream->GetRingBuffer();
+            const u8* first = nullptr;
+            const u8* second = nullptr;
+            u32 firstSize = 0;
+            u32 secondSize = 0;
+            ringBuffer.GetReadRegions(destinationSize - writtenSize, first, firstSize, second, secondSize);
+            Result result = TransferRegion(destinationBuffer, writtenSize, first, firstSize);
+            LOOM_CHECK_RESULT(result);
+            result = TransferRegion(destinationBuffer, writtenSize + firstSize, second, secondSize);
+            LOOM_CHECK_RESULT(result);
+            ringBuffer.CommitRead(firstSize + secondSize);
+            writtenSize += firstSize + secondSize;
+            // Streams do not move while waiting for data
+            AdvancePosition(_FramePosition, _LoopsPlayed, (firstSize + secondSize) / frameSize);
+        }
+
+        if (writtenSize < destinationSize)
+        {
+            memset(destinationBuffer.GetData() + writtenSize, 0, destinationSize - writtenSize);
+            if (seeking)
+                _StreamSeekGap = true;
+            else if (endOfStream)
+                ended = true;
+            else
+                _Stream->CountUnderrun();
+        }
+        return Result::Ok;
+    }
+
+    // Points to frames of the asset, frames being reduced to the ones contiguous in memory.
+    // Encoded assets decode the block holding the position, found through their block table.
+    Result AssetReaderNode::GetAssetFrames(u32 framePosition, u32& frames, DecodedBlock& block, const u8*& data)
+    {
+        const AudioAssetData& assetData = _Asset->GetData();
+        u32 frameSize = assetData.format.GetFrameSize();
+        if (!_Asset->IsEncoded())
+        {
+            data = assetData.GetSamples() + static_cast<size_t>(framePosition) * frameSize;
+            return Result::Ok;
+        }
+        if (block.samples.size() < static_cast<size_t>(assetData.blockFrames) * frameSize)
+            LOOM_RETURN_RESULT(Result::NotReady);
+        u32 blockIndex = framePosition / assetData.blockFrames;
+        u32 blockFirstFrame = blockIndex * assetData.blockFrames;
+        u32 blockFrames = std::min(assetData.blockFrames, assetData.frameCount - blockFirstFrame);
+        if (blockIndex != block.index)
+        {
+            const u32* blockOffsets = assetData.GetBlockOffsets();
+            u32 blockOffset = blockOffsets[blockIndex];
+            u32 blockSize = blockOffsets[blockIndex + 1] - blockOffset;
+            s16* blockSamples = reinterpret_cast<s16*>(block.samples.data());
+            Result result = DecodeBlock(assetData.encoding, assetData.GetSamples() + blockOffset, blockSize, assetData.format.channels, blockSamples, blockFrames);
+            if (!Ok(result))
+            {
+                block.index = InvalidBlock;
+                LOOM_RETURN_RESULT(result);
+            }
+            block.index = blockIndex;
+        }
+        u32 frameOffset = framePosition - blockFirstFrame;
+        frames = std::min(frames, blockFrames - frameOffset);
+        data = block.samples.data() + frameOffset * frameSize;
+        return Result::Ok;
+    }
+
+    void AssetReaderNode::PrepareBuffers()
+    {
+        // Sized outside of the audio thread, once the format and block layout of the asset are known
+        if (_Asset == nullptr)
+            return;
+        const AudioAssetData& data = _Asset->GetData();
+        _SeekBuffer.resize(static_cast<size_t>(SeekFadeFrames) * data.format.GetFrameSize());
+        if (!_Asset->IsEncoded())
+            return;
+        for (DecodedBlock* block : {&_Block, &_LoopBlock})
+        {
+            block->samples.resize(static_cast<size_t>(data.blockFrames) * data.format.GetFrameSize());
+            block->index = InvalidBlock;
+        }
+    }
+
+    // Only for sources the audio thread does not render
+    void AssetReaderNode::SetFramePosition(u32 frame)
+    {
+        _FramePosition = frame;
+        if (_Stream != nullptr)
+        {
+            _StreamHead = frame < _Asset->GetBuffer().GetFrameCount();
+            _Stream->Seek(frame, _LoopsPlayed);
+        }
+    }
+
+    void AssetReaderNode::ResetPosition()
+    {
+        _LoopsPlayed = 0;
+        SetFramePosition(0);
+    }
+
+    // Positions are O(1) to reach: resident data is indexed directly, encoded assets
+    // go through their block table and streams through the frame offset in their file.
+    // What would have played without the seek is rendered first, to fade out over the new position.
+    void AssetReaderNode::ApplySeek(u32 frame, const AudioFormat& format)
+    {
+        u32 seekSize = static_cast<u32>(_SeekBuffer.size());
+        if (seekSize > 0)
+        {
+            AudioBuffer seekBuffer(nullptr, format, _SeekBuffer.data(), seekSize);
+            seekBuffer.SetSize(seekSize);
+            // Reaching the end of the asset here does not end playback, the seek moves away from it
+            u32 loopsPlayed = _LoopsPlayed;
+            bool ended = false;
+            if (!Ok(Read(seekBuffer, ended)))
+                memset(_SeekBuffer.data(), 0, seekSize);
+            _LoopsPlayed = loopsPlayed;
+            _SeekFadeFrame = 0;
+        }
+        _StreamSeekGap = false;
+        SetFramePosition(frame);
+    }
+
+    Result AssetReaderNode::CrossfadeSeek(AudioBuffer& destinationBuffer)
+    {
+        if (_SeekFadeFrame >= SeekFadeFrames)
+            return Result::Ok;
+        u32 channels = destinationBuffer.GetChannels();
+        u32 frameSize = channels * destinationBuffer.GetSampleSize();
+        u32 frames = std::min(destinationBuffer.GetFrameCount(), SeekFadeFrames - _SeekFadeFrame);
+        u8* destinationData = destinationBuffer.GetData();
+        const u8* seekData = _SeekBuffer.data() + _SeekFadeFrame * frameSize;
+        u32 fadeFrame = _SeekFadeFrame;
+        _SeekFadeFrame += frames;
         switch (destinationBuffer.GetSampleFormat())
         {
             case SampleFormat::Int16:
-                TransferBuffer<s16>(destinationBuffer, offset, sizeBeforeWrapAround, sizeAfterWrapAround);
-                break;
+                CrossfadeBuffer<s16>(destinationData, seekData, frames, channels, fadeFrame);
+                return Result::Ok;
             case SampleFormat::Int32:
-                TransferBuffer<s32>(destinationBuffer, offset, sizeBeforeWrapAround, sizeAfterWrapAround);
-                break;
+                CrossfadeBuffer<s32>(destinationData, seekData, frames, channels, fadeFrame);
+                return Result::Ok;
             case SampleFormat::Float32:
-                TransferBuffer<float>(destinationBuffer, offset, sizeBeforeWrapAround, sizeAfterWrapAround);
-                break;
+                CrossfadeBuffer<float>(destinationData, seekData, frames, channels, fadeFrame);
+                return Result::Ok;
             default:
                 LOOM_RETURN_RESULT(Result::InvalidBufferSampleFormat);
         }
-        _FramePosition += destinationBuffer.GetFrameCount();
-        return Result::Ok;
     }
 
-    void AssetReaderNode::ConfigureFade(FadeFunction function, float duration)
+    Result AssetReaderNode::TransferRegion(AudioBuffer& destinationBuffer, u32 destinationOffset, const u8* sourceData, u32 size, const u8* loopData, u32 loopFadeFrame, u32 loopFadeFrames)
     {
-        _FadeFunction = function;
-        if (function != nullptr)
+        if (size == 0)
+            return Result::Ok;
+        u8* destinationData = destinationBuffer.GetData() + destinationOffset;
+        u32 channels = destinationBuffer.GetChannels();
+        u64 frame = _RenderFrameTime + destinationOffset / (channels * destinationBuffer.GetSampleSize());
+        switch (destinationBuffer.GetSampleFormat())
         {
-            _FadeStartTime = Now();
-            _FadeEndTime = _FadeStartTime + static_cast<u64>(duration * NanosecondsPerSecond);
-            if (function == FadeIn)
-                _FadeGain = 0.0f;
-            else if (function == FadeOut)
-                _FadeGain = 1.0f;
+            case SampleFormat::Int16:
+                TransferBuffer<s16>(destinationData, sourceData, size, channels, frame, loopData, loopFadeFrame, loopFadeFrames);
+                return Result::Ok;
+            case SampleFormat::Int32:
+                TransferBuffer<s32>(destinationData, sourceData, size, channels, frame, loopData, loopFadeFrame, loopFadeFrames);
+                return Result::Ok;
+            case SampleFormat::Float32:
+                TransferBuffer<float>(destinationData, sourceData, size, channels, frame, loopData, loopFadeFrame, loopFadeFrames);
+                return Result::Ok;
+            default:
+                LOOM_RETURN_RESULT(Result::InvalidBufferSampleFormat);
         }
     }
 
+    void AssetReaderNode::UpdateFadeGain(u64 frameTime)
+    {
+        if (!_Fade.IsActive())
+            return;
+        _FadeGain = _Fade.GetGain(frameTime);
+        if (_Fade.IsComplete(frameTime))
+            _Fade.Stop();
+    }
+
+    void AssetReaderNode::StartFade(float startGain, float targetGain, float duration)
+    {
+        PostFade(false, startGain, targetGain, duration);
+    }
+
+    // Fades from the current gain, avoiding a jump when a fade is interrupted
+    void AssetReaderNode::ContinueFade(float targetGain, float duration)
+    {
+        PostFade(true, 0.0f, targetGain, duration);
+    }
+
+    // A source scheduled to start later fades in from its start frame
+    void AssetReaderNode::PostFade(bool continues, float startGain, float targetGain, float duration)
+    {
+        const AudioClock& clock = GetSystem().GetClock();
+        u64 startFrame = clock.GetFrameTime();
+        u64 scheduledStartFrame = _ScheduledStartFrame.load();
+        if (scheduledStartFrame != NotScheduled)
+            startFrame = std::max(startFrame, scheduledStartFrame);
+        FadeRequest& request = _FadeRequests.GetWriteBuffer();
+        request.continues = continues;
+        request.startGain = startGain;
+        request.targetGain = targetGain;
+        request.startFrame = startFrame;
+        request.frames = clock.SecondsToFrames(duration);
+        _FadeRequests.Publish();
+    }
+
+    // The fade starts from the first frame the audio thread has yet to render
+    void AssetReaderNode::ApplyFadeRequest()
+    {
+        if (!_FadeRequests.Update())
+            return;
+        const FadeRequest& request = _FadeRequests.GetReadBuffer();
+        if (!request.continues)
+            _FadeGain = request.startGain;
+        u64 startFrame = std::max(request.startFrame, GetSystem().GetClock().GetFrameTime());
+        _Fade.Start(_FadeGain, request.targetGain, startFrame, startFrame + request.frames, _FadeCurve);
+    }
+
+    void AssetReaderNode::SetFadeCurve(FadeCurve curve)
+    {
+        _FadeCurve = curve;
+    }
+
+    FadeCurve AssetReaderNode::GetFadeCurve() const
+    {
+        return _FadeCurve;
+    }
+
     const char* AssetReaderNode::GetName() const
     {
         return "AudioSource";
@@ -214,39 +717,263 @@ namespace Loom
 
     Result AssetReaderNode::SeekFrame(u32 frame)
     {
-        LOOM_UNUSED(frame);
-        LOOM_RETURN_RESULT(Result::NotYetImplemented);
+        if (!AssetIsLoaded())
+            LOOM_RETURN_RESULT(Result::NotReady);
+        if (frame >= _Asset->GetData().frameCount)
+            LOOM_RETURN_RESULT(Result::InvalidPosition);
+        switch (_State)
+        {
+        case Playing:
+        case Stopping:
+        case Virtualizing:
+        case Devirtualizing:
+            // Rendering sources crossfade to the new position on the audio thread
+            _PendingSeekFrame = frame;
+            return Result::Ok;
+        case Virtual:
+            _FramePosition = frame;
+            EnterVirtual();
+            return Result::Ok;
+        default:
+            SetFramePosition(frame);
+            return Result::Ok;
+        }
     }
 
     Result AssetReaderNode::SeekTime(float seconds)
     {
-        LOOM_UNUSED(seconds);
-        LOOM_RETURN_RESULT(Result::NotYetImplemented);
+        if (!AssetIsLoaded())
+            LOOM_RETURN_RESULT(Result::NotReady);
+        if (seconds < 0.0f)
+            LOOM_RETURN_RESULT(Result::InvalidPosition);
+        return SeekFrame(static_cast<u32>(seconds * _Asset->GetData().format.frameRate));
     }
 
     u32 AssetReaderNode::GetFramePosition() const
     {
+        if (_State == Virtual)
+        {
+            u32 loopsPlayed = 0;
+            bool ended = false;
+            return GetVirtualFramePosition(loopsPlayed, ended);
+        }
         return _FramePosition;
     }
 
     float AssetReaderNode::GetTimePosition() const
     {
-        return GetFramePosition() / _Asset->GetFrames() * _Asset->GetDuration();
+        u32 frameRate = _Asset != nullptr ? _Asset->GetData().format.frameRate : 0;
+        if (frameRate == 0)
+            return 0.0f;
+        return static_cast<float>(GetFramePosition()) / frameRate;
     }
 
     void AssetReaderNode::SetLoop(bool loop)
     {
-        _Loop = loop;
+        SetLoopCount(loop ? LoopForever : 0);
     }
 
     bool AssetReaderNode::IsLooping() const
     {
-        return _Loop;
+        return _LoopCount > 0;
+    }
+
+    void AssetReaderNode::SetLoopCount(u32 count)
+    {
+        _LoopCount = count;
+        UpdateStreamLoop();
+    }
+
+    u32 AssetReaderNode::GetLoopCount() const
+    {
+        return _LoopCount;
+    }
+
+    void AssetReaderNode::SetLoopRegion(u32 startFrame, u32 endFrame)
+    {
+        _LoopStartFrame = startFrame;
+        _LoopEndFrame = endFrame;
+        _HasLoopRegion = true;
+        UpdateStreamLoop();
+    }
+
+    void AssetReaderNode::SetLoopCrossfade(u32 frames)
+    {
+        _LoopCrossfadeFrames = frames;
+    }
+
+    u32 AssetReaderNode::GetLoopCrossfade() const
+    {
+        return _LoopCrossfadeFrames;
+    }
+
+    // Region of the asset, unless the source set its own, within the frames of the asset
+    void AssetReaderNode::GetLoopRegion(u32& startFrame, u32& endFrame) const
+    {
+        u32 assetFrames = _Asset != nullptr ? _Asset->GetData().frameCount : 0;
+        startFrame = 0;
+        endFrame = 0;
+        if (_HasLoopRegion)
+        {
+            startFrame = _LoopStartFrame;
+            endFrame = _LoopEndFrame;
+        }
+        else if (_Asset != nullptr)
+        {
+            startFrame = _Asset->GetLoopStartFrame();
+            endFrame = _Asset->GetLoopEndFrame();
+        }
+        if (endFrame == 0 || endFrame > assetFrames)
+            endFrame = assetFrames;
+        startFrame = std::min(startFrame, endFrame);
+    }
+
+    // The crossfade fades in the frames before the loop start and stays within the loop. Loops with
+    // fewer frames before them, like whole asset loops, fade in their head and resume after it instead.
+    u32 AssetReaderNode::GetLoopCrossfadeFrames(u32 startFrame, u32 endFrame, u32& fadeInFrame) const
+    {
+        fadeInFrame = startFrame;
+        if (_Stream != nullptr)
+            return 0;
+        u32 frames = _LoopCrossfadeFrames.load();
+        if (frames <= startFrame)
+        {
+            frames = std::min(frames, endFrame - startFrame);
+            fadeInFrame = startFrame - frames;
+            return frames;
+        }
+        // The head and the tail do not overlap
+        return std::min(frames, (endFrame - startFrame) / 2);
+    }
+
+    // Moves a position by a number of frames through the loop region, as rendering would.
+    // Returns false when this reaches the end of the asset.
+    bool AssetReaderNode::AdvancePosition(u32& framePosition, u32& loopsPlayed, u64 frames) const
+    {
+        u32 assetFrames = _Asset != nullptr ? _Asset->GetData().frameCount : 0;
+        u32 loopStartFrame = 0;
+        u32 loopEndFrame = 0;
+        GetLoopRegion(loopStartFrame, loopEndFrame);
+        u32 loopFadeInFrame = 0;
+        u32 loopFadeFrames = GetLoopCrossfadeFrames(loopStartFrame, loopEndFrame, loopFadeInFrame);
+        u32 loopResumeFrame = loopFadeInFrame + loopFadeFrames;
+        u32 loopCount = _LoopCount;
+        u64 position = framePosition + frames;
+        if (loopsPlayed < loopCount && loopStartFrame < loopEndFrame && framePosition <= loopEndFrame && position >= loopEndFrame)
+        {
+            // Whole loops are skipped at once, a virtual source can be far behind
+            u64 loopFrames = loopEndFrame - loopResumeFrame;
+            u64 loops = std::min<u64>((position - loopResumeFrame) / loopFrames, loopCount - loopsPlayed);
+            position -= loops * loopFrames;
+            loopsPlayed += static_cast<u32>(loops);
+        }
+        if (position >= assetFrames)
+        {
+            framePosition = assetFrames;
+            return false;
+        }
+        framePosition = static_cast<u32>(position);
+        return true;
+    }
+
+    void AssetReaderNode::UpdateStreamLoop()
+    {
+        if (_Stream == nullptr)
+            return;
+        if (_HasLoopRegion)
+            _Stream->SetLoop(_LoopStartFrame, _LoopEndFrame, _LoopCount);
+        else if (_Asset != nullptr)
+            _Stream->SetLoop(_Asset->GetLoopStartFrame(), _Asset->GetLoopEndFrame(), _LoopCount);
     }
 
     bool AssetReaderNode::IsVirtual() const
     {
-        return BypassNode();
+        return _Virtual.load() || BypassNode();
+    }
+
+    const shared_ptr<AudioAsset>& AssetReaderNode::GetAsset() const
+    {
+        return _Asset;
+    }
+
+    void AssetReaderNode::SetPriority(u32 priority)
+    {
+        _Priority = priority;
+    }
+
+    u32 AssetReaderNode::GetPriority() const
+    {
+        return _Priority;
+    }
+
+    void AssetReaderNode::SetVolume(float volume)
+    {
+        _Volume = std::max(volume, 0.0f);
+    }
+
+    float AssetReaderNode::GetVolume() const
+    {
+        return _Volume;
+    }
+
+    // Estimate of how loud the source is, used to pick the sources worth rendering
+    float AssetReaderNode::GetAudibility() const
+    {
+        return _Volume;
+    }
+
+    // Virtual sources keep their state without rendering, transitions are applied on the next update
+    void AssetReaderNode::SetVirtual(bool isVirtual)
+    {
+        _Virtual = isVirtual;
+    }
+
+    Result AssetReaderNode::SetPosition(const Vector3& position, const Vector3& velocity)
+    {
+        Result result = _Position.SetValue<Vector3>(position);
+        LOOM_CHECK_RESULT(result);
+        return _Velocity.SetValue<Vector3>(velocity);
+    }
+
+    Result AssetReaderNode::GetPosition(Vector3& position, Vector3& velocity) const
+    {
+        Result result = _Position.GetValue<Vector3>(position);
+        LOOM_CHECK_RESULT(result);
+        return _Velocity.GetValue<Vector3>(velocity);
+    }
+
+    bool AssetReaderNode::WantsToPlay() const
+    {
+        switch (_State)
+        {
+        case Playing:
+        case Virtualizing:
+        case Virtual:
+        case Devirtualizing:
+            return true;
+        case Initializing:
+        case Loading:
+        case Stopping:
+        case Stopped:
+            return PlayIsRequested();
+        default:
+            return false;
+        }
+    }
+
+    // Whether the source currently renders, including fades
+    bool AssetReaderNode::IsAudible() const
+    {
+        switch (_State)
+        {
+        case Playing:
+        case Stopping:
+        case Virtualizing:
+        case Devirtualizing:
+            return true;
+        default:
+            return false;
+        }
     }
 
     bool AssetReaderNode::PlayIsRequested() const
@@ -259,6 +986,52 @@ namespace Loom
         return _PendingEvent.load() == StopRequest;
     }
 
+    void AssetReaderNode::ConsumeEvent()
+    {
+        _PendingEvent = NoEvent;
+    }
+
+    void AssetReaderNode::EnterVirtual()
+    {
+        // A source scheduled to start later only starts moving from its start frame
+        u64 startFrame = _ScheduledStartFrame.load();
+        u64 frameTime = GetSystem().GetClock().GetFrameTime();
+        u32 seekFrame = _PendingSeekFrame.exchange(NoSeek);
+        if (seekFrame != NoSeek)
+            _FramePosition = seekFrame;
+        _VirtualFrameTime = startFrame != NotScheduled ? std::max(frameTime, startFrame) : frameTime;
+        _VirtualFramePosition = _FramePosition;
+        _VirtualLoopsPlayed = _LoopsPlayed;
+        _State = Virtual;
+    }
+
+    bool AssetReaderNode::ScheduledStopReached() const
+    {
+        u64 stopFrame = _ScheduledStopFrame.load();
+        return stopFrame != NotScheduled && GetSystem().GetClock().GetFrameTime() >= stopFrame;
+    }
+
+    bool AssetReaderNode::VirtualPlaybackEnded() const
+    {
+        u32 loopsPlayed = 0;
+        bool ended = false;
+        GetVirtualFramePosition(loopsPlayed, ended);
+        return ended;
+    }
+
+    // Position the source would have reached if it kept rendering since it became virtual
+    u32 AssetReaderNode::GetVirtualFramePosition(u32& loopsPlayed, bool& ended) const
+    {
+        ended = false;
+        loopsPlayed = _VirtualLoopsPlayed;
+        u32 framePosition = _VirtualFramePosition;
+        u64 frameTime = GetSystem().GetClock().GetFrameTime();
+        if (frameTime <= _VirtualFrameTime)
+            return framePosition;
+        ended = !AdvancePosition(framePosition, loopsPlayed, frameTime - _VirtualFrameTime);
+        return framePosition;
+    }
+
     bool AssetReaderNode::AssetIsLoaded() const
     {
         return _Asset != nullptr && _Asset->GetState() == AudioAssetState::Loaded;
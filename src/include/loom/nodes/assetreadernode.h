@@ -1,9 +1,11 @@
 #pragma once
 
 #include "loom/nodes/audionode.h"
+#include "loom/nodes/audionodeparameter.h"
 #include "loom/audioasset.h"
-#include "loom/time.h"
+#include "loom/audiostream.h"
 #include "loom/fade.h"
+#include "loom/triplebuffer.h"
 
 namespace Loom
 {
@@ -12,6 +14,12 @@ class AssetReaderNode : public AudioNode
 {
 public:
     static constexpr float VirtualFadeDuration = 0.05f;
+    static constexpr u32 InvalidBlock = UINT32_MAX;
+    static constexpr u64 NotScheduled = UINT64_MAX;
+    static constexpr u32 NoSeek = UINT32_MAX;
+    static constexpr u32 LoopForever = UINT32_MAX;
+    // Length of the crossfade between the previous and the new position of a seek
+    static constexpr u32 SeekFadeFrames = 256;
 
     enum State
     {
@@ -36,78 +44,269 @@ public:
     };
 
     AssetReaderNode(IAudioSystem& system, shared_ptr<AudioAsset> asset);
+    ~AssetReaderNode();
     u64 GetTypeId() const override;
     const char* GetName() const override;
+    Result Initialize() override;
+    Result Shutdown() override;
     Result Execute(AudioBuffer& destinationBuffer) override;
 
     Result Play(float fade = 0.0f);
     Result Stop(float fade = 0.05f);
+    // Frame times are on the system clock, rendering starts or ends at that exact frame
+    Result PlayAt(u64 frameTime, float fade = 0.0f);
+    Result StopAt(u64 frameTime, float fade = 0.0f);
     Result Update();
     Result LoadAsset(bool& loaded);
-    void ConfigureFade(FadeFunction function, float duration);
+    void SetFadeCurve(FadeCurve curve);
+    FadeCurve GetFadeCurve() const;
     Result SeekFrame(u32 frame);
     Result SeekTime(float seconds);
     u32 GetFramePosition() const;
     float GetTimePosition() const;
     void SetLoop(bool loop);
     bool IsLooping() const;
+    // Times playback jumps back to the loop start, before playing through to the end of the asset
+    void SetLoopCount(u32 count);
+    u32 GetLoopCount() const;
+    // Overrides the loop region of the asset, an end frame of 0 is the end of the asset
+    void SetLoopRegion(u32 startFrame, u32 endFrame);
+    // Frames before the loop end crossfaded with the frames before the loop start. Loops with fewer
+    // frames before them crossfade with their first frames instead, at most half the loop, and jump
+    // past those, each loop after the first being shorter by the crossfade. Not applied to streams.
+    void SetLoopCrossfade(u32 frames);
+    u32 GetLoopCrossfade() const;
     bool IsVirtual() const;
+    const shared_ptr<AudioAsset>& GetAsset() const;
 
+    // Voice management
+    void SetPriority(u32 priority);
+    u32 GetPriority() const;
+    void SetVolume(float volume);
+    float GetVolume() const;
+    float GetAudibility() const;
+    void SetVirtual(bool isVirtual);
+    // World position and velocity, read by the SpatializerNode the source is connected to
+    Result SetPosition(const Vector3& position, const Vector3& velocity = Vector3{0.0f, 0.0f, 0.0f});
+    Result GetPosition(Vector3& position, Vector3& velocity) const;
+    bool WantsToPlay() const;
+    bool IsAudible() const;
+
+    // Applies the volume and the fade ramp, frame being the clock time of the first frame.
+    // Within a loop crossfade, loopData holds the frames leading to the loop start, or its
+    // first frames, fading in while the source frames fade out.
     template <class T>
-    void TransferBuffer(AudioBuffer& destinationBuffer, u32 offset, u32 sizeBeforeWrapAround, u32 sizeAfterWrapAround)
+    void TransferBuffer(u8* destinationData, const u8* sourceData, u32 size, u32 channels, u64 frame, const u8* loopData = nullptr, u32 loopFadeFrame = 0, u32 loopFadeFrames = 0)
     {
-        T* destinationData = destinationBuffer.GetData<T>();
-        T* assetData = _Asset->GetBuffer().GetData<T>();
-        sizeBeforeWrapAround /= sizeof(T);
-        sizeAfterWrapAround /= sizeof(T);
-        if (_FadeFunction != nullptr)
+        T* destination = reinterpret_cast<T*>(destinationData);
+        const T* source = reinterpret_cast<const T*>(sourceData);
+        const T* loopSource = reinterpret_cast<const T*>(loopData);
+        const float* loopFadeTable = GetFadeTable(FadeCurve::EqualPower);
+        u32 frameCount = size / (sizeof(T) * channels);
+        float volume = _Volume.load(std::memory_order_relaxed);
+        float gains[FadeChunkFrames];
+        u32 frameOffset = 0;
+        while (frameOffset < frameCount)
         {
-            _FadeFunction(_FadeGain, _FadeStartTime, _FadeEndTime);
-            if ((_FadeFunction == FadeIn && _FadeGain == 1.0f) || (_FadeFunction == FadeOut && _FadeGain == 0.0f))
-                _FadeFunction = nullptr;
-            if (_FadeGain == 0.0f)
+            u32 frames = frameCount - frameOffset;
+            float gain = _FadeGain;
+            bool ramp = false;
+            if (_Fade.IsActive())
+            {
+                if (frame >= _Fade.GetEndFrame())
+                {
+                    gain = _Fade.GetTargetGain();
+                }
+                else if (frame < _Fade.GetStartFrame())
+                {
+                    gain = _Fade.GetStartGain();
+                    frames = static_cast<u32>(std::min<u64>(frames, _Fade.GetStartFrame() - frame));
+                }
+                else
+                {
+                    frames = static_cast<u32>(std::min<u64>(std::min(frames, FadeChunkFrames), _Fade.GetEndFrame() - frame));
+                    _Fade.GetGains(frame, frames, gains, volume);
+                    ramp = true;
+                }
+            }
+            gain *= volume;
+
+            T* destinationFrames = destination + frameOffset * channels;
+            const T* sourceFrames = source + frameOffset * channels;
+            if (loopSource != nullptr)
             {
-                memset(destinationData, 0, destinationBuffer.GetSize());
+                const T* loopFrames = loopSource + frameOffset * channels;
+                for (u32 i = 0; i < frames; i++)
+                {
+                    float frameGain = ramp ? gains[i] : gain;
+                    u64 index = static_cast<u64>(loopFadeFrame + frameOffset + i) * FadeTableSize / loopFadeFrames;
+                    float gainIn = loopFadeTable[index] * frameGain;
+                    float gainOut = loopFadeTable[FadeTableSize - index] * frameGain;
+                    for (u32 channel = 0; channel < channels; channel++)
+                    {
+                        u32 sample = i * channels + channel;
+                        destinationFrames[sample] = static_cast<T>(static_cast<float>(sourceFrames[sample]) * gainOut + static_cast<float>(loopFrames[sample]) * gainIn);
+                    }
+                }
+            }
+            else if (ramp)
+            {
+                for (u32 i = 0; i < frames; i++)
+                {
+                    for (u32 channel = 0; channel < channels; channel++)
+                        destinationFrames[i * channels + channel] = static_cast<T>(static_cast<float>(sourceFrames[i * channels + channel]) * gains[i]);
+                }
             }
             else
             {
-                for (u32 i = 0; i < sizeBeforeWrapAround; i++)
-                    destinationData[i] = static_cast<T>(static_cast<float>(assetData[offset + i]) * _FadeGain);
-                for (u32 i = 0; i < sizeAfterWrapAround; i++)
-                    destinationData[sizeBeforeWrapAround + i] = static_cast<T>(static_cast<float>(assetData[i]) * _FadeGain);
+                u32 sampleCount = frames * channels;
+                if (gain == 1.0f)
+                {
+                    for (u32 i = 0; i < sampleCount; i++)
+                        destinationFrames[i] = sourceFrames[i];
+                }
+                else if (gain == 0.0f)
+                {
+                    memset(destinationFrames, 0, sampleCount * sizeof(T));
+                }
+                else
+                {
+                    for (u32 i = 0; i < sampleCount; i++)
+                        destinationFrames[i] = static_cast<T>(static_cast<float>(sourceFrames[i]) * gain);
+                }
             }
+            frameOffset += frames;
+            frame += frames;
         }
-        else
+    }
+
+    // Mixes the frames rendered from before a seek, fading out, into the ones rendered from after it
+    template <class T>
+    void CrossfadeBuffer(u8* destinationData, const u8* seekData, u32 frames, u32 channels, u32 fadeFrame)
+    {
+        T* destination = reinterpret_cast<T*>(destinationData);
+        const T* seekSamples = reinterpret_cast<const T*>(seekData);
+        const float* table = GetFadeTable(FadeCurve::EqualPower);
+        for (u32 i = 0; i < frames; i++)
         {
-            for (u32 i = 0; i < sizeBeforeWrapAround; i++)
-                destinationData[i] = assetData[offset + i];
-            for (u32 i = 0; i < sizeAfterWrapAround; i++)
-                destinationData[sizeBeforeWrapAround + i] = assetData[i];
+            u32 index = (fadeFrame + i) * FadeTableSize / SeekFadeFrames;
+            float gainIn = table[index];
+            float gainOut = table[FadeTableSize - index];
+            for (u32 channel = 0; channel < channels; channel++)
+            {
+                u32 sample = i * channels + channel;
+                destination[sample] = static_cast<T>(static_cast<float>(destination[sample]) * gainIn + static_cast<float>(seekSamples[sample]) * gainOut);
+            }
         }
     }
 
 private:
     bool PlayIsRequested() const;
     bool StopIsRequested() const;
+    struct DecodedBlock
+    {
+        vector<u8> samples;
+        u32 index;
+    };
+
+    struct FadeRequest
+    {
+        FadeRequest()
+            : continues(false)
+            , startGain(0.0f)
+            , targetGain(0.0f)
+            , startFrame(0)
+            , frames(0)
+        {
+        }
+
+        // Starts from the gain the audio thread reached instead of startGain
+        bool continues;
+        float startGain;
+        float targetGain;
+        u64 startFrame;
+        u64 frames;
+    };
+
+    void ConsumeEvent();
+    void EnterVirtual();
+    bool VirtualPlaybackEnded() const;
+    bool ScheduledStopReached() const;
+    u32 GetVirtualFramePosition(u32& loopsPlayed, bool& ended) const;
+    void GetLoopRegion(u32& startFrame, u32& endFrame) const;
+    u32 GetLoopCrossfadeFrames(u32 startFrame, u32 endFrame, u32& fadeInFrame) const;
+    bool AdvancePosition(u32& framePosition, u32& loopsPlayed, u64 frames) const;
+    void UpdateStreamLoop();
+    void ResetPosition();
     bool AssetIsLoaded() const;
+    void StartFade(float startGain, float targetGain, float duration);
+    void ContinueFade(float targetGain, float duration);
+    void PostFade(bool continues, float startGain, float targetGain, float duration);
+    void ApplyFadeRequest();
+    void UpdateFadeGain(u64 frameTime);
+    Result Read(AudioBuffer& destinationBuffer, bool& ended);
+    Result ReadAsset(AudioBuffer& destinationBuffer, bool& ended);
+    Result ReadResidentFrames(AudioBuffer& destinationBuffer, u32 residentFrames, u32& writtenFrames, bool& ended);
+    Result ReadStream(AudioBuffer& destinationBuffer, bool& ended);
+    Result GetAssetFrames(u32 framePosition, u32& frames, DecodedBlock& block, const u8*& data);
+    void PrepareBuffers();
+    void SetFramePosition(u32 frame);
+    void ApplySeek(u32 frame, const AudioFormat& format);
+    Result CrossfadeSeek(AudioBuffer& destinationBuffer);
+    Result TransferRegion(AudioBuffer& destinationBuffer, u32 destinationOffset, const u8* sourceData, u32 size, const u8* loopData = nullptr, u32 loopFadeFrame = 0, u32 loopFadeFrames = 0);
 
 private:
     u32 _Id;
     u32 _FramePosition;
-    u32 _Priority;
-    bool _Loop;
-    float _Volume;
+    atomic<u32> _Priority;
+    atomic<float> _Volume;
+    atomic<bool> _Virtual;
+    AudioNodeParameter _Position;
+    AudioNodeParameter _Velocity;
     shared_ptr<AudioAsset> _Asset;
+    shared_ptr<AudioStream> _Stream;
+    // Blocks of encoded assets being read, and of the frames crossfaded at the loop end
+    DecodedBlock _Block;
+    DecodedBlock _LoopBlock;
+
+    atomic<u32> _LoopCount;
+    atomic<bool> _HasLoopRegion;
+    atomic<u32> _LoopStartFrame;
+    atomic<u32> _LoopEndFrame;
+    atomic<u32> _LoopCrossfadeFrames;
+    u32 _LoopsPlayed;
+
+    // Seeks of a rendering source are applied by the audio thread
+    atomic<u32> _PendingSeekFrame;
+    // Frames that followed the position before the last seek, faded out over the first frames after it
+    vector<u8> _SeekBuffer;
+    u32 _SeekFadeFrame;
+    // A stream renders silence until the streamer refilled it from the new position
+    bool _StreamSeekGap;
+    // Whether the stream plays from the resident head, the ring buffer then holds the frames following it
+    bool _StreamHead;
+
+    atomic<u64> _ScheduledStartFrame;
+    atomic<u64> _ScheduledStopFrame;
+
+    // Virtual sources do not render, their position is derived from the frame time when needed
+    u64 _VirtualFrameTime;
+    u32 _VirtualFramePosition;
+    u32 _VirtualLoopsPlayed;
 
     atomic<AssetReaderNode::Event> _PendingEvent;
     atomic<AssetReaderNode::State> _State;
 
+    // Gain reached at the end of the last rendered buffer
     float _FadeGain;
     float _FadeInDuration;
     float _FadeOutDuration;
-    u64 _FadeStartTime;
-    u64 _FadeEndTime;
-    FadeFunction _FadeFunction;
+    FadeCurve _FadeCurve;
+    Fade _Fade;
+    // Fades are requested by the game thread and started by the audio thread before it renders, the latest request wins
+    TripleBuffer<FadeRequest> _FadeRequests;
+    // Clock time of the first frame of the buffer being rendered
+    u64 _RenderFrameTime;
 };
 
 } // namespace Loom
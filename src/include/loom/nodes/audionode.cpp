@@ -1,12 +1,18 @@
 #include "loom/nodes/audionode.h"
 #include "loom/interfaces/iaudiosystem.h"
+#include "loom/interfaces/iaudiobufferprovider.h"
+#include "loom/interfaces/iaudiograph.h"
 
 namespace Loom
 {
 
 AudioNode::AudioNode(IAudioSystem& system)
-    : _System(system)
-    , _State(AudioNodeState::Idle)
+    : _State(AudioNodeState::Idle)
+    , _System(system)
+    , _Visited(false)
+    , _Bypass(false)
+    , _ProfilerSlot(NoProfilerSlot)
+    , _ProfiledInputCycles(0)
 {
 }
 
@@ -73,6 +79,11 @@ IAudioSystem& AudioNode::GetSystem()
     return _System;
 }
 
+const IAudioSystem& AudioNode::GetSystem() const
+{
+    return _System;
+}
+
 void AudioNode::ReleaseBuffer()
 {
     _Buffer.Release();
@@ -87,46 +98,38 @@ Result AudioNode::ExecuteInputNodes(AudioBuffer& destinationBuffer)
 {
     if (_InputNodes.empty())
         LOOM_RETURN_RESULT(Result::NoData);
-    vector<AudioBuffer> buffersToMix;
-    buffersToMix.reserve(_InputNodes.size());
-    AudioBuffer tmpBuffer = destinationBuffer;
-    for (auto itr = _InputNodes.begin(); itr != _InputNodes.end(); itr++)
+    // Every input renders to a buffer of its own, summed into the destination
+    IAudioBufferProvider& bufferProvider = _System.GetBufferProvider();
+    bool mixed = false;
+    for (const AudioNodePtr& node : _InputNodes)
     {
-        AudioNodePtr node = *itr;
-        Result result = node->Execute(tmpBuffer);
+        AudioBuffer inputBuffer;
+        Result result = bufferProvider.AllocateBuffer(inputBuffer);
+        if (Ok(result))
+            result = inputBuffer.SetSize(destinationBuffer.GetSize());
+        if (Ok(result))
+            result = ExecuteInputNode(*node, inputBuffer);
         if (Ok(result))
         {
-            buffersToMix.emplace_back(tmpBuffer);
-            tmpBuffer.Release();
+            result = mixed ? destinationBuffer.AddSamplesFrom(inputBuffer) : destinationBuffer.CloneDataFrom(inputBuffer);
+            mixed = mixed || Ok(result);
         }
-        else if (result != Result::NodeIsVirtual)
-        {
+        if (!Ok(result) && result != Result::NodeIsVirtual)
             LOOM_LOG_RESULT(result);
-        }
     }
-    if (buffersToMix.empty())
-    {
+    if (!mixed)
         return Result::NoData;
-    }
-    else
-    {
-        for (auto itr = buffersToMix.begin(); itr != buffersToMix.end(); itr++)
-        {
-            AudioBuffer& buffer = *itr;
-            if (itr == buffersToMix.begin())
-            {
-                _Buffer = buffer;
-            }
-            else
-            {
-                Result result = _Buffer.AddSamplesFrom(buffer);
-                if (!Ok(result))
-                    LOOM_LOG_RESULT(result);
-            }
-        }
-    }
-    destinationBuffer = _Buffer;
     return Result::Ok;
 }
 
+const set<AudioNodePtr>& AudioNode::GetInputNodes() const
+{
+    return _InputNodes;
+}
+
+Result AudioNode::ExecuteInputNode(AudioNode& node, AudioBuffer& destinationBuffer)
+{
+    return _System.GetGraph().GetProfiler().ExecuteNode(node, destinationBuffer, this);
+}
+
 } // namespace Loom
@@ -23,6 +23,11 @@ struct AudioNodeId
 {
     static constexpr u64 AudioSource = 1;
     static constexpr u64 MixingNode = 2;
+    static constexpr u64 BiquadFilter = 3;
+    static constexpr u64 Convolution = 4;
+    static constexpr u64 SpectrumAnalyzer = 5;
+    static constexpr u64 Spatializer = 6;
+    static constexpr u64 BiquadFilterBank = 7;
 };
 
 class IAudioSystem;
@@ -49,12 +54,19 @@ public:
 protected:
     AudioBuffer& GetBuffer();
     IAudioSystem& GetSystem();
+    const IAudioSystem& GetSystem() const;
     void ReleaseBuffer();
     bool BypassNode() const;
     Result ExecuteInputNodes(AudioBuffer& destinationBuffer);
+    // For nodes processing their inputs one by one instead of their mix
+    const set<shared_ptr<AudioNode>>& GetInputNodes() const;
+    Result ExecuteInputNode(AudioNode& node, AudioBuffer& destinationBuffer);
 
 private:
     friend class IAudioGraph;
+    friend class AudioProfiler;
+
+    static constexpr u32 NoProfilerSlot = UINT32_MAX;
 
     atomic<AudioNodeState> _State;
     string _Name;
@@ -65,6 +77,10 @@ private:
     IAudioSystem& _System;
     bool _Visited;
     bool _Bypass;
+
+    // Owned by the profiler of the graph, written by the audio thread only
+    u32 _ProfilerSlot;
+    u64 _ProfiledInputCycles;
 };
 
 using AudioNodePtr = shared_ptr<AudioNode>;
@@ -19,6 +19,25 @@ enum class AudioNodeParameterType
     Transform,
 };
 
+template <class T>
+constexpr AudioNodeParameterType GetNodeParameterType()
+{
+    if constexpr (std::is_same_v<T, u32>)
+        return AudioNodeParameterType::Unsigned32;
+    else if constexpr (std::is_same_v<T, s32>)
+        return AudioNodeParameterType::Signed32;
+    else if constexpr (std::is_same_v<T, float>)
+        return AudioNodeParameterType::Float32;
+    else if constexpr (std::is_same_v<T, bool>)
+        return AudioNodeParameterType::Boolean;
+    else if constexpr (std::is_same_v<T, Vector3>)
+        return AudioNodeParameterType::Vector3;
+    else if constexpr (std::is_same_v<T, Transform>)
+        return AudioNodeParameterType::Transform;
+    else
+        return AudioNodeParameterType::NotSupported;
+}
+
 // Object encapsulating the value of an audio node parameter
 class AudioNodeParameter
 {
@@ -43,8 +62,14 @@ public:
         if (GetNodeParameterType<T>() == _Type)
         {
             unique_lock lock(_ValueAccessMutex);
-            if (_HasLimits && (value > _Max || value < _Min))
-                std::clamp(value, std::get<T>(_Min), std::get<T>(_Max));
+            if constexpr (std::is_arithmetic_v<T>)
+            {
+                if (_HasLimits)
+                {
+                    _Value = std::clamp(value, std::get<T>(_Min), std::get<T>(_Max));
+                    return Result::Ok;
+                }
+            }
             _Value = value;
             return Result::Ok;
         }
@@ -77,26 +102,6 @@ private:
     bool _HasLimits;
     const ValueType _Min;
     const ValueType _Max;
-
-private:
-    template <class T>
-    static constexpr AudioNodeParameterType GetParameterType();
-};
-
-template <class T>
-constexpr AudioNodeParameterType GetNodeParameterType()
-{
-    if constexpr (std::is_same_v<T, u32>)
-        return AudioNodeParameterType::Unsigned32;
-    else if constexpr (std::is_same_v<T, s32>)
-        return AudioNodeParameterType::Signed32;
-    else if constexpr (std::is_same_v<T, bool>)
-        return AudioNodeParameterType::Boolean;
-    else if constexpr (std::is_same_v<T, Vector3>)
-        return AudioNodeParameterType::Vector3;
-    else if constexpr (std::is_same_v<T, Transform>)
-        return AudioNodeParameterType::Transform;
-    return AudioNodeParameterType::NotSupported;
 };
 
 } // namespace Loom
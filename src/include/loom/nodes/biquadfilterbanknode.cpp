@@ -0,0 +1,165 @@
+#include "loom/nodes/biquadfilterbanknode.h"
+#include "loom/interfaces/iaudiosystem.h"
+#include "loom/interfaces/iaudiobufferprovider.h"
+
+namespace Loom
+{
+
+BiquadFilterBankNode::BiquadFilterBankNode(IAudioSystem& system, u32 voiceCapacity)
+    : AudioNode(system)
+    , _Bank(voiceCapacity)
+    , _Voices(voiceCapacity, nullptr)
+    , _VoiceBuffers(voiceCapacity)
+    , _VoiceSamples(voiceCapacity, nullptr)
+    , _FilterFrameRate(0)
+{
+}
+
+const char* BiquadFilterBankNode::GetName() const
+{
+    return "BiquadFilterBankNode";
+}
+
+u64 BiquadFilterBankNode::GetTypeId() const
+{
+    return AudioNodeId::BiquadFilterBank;
+}
+
+Result BiquadFilterBankNode::SetInputFilter(const AudioNodePtr& input, BiquadFilterType type, float frequency, float q, float gainDB)
+{
+    if (input == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    if (frequency <= 0.0f || q <= 0.0f || type > BiquadFilterType::Peak)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    scoped_lock lock(_InputFiltersMutex);
+    auto it = std::find_if(_InputFilters.begin(), _InputFilters.end(), [&input](const InputFilter& filter) { return filter.input == input.get(); });
+    if (it == _InputFilters.end())
+        it = _InputFilters.emplace(_InputFilters.end());
+    it->input = input.get();
+    it->type = type;
+    it->frequency = frequency;
+    it->q = q;
+    it->gainDB = gainDB;
+    PublishFilters();
+    return Result::Ok;
+}
+
+Result BiquadFilterBankNode::RemoveInputFilter(const AudioNodePtr& input)
+{
+    if (input == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    scoped_lock lock(_InputFiltersMutex);
+    auto it = std::find_if(_InputFilters.begin(), _InputFilters.end(), [&input](const InputFilter& filter) { return filter.input == input.get(); });
+    if (it == _InputFilters.end())
+        LOOM_RETURN_RESULT(Result::CannotFind);
+    _InputFilters.erase(it);
+    PublishFilters();
+    return Result::Ok;
+}
+
+// Under the filters mutex, the game thread allocates the copies
+void BiquadFilterBankNode::PublishFilters()
+{
+    _Filters.GetWriteBuffer() = _InputFilters;
+    _Filters.Publish();
+}
+
+BiquadCoefficients BiquadFilterBankNode::GetInputCoefficients(const AudioNode* input, u32 frameRate) const
+{
+    for (const InputFilter& filter : _Filters.GetReadBuffer())
+    {
+        if (filter.input == input)
+            return BiquadCoefficients::Compute(filter.type, static_cast<float>(frameRate), filter.frequency, filter.q, filter.gainDB);
+    }
+    return BiquadCoefficients();
+}
+
+void BiquadFilterBankNode::ReleaseVoiceBuffers(u32 voiceCount)
+{
+    for (u32 voice = 0; voice < voiceCount; ++voice)
+    {
+        _VoiceBuffers[voice].Release();
+        _VoiceSamples[voice] = nullptr;
+    }
+}
+
+Result BiquadFilterBankNode::Execute(AudioBuffer& destinationBuffer)
+{
+    if (destinationBuffer.GetSampleFormat() != SampleFormat::Float32)
+        LOOM_RETURN_RESULT(Result::BufferFormatMismatch);
+    u32 frameRate = destinationBuffer.GetFrameRate();
+    bool filtersChanged = _Filters.Update() || frameRate != _FilterFrameRate;
+    _FilterFrameRate = frameRate;
+
+    // Inputs render mono frames to the start of a pooled buffer of the output format
+    u32 frames = destinationBuffer.GetFrameCount();
+    AudioFormat voiceFormat = destinationBuffer.GetFormat();
+    voiceFormat.channels = 1;
+    IAudioBufferProvider& bufferProvider = GetSystem().GetBufferProvider();
+    u32 voiceCount = 0;
+    bool rendered = false;
+    for (const AudioNodePtr& node : GetInputNodes())
+    {
+        if (voiceCount == _Bank.GetVoiceCapacity())
+            break;
+        u32 voice = voiceCount;
+        Result result = bufferProvider.AllocateBuffer(_VoiceBuffers[voice]);
+        if (!Ok(result))
+        {
+            ReleaseVoiceBuffers(voiceCount);
+            LOOM_RETURN_RESULT(result);
+        }
+        ++voiceCount;
+        if (_Voices[voice] != node.get())
+        {
+            _Bank.ResetVoice(voice);
+            _Bank.SetCoefficients(voice, GetInputCoefficients(node.get(), frameRate));
+            _Voices[voice] = node.get();
+        }
+        else if (filtersChanged)
+        {
+            _Bank.SetCoefficients(voice, GetInputCoefficients(node.get(), frameRate));
+        }
+        _VoiceSamples[voice] = _VoiceBuffers[voice].GetData<float>();
+        AudioBuffer voiceBuffer(nullptr, voiceFormat, _VoiceBuffers[voice].GetData(), frames * sizeof(float));
+        result = voiceBuffer.SetSize(frames * sizeof(float));
+        if (Ok(result))
+            result = ExecuteInputNode(*node, voiceBuffer);
+        if (Ok(result))
+        {
+            rendered = true;
+            continue;
+        }
+        if (result != Result::NodeIsVirtual && result != Result::NoData)
+            LOOM_LOG_RESULT(result);
+        // Silent inputs still run through their filter, which keeps its state consistent
+        memset(_VoiceSamples[voice], 0, frames * sizeof(float));
+    }
+    // Every input being silent is not an error
+    if (!rendered)
+    {
+        ReleaseVoiceBuffers(voiceCount);
+        return Result::NoData;
+    }
+
+    Result result = _Bank.Process(_VoiceSamples.data(), voiceCount, frames);
+    if (Ok(result))
+    {
+        u32 channels = destinationBuffer.GetChannels();
+        float* destination = destinationBuffer.GetData<float>();
+        memset(destination, 0, destinationBuffer.GetSize());
+        for (u32 voice = 0; voice < voiceCount; ++voice)
+        {
+            const float* samples = _VoiceSamples[voice];
+            for (u32 frame = 0; frame < frames; ++frame)
+            {
+                for (u32 channel = 0; channel < channels; ++channel)
+                    destination[frame * channels + channel] += samples[frame];
+            }
+        }
+    }
+    ReleaseVoiceBuffers(voiceCount);
+    return result;
+}
+
+} // namespace Loom
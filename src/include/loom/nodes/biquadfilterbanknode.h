@@ -0,0 +1,72 @@
+#pragma once
+
+#include "loom/nodes/audionode.h"
+#include "loom/audiobuffer.h"
+#include "loom/biquad.h"
+#include "loom/triplebuffer.h"
+
+namespace Loom
+{
+
+class IAudioSystem;
+
+// Filters each of its inputs with a biquad of its own before mixing them, like per voice
+// occlusion filters. Inputs render mono frames to buffers of their own, which are filtered
+// in one batch per buffer, vectorized across inputs, and added to every channel of the
+// output. Inputs take the bank voices in the order of the input set and the ones over the
+// capacity are skipped. Inputs without a filter pass through.
+class BiquadFilterBankNode : public AudioNode
+{
+public:
+    static constexpr u32 DefaultVoiceCapacity = 64;
+
+    BiquadFilterBankNode(IAudioSystem& system, u32 voiceCapacity = DefaultVoiceCapacity);
+    Result Execute(AudioBuffer& destinationBuffer) override;
+    const char* GetName() const override;
+    u64 GetTypeId() const override;
+
+    // Applied from the next buffer. Filters are matched to inputs by address, the filter
+    // of an input removed from the graph should be removed along with it.
+    Result SetInputFilter(const AudioNodePtr& input, BiquadFilterType type, float frequency, float q = 0.7071f, float gainDB = 0.0f);
+    Result RemoveInputFilter(const AudioNodePtr& input);
+
+private:
+    struct InputFilter
+    {
+        InputFilter()
+            : input(nullptr)
+            , type(BiquadFilterType::LowPass)
+            , frequency(0.0f)
+            , q(0.0f)
+            , gainDB(0.0f)
+        {
+        }
+
+        const AudioNode* input;
+        BiquadFilterType type;
+        float frequency;
+        float q;
+        float gainDB;
+    };
+
+    void PublishFilters();
+    BiquadCoefficients GetInputCoefficients(const AudioNode* input, u32 frameRate) const;
+    void ReleaseVoiceBuffers(u32 voiceCount);
+
+private:
+    BiquadFilterBank _Bank;
+
+    // Filters set by the game thread, handed to the audio thread through a triple buffer
+    vector<InputFilter> _InputFilters;
+    mutex _InputFiltersMutex;
+    TripleBuffer<vector<InputFilter>> _Filters;
+
+    // Sized to the capacity, the input each voice filtered last, its state being reset when another one takes it
+    vector<const AudioNode*> _Voices;
+    vector<AudioBuffer> _VoiceBuffers;
+    vector<float*> _VoiceSamples;
+    // Frame rate the coefficients were computed for
+    u32 _FilterFrameRate;
+};
+
+} // namespace Loom
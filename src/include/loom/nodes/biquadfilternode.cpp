@@ -0,0 +1,83 @@
+#include "loom/nodes/biquadfilternode.h"
+
+namespace Loom
+{
+
+BiquadFilterNode::BiquadFilterNode(IAudioSystem& system, BiquadFilterType type, float frequency, float q, float gainDB)
+    : AudioNode(system)
+    , _Type("Type", AudioNodeParameterType::Unsigned32, static_cast<u32>(type), true, static_cast<u32>(BiquadFilterType::LowPass), static_cast<u32>(BiquadFilterType::Peak))
+    , _Frequency("Frequency", AudioNodeParameterType::Float32, frequency, true, 10.0f, 24000.0f)
+    , _Q("Q", AudioNodeParameterType::Float32, q, true, 0.1f, 40.0f)
+    , _Gain("Gain", AudioNodeParameterType::Float32, gainDB, true, -48.0f, 48.0f)
+    , _FilterType(UINT32_MAX)
+    , _FilterFrequency(0.0f)
+    , _FilterQ(0.0f)
+    , _FilterGain(0.0f)
+    , _FilterFrameRate(0)
+{
+}
+
+const char* BiquadFilterNode::GetName() const
+{
+    return "BiquadFilterNode";
+}
+
+u64 BiquadFilterNode::GetTypeId() const
+{
+    return AudioNodeId::BiquadFilter;
+}
+
+Result BiquadFilterNode::SetType(BiquadFilterType type)
+{
+    return _Type.SetValue<u32>(static_cast<u32>(type));
+}
+
+Result BiquadFilterNode::SetFrequency(float frequency)
+{
+    return _Frequency.SetValue<float>(frequency);
+}
+
+Result BiquadFilterNode::SetQ(float q)
+{
+    return _Q.SetValue<float>(q);
+}
+
+Result BiquadFilterNode::SetGain(float gainDB)
+{
+    return _Gain.SetValue<float>(gainDB);
+}
+
+void BiquadFilterNode::UpdateCoefficients(u32 frameRate)
+{
+    u32 type = 0;
+    float frequency = 0.0f;
+    float q = 0.0f;
+    float gain = 0.0f;
+    _Type.GetValue<u32>(type);
+    _Frequency.GetValue<float>(frequency);
+    _Q.GetValue<float>(q);
+    _Gain.GetValue<float>(gain);
+    if (type == _FilterType && frequency == _FilterFrequency && q == _FilterQ && gain == _FilterGain && frameRate == _FilterFrameRate)
+        return;
+    _Filter.SetCoefficients(BiquadCoefficients::Compute(static_cast<BiquadFilterType>(type), static_cast<float>(frameRate), frequency, q, gain));
+    _FilterType = type;
+    _FilterFrequency = frequency;
+    _FilterQ = q;
+    _FilterGain = gain;
+    _FilterFrameRate = frameRate;
+}
+
+Result BiquadFilterNode::Execute(AudioBuffer& destinationBuffer)
+{
+    Result result = ExecuteInputNodes(destinationBuffer);
+    // Every input being silent is not an error
+    if (result == Result::NoData)
+        return result;
+    LOOM_CHECK_RESULT(result);
+    if (destinationBuffer.GetSampleFormat() != SampleFormat::Float32)
+        LOOM_RETURN_RESULT(Result::BufferFormatMismatch);
+    UpdateCoefficients(destinationBuffer.GetFrameRate());
+    return _Filter.Process(destinationBuffer.GetData<float>(), destinationBuffer.GetFrameCount(), destinationBuffer.GetChannels());
+}
+
+} // namespace Loom
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "loom/nodes/audionode.h"
+#include "loom/nodes/audionodeparameter.h"
+#include "loom/biquad.h"
+
+namespace Loom
+{
+
+class IAudioSystem;
+class AudioBuffer;
+
+// Filters the mix of its inputs, the coefficients follow the parameters from one buffer to the next
+class BiquadFilterNode : public AudioNode
+{
+public:
+    BiquadFilterNode(IAudioSystem& system, BiquadFilterType type = BiquadFilterType::LowPass, float frequency = 1000.0f, float q = 0.7071f, float gainDB = 0.0f);
+    Result Execute(AudioBuffer& destinationBuffer) override;
+    const char* GetName() const override;
+    u64 GetTypeId() const override;
+
+    Result SetType(BiquadFilterType type);
+    Result SetFrequency(float frequency);
+    Result SetQ(float q);
+    Result SetGain(float gainDB);
+
+private:
+    void UpdateCoefficients(u32 frameRate);
+
+private:
+    AudioNodeParameter _Type;
+    AudioNodeParameter _Frequency;
+    AudioNodeParameter _Q;
+    AudioNodeParameter _Gain;
+    BiquadFilter _Filter;
+
+    // Parameters the coefficients were computed from
+    u32 _FilterType;
+    float _FilterFrequency;
+    float _FilterQ;
+    float _FilterGain;
+    u32 _FilterFrameRate;
+};
+
+} // namespace Loom
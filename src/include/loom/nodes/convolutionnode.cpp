@@ -0,0 +1,68 @@
+#include "loom/nodes/convolutionnode.h"
+
+namespace Loom
+{
+
+ConvolutionNode::ConvolutionNode(IAudioSystem& system, const float* impulse, u32 impulseFrames, u32 impulseChannels, u32 blockFrames)
+    : AudioNode(system)
+    , _Gain("Gain", AudioNodeParameterType::Float32, 1.0f, true, 0.0f, 10.0f)
+    , _ImpulseChannels(impulseChannels)
+    , _BlockFrames(blockFrames)
+{
+    if (impulse != nullptr)
+        _Impulse.assign(impulse, impulse + impulseFrames * impulseChannels);
+}
+
+const char* ConvolutionNode::GetName() const
+{
+    return "ConvolutionNode";
+}
+
+u64 ConvolutionNode::GetTypeId() const
+{
+    return AudioNodeId::Convolution;
+}
+
+Result ConvolutionNode::Initialize()
+{
+    if (_Impulse.empty() || _ImpulseChannels == 0)
+        LOOM_RETURN_RESULT(Result::NoData);
+    u32 impulseFrames = static_cast<u32>(_Impulse.size() / _ImpulseChannels);
+    return _Convolver.Initialize(_Impulse.data(), impulseFrames, _ImpulseChannels, GetSystem().GetConfig().deviceChannels, _BlockFrames);
+}
+
+Result ConvolutionNode::Shutdown()
+{
+    _Convolver.Shutdown();
+    return Result::Ok;
+}
+
+Result ConvolutionNode::SetGain(float gain)
+{
+    return _Gain.SetValue<float>(gain);
+}
+
+u32 ConvolutionNode::GetLatency() const
+{
+    return _Convolver.GetLatency();
+}
+
+Result ConvolutionNode::Execute(AudioBuffer& destinationBuffer)
+{
+    Result result = ExecuteInputNodes(destinationBuffer);
+    if (result != Result::NoData)
+        LOOM_CHECK_RESULT(result);
+    if (destinationBuffer.GetSampleFormat() != SampleFormat::Float32 || destinationBuffer.GetChannels() != _Convolver.GetChannels())
+        LOOM_RETURN_RESULT(Result::BufferFormatMismatch);
+    // Silent inputs still feed the tail of the reverb
+    if (result == Result::NoData)
+        memset(destinationBuffer.GetData(), 0, destinationBuffer.GetSize());
+    result = _Convolver.Process(destinationBuffer.GetData<float>(), destinationBuffer.GetFrameCount());
+    LOOM_CHECK_RESULT(result);
+    float gain = 1.0f;
+    _Gain.GetValue<float>(gain);
+    destinationBuffer.MultiplySamplesBy<float>(gain);
+    return Result::Ok;
+}
+
+} // namespace Loom
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "loom/nodes/audionode.h"
+#include "loom/nodes/audionodeparameter.h"
+#include "loom/convolution.h"
+
+namespace Loom
+{
+
+class IAudioSystem;
+class AudioBuffer;
+
+// Convolution reverb of the mix of its inputs, with the channels of the device.
+// The response is partitioned when the node is initialized, and the tail keeps
+// ringing after the inputs went silent.
+class ConvolutionNode : public AudioNode
+{
+public:
+    // The impulse response holds interleaved frames of float samples
+    ConvolutionNode(IAudioSystem& system, const float* impulse, u32 impulseFrames, u32 impulseChannels, u32 blockFrames = Convolver::DefaultBlockFrames);
+    Result Initialize() override;
+    Result Shutdown() override;
+    Result Execute(AudioBuffer& destinationBuffer) override;
+    const char* GetName() const override;
+    u64 GetTypeId() const override;
+
+    Result SetGain(float gain);
+    u32 GetLatency() const;
+
+private:
+    AudioNodeParameter _Gain;
+    vector<float> _Impulse;
+    u32 _ImpulseChannels;
+    u32 _BlockFrames;
+    Convolver _Convolver;
+};
+
+} // namespace Loom
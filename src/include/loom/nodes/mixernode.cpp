@@ -22,6 +22,9 @@ u64 MixerNode::GetTypeId() const
 Result MixerNode::Execute(AudioBuffer& destinationBuffer)
 {
     Result result = ExecuteInputNodes(destinationBuffer);
+    // Every input being silent is not an error
+    if (result == Result::NoData)
+        return result;
     LOOM_CHECK_RESULT(result);
     float gain = 1.0f;
     _Gain.GetValue<float>(gain);
@@ -0,0 +1,146 @@
+#include "loom/nodes/spatializernode.h"
+#include "loom/nodes/assetreadernode.h"
+#include "loom/interfaces/iaudiosystem.h"
+#include "loom/interfaces/iaudiobufferprovider.h"
+
+namespace Loom
+{
+
+SpatializerNode::SpatializerNode(IAudioSystem& system, u32 sourceCapacity, SpeakerLayout layout)
+    : AudioNode(system)
+    , _Listener("Listener", AudioNodeParameterType::Transform, Transform{{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f, 0.0f}})
+    , _ListenerVelocity("ListenerVelocity", AudioNodeParameterType::Vector3, Vector3{0.0f, 0.0f, 0.0f})
+    , _DistanceModel("DistanceModel", AudioNodeParameterType::Unsigned32, static_cast<u32>(DistanceModel::Inverse), true, static_cast<u32>(DistanceModel::None), static_cast<u32>(DistanceModel::Linear))
+    , _MinDistance("MinDistance", AudioNodeParameterType::Float32, 1.0f)
+    , _MaxDistance("MaxDistance", AudioNodeParameterType::Float32, 100.0f)
+    , _Rolloff("Rolloff", AudioNodeParameterType::Float32, 1.0f)
+    , _Spatializer(sourceCapacity, layout)
+    , _Sources(sourceCapacity, nullptr)
+    , _SourceDistanceModel(static_cast<u32>(DistanceModel::Inverse))
+    , _SourceMinDistance(1.0f)
+    , _SourceMaxDistance(100.0f)
+    , _SourceRolloff(1.0f)
+{
+}
+
+const char* SpatializerNode::GetName() const
+{
+    return "SpatializerNode";
+}
+
+u64 SpatializerNode::GetTypeId() const
+{
+    return AudioNodeId::Spatializer;
+}
+
+Result SpatializerNode::SetListener(const Transform& transform, const Vector3& velocity)
+{
+    Result result = _Listener.SetValue<Transform>(transform);
+    LOOM_CHECK_RESULT(result);
+    return _ListenerVelocity.SetValue<Vector3>(velocity);
+}
+
+Result SpatializerNode::SetAttenuation(DistanceModel model, float minDistance, float maxDistance, float rolloff)
+{
+    if (minDistance <= 0.0f || maxDistance <= minDistance || rolloff < 0.0f)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    Result result = _DistanceModel.SetValue<u32>(static_cast<u32>(model));
+    if (Ok(result))
+        result = _MinDistance.SetValue<float>(minDistance);
+    if (Ok(result))
+        result = _MaxDistance.SetValue<float>(maxDistance);
+    if (Ok(result))
+        result = _Rolloff.SetValue<float>(rolloff);
+    return result;
+}
+
+Result SpatializerNode::UpdateSettings()
+{
+    Transform listener;
+    Vector3 listenerVelocity;
+    _Listener.GetValue<Transform>(listener);
+    _ListenerVelocity.GetValue<Vector3>(listenerVelocity);
+    _Spatializer.SetListener(listener, listenerVelocity);
+
+    u32 model = 0;
+    float minDistance = 0.0f;
+    float maxDistance = 0.0f;
+    float rolloff = 0.0f;
+    _DistanceModel.GetValue<u32>(model);
+    _MinDistance.GetValue<float>(minDistance);
+    _MaxDistance.GetValue<float>(maxDistance);
+    _Rolloff.GetValue<float>(rolloff);
+    if (model == _SourceDistanceModel && minDistance == _SourceMinDistance && maxDistance == _SourceMaxDistance && rolloff == _SourceRolloff)
+        return Result::Ok;
+    for (u32 source = 0; source < _Spatializer.GetSourceCapacity(); ++source)
+    {
+        Result result = _Spatializer.SetSourceAttenuation(source, static_cast<DistanceModel>(model), minDistance, maxDistance, rolloff);
+        LOOM_CHECK_RESULT(result);
+    }
+    _SourceDistanceModel = model;
+    _SourceMinDistance = minDistance;
+    _SourceMaxDistance = maxDistance;
+    _SourceRolloff = rolloff;
+    return Result::Ok;
+}
+
+Result SpatializerNode::Execute(AudioBuffer& destinationBuffer)
+{
+    if (destinationBuffer.GetSampleFormat() != SampleFormat::Float32 || destinationBuffer.GetChannels() != _Spatializer.GetChannels())
+        LOOM_RETURN_RESULT(Result::BufferFormatMismatch);
+    Result result = UpdateSettings();
+    LOOM_CHECK_RESULT(result);
+
+    // Positions first, the gains of every source are computed at once
+    u32 sourceCount = 0;
+    for (const AudioNodePtr& node : GetInputNodes())
+    {
+        if (sourceCount == _Spatializer.GetSourceCapacity())
+            break;
+        if (node->GetTypeId() != AudioNodeId::AudioSource)
+            continue;
+        AssetReaderNode* source = static_cast<AssetReaderNode*>(node.get());
+        Vector3 position;
+        Vector3 velocity;
+        source->GetPosition(position, velocity);
+        _Spatializer.SetSourcePosition(sourceCount, position, velocity);
+        _Sources[sourceCount++] = source;
+    }
+    result = _Spatializer.Update(sourceCount);
+    LOOM_CHECK_RESULT(result);
+
+    // Sources render mono frames to the start of a pooled buffer of the output format
+    u32 frames = destinationBuffer.GetFrameCount();
+    AudioFormat sourceFormat = destinationBuffer.GetFormat();
+    sourceFormat.channels = 1;
+    memset(destinationBuffer.GetData(), 0, destinationBuffer.GetSize());
+    IAudioBufferProvider& bufferProvider = GetSystem().GetBufferProvider();
+    bool mixed = false;
+    for (u32 source = 0; source < sourceCount; ++source)
+    {
+        AudioBuffer pooledBuffer;
+        result = bufferProvider.AllocateBuffer(pooledBuffer);
+        if (!Ok(result))
+        {
+            LOOM_LOG_RESULT(result);
+            continue;
+        }
+        AudioBuffer sourceBuffer(nullptr, sourceFormat, pooledBuffer.GetData(), frames * sizeof(float));
+        result = sourceBuffer.SetSize(frames * sizeof(float));
+        if (Ok(result))
+            result = ExecuteInputNode(*_Sources[source], sourceBuffer);
+        if (Ok(result))
+        {
+            result = _Spatializer.Mix(source, sourceBuffer.GetData<float>(), frames, destinationBuffer.GetData<float>());
+            mixed = mixed || Ok(result);
+        }
+        if (!Ok(result) && result != Result::NodeIsVirtual)
+            LOOM_LOG_RESULT(result);
+    }
+    // Every input being silent is not an error
+    if (!mixed)
+        return Result::NoData;
+    return Result::Ok;
+}
+
+} // namespace Loom
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "loom/nodes/audionode.h"
+#include "loom/nodes/audionodeparameter.h"
+#include "loom/spatializer.h"
+
+namespace Loom
+{
+
+class IAudioSystem;
+class AudioBuffer;
+class AssetReaderNode;
+
+// Places its mono AssetReaderNode inputs around a listener. Each input renders to a buffer
+// of its own and is mixed into the interleaved output with the gains of its position, all
+// of them computed in one batch per buffer. Inputs take the spatializer slots in connection
+// order and the ones over the capacity are skipped. Doppler ratios are not applied, sources
+// do not resample.
+class SpatializerNode : public AudioNode
+{
+public:
+    static constexpr u32 DefaultSourceCapacity = 64;
+
+    SpatializerNode(IAudioSystem& system, u32 sourceCapacity = DefaultSourceCapacity, SpeakerLayout layout = SpeakerLayout::Stereo);
+    Result Execute(AudioBuffer& destinationBuffer) override;
+    const char* GetName() const override;
+    u64 GetTypeId() const override;
+
+    Result SetListener(const Transform& transform, const Vector3& velocity = Vector3{0.0f, 0.0f, 0.0f});
+    // Distance attenuation of every source
+    Result SetAttenuation(DistanceModel model, float minDistance, float maxDistance, float rolloff = 1.0f);
+
+private:
+    Result UpdateSettings();
+
+private:
+    AudioNodeParameter _Listener;
+    AudioNodeParameter _ListenerVelocity;
+    AudioNodeParameter _DistanceModel;
+    AudioNodeParameter _MinDistance;
+    AudioNodeParameter _MaxDistance;
+    AudioNodeParameter _Rolloff;
+    Spatializer _Spatializer;
+    // Sized to the capacity, the inputs of the buffer being rendered
+    vector<AssetReaderNode*> _Sources;
+
+    // Attenuation the spatializer was set with
+    u32 _SourceDistanceModel;
+    float _SourceMinDistance;
+    float _SourceMaxDistance;
+    float _SourceRolloff;
+};
+
+} // namespace Loom
@@ -0,0 +1,138 @@
+#include "loom/nodes/spectrumanalyzernode.h"
+
+namespace Loom
+{
+
+SpectrumAnalyzerNode::SpectrumAnalyzerNode(IAudioSystem& system, u32 fftSize)
+    : AudioNode(system)
+    , _FFTSize(fftSize)
+    , _Initialized(false)
+    , _MagnitudeScale(0.0f)
+    , _HistoryPosition(0)
+    , _FramesSinceAnalysis(0)
+    , _Peak()
+    , _SquareSum()
+    , _Sequence(0)
+{
+}
+
+const char* SpectrumAnalyzerNode::GetName() const
+{
+    return "SpectrumAnalyzerNode";
+}
+
+u64 SpectrumAnalyzerNode::GetTypeId() const
+{
+    return AudioNodeId::SpectrumAnalyzer;
+}
+
+u32 SpectrumAnalyzerNode::GetFFTSize() const
+{
+    return _FFTSize;
+}
+
+Result SpectrumAnalyzerNode::Initialize()
+{
+    if (_FFTSize < MinFFTSize || _FFTSize > FFT::MaxSize)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    Result result = _FFT.Initialize(_FFTSize);
+    LOOM_CHECK_RESULT(result);
+    // Periodic Hann window, the magnitudes are scaled by its coherent gain
+    constexpr double Pi = 3.14159265358979323846;
+    _Window.resize(_FFTSize);
+    double windowSum = 0.0;
+    for (u32 i = 0; i < _FFTSize; ++i)
+    {
+        _Window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * Pi * i / _FFTSize));
+        windowSum += _Window[i];
+    }
+    _MagnitudeScale = static_cast<float>(2.0 / windowSum);
+    _History.assign(_FFTSize, 0.0f);
+    _HistoryPosition = 0;
+    _Spectrum.assign(_FFTSize + 2, 0.0f);
+
+    SpectrumAnalysis analysis;
+    analysis.magnitudes.assign(_FFT.GetBinCount(), 0.0f);
+    _Analyses.Reset(analysis);
+    _Initialized = true;
+    return Result::Ok;
+}
+
+Result SpectrumAnalyzerNode::Execute(AudioBuffer& destinationBuffer)
+{
+    Result result = ExecuteInputNodes(destinationBuffer);
+    // Every input being silent is not an error
+    bool silent = result == Result::NoData;
+    if (!silent)
+        LOOM_CHECK_RESULT(result);
+    if (!_Initialized.load(std::memory_order_acquire))
+        return result;
+    if (destinationBuffer.GetSampleFormat() != SampleFormat::Float32)
+        LOOM_RETURN_RESULT(Result::BufferFormatMismatch);
+    // Silence is analyzed too, the meters decay and the window drains while the inputs are quiet
+    if (silent)
+        memset(destinationBuffer.GetData(), 0, destinationBuffer.GetSize());
+
+    const float* samples = destinationBuffer.GetData<float>();
+    u32 frames = destinationBuffer.GetFrameCount();
+    u32 channels = destinationBuffer.GetChannels();
+    u32 meteredChannels = std::min(channels, SpectrumAnalysis::MaxChannels);
+    float mixScale = 1.0f / channels;
+    u32 historyMask = _FFTSize - 1;
+    for (u32 frame = 0; frame < frames; ++frame, samples += channels)
+    {
+        float mix = 0.0f;
+        for (u32 channel = 0; channel < channels; ++channel)
+            mix += samples[channel];
+        _History[_HistoryPosition] = mix * mixScale;
+        _HistoryPosition = (_HistoryPosition + 1) & historyMask;
+        for (u32 channel = 0; channel < meteredChannels; ++channel)
+        {
+            _Peak[channel] = std::max(_Peak[channel], std::abs(samples[channel]));
+            _SquareSum[channel] += samples[channel] * samples[channel];
+        }
+    }
+    _FramesSinceAnalysis += frames;
+    if (_FramesSinceAnalysis >= _FFTSize / 2)
+        Analyze(destinationBuffer.GetFrameRate(), meteredChannels);
+    return result;
+}
+
+void SpectrumAnalyzerNode::Analyze(u32 frameRate, u32 channels)
+{
+    // Oldest frame first
+    for (u32 i = 0; i < _FFTSize; ++i)
+        _Spectrum[i] = _History[(_HistoryPosition + i) & (_FFTSize - 1)] * _Window[i];
+    _FFT.Forward(_Spectrum.data(), _Spectrum.data());
+
+    SpectrumAnalysis& analysis = _Analyses.GetWriteBuffer();
+    analysis.sequence = _Sequence++;
+    analysis.frameRate = frameRate;
+    analysis.channels = channels;
+    for (u32 bin = 0; bin < analysis.magnitudes.size(); ++bin)
+    {
+        float real = _Spectrum[2 * bin];
+        float imaginary = _Spectrum[2 * bin + 1];
+        analysis.magnitudes[bin] = std::sqrt(real * real + imaginary * imaginary) * _MagnitudeScale;
+    }
+    for (u32 channel = 0; channel < SpectrumAnalysis::MaxChannels; ++channel)
+    {
+        analysis.peak[channel] = _Peak[channel];
+        analysis.rms[channel] = static_cast<float>(std::sqrt(_SquareSum[channel] / _FramesSinceAnalysis));
+        _Peak[channel] = 0.0f;
+        _SquareSum[channel] = 0.0;
+    }
+    _FramesSinceAnalysis = 0;
+    _Analyses.Publish();
+}
+
+bool SpectrumAnalyzerNode::ReadAnalysis(SpectrumAnalysis& analysis)
+{
+    scoped_lock lock(_ReadMutex);
+    if (!_Analyses.Update())
+        return false;
+    analysis = _Analyses.GetReadBuffer();
+    return true;
+}
+
+} // namespace Loom
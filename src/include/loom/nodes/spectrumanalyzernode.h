@@ -0,0 +1,84 @@
+#pragma once
+
+#include "loom/nodes/audionode.h"
+#include "loom/fft.h"
+#include "loom/triplebuffer.h"
+
+namespace Loom
+{
+
+class IAudioSystem;
+class AudioBuffer;
+
+struct SpectrumAnalysis
+{
+    static constexpr u32 MaxChannels = 8;
+
+    SpectrumAnalysis()
+        : sequence(0)
+        , frameRate(0)
+        , channels(0)
+        , peak()
+        , rms()
+    {
+    }
+
+    float GetBinFrequency(u32 bin) const
+    {
+        return magnitudes.size() > 1 ? 0.5f * bin * frameRate / (magnitudes.size() - 1) : 0.0f;
+    }
+
+    // Analyses published before this one
+    u64 sequence;
+    u32 frameRate;
+    u32 channels;
+    // Bins from DC to Nyquist of the mix of the channels, a full scale sine peaks at 1
+    vector<float> magnitudes;
+    // Levels of the frames received since the previous analysis
+    float peak[MaxChannels];
+    float rms[MaxChannels];
+};
+
+// Passes the mix of its inputs through, analyzing it every half FFT size frames with a
+// Hann window. Analyses are handed to readers through a triple buffer, the audio thread
+// never waits for them.
+class SpectrumAnalyzerNode : public AudioNode
+{
+public:
+    static constexpr u32 MinFFTSize = 64;
+    static constexpr u32 DefaultFFTSize = 2048;
+
+    SpectrumAnalyzerNode(IAudioSystem& system, u32 fftSize = DefaultFFTSize);
+    Result Initialize() override;
+    Result Execute(AudioBuffer& destinationBuffer) override;
+    const char* GetName() const override;
+    u64 GetTypeId() const override;
+
+    u32 GetFFTSize() const;
+    // Copies the latest analysis, returns false when none was published since the last read
+    bool ReadAnalysis(SpectrumAnalysis& analysis);
+
+private:
+    void Analyze(u32 frameRate, u32 channels);
+
+private:
+    u32 _FFTSize;
+    atomic<bool> _Initialized;
+    RealFFT _FFT;
+    vector<float> _Window;
+    float _MagnitudeScale;
+    vector<float> _History;
+    u32 _HistoryPosition;
+    vector<float> _Spectrum;
+
+    u32 _FramesSinceAnalysis;
+    float _Peak[SpectrumAnalysis::MaxChannels];
+    double _SquareSum[SpectrumAnalysis::MaxChannels];
+    u64 _Sequence;
+
+    TripleBuffer<SpectrumAnalysis> _Analyses;
+    // Between readers only
+    mutex _ReadMutex;
+};
+
+} // namespace Loom
@@ -0,0 +1,163 @@
+#include "loom/nullaudiodevicemanager.h"
+#include "loom/interfaces/iaudiosystem.h"
+#include "loom/time.h"
+#include "loom/audiotracer.h"
+
+namespace Loom
+{
+
+NullAudioDeviceManager::NullAudioDeviceManager(IAudioSystem& system)
+    : IAudioDeviceManager(system)
+    , _PlaybackCallback(nullptr)
+    , _PlaybackUserData(nullptr)
+    , _ErrorCallback(nullptr)
+    , _ErrorUserData(nullptr)
+    , _Running(false)
+{
+}
+
+NullAudioDeviceManager::~NullAudioDeviceManager()
+{
+    // Derived classes stop in their own destructor if they need OnStop
+    {
+        scoped_lock lock(_Mutex);
+        _Running = false;
+    }
+    if (_Thread.joinable())
+        _Thread.join();
+}
+
+const char* NullAudioDeviceManager::GetName() const
+{
+    return "NullAudioDeviceManager";
+}
+
+Result NullAudioDeviceManager::Initialize()
+{
+    const AudioSystemConfig& config = GetSystemInterface().GetConfig();
+    if (config.deviceFrameRate == 0 || config.deviceChannels == 0 || config.deviceBufferFrames == 0)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    _Device.name = GetName();
+    _Device.defaultDevice = true;
+    _Device.audioFormat.channels = config.deviceChannels;
+    _Device.audioFormat.frameRate = config.deviceFrameRate;
+    _Device.audioFormat.sampleFormat = SampleFormat::Float32;
+    _Device.bufferSize = config.deviceBufferFrames * _Device.audioFormat.GetFrameSize();
+    _Device.deviceType = AudioDeviceType::Playback;
+    return Result::Ok;
+}
+
+Result NullAudioDeviceManager::RegisterPlaybackCallback(AudioDevicePlaybackCallback callback, void* userData)
+{
+    scoped_lock lock(_Mutex);
+    if (_Running)
+        LOOM_RETURN_RESULT(Result::Busy);
+    _PlaybackCallback = callback;
+    _PlaybackUserData = userData;
+    return Result::Ok;
+}
+
+Result NullAudioDeviceManager::RegisterErrorCallback(AudioDeviceErrorCallback callback, void* userData)
+{
+    scoped_lock lock(_Mutex);
+    if (_Running)
+        LOOM_RETURN_RESULT(Result::Busy);
+    _ErrorCallback = callback;
+    _ErrorUserData = userData;
+    return Result::Ok;
+}
+
+Result NullAudioDeviceManager::EnumerateDevices(u32& deviceCount, const AudioDeviceDescription*& devices)
+{
+    deviceCount = 1;
+    devices = &_Device;
+    return Result::Ok;
+}
+
+Result NullAudioDeviceManager::SelectPlaybackDevice(const AudioDeviceDescription* device)
+{
+    if (device == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    if (device != &_Device)
+        LOOM_RETURN_RESULT(Result::CannotFind);
+    return Result::Ok;
+}
+
+Result NullAudioDeviceManager::SelectDefaultPlaybackDevice(AudioDeviceDescription& defaultDeviceDescription)
+{
+    if (_Device.bufferSize == 0)
+        LOOM_RETURN_RESULT(Result::NotReady);
+    defaultDeviceDescription = _Device;
+    return Result::Ok;
+}
+
+Result NullAudioDeviceManager::Start()
+{
+    scoped_lock lock(_Mutex);
+    if (_Running)
+        return Result::Ok;
+    if (_PlaybackCallback == nullptr || _Device.bufferSize == 0)
+        LOOM_RETURN_RESULT(Result::NotReady);
+    Result result = OnStart(_Device.audioFormat);
+    LOOM_CHECK_RESULT(result);
+    _BufferData.resize(_Device.bufferSize);
+    _Running = true;
+    _Thread = thread(&NullAudioDeviceManager::DeviceThread, this);
+    return Result::Ok;
+}
+
+Result NullAudioDeviceManager::Stop()
+{
+    scoped_lock lock(_Mutex);
+    if (!_Thread.joinable())
+        return Result::Ok;
+    _Running = false;
+    _Thread.join();
+    return OnStop();
+}
+
+Result NullAudioDeviceManager::OnStart(const AudioFormat&)
+{
+    return Result::Ok;
+}
+
+Result NullAudioDeviceManager::OnBufferRendered(const AudioBuffer&)
+{
+    return Result::Ok;
+}
+
+Result NullAudioDeviceManager::OnStop()
+{
+    return Result::Ok;
+}
+
+void NullAudioDeviceManager::DeviceThread()
+{
+    LOOM_TRACE_THREAD_NAME("Loom device");
+    using Clock = std::chrono::steady_clock;
+    const AudioFormat& format = _Device.audioFormat;
+    AudioBuffer buffer(nullptr, format, _BufferData.data(), _Device.bufferSize);
+    u32 bufferFrames = _Device.bufferSize / format.GetFrameSize();
+    Clock::time_point startTime = Clock::now();
+    u64 renderedFrames = 0;
+    while (_Running)
+    {
+        buffer.SetSize(_Device.bufferSize);
+        _PlaybackCallback(buffer, _PlaybackUserData);
+        Result result = OnBufferRendered(buffer);
+        if (!Ok(result))
+        {
+            LOOM_LOG_RESULT(result);
+            if (_ErrorCallback != nullptr)
+                _ErrorCallback(result, _ErrorUserData);
+            return;
+        }
+        // Deadlines follow the frames rendered, the time spent rendering does not make the rate drift
+        renderedFrames += bufferFrames;
+        u64 seconds = renderedFrames / format.frameRate;
+        u64 nanoseconds = (renderedFrames % format.frameRate) * NanosecondsPerSecond / format.frameRate;
+        std::this_thread::sleep_until(startTime + std::chrono::seconds(seconds) + std::chrono::nanoseconds(nanoseconds));
+    }
+}
+
+} // namespace Loom
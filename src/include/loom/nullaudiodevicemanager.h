@@ -0,0 +1,45 @@
+#pragma once
+
+#include "loom/interfaces/iaudiodevicemanager.h"
+
+namespace Loom
+{
+
+// Device manager of headless machines, calling back from a timer thread at the rate of a
+// device configured through AudioSystemConfig. Rendered buffers are handed to OnBufferRendered.
+class NullAudioDeviceManager : public IAudioDeviceManager
+{
+public:
+    NullAudioDeviceManager(IAudioSystem& system);
+    ~NullAudioDeviceManager();
+    const char* GetName() const override;
+    Result Initialize() override;
+    Result RegisterPlaybackCallback(AudioDevicePlaybackCallback callback, void* userData) override;
+    Result RegisterErrorCallback(AudioDeviceErrorCallback callback, void* userData) override;
+    Result EnumerateDevices(u32& deviceCount, const AudioDeviceDescription*& devices) override;
+    Result SelectPlaybackDevice(const AudioDeviceDescription* device) override;
+    Result SelectDefaultPlaybackDevice(AudioDeviceDescription& defaultDeviceDescription) override;
+    Result Start() override;
+    Result Stop() override;
+
+protected:
+    virtual Result OnStart(const AudioFormat& format);
+    virtual Result OnBufferRendered(const AudioBuffer& buffer);
+    virtual Result OnStop();
+
+private:
+    void DeviceThread();
+
+private:
+    AudioDeviceDescription _Device;
+    AudioDevicePlaybackCallback _PlaybackCallback;
+    void* _PlaybackUserData;
+    AudioDeviceErrorCallback _ErrorCallback;
+    void* _ErrorUserData;
+    vector<u8> _BufferData;
+    thread _Thread;
+    atomic<bool> _Running;
+    mutex _Mutex;
+};
+
+} // namespace Loom
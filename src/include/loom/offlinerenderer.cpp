@@ -0,0 +1,141 @@
+#include "loom/offlinerenderer.h"
+#include "loom/audiosystem.h"
+#include "loom/time.h"
+#include "loom/audiotracer.h"
+
+namespace Loom
+{
+
+OfflineRenderer::OfflineRenderer(u32 threadCount)
+    : _ThreadCount(std::max(threadCount, 1u))
+{
+}
+
+Result OfflineRenderer::Render(OfflineRenderJob& job)
+{
+    RenderJob(job);
+    _Stats = job.stats;
+    return job.result;
+}
+
+Result OfflineRenderer::Render(vector<OfflineRenderJob>& jobs)
+{
+    u64 startTime = Now();
+    u32 threadCount = std::min(_ThreadCount, static_cast<u32>(jobs.size()));
+    if (threadCount <= 1)
+    {
+        for (OfflineRenderJob& job : jobs)
+            RenderJob(job);
+    }
+    else
+    {
+        atomic<size_t> nextJob(0);
+        auto worker = [&jobs, &nextJob]()
+        {
+            LOOM_TRACE_THREAD_NAME("Loom offline renderer");
+            for (size_t i = nextJob++; i < jobs.size(); i = nextJob++)
+                RenderJob(jobs[i]);
+        };
+        vector<thread> threads;
+        for (u32 i = 0; i < threadCount; ++i)
+            threads.emplace_back(worker);
+        for (thread& workerThread : threads)
+            workerThread.join();
+    }
+
+    _Stats = OfflineRenderStats();
+    _Stats.elapsedNanoseconds = Now() - startTime;
+    double renderedSeconds = 0.0;
+    Result result = Result::Ok;
+    for (OfflineRenderJob& job : jobs)
+    {
+        _Stats.renderedFrames += job.stats.renderedFrames;
+        _Stats.renderedBuffers += job.stats.renderedBuffers;
+        _Stats.maxBufferNanoseconds = std::max(_Stats.maxBufferNanoseconds, job.stats.maxBufferNanoseconds);
+        renderedSeconds += job.system.GetClock().FramesToSeconds(job.stats.renderedFrames);
+        if (Ok(result) && !Ok(job.result))
+            result = job.result;
+    }
+    UpdateRates(_Stats, renderedSeconds);
+    return result;
+}
+
+const OfflineRenderStats& OfflineRenderer::GetStats() const
+{
+    return _Stats;
+}
+
+void OfflineRenderer::RenderJob(OfflineRenderJob& job)
+{
+    LOOM_TRACE_SCOPE("OfflineRenderer", "RenderJob");
+    AudioSystem& system = job.system;
+    job.stats = OfflineRenderStats();
+    job.output.clear();
+    job.bufferNanoseconds.clear();
+    const AudioDeviceDescription& device = system.GetCurrentDevice();
+    u32 frameSize = device.audioFormat.GetFrameSize();
+    u32 bufferFrames = frameSize > 0 ? device.bufferSize / frameSize : 0;
+    // Systems not initialized with InitializeOffline have no format to render
+    if (frameSize == 0 || bufferFrames == 0)
+    {
+        LOOM_LOG_RESULT(Result::NotReady);
+        job.result = Result::NotReady;
+        return;
+    }
+    AudioBuffer buffer;
+    Result result = system.GetBufferProvider().AllocateBuffer(buffer);
+    if (!Ok(result))
+    {
+        LOOM_LOG_RESULT(result);
+        job.result = result;
+        return;
+    }
+    if (job.callback == nullptr)
+        job.output.reserve(job.frameCount * frameSize);
+    if (job.recordBufferTimes)
+        job.bufferNanoseconds.reserve((job.frameCount + bufferFrames - 1) / bufferFrames);
+
+    u64 startTime = Now();
+    while (job.stats.renderedFrames < job.frameCount)
+    {
+        // The last buffer is cut short to stop on the requested frame
+        u32 frames = static_cast<u32>(std::min<u64>(bufferFrames, job.frameCount - job.stats.renderedFrames));
+        buffer.SetSize(frames * frameSize);
+        u64 frameTime = system.GetClock().GetFrameTime();
+        // Updating before every buffer keeps virtualization at the same frames from run to run
+        result = system.Update();
+        if (!Ok(result))
+            LOOM_LOG_RESULT(result);
+        u64 renderStartTime = Now();
+        result = system.Render(buffer);
+        u64 renderTime = Now() - renderStartTime;
+        job.stats.maxBufferNanoseconds = std::max(job.stats.maxBufferNanoseconds, renderTime);
+        if (job.recordBufferTimes)
+            job.bufferNanoseconds.push_back(renderTime);
+        if (!Ok(result))
+        {
+            LOOM_LOG_RESULT(result);
+            break;
+        }
+        if (job.callback != nullptr)
+            job.callback(buffer, frameTime, job.userData);
+        else
+            job.output.insert(job.output.end(), buffer.GetData(), buffer.GetData() + buffer.GetSize());
+        job.stats.renderedFrames += frames;
+        ++job.stats.renderedBuffers;
+    }
+    job.stats.elapsedNanoseconds = Now() - startTime;
+    UpdateRates(job.stats, system.GetClock().FramesToSeconds(job.stats.renderedFrames));
+    job.result = result;
+}
+
+void OfflineRenderer::UpdateRates(OfflineRenderStats& stats, double renderedSeconds)
+{
+    if (stats.elapsedNanoseconds == 0)
+        return;
+    double elapsedSeconds = static_cast<double>(stats.elapsedNanoseconds) / NanosecondsPerSecond;
+    stats.framesPerSecond = stats.renderedFrames / elapsedSeconds;
+    stats.realtimeFactor = renderedSeconds / elapsedSeconds;
+}
+
+} // namespace Loom
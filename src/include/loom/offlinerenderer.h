@@ -0,0 +1,90 @@
+#pragma once
+
+#include "loom/defines.h"
+#include "loom/types.h"
+#include "loom/result.h"
+
+namespace Loom
+{
+
+class AudioSystem;
+class AudioBuffer;
+
+// Receives every rendered buffer along with the frame time of its first frame
+using OfflineRenderCallback = void(*)(const AudioBuffer& buffer, u64 frameTime, void* userData);
+
+struct OfflineRenderStats
+{
+    OfflineRenderStats()
+        : renderedFrames(0)
+        , renderedBuffers(0)
+        , elapsedNanoseconds(0)
+        , maxBufferNanoseconds(0)
+        , framesPerSecond(0.0)
+        , realtimeFactor(0.0)
+    {
+    }
+
+    u64 renderedFrames;
+    u64 renderedBuffers;
+    u64 elapsedNanoseconds;
+    // Longest time spent in AudioSystem::Render, the part a device callback would run
+    u64 maxBufferNanoseconds;
+
+    // Throughput, and how many seconds of audio were rendered per second
+    double framesPerSecond;
+    double realtimeFactor;
+};
+
+struct OfflineRenderJob
+{
+    OfflineRenderJob(AudioSystem& system, u64 frameCount, OfflineRenderCallback callback = nullptr, void* userData = nullptr)
+        : system(system)
+        , frameCount(frameCount)
+        , callback(callback)
+        , userData(userData)
+        , recordBufferTimes(false)
+        , result(Result::Ok)
+    {
+    }
+
+    // Initialized with AudioSystem::InitializeOffline
+    AudioSystem& system;
+    u64 frameCount;
+
+    // Without a callback the interleaved samples are kept in output
+    OfflineRenderCallback callback;
+    void* userData;
+    vector<u8> output;
+
+    // Time spent rendering every buffer, for percentiles
+    bool recordBufferTimes;
+    vector<u64> bufferNanoseconds;
+
+    OfflineRenderStats stats;
+    Result result;
+};
+
+// Renders systems as fast as the CPU allows, without any device.
+// Jobs are spread over up to threadCount threads, a system always rendering on a single
+// thread, so the output of a job does not depend on the thread count.
+class OfflineRenderer
+{
+public:
+    OfflineRenderer(u32 threadCount = 1);
+
+    Result Render(OfflineRenderJob& job);
+    Result Render(vector<OfflineRenderJob>& jobs);
+    // Totals of the last render over all of its jobs
+    const OfflineRenderStats& GetStats() const;
+
+private:
+    static void RenderJob(OfflineRenderJob& job);
+    static void UpdateRates(OfflineRenderStats& stats, double renderedSeconds);
+
+private:
+    u32 _ThreadCount;
+    OfflineRenderStats _Stats;
+};
+
+} // namespace Loom
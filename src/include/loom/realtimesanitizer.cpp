@@ -0,0 +1,565 @@
+#include "loom/realtimesanitizer.h"
+
+#include <cstdlib>
+#include <new>
+
+#if defined(LOOM_REALTIME_SANITIZER) && defined(__GLIBC__)
+    #define LOOM_REALTIME_INTERCEPTORS 1
+    #include <cerrno>
+    #include <dlfcn.h>
+    #include <execinfo.h>
+    #include <malloc.h>
+    #include <pthread.h>
+    #include <time.h>
+    #include <unistd.h>
+
+// The glibc allocator behind malloc, called by the replacements below
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* pointer, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void* pointer);
+}
+#endif
+
+namespace Loom
+{
+
+namespace
+{
+
+// Constant initialized, readable from allocations made before any constructor ran
+struct ThreadState
+{
+    u32 realtimeDepth;
+    u32 exemptDepth;
+    bool inCall;
+};
+
+thread_local ThreadState CurrentThread = {0, 0, false};
+
+struct CallSite
+{
+    atomic<u64> key;
+    atomic<bool> ready;
+    atomic<u64> count;
+    RealtimeViolationKind kind;
+    const char* function;
+    void* frames[RealtimeSanitizer::MaxFrames];
+    u32 frameCount;
+};
+
+CallSite CallSites[RealtimeSanitizer::MaxCallSites];
+atomic<u64> ViolationCount(0);
+atomic<u64> UnrecordedViolationCount(0);
+
+RealtimeViolationMode GetDefaultMode()
+{
+    const char* mode = getenv("LOOM_REALTIME_SANITIZER");
+    return mode != nullptr && strcmp(mode, "trap") == 0 ? RealtimeViolationMode::Trap : RealtimeViolationMode::Count;
+}
+
+atomic<RealtimeViolationMode> Mode(GetDefaultMode());
+
+u32 CaptureFrames(void** frames)
+{
+#if defined(LOOM_REALTIME_INTERCEPTORS)
+    // OnCall and the interceptor are skipped
+    constexpr int SkippedFrames = 2;
+    void* capturedFrames[RealtimeSanitizer::MaxFrames + SkippedFrames];
+    int capturedCount = backtrace(capturedFrames, RealtimeSanitizer::MaxFrames + SkippedFrames);
+    u32 frameCount = 0;
+    for (int i = SkippedFrames; i < capturedCount; ++i)
+        frames[frameCount++] = capturedFrames[i];
+    return frameCount;
+#else
+    LOOM_UNUSED(frames);
+    return 0;
+#endif
+}
+
+u64 HashCallSite(RealtimeViolationKind kind, const char* function, void* const* frames, u32 frameCount)
+{
+    // FNV-1a over the identity of the call, 0 marks free slots
+    u64 hash = 14695981039346656037ull;
+    auto mix = [&hash](u64 value)
+    {
+        hash = (hash ^ value) * 1099511628211ull;
+    };
+    mix(static_cast<u64>(kind));
+    mix(reinterpret_cast<u64>(function));
+    for (u32 i = 0; i < frameCount; ++i)
+        mix(reinterpret_cast<u64>(frames[i]));
+    return hash != 0 ? hash : 1;
+}
+
+void RecordCallSite(RealtimeViolationKind kind, const char* function, void* const* frames, u32 frameCount)
+{
+    u64 key = HashCallSite(kind, function, frames, frameCount);
+    for (u32 i = 0; i < RealtimeSanitizer::MaxCallSites; ++i)
+    {
+        CallSite& callSite = CallSites[(key + i) % RealtimeSanitizer::MaxCallSites];
+        u64 slotKey = callSite.key.load(std::memory_order_acquire);
+        if (slotKey == 0 && callSite.key.compare_exchange_strong(slotKey, key, std::memory_order_acq_rel))
+        {
+            callSite.kind = kind;
+            callSite.function = function;
+            callSite.frameCount = frameCount;
+            for (u32 frame = 0; frame < frameCount; ++frame)
+                callSite.frames[frame] = frames[frame];
+            callSite.count.fetch_add(1, std::memory_order_relaxed);
+            callSite.ready.store(true, std::memory_order_release);
+            return;
+        }
+        if (slotKey == key)
+        {
+            callSite.count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    UnrecordedViolationCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Trap(RealtimeViolationKind kind, const char* function, void* const* frames, u32 frameCount)
+{
+    // Written straight to stderr, the logger thread would not get to print it
+    char message[256];
+    int length = snprintf(message, sizeof(message), "[REALTIME] %s from a realtime thread (%s), call stack:\n", RealtimeViolationKindToString(kind), function);
+    fwrite(message, 1, std::min<size_t>(std::max(length, 0), sizeof(message) - 1), stderr);
+#if defined(LOOM_REALTIME_INTERCEPTORS)
+    backtrace_symbols_fd(frames, static_cast<int>(frameCount), STDERR_FILENO);
+#else
+    LOOM_UNUSED(frames);
+    LOOM_UNUSED(frameCount);
+#endif
+    fflush(stderr);
+    LOOM_DEBUG_BREAK();
+}
+
+#if defined(LOOM_REALTIME_INTERCEPTORS)
+// Loads the unwinder up front, backtrace allocates on its first call
+const bool UnwinderLoaded = []()
+{
+    void* frame = nullptr;
+    return backtrace(&frame, 1) >= 0;
+}();
+#endif
+
+} // namespace
+
+bool RealtimeSanitizer::IsAvailable()
+{
+#if defined(LOOM_REALTIME_SANITIZER)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void RealtimeSanitizer::SetMode(RealtimeViolationMode mode)
+{
+    Mode.store(mode, std::memory_order_relaxed);
+}
+
+RealtimeViolationMode RealtimeSanitizer::GetMode()
+{
+    return Mode.load(std::memory_order_relaxed);
+}
+
+bool RealtimeSanitizer::IsRealtimeThread()
+{
+    return CurrentThread.realtimeDepth > 0 && CurrentThread.exemptDepth == 0;
+}
+
+u64 RealtimeSanitizer::GetViolationCount()
+{
+    return ViolationCount.load(std::memory_order_relaxed);
+}
+
+Result RealtimeSanitizer::GetViolations(vector<RealtimeViolation>& violations)
+{
+    violations.clear();
+    for (const CallSite& callSite : CallSites)
+    {
+        if (!callSite.ready.load(std::memory_order_acquire))
+            continue;
+        RealtimeViolation violation;
+        violation.kind = callSite.kind;
+        violation.function = callSite.function;
+        violation.count = callSite.count.load(std::memory_order_relaxed);
+#if defined(LOOM_REALTIME_INTERCEPTORS)
+        char** symbols = backtrace_symbols(callSite.frames, static_cast<int>(callSite.frameCount));
+        for (u32 i = 0; symbols != nullptr && i < callSite.frameCount; ++i)
+            violation.callStack.emplace_back(symbols[i]);
+        free(symbols);
+#endif
+        violations.push_back(std::move(violation));
+    }
+    // Most frequent offenders first
+    std::sort(violations.begin(), violations.end(), [](const RealtimeViolation& a, const RealtimeViolation& b)
+    {
+        return a.count > b.count;
+    });
+    return Result::Ok;
+}
+
+void RealtimeSanitizer::PrintViolations()
+{
+    vector<RealtimeViolation> violations;
+    GetViolations(violations);
+    // Printed directly, a report is longer than a log message
+    printf("[REALTIME] %llu violations from %zu call sites\n", static_cast<unsigned long long>(GetViolationCount()), violations.size());
+    for (const RealtimeViolation& violation : violations)
+    {
+        printf("  %llu x %s (%s)\n", static_cast<unsigned long long>(violation.count), RealtimeViolationKindToString(violation.kind), violation.function);
+        for (const string& frame : violation.callStack)
+            printf("      %s\n", frame.c_str());
+    }
+    u64 unrecorded = UnrecordedViolationCount.load(std::memory_order_relaxed);
+    if (unrecorded > 0)
+        printf("  %llu violations from call sites past the first %u\n", static_cast<unsigned long long>(unrecorded), MaxCallSites);
+    fflush(stdout);
+}
+
+void RealtimeSanitizer::Reset()
+{
+    for (CallSite& callSite : CallSites)
+    {
+        callSite.ready.store(false, std::memory_order_relaxed);
+        callSite.count.store(0, std::memory_order_relaxed);
+        callSite.key.store(0, std::memory_order_release);
+    }
+    ViolationCount.store(0, std::memory_order_relaxed);
+    UnrecordedViolationCount.store(0, std::memory_order_relaxed);
+}
+
+void RealtimeSanitizer::OnCall(RealtimeViolationKind kind, const char* function)
+{
+    ThreadState& state = CurrentThread;
+    // Calls made while handling a violation, like the allocations of the unwinder, are not reported
+    if (state.realtimeDepth == 0 || state.exemptDepth > 0 || state.inCall)
+        return;
+    state.inCall = true;
+    void* frames[MaxFrames];
+    u32 frameCount = CaptureFrames(frames);
+    ViolationCount.fetch_add(1, std::memory_order_relaxed);
+    if (GetMode() == RealtimeViolationMode::Trap)
+        Trap(kind, function, frames, frameCount);
+    RecordCallSite(kind, function, frames, frameCount);
+    state.inCall = false;
+}
+
+RealtimeScope::RealtimeScope(bool realtime)
+    : _Realtime(realtime)
+{
+    if (_Realtime)
+        ++CurrentThread.realtimeDepth;
+    else
+        ++CurrentThread.exemptDepth;
+}
+
+RealtimeScope::~RealtimeScope()
+{
+    if (_Realtime)
+        --CurrentThread.realtimeDepth;
+    else
+        --CurrentThread.exemptDepth;
+}
+
+const char* RealtimeViolationKindToString(RealtimeViolationKind kind)
+{
+    switch (kind)
+    {
+        case RealtimeViolationKind::Allocation: return "Allocation";
+        case RealtimeViolationKind::Deallocation: return "Deallocation";
+        case RealtimeViolationKind::Lock: return "Lock";
+        case RealtimeViolationKind::BlockingCall: return "BlockingCall";
+        default: return "Invalid";
+    }
+}
+
+} // namespace Loom
+
+#if defined(LOOM_REALTIME_SANITIZER)
+
+namespace
+{
+
+using Loom::RealtimeSanitizer;
+using Loom::RealtimeViolationKind;
+
+void* RawAllocate(size_t size)
+{
+#if defined(LOOM_REALTIME_INTERCEPTORS)
+    return __libc_malloc(size);
+#else
+    return std::malloc(size);
+#endif
+}
+
+void* RawAllocateAligned(size_t size, size_t alignment)
+{
+#if defined(LOOM_REALTIME_INTERCEPTORS)
+    return __libc_memalign(alignment, size);
+#elif defined(_MSC_VER)
+    return _aligned_malloc(size, alignment);
+#else
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+void RawFree(void* pointer)
+{
+#if defined(LOOM_REALTIME_INTERCEPTORS)
+    __libc_free(pointer);
+#else
+    std::free(pointer);
+#endif
+}
+
+void RawFreeAligned(void* pointer)
+{
+#if defined(_MSC_VER) && !defined(LOOM_REALTIME_INTERCEPTORS)
+    _aligned_free(pointer);
+#else
+    RawFree(pointer);
+#endif
+}
+
+void* CheckedNew(size_t size, const char* function)
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Allocation, function);
+    void* pointer = RawAllocate(size > 0 ? size : 1);
+    if (pointer == nullptr)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* CheckedNewAligned(size_t size, std::align_val_t alignment, const char* function)
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Allocation, function);
+    void* pointer = RawAllocateAligned(size > 0 ? size : 1, static_cast<size_t>(alignment));
+    if (pointer == nullptr)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void CheckedDelete(void* pointer, const char* function)
+{
+    if (pointer == nullptr)
+        return;
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Deallocation, function);
+    RawFree(pointer);
+}
+
+void CheckedDeleteAligned(void* pointer, const char* function)
+{
+    if (pointer == nullptr)
+        return;
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Deallocation, function);
+    RawFreeAligned(pointer);
+}
+
+} // namespace
+
+void* operator new(size_t size) { return CheckedNew(size, "operator new"); }
+void* operator new[](size_t size) { return CheckedNew(size, "operator new[]"); }
+void* operator new(size_t size, std::align_val_t alignment) { return CheckedNewAligned(size, alignment, "operator new"); }
+void* operator new[](size_t size, std::align_val_t alignment) { return CheckedNewAligned(size, alignment, "operator new[]"); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Allocation, "operator new");
+    return RawAllocate(size > 0 ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Allocation, "operator new[]");
+    return RawAllocate(size > 0 ? size : 1);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Allocation, "operator new");
+    return RawAllocateAligned(size > 0 ? size : 1, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Allocation, "operator new[]");
+    return RawAllocateAligned(size > 0 ? size : 1, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept { CheckedDelete(pointer, "operator delete"); }
+void operator delete[](void* pointer) noexcept { CheckedDelete(pointer, "operator delete[]"); }
+void operator delete(void* pointer, size_t) noexcept { CheckedDelete(pointer, "operator delete"); }
+void operator delete[](void* pointer, size_t) noexcept { CheckedDelete(pointer, "operator delete[]"); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { CheckedDelete(pointer, "operator delete"); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { CheckedDelete(pointer, "operator delete[]"); }
+void operator delete(void* pointer, std::align_val_t) noexcept { CheckedDeleteAligned(pointer, "operator delete"); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { CheckedDeleteAligned(pointer, "operator delete[]"); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { CheckedDeleteAligned(pointer, "operator delete"); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { CheckedDeleteAligned(pointer, "operator delete[]"); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { CheckedDeleteAligned(pointer, "operator delete"); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { CheckedDeleteAligned(pointer, "operator delete[]"); }
+
+#endif
+
+#if defined(LOOM_REALTIME_INTERCEPTORS)
+
+namespace
+{
+
+// The next definition of an interposed function, in the C library
+void* GetNextFunction(std::atomic<void*>& cache, const char* name)
+{
+    void* function = cache.load(std::memory_order_relaxed);
+    if (function == nullptr)
+    {
+        function = dlsym(RTLD_NEXT, name);
+        cache.store(function, std::memory_order_relaxed);
+    }
+    return function;
+}
+
+#define LOOM_NEXT_FUNCTION(name) \
+    static std::atomic<void*> nextFunction(nullptr); \
+    auto next = reinterpret_cast<decltype(&name)>(GetNextFunction(nextFunction, #name))
+
+} // namespace
+
+extern "C"
+{
+
+void* malloc(size_t size) noexcept
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Allocation, "malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Allocation, "calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) noexcept
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Allocation, "realloc");
+    return __libc_realloc(pointer, size);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Allocation, "memalign");
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Allocation, "aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** pointer, size_t alignment, size_t size) noexcept
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Allocation, "posix_memalign");
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+    void* allocation = __libc_memalign(alignment, size);
+    if (allocation == nullptr)
+        return ENOMEM;
+    *pointer = allocation;
+    return 0;
+}
+
+void free(void* pointer) noexcept
+{
+    if (pointer != nullptr)
+        RealtimeSanitizer::OnCall(RealtimeViolationKind::Deallocation, "free");
+    __libc_free(pointer);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Lock, "pthread_mutex_lock");
+    LOOM_NEXT_FUNCTION(pthread_mutex_lock);
+    return next(mutex);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* rwlock) noexcept
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Lock, "pthread_rwlock_rdlock");
+    LOOM_NEXT_FUNCTION(pthread_rwlock_rdlock);
+    return next(rwlock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* rwlock) noexcept
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::Lock, "pthread_rwlock_wrlock");
+    LOOM_NEXT_FUNCTION(pthread_rwlock_wrlock);
+    return next(rwlock);
+}
+
+int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex)
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::BlockingCall, "pthread_cond_wait");
+    LOOM_NEXT_FUNCTION(pthread_cond_wait);
+    return next(condition, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* time)
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::BlockingCall, "pthread_cond_timedwait");
+    LOOM_NEXT_FUNCTION(pthread_cond_timedwait);
+    return next(condition, mutex, time);
+}
+
+int nanosleep(const struct timespec* requested, struct timespec* remaining)
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::BlockingCall, "nanosleep");
+    LOOM_NEXT_FUNCTION(nanosleep);
+    return next(requested, remaining);
+}
+
+int clock_nanosleep(clockid_t clock, int flags, const struct timespec* requested, struct timespec* remaining)
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::BlockingCall, "clock_nanosleep");
+    LOOM_NEXT_FUNCTION(clock_nanosleep);
+    return next(clock, flags, requested, remaining);
+}
+
+int usleep(useconds_t microseconds)
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::BlockingCall, "usleep");
+    LOOM_NEXT_FUNCTION(usleep);
+    return next(microseconds);
+}
+
+FILE* fopen(const char* path, const char* mode)
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::BlockingCall, "fopen");
+    LOOM_NEXT_FUNCTION(fopen);
+    return next(path, mode);
+}
+
+ssize_t read(int descriptor, void* data, size_t size)
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::BlockingCall, "read");
+    LOOM_NEXT_FUNCTION(read);
+    return next(descriptor, data, size);
+}
+
+ssize_t write(int descriptor, const void* data, size_t size)
+{
+    RealtimeSanitizer::OnCall(RealtimeViolationKind::BlockingCall, "write");
+    LOOM_NEXT_FUNCTION(write);
+    return next(descriptor, data, size);
+}
+
+} // extern "C"
+
+#endif
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "loom/defines.h"
+#include "loom/types.h"
+#include "loom/result.h"
+
+// Realtime scopes only cost something when the sanitizer is compiled in, with the
+// LOOM_REALTIME_SANITIZER CMake option meant for debug and CI builds.
+#if defined(LOOM_REALTIME_SANITIZER)
+    #define LOOM_REALTIME_SCOPE() RealtimeScope LOOM_CONCAT(_RealtimeScope, __LINE__)(true)
+    #define LOOM_REALTIME_EXEMPT_SCOPE() RealtimeScope LOOM_CONCAT(_RealtimeScope, __LINE__)(false)
+#else
+    #define LOOM_REALTIME_SCOPE()
+    #define LOOM_REALTIME_EXEMPT_SCOPE()
+#endif
+
+namespace Loom
+{
+
+enum class RealtimeViolationKind
+{
+    Allocation,
+    Deallocation,
+    Lock,
+    BlockingCall
+};
+
+enum class RealtimeViolationMode
+{
+    // Violations are counted per call site, see GetViolations
+    Count,
+    // The first violation prints its call stack and stops the process
+    Trap
+};
+
+struct RealtimeViolation
+{
+    RealtimeViolation()
+        : kind(RealtimeViolationKind::Allocation)
+        , function(nullptr)
+        , count(0)
+    {
+    }
+
+    RealtimeViolationKind kind;
+    // Intercepted function, like malloc or pthread_mutex_lock
+    const char* function;
+    u64 count;
+    // Symbolized frames, the offender first
+    vector<string> callStack;
+};
+
+// Detects allocations, locks and blocking calls made from realtime scopes. Operator new and
+// delete are replaced, and on glibc malloc, pthread locks, sleeps and file io are
+// interposed. The mode is Count unless set otherwise, or LOOM_REALTIME_SANITIZER=trap is
+// found in the environment.
+class RealtimeSanitizer
+{
+public:
+    static constexpr u32 MaxCallSites = 256;
+    static constexpr u32 MaxFrames = 12;
+
+    // Whether the sanitizer is compiled in
+    static bool IsAvailable();
+    static void SetMode(RealtimeViolationMode mode);
+    static RealtimeViolationMode GetMode();
+    static bool IsRealtimeThread();
+
+    static u64 GetViolationCount();
+    static Result GetViolations(vector<RealtimeViolation>& violations);
+    static void PrintViolations();
+    static void Reset();
+
+    // Called by the interceptors
+    static void OnCall(RealtimeViolationKind kind, const char* function);
+};
+
+// Marks the calling thread as realtime for its lifetime, or exempts it within a realtime scope
+class RealtimeScope
+{
+public:
+    RealtimeScope(bool realtime);
+    ~RealtimeScope();
+
+private:
+    bool _Realtime;
+};
+
+const char* RealtimeViolationKindToString(RealtimeViolationKind kind);
+
+} // namespace Loom
@@ -27,6 +27,7 @@ const char* ResultToString(Result result)
         case Result::NotReady: return "Not Ready";
         case Result::Busy: return "Already Working";
         case Result::UnableToConnect: return "Unable To Connect";
+        case Result::Canceled: return "Canceled";
         case Result::Unknown: return "Unknown";
         default:
             return "No ResultToString conversion available";
@@ -40,6 +40,7 @@ enum class Result : u32
     InvalidParameter,
     InvalidState,
     NodeIsVirtual,
+    Canceled,
     Unknown = UINT32_MAX
 };
 
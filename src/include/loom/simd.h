@@ -0,0 +1,171 @@
+#pragma once
+
+#include "loom/types.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define LOOM_SIMD_SSE 1
+    #include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define LOOM_SIMD_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace Loom
+{
+
+// Four float lanes, SSE2 on x86, NEON on 64-bit ARM and plain arrays elsewhere
+struct FloatVector
+{
+    static constexpr u32 Lanes = 4;
+
+#if defined(LOOM_SIMD_SSE)
+    __m128 value;
+
+    FloatVector() = default;
+    FloatVector(__m128 value) : value(value) {}
+
+    static FloatVector Zero() { return _mm_setzero_ps(); }
+    static FloatVector Broadcast(float scalar) { return _mm_set1_ps(scalar); }
+    static FloatVector Set(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+    static FloatVector Load(const float* data) { return _mm_loadu_ps(data); }
+    void Store(float* data) const { _mm_storeu_ps(data, value); }
+
+    friend FloatVector operator+(FloatVector a, FloatVector b) { return _mm_add_ps(a.value, b.value); }
+    friend FloatVector operator-(FloatVector a, FloatVector b) { return _mm_sub_ps(a.value, b.value); }
+    friend FloatVector operator*(FloatVector a, FloatVector b) { return _mm_mul_ps(a.value, b.value); }
+    friend FloatVector operator/(FloatVector a, FloatVector b) { return _mm_div_ps(a.value, b.value); }
+
+    static FloatVector Sqrt(FloatVector a) { return _mm_sqrt_ps(a.value); }
+    static FloatVector Min(FloatVector a, FloatVector b) { return _mm_min_ps(a.value, b.value); }
+    static FloatVector Max(FloatVector a, FloatVector b) { return _mm_max_ps(a.value, b.value); }
+    // 1 in the lanes where a >= b, 0 elsewhere
+    static FloatVector IsGreaterEqual(FloatVector a, FloatVector b) { return _mm_and_ps(_mm_cmpge_ps(a.value, b.value), _mm_set1_ps(1.0f)); }
+
+    // Rows become columns
+    static void Transpose(FloatVector& a, FloatVector& b, FloatVector& c, FloatVector& d)
+    {
+        _MM_TRANSPOSE4_PS(a.value, b.value, c.value, d.value);
+    }
+
+    // Even and odd lanes of two consecutive vectors, like real and imaginary parts of complex values
+    static void Deinterleave(FloatVector low, FloatVector high, FloatVector& even, FloatVector& odd)
+    {
+        even = _mm_shuffle_ps(low.value, high.value, _MM_SHUFFLE(2, 0, 2, 0));
+        odd = _mm_shuffle_ps(low.value, high.value, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+
+    static void Interleave(FloatVector even, FloatVector odd, FloatVector& low, FloatVector& high)
+    {
+        low = _mm_unpacklo_ps(even.value, odd.value);
+        high = _mm_unpackhi_ps(even.value, odd.value);
+    }
+#elif defined(LOOM_SIMD_NEON)
+    float32x4_t value;
+
+    FloatVector() = default;
+    FloatVector(float32x4_t value) : value(value) {}
+
+    static FloatVector Zero() { return vdupq_n_f32(0.0f); }
+    static FloatVector Broadcast(float scalar) { return vdupq_n_f32(scalar); }
+    static FloatVector Set(float a, float b, float c, float d)
+    {
+        float lanes[Lanes] = {a, b, c, d};
+        return vld1q_f32(lanes);
+    }
+    static FloatVector Load(const float* data) { return vld1q_f32(data); }
+    void Store(float* data) const { vst1q_f32(data, value); }
+
+    friend FloatVector operator+(FloatVector a, FloatVector b) { return vaddq_f32(a.value, b.value); }
+    friend FloatVector operator-(FloatVector a, FloatVector b) { return vsubq_f32(a.value, b.value); }
+    friend FloatVector operator*(FloatVector a, FloatVector b) { return vmulq_f32(a.value, b.value); }
+    friend FloatVector operator/(FloatVector a, FloatVector b) { return vdivq_f32(a.value, b.value); }
+
+    static FloatVector Sqrt(FloatVector a) { return vsqrtq_f32(a.value); }
+    static FloatVector Min(FloatVector a, FloatVector b) { return vminq_f32(a.value, b.value); }
+    static FloatVector Max(FloatVector a, FloatVector b) { return vmaxq_f32(a.value, b.value); }
+    static FloatVector IsGreaterEqual(FloatVector a, FloatVector b)
+    {
+        return vreinterpretq_f32_u32(vandq_u32(vcgeq_f32(a.value, b.value), vreinterpretq_u32_f32(vdupq_n_f32(1.0f))));
+    }
+
+    static void Transpose(FloatVector& a, FloatVector& b, FloatVector& c, FloatVector& d)
+    {
+        float32x4x2_t ab = vtrnq_f32(a.value, b.value);
+        float32x4x2_t cd = vtrnq_f32(c.value, d.value);
+        a.value = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+        b.value = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+        c.value = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+        d.value = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+    }
+
+    static void Deinterleave(FloatVector low, FloatVector high, FloatVector& even, FloatVector& odd)
+    {
+        float32x4x2_t lanes = vuzpq_f32(low.value, high.value);
+        even.value = lanes.val[0];
+        odd.value = lanes.val[1];
+    }
+
+    static void Interleave(FloatVector even, FloatVector odd, FloatVector& low, FloatVector& high)
+    {
+        float32x4x2_t lanes = vzipq_f32(even.value, odd.value);
+        low.value = lanes.val[0];
+        high.value = lanes.val[1];
+    }
+#else
+    float value[Lanes];
+
+    static FloatVector Zero() { return Broadcast(0.0f); }
+    static FloatVector Broadcast(float scalar) { return Set(scalar, scalar, scalar, scalar); }
+    static FloatVector Set(float a, float b, float c, float d)
+    {
+        FloatVector result;
+        result.value[0] = a;
+        result.value[1] = b;
+        result.value[2] = c;
+        result.value[3] = d;
+        return result;
+    }
+    static FloatVector Load(const float* data) { return Set(data[0], data[1], data[2], data[3]); }
+    void Store(float* data) const
+    {
+        for (u32 i = 0; i < Lanes; ++i)
+            data[i] = value[i];
+    }
+
+    friend FloatVector operator+(FloatVector a, FloatVector b) { return Set(a.value[0] + b.value[0], a.value[1] + b.value[1], a.value[2] + b.value[2], a.value[3] + b.value[3]); }
+    friend FloatVector operator-(FloatVector a, FloatVector b) { return Set(a.value[0] - b.value[0], a.value[1] - b.value[1], a.value[2] - b.value[2], a.value[3] - b.value[3]); }
+    friend FloatVector operator*(FloatVector a, FloatVector b) { return Set(a.value[0] * b.value[0], a.value[1] * b.value[1], a.value[2] * b.value[2], a.value[3] * b.value[3]); }
+    friend FloatVector operator/(FloatVector a, FloatVector b) { return Set(a.value[0] / b.value[0], a.value[1] / b.value[1], a.value[2] / b.value[2], a.value[3] / b.value[3]); }
+
+    static FloatVector Sqrt(FloatVector a) { return Set(std::sqrt(a.value[0]), std::sqrt(a.value[1]), std::sqrt(a.value[2]), std::sqrt(a.value[3])); }
+    static FloatVector Min(FloatVector a, FloatVector b) { return Set(std::min(a.value[0], b.value[0]), std::min(a.value[1], b.value[1]), std::min(a.value[2], b.value[2]), std::min(a.value[3], b.value[3])); }
+    static FloatVector Max(FloatVector a, FloatVector b) { return Set(std::max(a.value[0], b.value[0]), std::max(a.value[1], b.value[1]), std::max(a.value[2], b.value[2]), std::max(a.value[3], b.value[3])); }
+    static FloatVector IsGreaterEqual(FloatVector a, FloatVector b)
+    {
+        return Set(a.value[0] >= b.value[0], a.value[1] >= b.value[1], a.value[2] >= b.value[2], a.value[3] >= b.value[3]);
+    }
+
+    static void Transpose(FloatVector& a, FloatVector& b, FloatVector& c, FloatVector& d)
+    {
+        FloatVector rows[Lanes] = {a, b, c, d};
+        a = Set(rows[0].value[0], rows[1].value[0], rows[2].value[0], rows[3].value[0]);
+        b = Set(rows[0].value[1], rows[1].value[1], rows[2].value[1], rows[3].value[1]);
+        c = Set(rows[0].value[2], rows[1].value[2], rows[2].value[2], rows[3].value[2]);
+        d = Set(rows[0].value[3], rows[1].value[3], rows[2].value[3], rows[3].value[3]);
+    }
+
+    static void Deinterleave(FloatVector low, FloatVector high, FloatVector& even, FloatVector& odd)
+    {
+        even = Set(low.value[0], low.value[2], high.value[0], high.value[2]);
+        odd = Set(low.value[1], low.value[3], high.value[1], high.value[3]);
+    }
+
+    static void Interleave(FloatVector even, FloatVector odd, FloatVector& low, FloatVector& high)
+    {
+        low = Set(even.value[0], odd.value[0], even.value[1], odd.value[1]);
+        high = Set(even.value[2], odd.value[2], even.value[3], odd.value[3]);
+    }
+#endif
+};
+
+} // namespace Loom
@@ -0,0 +1,331 @@
+#include "loom/soundbank.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Loom
+{
+
+namespace
+{
+
+u64 AlignOffset(u64 offset, u64 alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+bool RangeIsValid(u64 offset, u64 size, u64 fileSize)
+{
+    return offset <= fileSize && size <= fileSize - offset;
+}
+
+} // namespace
+
+u64 HashSoundName(const char* name)
+{
+    u64 hash = 14695981039346656037ull;
+    for (const char* c = name; *c != '\0'; ++c)
+    {
+        hash ^= static_cast<u8>(*c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+SoundBank::SoundBank(IAudioSystem& system, const char* filePath)
+    : _System(system)
+    , _FilePath(filePath)
+    , _Data(nullptr)
+    , _Size(0)
+    , _Header(nullptr)
+    , _Entries(nullptr)
+#if defined(_WIN32)
+    , _FileHandle(nullptr)
+    , _MappingHandle(nullptr)
+#endif
+{
+}
+
+SoundBank::~SoundBank()
+{
+    Unmap();
+}
+
+Result SoundBank::Open(IAudioSystem& system, const char* filePath, shared_ptr<SoundBank>& bank)
+{
+    if (filePath == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    shared_ptr<SoundBank> newBank(new SoundBank(system, filePath));
+    Result result = newBank->Map();
+    LOOM_CHECK_RESULT(result);
+    result = newBank->ValidateHeader();
+    LOOM_CHECK_RESULT(result);
+    newBank->_Header = reinterpret_cast<const SoundBankHeader*>(newBank->_Data);
+    newBank->_Entries = reinterpret_cast<const SoundBankEntry*>(newBank->_Data + newBank->_Header->indexOffset);
+    bank = newBank;
+    return Result::Ok;
+}
+
+const char* SoundBank::GetFilePath() const
+{
+    return _FilePath.c_str();
+}
+
+u32 SoundBank::GetAssetCount() const
+{
+    return _Header->entryCount;
+}
+
+bool SoundBank::Contains(const char* name) const
+{
+    return name != nullptr && FindEntry(name) != nullptr;
+}
+
+Result SoundBank::GetAsset(const char* name, shared_ptr<AudioAsset>& asset)
+{
+    if (name == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    const SoundBankEntry* entry = FindEntry(name);
+    if (entry == nullptr)
+        LOOM_RETURN_RESULT(Result::CannotFind);
+    scoped_lock lock(_Mutex);
+    asset = _Assets[entry].lock();
+    if (asset != nullptr)
+        return Result::Ok;
+    Result result = CreateAsset(*entry, asset);
+    LOOM_CHECK_RESULT(result);
+    _Assets[entry] = asset;
+    return Result::Ok;
+}
+
+Result SoundBank::Map()
+{
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(_FilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    _FileHandle = file;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    _MappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_MappingHandle == nullptr)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    void* data = MapViewOfFile(_MappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    _Data = static_cast<const u8*>(data);
+    _Size = static_cast<u64>(fileSize.QuadPart);
+#else
+    int file = open(_FilePath.c_str(), O_RDONLY);
+    if (file < 0)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    struct stat fileStat;
+    if (fstat(file, &fileStat) != 0 || fileStat.st_size <= 0)
+    {
+        close(file);
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    }
+    void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping outlives the descriptor
+    close(file);
+    if (data == MAP_FAILED)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    _Data = static_cast<const u8*>(data);
+    _Size = static_cast<u64>(fileStat.st_size);
+#endif
+    return Result::Ok;
+}
+
+void SoundBank::Unmap()
+{
+#if defined(_WIN32)
+    if (_Data != nullptr)
+        UnmapViewOfFile(_Data);
+    if (_MappingHandle != nullptr)
+        CloseHandle(_MappingHandle);
+    if (_FileHandle != nullptr)
+        CloseHandle(_FileHandle);
+    _MappingHandle = nullptr;
+    _FileHandle = nullptr;
+#else
+    if (_Data != nullptr)
+        munmap(const_cast<u8*>(_Data), static_cast<size_t>(_Size));
+#endif
+    _Data = nullptr;
+    _Size = 0;
+    _Header = nullptr;
+    _Entries = nullptr;
+}
+
+Result SoundBank::ValidateHeader() const
+{
+    if (_Size < sizeof(SoundBankHeader))
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    const SoundBankHeader* header = reinterpret_cast<const SoundBankHeader*>(_Data);
+    if (memcmp(header->magic, SoundBankMagic, sizeof(SoundBankMagic)) != 0 || header->fileSize != _Size)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    if (header->version != SoundBankVersion)
+        LOOM_RETURN_RESULT(Result::UnsupportedFormat);
+    if (header->indexOffset % alignof(SoundBankEntry) != 0
+        || !RangeIsValid(header->indexOffset, static_cast<u64>(header->entryCount) * sizeof(SoundBankEntry), _Size)
+        || !RangeIsValid(header->namesOffset, header->namesSize, _Size))
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    return Result::Ok;
+}
+
+const SoundBankEntry* SoundBank::FindEntry(const char* name) const
+{
+    u64 hash = HashSoundName(name);
+    size_t nameSize = strlen(name);
+    const SoundBankEntry* end = _Entries + _Header->entryCount;
+    const SoundBankEntry* entry = std::lower_bound(_Entries, end, hash, [](const SoundBankEntry& entry, u64 hash)
+    {
+        return entry.nameHash < hash;
+    });
+    // Entries sharing a hash are adjacent, names resolve collisions
+    for (; entry != end && entry->nameHash == hash; ++entry)
+    {
+        if (entry->nameSize != nameSize || static_cast<u64>(entry->nameOffset) + nameSize > _Header->namesSize)
+            continue;
+        if (memcmp(_Data + _Header->namesOffset + entry->nameOffset, name, nameSize) == 0)
+            return entry;
+    }
+    return nullptr;
+}
+
+Result SoundBank::CreateAsset(const SoundBankEntry& entry, shared_ptr<AudioAsset>& asset)
+{
+    if (!RangeIsValid(entry.dataOffset, entry.dataSize, _Size) || entry.dataSize > UINT32_MAX)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    AudioAssetData data;
+    data.format.channels = entry.channels;
+    data.format.frameRate = entry.frameRate;
+    data.format.sampleFormat = static_cast<SampleFormat>(entry.sampleFormat);
+    data.frameCount = entry.frameCount;
+    data.encoding = static_cast<SampleEncoding>(entry.encoding);
+    data.blockFrames = entry.blockFrames;
+    if (data.format.GetFrameSize() == 0)
+        LOOM_RETURN_RESULT(Result::UnsupportedFormat);
+    if (data.encoding == SampleEncoding::Pcm)
+    {
+        if (entry.dataSize < static_cast<u64>(entry.frameCount) * data.format.GetFrameSize())
+            LOOM_RETURN_RESULT(Result::InvalidFile);
+    }
+    else
+    {
+        u64 blockOffsetsSize = (static_cast<u64>(data.GetBlockCount()) + 1) * sizeof(u32);
+        if (data.blockFrames == 0 || entry.blockOffsetsOffset % alignof(u32) != 0 || !RangeIsValid(entry.blockOffsetsOffset, blockOffsetsSize, _Size))
+            LOOM_RETURN_RESULT(Result::InvalidFile);
+        data.mappedBlockOffsets = reinterpret_cast<const u32*>(_Data + entry.blockOffsetsOffset);
+    }
+    data.mappedSamples = _Data + entry.dataOffset;
+    data.mappedSampleSize = entry.dataSize;
+    data.mapping = shared_from_this();
+
+    string name(reinterpret_cast<const char*>(_Data + _Header->namesOffset + entry.nameOffset), entry.nameSize);
+    asset.reset(new AudioAsset(_System, name.c_str(), _FilePath.c_str(), AudioAssetStorage::Mapped));
+    asset->SetData(std::move(data));
+    asset->SetState(AudioAssetState::Loaded);
+    return Result::Ok;
+}
+
+Result SoundBankWriter::AddAsset(const char* name, AudioAssetData&& data)
+{
+    if (name == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    if (data.IsMapped() || data.format.GetFrameSize() == 0)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    if (!_Names.insert(name).second)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    _Assets.push_back({name, HashSoundName(name), std::move(data)});
+    return Result::Ok;
+}
+
+Result SoundBankWriter::Write(const char* filePath) const
+{
+    if (filePath == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    vector<const PendingAsset*> assets;
+    for (const PendingAsset& asset : _Assets)
+        assets.push_back(&asset);
+    std::stable_sort(assets.begin(), assets.end(), [](const PendingAsset* a, const PendingAsset* b)
+    {
+        return a->nameHash < b->nameHash;
+    });
+
+    SoundBankHeader header = {};
+    memcpy(header.magic, SoundBankMagic, sizeof(SoundBankMagic));
+    header.version = SoundBankVersion;
+    header.entryCount = static_cast<u32>(assets.size());
+    header.indexOffset = sizeof(SoundBankHeader);
+    header.namesOffset = header.indexOffset + assets.size() * sizeof(SoundBankEntry);
+
+    vector<SoundBankEntry> entries(assets.size());
+    string names;
+    for (size_t i = 0; i < assets.size(); ++i)
+    {
+        entries[i].nameHash = assets[i]->nameHash;
+        entries[i].nameOffset = static_cast<u32>(names.size());
+        entries[i].nameSize = static_cast<u32>(assets[i]->name.size());
+        names += assets[i]->name;
+    }
+    header.namesSize = names.size();
+
+    u64 offset = header.namesOffset + header.namesSize;
+    for (size_t i = 0; i < assets.size(); ++i)
+    {
+        const AudioAssetData& data = assets[i]->data;
+        SoundBankEntry& entry = entries[i];
+        offset = AlignOffset(offset, SoundBankAlignment);
+        entry.dataOffset = offset;
+        entry.dataSize = data.samples.size();
+        offset += entry.dataSize;
+        if (data.encoding != SampleEncoding::Pcm)
+        {
+            if (data.blockOffsets.size() != static_cast<size_t>(data.GetBlockCount()) + 1)
+                LOOM_RETURN_RESULT(Result::InvalidParameter);
+            offset = AlignOffset(offset, alignof(u32));
+            entry.blockOffsetsOffset = offset;
+            offset += data.blockOffsets.size() * sizeof(u32);
+        }
+        entry.frameCount = data.frameCount;
+        entry.frameRate = data.format.frameRate;
+        entry.channels = data.format.channels;
+        entry.sampleFormat = static_cast<u32>(data.format.sampleFormat);
+        entry.encoding = static_cast<u32>(data.encoding);
+        entry.blockFrames = data.blockFrames;
+        entry.duration = data.format.frameRate > 0 ? static_cast<float>(data.frameCount) / data.format.frameRate : 0.0f;
+    }
+    header.fileSize = offset;
+
+    FILE* file = fopen(filePath, "wb");
+    if (file == nullptr)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    vector<u8> bytes(static_cast<size_t>(header.fileSize), 0);
+    memcpy(bytes.data(), &header, sizeof(header));
+    memcpy(bytes.data() + header.indexOffset, entries.data(), entries.size() * sizeof(SoundBankEntry));
+    memcpy(bytes.data() + header.namesOffset, names.data(), names.size());
+    for (size_t i = 0; i < assets.size(); ++i)
+    {
+        const AudioAssetData& data = assets[i]->data;
+        memcpy(bytes.data() + entries[i].dataOffset, data.samples.data(), data.samples.size());
+        if (entries[i].blockOffsetsOffset != 0)
+            memcpy(bytes.data() + entries[i].blockOffsetsOffset, data.blockOffsets.data(), data.blockOffsets.size() * sizeof(u32));
+    }
+    bool written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    written = fclose(file) == 0 && written;
+    if (!written)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    return Result::Ok;
+}
+
+} // namespace Loom
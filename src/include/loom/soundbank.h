@@ -0,0 +1,110 @@
+#pragma once
+
+#include "loom/audioasset.h"
+
+namespace Loom
+{
+
+// Sound bank layout, all values little endian:
+// [header][index entries sorted by name hash][names][payloads aligned to SoundBankAlignment]
+// Each payload holds the asset samples, followed for encoded assets by its block offsets table.
+constexpr char SoundBankMagic[4] = {'L', 'M', 'B', 'K'};
+constexpr u32 SoundBankVersion = 1;
+constexpr u64 SoundBankAlignment = 64;
+
+struct SoundBankHeader
+{
+    char magic[4];
+    u32 version;
+    u32 entryCount;
+    u32 reserved;
+    u64 indexOffset;
+    u64 namesOffset;
+    u64 namesSize;
+    u64 fileSize;
+};
+
+struct SoundBankEntry
+{
+    u64 nameHash;
+    u32 nameOffset;
+    u32 nameSize;
+    u64 dataOffset;
+    u64 dataSize;
+    // Zero for PCM assets
+    u64 blockOffsetsOffset;
+    u32 frameCount;
+    u32 frameRate;
+    u32 channels;
+    u32 sampleFormat;
+    u32 encoding;
+    u32 blockFrames;
+    float duration;
+    u32 reserved;
+};
+
+static_assert(sizeof(SoundBankHeader) == 48, "SoundBankHeader layout is part of the file format");
+static_assert(sizeof(SoundBankEntry) == 72, "SoundBankEntry layout is part of the file format");
+
+// FNV-1a hash of an asset name
+u64 HashSoundName(const char* name);
+
+// Bank file mapped in memory in one go.
+// Assets are created on first request as views into the mapping, which stays
+// mapped for as long as one of them is alive.
+class SoundBank : public enable_shared_from_this<SoundBank>
+{
+public:
+    static Result Open(IAudioSystem& system, const char* filePath, shared_ptr<SoundBank>& bank);
+    ~SoundBank();
+    SoundBank(const SoundBank&) = delete;
+    SoundBank& operator=(const SoundBank&) = delete;
+
+    const char* GetFilePath() const;
+    u32 GetAssetCount() const;
+    bool Contains(const char* name) const;
+    Result GetAsset(const char* name, shared_ptr<AudioAsset>& asset);
+
+private:
+    SoundBank(IAudioSystem& system, const char* filePath);
+    Result Map();
+    void Unmap();
+    Result ValidateHeader() const;
+    const SoundBankEntry* FindEntry(const char* name) const;
+    Result CreateAsset(const SoundBankEntry& entry, shared_ptr<AudioAsset>& asset);
+
+private:
+    IAudioSystem& _System;
+    string _FilePath;
+    const u8* _Data;
+    u64 _Size;
+    const SoundBankHeader* _Header;
+    const SoundBankEntry* _Entries;
+#if defined(_WIN32)
+    void* _FileHandle;
+    void* _MappingHandle;
+#endif
+    mutex _Mutex;
+    map<const SoundBankEntry*, weak_ptr<AudioAsset>> _Assets;
+};
+
+// Builds bank files, see the bankbuilder tool
+class SoundBankWriter
+{
+public:
+    Result AddAsset(const char* name, AudioAssetData&& data);
+    Result Write(const char* filePath) const;
+
+private:
+    struct PendingAsset
+    {
+        string name;
+        u64 nameHash;
+        AudioAssetData data;
+    };
+
+    vector<PendingAsset> _Assets;
+    set<string> _Names;
+};
+
+} // namespace Loom
@@ -0,0 +1,325 @@
+#include "loom/spatializer.h"
+#include "loom/simd.h"
+
+namespace Loom
+{
+
+namespace
+{
+
+constexpr u32 Lanes = FloatVector::Lanes;
+constexpr float Epsilon = 1e-6f;
+
+struct Speaker
+{
+    u32 channel;
+    // Degrees, 0 in front and positive to the right
+    float azimuth;
+};
+
+u32 GetSpeakers(SpeakerLayout layout, vector<Speaker>& speakers)
+{
+    switch (layout)
+    {
+        case SpeakerLayout::Quad:
+            speakers = {{0, -45.0f}, {1, 45.0f}, {2, -135.0f}, {3, 135.0f}};
+            return 4;
+        case SpeakerLayout::Surround51:
+            speakers = {{0, -30.0f}, {1, 30.0f}, {2, 0.0f}, {4, -110.0f}, {5, 110.0f}};
+            return 6;
+        case SpeakerLayout::Surround71:
+            speakers = {{0, -30.0f}, {1, 30.0f}, {2, 0.0f}, {4, -150.0f}, {5, 150.0f}, {6, -90.0f}, {7, 90.0f}};
+            return 8;
+        case SpeakerLayout::Stereo:
+        default:
+            speakers = {{0, -30.0f}, {1, 30.0f}};
+            return 2;
+    }
+}
+
+// Only the lanes of the updated sources are written
+void StoreLanes(FloatVector value, float* destination, u32 lanes)
+{
+    if (lanes == Lanes)
+    {
+        value.Store(destination);
+        return;
+    }
+    float values[Lanes];
+    value.Store(values);
+    std::copy_n(values, lanes, destination);
+}
+
+} // namespace
+
+Spatializer::Spatializer(u32 sourceCapacity, SpeakerLayout layout)
+    : _SourceCapacity(sourceCapacity)
+    , _PaddedCapacity((sourceCapacity + Lanes - 1) / Lanes * Lanes)
+    , _Channels(0)
+    , _Stereo(layout == SpeakerLayout::Stereo)
+    , _ListenerPosition({0.0f, 0.0f, 0.0f})
+    , _ListenerVelocity({0.0f, 0.0f, 0.0f})
+    , _ListenerRight({1.0f, 0.0f, 0.0f})
+    , _ListenerForward({0.0f, 0.0f, 1.0f})
+{
+    vector<Speaker> speakers;
+    _Channels = GetSpeakers(layout, speakers);
+    if (!_Stereo)
+    {
+        // Neighbouring speakers around the listener form the pairs
+        std::sort(speakers.begin(), speakers.end(), [](const Speaker& a, const Speaker& b) { return a.azimuth < b.azimuth; });
+        constexpr double Pi = 3.14159265358979323846;
+        for (size_t i = 0; i < speakers.size(); ++i)
+        {
+            const Speaker& first = speakers[i];
+            const Speaker& second = speakers[(i + 1) % speakers.size()];
+            double firstX = std::sin(first.azimuth * Pi / 180.0);
+            double firstZ = std::cos(first.azimuth * Pi / 180.0);
+            double secondX = std::sin(second.azimuth * Pi / 180.0);
+            double secondZ = std::cos(second.azimuth * Pi / 180.0);
+            double determinant = firstX * secondZ - secondX * firstZ;
+            SpeakerPair pair;
+            pair.first = first.channel;
+            pair.second = second.channel;
+            pair.inverse[0] = static_cast<float>(secondZ / determinant);
+            pair.inverse[1] = static_cast<float>(-secondX / determinant);
+            pair.inverse[2] = static_cast<float>(-firstZ / determinant);
+            pair.inverse[3] = static_cast<float>(firstX / determinant);
+            _SpeakerPairs.push_back(pair);
+        }
+    }
+
+    // Whole lane groups, the padding sources sit at the listener and are never read back
+    _PositionX.assign(_PaddedCapacity, 0.0f);
+    _PositionY.assign(_PaddedCapacity, 0.0f);
+    _PositionZ.assign(_PaddedCapacity, 0.0f);
+    _VelocityX.assign(_PaddedCapacity, 0.0f);
+    _VelocityY.assign(_PaddedCapacity, 0.0f);
+    _VelocityZ.assign(_PaddedCapacity, 0.0f);
+    _MinDistance.assign(_PaddedCapacity, 1.0f);
+    _MaxDistance.assign(_PaddedCapacity, 100.0f);
+    _Rolloff.assign(_PaddedCapacity, 1.0f);
+    _InverseWeight.assign(_PaddedCapacity, 1.0f);
+    _LinearWeight.assign(_PaddedCapacity, 0.0f);
+    _Attenuation.assign(_PaddedCapacity, 1.0f);
+    _DopplerRatio.assign(_PaddedCapacity, 1.0f);
+    _Gains.assign(_Channels * _PaddedCapacity, 0.0f);
+    _PreviousGains.assign(_Channels * _PaddedCapacity, 0.0f);
+}
+
+u32 Spatializer::GetSourceCapacity() const
+{
+    return _SourceCapacity;
+}
+
+u32 Spatializer::GetChannels() const
+{
+    return _Channels;
+}
+
+void Spatializer::SetListener(const Transform& transform, const Vector3& velocity)
+{
+    _ListenerPosition = transform.point;
+    _ListenerVelocity = velocity;
+    Quaternion q = transform.rotation;
+    float norm = std::sqrt(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+    if (norm < Epsilon)
+        q = {1.0f, 0.0f, 0.0f, 0.0f};
+    else
+        q = {q.w / norm, q.x / norm, q.y / norm, q.z / norm};
+    // First and third columns of the rotation matrix, listener space is reached with the transpose
+    _ListenerRight = {1.0f - 2.0f * (q.y * q.y + q.z * q.z), 2.0f * (q.x * q.y + q.w * q.z), 2.0f * (q.x * q.z - q.w * q.y)};
+    _ListenerForward = {2.0f * (q.x * q.z + q.w * q.y), 2.0f * (q.y * q.z - q.w * q.x), 1.0f - 2.0f * (q.x * q.x + q.y * q.y)};
+}
+
+Result Spatializer::SetSourcePosition(u32 source, const Vector3& position, const Vector3& velocity)
+{
+    if (source >= _SourceCapacity)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    _PositionX[source] = position.x;
+    _PositionY[source] = position.y;
+    _PositionZ[source] = position.z;
+    _VelocityX[source] = velocity.x;
+    _VelocityY[source] = velocity.y;
+    _VelocityZ[source] = velocity.z;
+    return Result::Ok;
+}
+
+Result Spatializer::SetSourceAttenuation(u32 source, DistanceModel model, float minDistance, float maxDistance, float rolloff)
+{
+    if (source >= _SourceCapacity || minDistance <= 0.0f || maxDistance <= minDistance || rolloff < 0.0f)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    _MinDistance[source] = minDistance;
+    _MaxDistance[source] = maxDistance;
+    _Rolloff[source] = rolloff;
+    _InverseWeight[source] = model == DistanceModel::Inverse ? 1.0f : 0.0f;
+    _LinearWeight[source] = model == DistanceModel::Linear ? 1.0f : 0.0f;
+    return Result::Ok;
+}
+
+Result Spatializer::Update(u32 sourceCount)
+{
+    if (sourceCount > _SourceCapacity)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    for (u32 channel = 0; channel < _Channels; ++channel)
+        std::copy_n(&_Gains[channel * _PaddedCapacity], sourceCount, &_PreviousGains[channel * _PaddedCapacity]);
+
+    const FloatVector zero = FloatVector::Zero();
+    const FloatVector one = FloatVector::Broadcast(1.0f);
+    const FloatVector half = FloatVector::Broadcast(0.5f);
+    const FloatVector epsilon = FloatVector::Broadcast(Epsilon);
+    const FloatVector speedOfSound = FloatVector::Broadcast(SpeedOfSound);
+    for (u32 first = 0; first < sourceCount; first += Lanes)
+    {
+        u32 lanes = std::min(Lanes, sourceCount - first);
+        FloatVector x = FloatVector::Load(&_PositionX[first]) - FloatVector::Broadcast(_ListenerPosition.x);
+        FloatVector y = FloatVector::Load(&_PositionY[first]) - FloatVector::Broadcast(_ListenerPosition.y);
+        FloatVector z = FloatVector::Load(&_PositionZ[first]) - FloatVector::Broadcast(_ListenerPosition.z);
+        FloatVector distance = FloatVector::Sqrt(x * x + y * y + z * z);
+
+        // Speeds along the direction from the listener to the source, a source at the listener has no Doppler shift
+        FloatVector inverseDistance = one / FloatVector::Max(distance, epsilon);
+        FloatVector directionX = x * inverseDistance;
+        FloatVector directionY = y * inverseDistance;
+        FloatVector directionZ = z * inverseDistance;
+        FloatVector listenerSpeed = FloatVector::Broadcast(_ListenerVelocity.x) * directionX + FloatVector::Broadcast(_ListenerVelocity.y) * directionY + FloatVector::Broadcast(_ListenerVelocity.z) * directionZ;
+        FloatVector sourceSpeed = FloatVector::Load(&_VelocityX[first]) * directionX + FloatVector::Load(&_VelocityY[first]) * directionY + FloatVector::Load(&_VelocityZ[first]) * directionZ;
+        FloatVector doppler = (speedOfSound + listenerSpeed) / FloatVector::Max(speedOfSound + sourceSpeed, speedOfSound * FloatVector::Broadcast(MinDopplerRatio));
+        doppler = FloatVector::Min(FloatVector::Max(doppler, FloatVector::Broadcast(MinDopplerRatio)), FloatVector::Broadcast(MaxDopplerRatio));
+        StoreLanes(doppler, &_DopplerRatio[first], lanes);
+
+        FloatVector minDistance = FloatVector::Load(&_MinDistance[first]);
+        FloatVector maxDistance = FloatVector::Load(&_MaxDistance[first]);
+        FloatVector rolloff = FloatVector::Load(&_Rolloff[first]);
+        FloatVector inverseWeight = FloatVector::Load(&_InverseWeight[first]);
+        FloatVector linearWeight = FloatVector::Load(&_LinearWeight[first]);
+        FloatVector excess = FloatVector::Min(FloatVector::Max(distance, minDistance), maxDistance) - minDistance;
+        FloatVector inverse = minDistance / (minDistance + rolloff * excess);
+        FloatVector linear = FloatVector::Max(zero, one - rolloff * excess / (maxDistance - minDistance));
+        FloatVector attenuation = inverseWeight * inverse + linearWeight * linear + (one - inverseWeight - linearWeight);
+        StoreLanes(attenuation, &_Attenuation[first], lanes);
+
+        // Horizontal direction in listener space, pointing forward when the source is straight above, below or at the listener
+        FloatVector right = FloatVector::Broadcast(_ListenerRight.x) * x + FloatVector::Broadcast(_ListenerRight.y) * y + FloatVector::Broadcast(_ListenerRight.z) * z;
+        FloatVector forward = FloatVector::Broadcast(_ListenerForward.x) * x + FloatVector::Broadcast(_ListenerForward.y) * y + FloatVector::Broadcast(_ListenerForward.z) * z;
+        FloatVector horizontal = FloatVector::Sqrt(right * right + forward * forward);
+        FloatVector clampedHorizontal = FloatVector::Max(horizontal, epsilon);
+        FloatVector panX = right / clampedHorizontal;
+        FloatVector panZ = (forward + clampedHorizontal - horizontal) / clampedHorizontal;
+
+        if (_Stereo)
+        {
+            // sqrt((1 -+ x) / 2), the squares of the two gains sum to one
+            FloatVector left = FloatVector::Sqrt(FloatVector::Max(zero, half - half * panX));
+            FloatVector rightGain = FloatVector::Sqrt(FloatVector::Max(zero, half + half * panX));
+            StoreLanes(left * attenuation, &_Gains[first], lanes);
+            StoreLanes(rightGain * attenuation, &_Gains[_PaddedCapacity + first], lanes);
+            continue;
+        }
+
+        FloatVector gains[MaxChannels];
+        for (u32 channel = 0; channel < _Channels; ++channel)
+            gains[channel] = zero;
+        // The pair around the direction is the one whose gains are both positive. On a speaker both
+        // neighbouring pairs contribute the same single gain, which the normalization below removes.
+        const FloatVector tolerance = FloatVector::Broadcast(-1e-4f);
+        for (const SpeakerPair& pair : _SpeakerPairs)
+        {
+            FloatVector firstGain = FloatVector::Broadcast(pair.inverse[0]) * panX + FloatVector::Broadcast(pair.inverse[1]) * panZ;
+            FloatVector secondGain = FloatVector::Broadcast(pair.inverse[2]) * panX + FloatVector::Broadcast(pair.inverse[3]) * panZ;
+            FloatVector inside = FloatVector::IsGreaterEqual(FloatVector::Min(firstGain, secondGain), tolerance);
+            gains[pair.first] = gains[pair.first] + inside * FloatVector::Max(firstGain, zero);
+            gains[pair.second] = gains[pair.second] + inside * FloatVector::Max(secondGain, zero);
+        }
+        FloatVector power = zero;
+        for (u32 channel = 0; channel < _Channels; ++channel)
+            power = power + gains[channel] * gains[channel];
+        FloatVector scale = attenuation / FloatVector::Sqrt(FloatVector::Max(power, epsilon));
+        for (u32 channel = 0; channel < _Channels; ++channel)
+            StoreLanes(gains[channel] * scale, &_Gains[channel * _PaddedCapacity + first], lanes);
+    }
+    return Result::Ok;
+}
+
+float Spatializer::GetGain(u32 source, u32 channel) const
+{
+    if (source >= _SourceCapacity || channel >= _Channels)
+        return 0.0f;
+    return _Gains[channel * _PaddedCapacity + source];
+}
+
+float Spatializer::GetAttenuation(u32 source) const
+{
+    return source < _SourceCapacity ? _Attenuation[source] : 0.0f;
+}
+
+float Spatializer::GetDopplerRatio(u32 source) const
+{
+    return source < _SourceCapacity ? _DopplerRatio[source] : 1.0f;
+}
+
+Result Spatializer::Mix(u32 source, const float* input, u32 frames, float* output) const
+{
+    if (input == nullptr || output == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    if (source >= _SourceCapacity)
+        LOOM_RETURN_RESULT(Result::InvalidParameter);
+    if (frames == 0)
+        return Result::Ok;
+    // The gain of a frame is the previous gain plus its index plus one times the step, the last frame reaching the current gain
+    float gains[MaxChannels];
+    float steps[MaxChannels];
+    for (u32 channel = 0; channel < _Channels; ++channel)
+    {
+        gains[channel] = _PreviousGains[channel * _PaddedCapacity + source];
+        steps[channel] = (_Gains[channel * _PaddedCapacity + source] - gains[channel]) / frames;
+    }
+    u32 frame = 0;
+    if (_Stereo)
+    {
+        // Four frames per vector, interleaved back into the output
+        FloatVector index = FloatVector::Set(1.0f, 2.0f, 3.0f, 4.0f);
+        const FloatVector indexStep = FloatVector::Broadcast(static_cast<float>(Lanes));
+        const FloatVector leftGain = FloatVector::Broadcast(gains[0]);
+        const FloatVector leftStep = FloatVector::Broadcast(steps[0]);
+        const FloatVector rightGain = FloatVector::Broadcast(gains[1]);
+        const FloatVector rightStep = FloatVector::Broadcast(steps[1]);
+        for (; frame + Lanes <= frames; frame += Lanes)
+        {
+            FloatVector samples = FloatVector::Load(input + frame);
+            FloatVector low;
+            FloatVector high;
+            FloatVector::Interleave(samples * (leftGain + index * leftStep), samples * (rightGain + index * rightStep), low, high);
+            float* frameOutput = output + frame * 2;
+            (FloatVector::Load(frameOutput) + low).Store(frameOutput);
+            (FloatVector::Load(frameOutput + Lanes) + high).Store(frameOutput + Lanes);
+            index = index + indexStep;
+        }
+    }
+    else
+    {
+        // Four channels per vector, the surround layouts having at least four
+        for (; frame < frames; ++frame)
+        {
+            float* frameOutput = output + frame * _Channels;
+            FloatVector sample = FloatVector::Broadcast(input[frame]);
+            FloatVector index = FloatVector::Broadcast(static_cast<float>(frame + 1));
+            u32 channel = 0;
+            for (; channel + Lanes <= _Channels; channel += Lanes)
+            {
+                FloatVector channelGains = FloatVector::Load(gains + channel) + index * FloatVector::Load(steps + channel);
+                (FloatVector::Load(frameOutput + channel) + sample * channelGains).Store(frameOutput + channel);
+            }
+            for (; channel < _Channels; ++channel)
+                frameOutput[channel] += input[frame] * (gains[channel] + static_cast<float>(frame + 1) * steps[channel]);
+        }
+    }
+    for (; frame < frames; ++frame)
+    {
+        for (u32 channel = 0; channel < _Channels; ++channel)
+            output[frame * _Channels + channel] += input[frame] * (gains[channel] + static_cast<float>(frame + 1) * steps[channel]);
+    }
+    return Result::Ok;
+}
+
+} // namespace Loom
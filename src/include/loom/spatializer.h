@@ -0,0 +1,98 @@
+#pragma once
+
+#include "loom/defines.h"
+#include "loom/types.h"
+#include "loom/result.h"
+
+namespace Loom
+{
+
+enum class DistanceModel : u32
+{
+    None,
+    // minDistance / (minDistance + rolloff * (distance - minDistance))
+    Inverse,
+    // 1 - rolloff * (distance - minDistance) / (maxDistance - minDistance)
+    Linear
+};
+
+// Channels in the WAVE order, the LFE channel of the surround layouts gets no gain
+enum class SpeakerLayout : u32
+{
+    Stereo,
+    Quad,
+    Surround51,
+    Surround71
+};
+
+// Computes the channel gains, the distance attenuation and the Doppler pitch ratio of many
+// sources relative to one listener in a single pass, four sources per SIMD vector. Positions
+// and settings are stored as arrays per component, and no trigonometry runs per source:
+// stereo pans with an equal-power law on the lateral part of the direction, the other layouts
+// with pair-wise VBAP over inverse speaker matrices computed once. Elevation is ignored by the
+// panning. In listener space +X is right, +Y up and +Z forward.
+class Spatializer
+{
+public:
+    static constexpr u32 MaxChannels = 8;
+    static constexpr float SpeedOfSound = 343.0f;
+    static constexpr float MinDopplerRatio = 0.5f;
+    static constexpr float MaxDopplerRatio = 2.0f;
+
+    Spatializer(u32 sourceCapacity, SpeakerLayout layout = SpeakerLayout::Stereo);
+
+    u32 GetSourceCapacity() const;
+    u32 GetChannels() const;
+    void SetListener(const Transform& transform, const Vector3& velocity);
+    Result SetSourcePosition(u32 source, const Vector3& position, const Vector3& velocity);
+    Result SetSourceAttenuation(u32 source, DistanceModel model, float minDistance, float maxDistance, float rolloff = 1.0f);
+    // Updates the first sourceCount sources, their previous gains are kept for the ramps of Mix
+    Result Update(u32 sourceCount);
+
+    // Panning gain times the distance attenuation
+    float GetGain(u32 source, u32 channel) const;
+    float GetAttenuation(u32 source) const;
+    float GetDopplerRatio(u32 source) const;
+    // Adds the mono frames of a source to interleaved output frames, ramping from the previous to the current gains
+    Result Mix(u32 source, const float* input, u32 frames, float* output) const;
+
+private:
+    struct SpeakerPair
+    {
+        u32 first;
+        u32 second;
+        // Maps a horizontal direction to the gains of the two speakers
+        float inverse[4];
+    };
+
+private:
+    u32 _SourceCapacity;
+    u32 _PaddedCapacity;
+    u32 _Channels;
+    bool _Stereo;
+    vector<SpeakerPair> _SpeakerPairs;
+    Vector3 _ListenerPosition;
+    Vector3 _ListenerVelocity;
+    // World directions of the listener axes
+    Vector3 _ListenerRight;
+    Vector3 _ListenerForward;
+    vector<float> _PositionX;
+    vector<float> _PositionY;
+    vector<float> _PositionZ;
+    vector<float> _VelocityX;
+    vector<float> _VelocityY;
+    vector<float> _VelocityZ;
+    vector<float> _MinDistance;
+    vector<float> _MaxDistance;
+    vector<float> _Rolloff;
+    // Blend of the distance models, 1 for the model of the source and 0 for the others
+    vector<float> _InverseWeight;
+    vector<float> _LinearWeight;
+    vector<float> _Attenuation;
+    vector<float> _DopplerRatio;
+    // Channel after channel, each holding the padded capacity of sources
+    vector<float> _Gains;
+    vector<float> _PreviousGains;
+};
+
+} // namespace Loom
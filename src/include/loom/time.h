@@ -9,12 +9,12 @@ namespace Loom
 
 constexpr u64 NanosecondsPerSecond = 1000000000;
 
-u64 Now()
+inline u64 Now()
 {
     return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
 }
 
-u64 SecondsToNanoseconds(double seconds)
+inline u64 SecondsToNanoseconds(double seconds)
 {
     return static_cast<u64>(seconds / 1000000000.0);
 }
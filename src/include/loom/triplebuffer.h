@@ -0,0 +1,67 @@
+#pragma once
+
+#include "loom/types.h"
+
+namespace Loom
+{
+
+// Lock-free exchange of the latest value between one writer and one reader thread.
+// The writer fills its buffer and publishes it by swapping it with the middle buffer,
+// the reader swaps the middle buffer with its own when a newer one was published.
+// Neither side waits, and values too large for an atomic are never torn.
+template <class T>
+class TripleBuffer
+{
+public:
+    TripleBuffer()
+        : _WriteIndex(0)
+        , _MiddleIndex(1)
+        , _ReadIndex(2)
+    {
+    }
+
+    // Sizes the three buffers, before the writer and the reader start
+    void Reset(const T& value)
+    {
+        for (T& buffer : _Buffers)
+            buffer = value;
+        _WriteIndex = 0;
+        _MiddleIndex = 1;
+        _ReadIndex = 2;
+    }
+
+    T& GetWriteBuffer()
+    {
+        return _Buffers[_WriteIndex];
+    }
+
+    void Publish()
+    {
+        _WriteIndex = _MiddleIndex.exchange(_WriteIndex | FreshFlag, std::memory_order_acq_rel) & IndexMask;
+    }
+
+    // Whether a newer buffer was published since the last update
+    bool Update()
+    {
+        if ((_MiddleIndex.load(std::memory_order_relaxed) & FreshFlag) == 0)
+            return false;
+        _ReadIndex = _MiddleIndex.exchange(_ReadIndex, std::memory_order_acq_rel) & IndexMask;
+        return true;
+    }
+
+    const T& GetReadBuffer() const
+    {
+        return _Buffers[_ReadIndex];
+    }
+
+private:
+    static constexpr u32 IndexMask = 3;
+    static constexpr u32 FreshFlag = 4;
+
+    T _Buffers[3];
+    u32 _WriteIndex;
+    atomic<u32> _MiddleIndex;
+    u32 _ReadIndex;
+};
+
+} // namespace Loom
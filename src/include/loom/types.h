@@ -2,12 +2,17 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
 #include <initializer_list>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <queue>
 #include <set>
 #include <shared_mutex>
 #include <sstream>
@@ -34,11 +39,16 @@ using scoped_lock = std::lock_guard<mutex>;
 using shared_mutex = std::shared_mutex;
 using shared_lock = std::shared_lock<shared_mutex>;
 using unique_lock = std::unique_lock<shared_mutex>;
+using mutex_lock = std::unique_lock<mutex>;
+using condition_variable = std::condition_variable;
+using thread = std::thread;
 template <class T> using atomic = std::atomic<T>;
 
 // Pointers
 template <class T> using unique_ptr = std::unique_ptr<T>;
 template <class T> using shared_ptr = std::shared_ptr<T>;
+template <class T> using weak_ptr = std::weak_ptr<T>;
+template <class T> using enable_shared_from_this = std::enable_shared_from_this<T>;
 template <typename T, typename... Args>
 auto make_shared(Args&&... args) -> shared_ptr<T>
 {
@@ -56,6 +66,8 @@ template <class T> using vector = std::vector<T>;
 template <class T> using initializer_list = std::initializer_list<T>;
 template <class T> using set = std::set<T>;
 template <class K, class V> using map = std::map<K, V>;
+template <class A, class B> using pair = std::pair<A, B>;
+template <class T> using priority_queue = std::priority_queue<T>;
 template <class... T> using variant = std::variant<T...>;
 
 // World positioning
@@ -0,0 +1,98 @@
+#include "loom/wavcodec.h"
+#include "loom/wavfile.h"
+#include "loom/audioasset.h"
+#include "loom/file.h"
+
+namespace Loom
+{
+
+WavCodec::WavCodec(IAudioSystem& system)
+    : IAudioCodec(system)
+{
+}
+
+const char* WavCodec::GetName() const
+{
+    return "WavCodec";
+}
+
+Result WavCodec::LoadAsset(const char* filePath, AudioAssetStorage storage, AudioAssetData& assetData)
+{
+    vector<u8> fileData;
+    Result result = ReadFile(filePath, fileData);
+    LOOM_CHECK_RESULT(result);
+    return DecodeAsset(fileData.data(), fileData.size(), storage, assetData);
+}
+
+Result WavCodec::DecodeAsset(const u8* fileData, u64 fileSize, AudioAssetStorage storage, AudioAssetData& assetData)
+{
+    WavFileInfo info;
+    Result result = ParseWavFile(fileData, fileSize, info);
+    LOOM_CHECK_RESULT(result);
+    assetData.format = info.format;
+    assetData.frameCount = info.frameCount;
+    const u8* data = fileData + info.dataOffset;
+    bool compressed = storage == AudioAssetStorage::Compressed;
+    if (info.encoding == SampleEncoding::Pcm)
+    {
+        if (compressed && info.format.sampleFormat == SampleFormat::Int16)
+            return EncodeLossless(reinterpret_cast<const s16*>(data), assetData);
+        if (compressed)
+            LOOM_LOG_WARNING("Only 16 bit PCM can be compressed, keeping %u bit samples uncompressed.", info.format.GetSampleSize() * 8);
+        u32 frameSize = info.format.GetFrameSize();
+        assetData.samples.assign(data, data + static_cast<size_t>(info.frameCount) * frameSize);
+        return Result::Ok;
+    }
+    return compressed ? CopyBlocks(data, info, assetData) : DecodeBlocks(data, info, assetData);
+}
+
+Result WavCodec::EncodeLossless(const s16* samples, AudioAssetData& assetData)
+{
+    u32 channels = assetData.format.channels;
+    u32 blockCount = (assetData.frameCount + LosslessBlockFrames - 1) / LosslessBlockFrames;
+    assetData.encoding = SampleEncoding::Lossless;
+    assetData.blockFrames = LosslessBlockFrames;
+    assetData.samples.clear();
+    assetData.blockOffsets.resize(blockCount + 1);
+    for (u32 block = 0; block < blockCount; ++block)
+    {
+        u32 firstFrame = block * LosslessBlockFrames;
+        u32 frames = std::min(LosslessBlockFrames, assetData.frameCount - firstFrame);
+        assetData.blockOffsets[block] = static_cast<u32>(assetData.samples.size());
+        Result result = EncodeLosslessBlock(samples + static_cast<size_t>(firstFrame) * channels, frames, channels, assetData.samples);
+        LOOM_CHECK_RESULT(result);
+    }
+    assetData.blockOffsets[blockCount] = static_cast<u32>(assetData.samples.size());
+    assetData.samples.shrink_to_fit();
+    return Result::Ok;
+}
+
+Result WavCodec::CopyBlocks(const u8* data, const WavFileInfo& info, AudioAssetData& assetData)
+{
+    u32 blockCount = (info.frameCount + info.blockFrames - 1) / info.blockFrames;
+    assetData.encoding = info.encoding;
+    assetData.blockFrames = info.blockFrames;
+    assetData.samples.assign(data, data + std::min<u64>(static_cast<u64>(blockCount) * info.blockSize, info.dataSize));
+    assetData.blockOffsets.resize(blockCount + 1);
+    // A short final block ends with the data
+    for (u32 block = 0; block <= blockCount; ++block)
+        assetData.blockOffsets[block] = static_cast<u32>(std::min<u64>(static_cast<u64>(block) * info.blockSize, assetData.samples.size()));
+    return Result::Ok;
+}
+
+Result WavCodec::DecodeBlocks(const u8* data, const WavFileInfo& info, AudioAssetData& assetData)
+{
+    u32 channels = info.format.channels;
+    assetData.samples.resize(static_cast<size_t>(info.frameCount) * info.format.GetFrameSize());
+    s16* destination = reinterpret_cast<s16*>(assetData.samples.data());
+    for (u32 firstFrame = 0; firstFrame < info.frameCount; firstFrame += info.blockFrames)
+    {
+        u32 frames = std::min(info.blockFrames, info.frameCount - firstFrame);
+        const u8* block = data + static_cast<u64>(firstFrame / info.blockFrames) * info.blockSize;
+        Result result = DecodeBlock(info.encoding, block, info.blockSize, channels, destination + static_cast<size_t>(firstFrame) * channels, frames);
+        LOOM_CHECK_RESULT(result);
+    }
+    return Result::Ok;
+}
+
+} // namespace Loom
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "loom/interfaces/iaudiocodec.h"
+#include "loom/wavfile.h"
+
+namespace Loom
+{
+
+class WavCodec : public IAudioCodec
+{
+public:
+    WavCodec(IAudioSystem& system);
+    const char* GetName() const override;
+    Result LoadAsset(const char* filePath, AudioAssetStorage storage, AudioAssetData& assetData) override;
+    Result DecodeAsset(const u8* fileData, u64 fileSize, AudioAssetStorage storage, AudioAssetData& assetData) override;
+
+private:
+    // Compressed storage of PCM files
+    Result EncodeLossless(const s16* samples, AudioAssetData& assetData);
+    // Compressed storage of ADPCM files keeps their blocks as is
+    Result CopyBlocks(const u8* data, const WavFileInfo& info, AudioAssetData& assetData);
+    Result DecodeBlocks(const u8* data, const WavFileInfo& info, AudioAssetData& assetData);
+};
+
+} // namespace Loom
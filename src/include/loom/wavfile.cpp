@@ -0,0 +1,382 @@
+#include "loom/wavfile.h"
+
+namespace Loom
+{
+
+namespace
+{
+
+constexpr u32 WaveFormatPcm = 0x0001;
+constexpr u32 WaveFormatMsAdpcm = 0x0002;
+constexpr u32 WaveFormatIeeeFloat = 0x0003;
+constexpr u32 WaveFormatImaAdpcm = 0x0011;
+constexpr u32 WaveFormatExtensible = 0xFFFE;
+
+u32 ReadLittleEndian(const u8* bytes, u32 size)
+{
+    u32 value = 0;
+    for (u32 i = 0; i < size; ++i)
+        value |= static_cast<u32>(bytes[i]) << (8 * i);
+    return value;
+}
+
+Result ParseFormatChunk(const u8* chunk, u32 chunkSize, WavFileInfo& info)
+{
+    if (chunkSize < 16)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    AudioFormat& format = info.format;
+    u32 formatTag = ReadLittleEndian(chunk, 2);
+    if (formatTag == WaveFormatExtensible && chunkSize >= 26)
+        formatTag = ReadLittleEndian(chunk + 24, 2);
+    u32 bitsPerSample = ReadLittleEndian(chunk + 14, 2);
+    format.channels = ReadLittleEndian(chunk + 2, 2);
+    format.frameRate = ReadLittleEndian(chunk + 4, 4);
+    info.encoding = SampleEncoding::Pcm;
+    if (formatTag == WaveFormatPcm && bitsPerSample == 16)
+        format.sampleFormat = SampleFormat::Int16;
+    else if (formatTag == WaveFormatPcm && bitsPerSample == 32)
+        format.sampleFormat = SampleFormat::Int32;
+    else if (formatTag == WaveFormatIeeeFloat && bitsPerSample == 32)
+        format.sampleFormat = SampleFormat::Float32;
+    else if ((formatTag == WaveFormatImaAdpcm || formatTag == WaveFormatMsAdpcm) && bitsPerSample == 4)
+    {
+        // ADPCM decodes to 16 bit samples
+        format.sampleFormat = SampleFormat::Int16;
+        info.encoding = formatTag == WaveFormatImaAdpcm ? SampleEncoding::ImaAdpcm : SampleEncoding::MsAdpcm;
+        info.blockSize = ReadLittleEndian(chunk + 12, 2);
+        info.blockFrames = GetAdpcmBlockFrames(info.encoding, info.blockSize, format.channels);
+        if (chunkSize >= 20)
+        {
+            u32 samplesPerBlock = ReadLittleEndian(chunk + 18, 2);
+            if (samplesPerBlock > 0 && samplesPerBlock <= info.blockFrames)
+                info.blockFrames = samplesPerBlock;
+        }
+        if (info.blockFrames == 0)
+            LOOM_RETURN_RESULT(Result::InvalidFile);
+    }
+    else
+        LOOM_RETURN_RESULT(Result::UnsupportedFormat);
+    if (format.channels == 0)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    return Result::Ok;
+}
+
+void WriteLittleEndian(u8* bytes, u32 value, u32 size)
+{
+    for (u32 i = 0; i < size; ++i)
+        bytes[i] = static_cast<u8>(value >> (8 * i));
+}
+
+bool SeekFile(FILE* file, u64 offset)
+{
+#if defined(_MSC_VER)
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+} // namespace
+
+Result ParseWavFile(const u8* fileData, u64 fileSize, WavFileInfo& info)
+{
+    if (fileData == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    if (fileSize < 12 || memcmp(fileData, "RIFF", 4) != 0 || memcmp(fileData + 8, "WAVE", 4) != 0)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    bool formatFound = false;
+    u32 factFrames = 0;
+    u64 offset = 12;
+    while (offset + 8 <= fileSize)
+    {
+        const u8* chunkHeader = fileData + offset;
+        u32 chunkSize = ReadLittleEndian(chunkHeader + 4, 4);
+        offset += 8;
+        if (memcmp(chunkHeader, "fmt ", 4) == 0)
+        {
+            if (offset + chunkSize > fileSize)
+                LOOM_RETURN_RESULT(Result::InvalidFile);
+            Result result = ParseFormatChunk(fileData + offset, chunkSize, info);
+            LOOM_CHECK_RESULT(result);
+            formatFound = true;
+        }
+        else if (memcmp(chunkHeader, "fact", 4) == 0 && chunkSize >= 4 && offset + 4 <= fileSize)
+        {
+            factFrames = ReadLittleEndian(fileData + offset, 4);
+        }
+        else if (memcmp(chunkHeader, "data", 4) == 0)
+        {
+            if (!formatFound)
+                LOOM_RETURN_RESULT(Result::InvalidFile);
+            // Tolerate truncated files, only keep the complete frames
+            info.dataOffset = offset;
+            info.dataSize = std::min<u64>(chunkSize, fileSize - offset);
+            if (info.encoding == SampleEncoding::Pcm)
+            {
+                info.frameCount = static_cast<u32>(info.dataSize / info.format.GetFrameSize());
+            }
+            else
+            {
+                // The fact chunk tells how many frames the last block really holds
+                u64 blockCount = info.dataSize / info.blockSize;
+                info.frameCount = static_cast<u32>(blockCount * info.blockFrames);
+                if (factFrames > 0)
+                    info.frameCount = std::min(info.frameCount, factFrames);
+            }
+            return Result::Ok;
+        }
+        // Chunks are padded to an even size
+        offset += chunkSize + (chunkSize & 1);
+    }
+    LOOM_RETURN_RESULT(Result::InvalidFile);
+}
+
+WavFileReader::WavFileReader()
+    : _File(nullptr)
+    , _FrameCount(0)
+    , _FramePosition(0)
+    , _DataOffset(0)
+{
+}
+
+WavFileReader::~WavFileReader()
+{
+    Close();
+}
+
+Result WavFileReader::Open(const char* filePath)
+{
+    Close();
+    if (filePath == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    _File = fopen(filePath, "rb");
+    if (_File == nullptr)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    Result result = ReadHeader();
+    if (!Ok(result))
+    {
+        Close();
+        LOOM_RETURN_RESULT(result);
+    }
+    return Result::Ok;
+}
+
+void WavFileReader::Close()
+{
+    if (_File != nullptr)
+        fclose(_File);
+    _File = nullptr;
+    _Format = AudioFormat();
+    _FrameCount = 0;
+    _FramePosition = 0;
+    _DataOffset = 0;
+}
+
+bool WavFileReader::IsOpen() const
+{
+    return _File != nullptr;
+}
+
+const AudioFormat& WavFileReader::GetFormat() const
+{
+    return _Format;
+}
+
+u32 WavFileReader::GetFrameCount() const
+{
+    return _FrameCount;
+}
+
+u32 WavFileReader::GetFrameSize() const
+{
+    return _Format.GetFrameSize();
+}
+
+u32 WavFileReader::GetFramePosition() const
+{
+    return _FramePosition;
+}
+
+Result WavFileReader::SeekFrame(u32 frame)
+{
+    if (_File == nullptr)
+        LOOM_RETURN_RESULT(Result::InvalidState);
+    if (frame > _FrameCount)
+        LOOM_RETURN_RESULT(Result::InvalidPosition);
+    if (!SeekFile(_File, _DataOffset + static_cast<u64>(frame) * GetFrameSize()))
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    _FramePosition = frame;
+    return Result::Ok;
+}
+
+Result WavFileReader::ReadFrames(u8* destination, u32 frames, u32& framesRead)
+{
+    framesRead = 0;
+    if (_File == nullptr)
+        LOOM_RETURN_RESULT(Result::InvalidState);
+    if (destination == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    frames = std::min(frames, _FrameCount - _FramePosition);
+    if (frames == 0)
+        return Result::EndOfFile;
+    u32 frameSize = GetFrameSize();
+    framesRead = static_cast<u32>(fread(destination, frameSize, frames, _File));
+    _FramePosition += framesRead;
+    if (framesRead < frames)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    return Result::Ok;
+}
+
+Result WavFileReader::ReadHeader()
+{
+    u8 riffHeader[12];
+    if (fread(riffHeader, 1, sizeof(riffHeader), _File) != sizeof(riffHeader)
+        || memcmp(riffHeader, "RIFF", 4) != 0
+        || memcmp(riffHeader + 8, "WAVE", 4) != 0)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+
+    u64 offset = sizeof(riffHeader);
+    bool formatFound = false;
+    u8 chunkHeader[8];
+    while (fread(chunkHeader, 1, sizeof(chunkHeader), _File) == sizeof(chunkHeader))
+    {
+        u32 chunkSize = ReadLittleEndian(chunkHeader + 4, 4);
+        offset += sizeof(chunkHeader);
+        if (memcmp(chunkHeader, "fmt ", 4) == 0)
+        {
+            u8 format[40] = {};
+            u32 formatSize = std::min<u32>(chunkSize, sizeof(format));
+            if (fread(format, 1, formatSize, _File) != formatSize)
+                LOOM_RETURN_RESULT(Result::InvalidFile);
+            WavFileInfo info;
+            Result result = ParseFormatChunk(format, formatSize, info);
+            LOOM_CHECK_RESULT(result);
+            // Streaming reads raw frames, which requires PCM data
+            if (info.encoding != SampleEncoding::Pcm)
+                LOOM_RETURN_RESULT(Result::UnsupportedFormat);
+            _Format = info.format;
+            formatFound = true;
+        }
+        else if (memcmp(chunkHeader, "data", 4) == 0)
+        {
+            if (!formatFound || GetFrameSize() == 0)
+                LOOM_RETURN_RESULT(Result::InvalidFile);
+            _DataOffset = offset;
+            _FrameCount = chunkSize / GetFrameSize();
+            _FramePosition = 0;
+            return SeekFrame(0);
+        }
+        // Chunks are padded to an even size
+        offset += chunkSize + (chunkSize & 1);
+        if (!SeekFile(_File, offset))
+            break;
+    }
+    LOOM_RETURN_RESULT(Result::InvalidFile);
+}
+
+WavFileWriter::WavFileWriter()
+    : _File(nullptr)
+    , _FrameCount(0)
+{
+}
+
+WavFileWriter::~WavFileWriter()
+{
+    Close();
+}
+
+Result WavFileWriter::Open(const char* filePath, const AudioFormat& format)
+{
+    Close();
+    if (filePath == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    if (format.GetFrameSize() == 0 || format.frameRate == 0)
+        LOOM_RETURN_RESULT(Result::UnsupportedFormat);
+    _File = fopen(filePath, "wb");
+    if (_File == nullptr)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    _Format = format;
+    // Written with empty sizes until the file is closed
+    Result result = WriteHeader();
+    if (!Ok(result))
+    {
+        fclose(_File);
+        _File = nullptr;
+        LOOM_RETURN_RESULT(result);
+    }
+    return Result::Ok;
+}
+
+Result WavFileWriter::Close()
+{
+    if (_File == nullptr)
+        return Result::Ok;
+    Result result = Result::Ok;
+    if (!SeekFile(_File, 0))
+        result = Result::InvalidFile;
+    else
+        result = WriteHeader();
+    fclose(_File);
+    _File = nullptr;
+    _Format = AudioFormat();
+    _FrameCount = 0;
+    LOOM_CHECK_RESULT(result);
+    return Result::Ok;
+}
+
+bool WavFileWriter::IsOpen() const
+{
+    return _File != nullptr;
+}
+
+const AudioFormat& WavFileWriter::GetFormat() const
+{
+    return _Format;
+}
+
+u32 WavFileWriter::GetFrameCount() const
+{
+    return _FrameCount;
+}
+
+Result WavFileWriter::WriteFrames(const u8* source, u32 frames)
+{
+    if (_File == nullptr)
+        LOOM_RETURN_RESULT(Result::InvalidState);
+    if (source == nullptr)
+        LOOM_RETURN_RESULT(Result::Nullptr);
+    u32 frameSize = _Format.GetFrameSize();
+    // The data chunk size is limited to 32 bits
+    if ((static_cast<u64>(_FrameCount) + frames) * frameSize > UINT32_MAX - 36)
+        LOOM_RETURN_RESULT(Result::ExceedingLimits);
+    u32 framesWritten = static_cast<u32>(fwrite(source, frameSize, frames, _File));
+    _FrameCount += framesWritten;
+    if (framesWritten < frames)
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    return Result::Ok;
+}
+
+Result WavFileWriter::WriteHeader()
+{
+    u32 sampleSize = _Format.GetSampleSize();
+    u32 frameSize = _Format.GetFrameSize();
+    u32 dataSize = _FrameCount * frameSize;
+    u8 header[44] = {};
+    memcpy(header, "RIFF", 4);
+    WriteLittleEndian(header + 4, 36 + dataSize, 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    WriteLittleEndian(header + 16, 16, 4);
+    WriteLittleEndian(header + 20, _Format.sampleFormat == SampleFormat::Float32 ? WaveFormatIeeeFloat : WaveFormatPcm, 2);
+    WriteLittleEndian(header + 22, _Format.channels, 2);
+    WriteLittleEndian(header + 24, _Format.frameRate, 4);
+    WriteLittleEndian(header + 28, _Format.frameRate * frameSize, 4);
+    WriteLittleEndian(header + 32, frameSize, 2);
+    WriteLittleEndian(header + 34, sampleSize * 8, 2);
+    memcpy(header + 36, "data", 4);
+    WriteLittleEndian(header + 40, dataSize, 4);
+    if (fwrite(header, 1, sizeof(header), _File) != sizeof(header))
+        LOOM_RETURN_RESULT(Result::InvalidFile);
+    return Result::Ok;
+}
+
+} // namespace Loom
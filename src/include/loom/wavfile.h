@@ -0,0 +1,91 @@
+#pragma once
+
+#include "loom/audioformat.h"
+#include "loom/blockcodec.h"
+
+namespace Loom
+{
+
+struct WavFileInfo
+{
+    WavFileInfo()
+        : encoding(SampleEncoding::Pcm)
+        , blockSize(0)
+        , blockFrames(0)
+        , frameCount(0)
+        , dataOffset(0)
+        , dataSize(0)
+    {
+    }
+
+    // Format of the decoded samples
+    AudioFormat format;
+    SampleEncoding encoding;
+    // ADPCM blocks layout
+    u32 blockSize;
+    u32 blockFrames;
+    u32 frameCount;
+    u64 dataOffset;
+    u64 dataSize;
+};
+
+// Parses a RIFF/WAVE file held in memory, locating its sample data.
+// Unlike WavFileReader, this also accepts IMA and Microsoft ADPCM files.
+Result ParseWavFile(const u8* fileData, u64 fileSize, WavFileInfo& info);
+
+// Minimal RIFF/WAVE reader for 16 and 32 bit integer or 32 bit float PCM data
+class WavFileReader
+{
+public:
+    WavFileReader();
+    ~WavFileReader();
+    WavFileReader(const WavFileReader&) = delete;
+    WavFileReader& operator=(const WavFileReader&) = delete;
+
+    Result Open(const char* filePath);
+    void Close();
+    bool IsOpen() const;
+    const AudioFormat& GetFormat() const;
+    u32 GetFrameCount() const;
+    u32 GetFrameSize() const;
+    u32 GetFramePosition() const;
+    Result SeekFrame(u32 frame);
+    Result ReadFrames(u8* destination, u32 frames, u32& framesRead);
+
+private:
+    Result ReadHeader();
+
+private:
+    FILE* _File;
+    AudioFormat _Format;
+    u32 _FrameCount;
+    u32 _FramePosition;
+    u64 _DataOffset;
+};
+
+// Writes 16 and 32 bit integer or 32 bit float PCM data, the sizes are completed on Close
+class WavFileWriter
+{
+public:
+    WavFileWriter();
+    ~WavFileWriter();
+    WavFileWriter(const WavFileWriter&) = delete;
+    WavFileWriter& operator=(const WavFileWriter&) = delete;
+
+    Result Open(const char* filePath, const AudioFormat& format);
+    Result Close();
+    bool IsOpen() const;
+    const AudioFormat& GetFormat() const;
+    u32 GetFrameCount() const;
+    Result WriteFrames(const u8* source, u32 frames);
+
+private:
+    Result WriteHeader();
+
+private:
+    FILE* _File;
+    AudioFormat _Format;
+    u32 _FrameCount;
+};
+
+} // namespace Loom
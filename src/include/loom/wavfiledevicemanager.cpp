@@ -0,0 +1,38 @@
+#include "loom/wavfiledevicemanager.h"
+
+namespace Loom
+{
+
+WavFileDeviceManager::WavFileDeviceManager(IAudioSystem& system, const char* filePath)
+    : NullAudioDeviceManager(system)
+    , _FilePath(filePath != nullptr ? filePath : "")
+{
+}
+
+WavFileDeviceManager::~WavFileDeviceManager()
+{
+    // Completes the file while the writer is still around
+    Stop();
+}
+
+const char* WavFileDeviceManager::GetName() const
+{
+    return "WavFileDeviceManager";
+}
+
+Result WavFileDeviceManager::OnStart(const AudioFormat& format)
+{
+    return _Writer.Open(_FilePath.c_str(), format);
+}
+
+Result WavFileDeviceManager::OnBufferRendered(const AudioBuffer& buffer)
+{
+    return _Writer.WriteFrames(buffer.GetData(), buffer.GetFrameCount());
+}
+
+Result WavFileDeviceManager::OnStop()
+{
+    return _Writer.Close();
+}
+
+} // namespace Loom
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "loom/nullaudiodevicemanager.h"
+#include "loom/wavfile.h"
+
+namespace Loom
+{
+
+// Headless device manager writing everything rendered between Start and Stop to a wav file
+class WavFileDeviceManager : public NullAudioDeviceManager
+{
+public:
+    WavFileDeviceManager(IAudioSystem& system, const char* filePath);
+    ~WavFileDeviceManager();
+    const char* GetName() const override;
+
+protected:
+    Result OnStart(const AudioFormat& format) override;
+    Result OnBufferRendered(const AudioBuffer& buffer) override;
+    Result OnStop() override;
+
+private:
+    string _FilePath;
+    WavFileWriter _Writer;
+};
+
+} // namespace Loom
@@ -1,8 +1,119 @@
 #include "gtest/gtest.h"
 #include "loom/loom.h"
+#include "loom/audioringbuffer.h"
+#include "loom/audiostream.h"
+#include "loom/blockcodec.h"
+#include "loom/audiobufferpool.h"
 
 using namespace Loom;
 
+namespace
+{
+
+// Mono 16 bit ramps, each sample holding its frame index
+AudioFormat GetRampFormat()
+{
+    AudioFormat format;
+    format.channels = 1;
+    format.frameRate = 48000;
+    format.sampleFormat = SampleFormat::Int16;
+    return format;
+}
+
+AudioAssetData CreateRampData(u32 frames)
+{
+    AudioAssetData data;
+    data.format = GetRampFormat();
+    data.frameCount = frames;
+    data.samples.resize(frames * sizeof(s16));
+    for (u32 i = 0; i < frames; ++i)
+        reinterpret_cast<s16*>(data.samples.data())[i] = static_cast<s16>(i);
+    return data;
+}
+
+bool WriteRampWav(const char* filePath, u32 frames)
+{
+    FILE* file = fopen(filePath, "wb");
+    if (file == nullptr)
+        return false;
+    const u32 header[] = {0x46464952, 36 + frames * 2, 0x45564157, 0x20746d66, 16, 0x00010001, 48000, 96000, 0x00100002, 0x61746164, frames * 2};
+    fwrite(header, sizeof(header), 1, file);
+    AudioAssetData data = CreateRampData(frames);
+    fwrite(data.samples.data(), data.samples.size(), 1, file);
+    fclose(file);
+    return true;
+}
+
+// Mono IMA ADPCM blocks of 256 bytes holding 505 frames, noise nibbles, the fact chunk
+// cutting the last block short
+bool WriteImaAdpcmWav(const char* filePath, u32 blocks, u32 frames)
+{
+    FILE* file = fopen(filePath, "wb");
+    if (file == nullptr)
+        return false;
+    const u32 dataSize = blocks * 256;
+    const u32 header[] = {0x46464952, 52 + dataSize, 0x45564157, 0x20746d66, 20, 0x00010011, 48000, 24333, 0x00040100, 0x01F90002, 0x74636166, 4, frames, 0x61746164, dataSize};
+    fwrite(header, sizeof(header), 1, file);
+    vector<u8> data(dataSize);
+    u32 noise = 1;
+    for (u32 block = 0; block < blocks; ++block)
+    {
+        // Predictor, step index and a reserved byte
+        u8* blockData = data.data() + block * 256;
+        blockData[0] = static_cast<u8>(block * 40);
+        blockData[1] = 0;
+        blockData[2] = static_cast<u8>(block * 20 % 89);
+        blockData[3] = 0;
+        for (u32 i = 4; i < 256; ++i)
+        {
+            noise = noise * 1664525 + 1013904223;
+            blockData[i] = static_cast<u8>(noise >> 24);
+        }
+    }
+    fwrite(data.data(), data.size(), 1, file);
+    fclose(file);
+    return true;
+}
+
+// Assets are loaded by the loader threads
+bool WaitForState(const AudioAsset& asset, AudioAssetState state)
+{
+    for (u32 i = 0; i < 5000 && asset.GetState() != state; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return asset.GetState() == state;
+}
+
+Result BuildRampBank(const char* bankPath, const char* assetName, u32 frames)
+{
+    SoundBankWriter writer;
+    Result result = writer.AddAsset(assetName, CreateRampData(frames));
+    LOOM_CHECK_RESULT(result);
+    return writer.Write(bankPath);
+}
+
+// Appends frames of a mono 16 bit source, rendered buffer by buffer straight through its Execute
+Result RenderSource(AssetReaderNode& source, u32 frames, u32 bufferFrames, vector<s16>& rendered)
+{
+    size_t offset = rendered.size();
+    rendered.resize(offset + frames, -1);
+    AudioFormat format = GetRampFormat();
+    for (u32 frame = 0; frame < frames; frame += bufferFrames)
+    {
+        u32 size = std::min(bufferFrames, frames - frame) * sizeof(s16);
+        AudioBuffer buffer(nullptr, format, reinterpret_cast<u8*>(rendered.data() + offset + frame), size);
+        buffer.SetSize(size);
+        Result result = source.Execute(buffer);
+        // Stopped sources render silence
+        if (result == Result::NodeIsVirtual)
+            memset(buffer.GetData(), 0, size);
+        else
+            LOOM_CHECK_RESULT(result);
+    }
+    return Result::Ok;
+}
+
+} // namespace
+
 class CompilationTests : public ::testing::Test
 {
 };
@@ -43,3 +154,1559 @@ TEST_F(CompilationTests, AudioGraph)
     Result result = graph.ConnectNodes({input, gain, reverb, output});
     LOOM_UNUSED(result);
 }
+
+
+class StreamingTests : public ::testing::Test
+{
+};
+
+TEST_F(StreamingTests, RingBufferWrapAround)
+{
+    AudioRingBuffer ringBuffer(8);
+    u8* writeRegions[2] = {};
+    u32 writeSizes[2] = {};
+    ringBuffer.GetWriteRegions(writeRegions[0], writeSizes[0], writeRegions[1], writeSizes[1]);
+    EXPECT_EQ(writeSizes[0], 8u);
+    EXPECT_EQ(writeSizes[1], 0u);
+    for (u8 i = 0; i < 6; ++i)
+        writeRegions[0][i] = i;
+    ringBuffer.CommitWrite(6);
+    ringBuffer.CommitRead(4);
+
+    ringBuffer.GetWriteRegions(writeRegions[0], writeSizes[0], writeRegions[1], writeSizes[1]);
+    EXPECT_EQ(writeSizes[0], 2u);
+    EXPECT_EQ(writeSizes[1], 4u);
+    u8 value = 10;
+    for (u32 region = 0; region < 2; ++region)
+        for (u32 i = 0; i < writeSizes[region]; ++i)
+            writeRegions[region][i] = value++;
+    ringBuffer.CommitWrite(6);
+    EXPECT_EQ(ringBuffer.GetWritableSize(), 0u);
+
+    const u8* readRegions[2] = {};
+    u32 readSizes[2] = {};
+    ringBuffer.GetReadRegions(8, readRegions[0], readSizes[0], readRegions[1], readSizes[1]);
+    EXPECT_EQ(readSizes[0], 4u);
+    EXPECT_EQ(readSizes[1], 4u);
+    const u8 expected[8] = {4, 5, 10, 11, 12, 13, 14, 15};
+    for (u32 i = 0; i < 8; ++i)
+        EXPECT_EQ(i < 4 ? readRegions[0][i] : readRegions[1][i - 4], expected[i]);
+    ringBuffer.CommitRead(8);
+    EXPECT_EQ(ringBuffer.GetReadableSize(), 0u);
+}
+
+TEST_F(StreamingTests, SeekRefillsFromFrame)
+{
+    const char* filePath = "streamingtests.wav";
+    ASSERT_TRUE(WriteRampWav(filePath, 4000));
+
+    shared_ptr<AudioAsset> asset = Loom::make_shared<AudioAsset>(IAudioSystem::GetStub(), filePath, filePath, AudioAssetStorage::Streamed);
+    AudioStream stream(asset, 256, 100);
+    EXPECT_EQ(stream.Fill(), Result::Ok);
+    ASSERT_TRUE(stream.IsReady());
+
+    stream.Seek(3000, 0);
+    EXPECT_TRUE(stream.IsSeeking());
+    EXPECT_EQ(stream.Fill(), Result::Ok);
+    EXPECT_FALSE(stream.IsSeeking());
+    const u8* regions[2] = {};
+    u32 sizes[2] = {};
+    stream.GetRingBuffer().GetReadRegions(2, regions[0], sizes[0], regions[1], sizes[1]);
+    ASSERT_EQ(sizes[0], 2u);
+    EXPECT_EQ(*reinterpret_cast<const s16*>(regions[0]), 3000);
+
+    // Frames of the head are not streamed, the ring buffer resumes after them
+    stream.Seek(10, 0);
+    EXPECT_EQ(stream.Fill(), Result::Ok);
+    stream.GetRingBuffer().GetReadRegions(2, regions[0], sizes[0], regions[1], sizes[1]);
+    EXPECT_EQ(*reinterpret_cast<const s16*>(regions[0]), 100);
+    std::remove(filePath);
+}
+
+class LoaderTests : public ::testing::Test
+{
+};
+
+struct LoadRecorder
+{
+    mutex completionsMutex;
+    vector<pair<string, Result>> completions;
+};
+
+void RecordLoad(AudioAsset& asset, Result result, void* userData)
+{
+    LoadRecorder* recorder = static_cast<LoadRecorder*>(userData);
+    scoped_lock lock(recorder->completionsMutex);
+    recorder->completions.emplace_back(asset.GetFilePath(), result);
+}
+
+TEST_F(LoaderTests, ServesRequestsByPriority)
+{
+    const char* filePaths[] = {"loadertests0.wav", "loadertests1.wav", "loadertests2.wav", "loadertests3.wav"};
+    for (const char* filePath : filePaths)
+        ASSERT_TRUE(WriteRampWav(filePath, 100));
+    AudioSystemConfig config;
+    config.assetLoaderIoThreads = 1;
+    config.assetLoaderDecodeThreads = 1;
+    config.shareAssets = false;
+    AudioSystem system(config);
+    shared_ptr<AudioAsset> assets[4];
+    for (u32 i = 0; i < 4; ++i)
+    {
+        assets[i] = system.CreateAudioAsset(filePaths[i]);
+        ASSERT_NE(assets[i], nullptr);
+    }
+
+    // Queued before the loader threads start, so that they find every request
+    LoadRecorder recorder;
+    ASSERT_EQ(assets[0]->Load(AudioAssetLoadPriority::Low, RecordLoad, &recorder), Result::Ok);
+    ASSERT_EQ(assets[1]->Load(AudioAssetLoadPriority::Normal, RecordLoad, &recorder), Result::Ok);
+    // A second load of an asset joins its request and raises its priority
+    ASSERT_EQ(assets[2]->Load(AudioAssetLoadPriority::Low, RecordLoad, &recorder), Result::Ok);
+    ASSERT_EQ(assets[2]->Load(AudioAssetLoadPriority::High, RecordLoad, &recorder), Result::Ok);
+    ASSERT_EQ(assets[3]->Load(AudioAssetLoadPriority::Critical, RecordLoad, &recorder), Result::Ok);
+    EXPECT_EQ(assets[3]->GetState(), AudioAssetState::Loading);
+    ASSERT_EQ(system.CancelAudioAssetLoad(assets[3]), Result::Ok);
+    EXPECT_EQ(assets[3]->GetState(), AudioAssetState::Unloaded);
+
+    ASSERT_EQ(system.GetAssetLoader().Initialize(), Result::Ok);
+    for (u32 i = 0; i < 3; ++i)
+        ASSERT_TRUE(WaitForState(*assets[i], AudioAssetState::Loaded));
+    system.Shutdown();
+
+    const vector<pair<string, Result>> expected =
+    {
+        {filePaths[3], Result::Canceled},
+        {filePaths[2], Result::Ok},
+        {filePaths[2], Result::Ok},
+        {filePaths[1], Result::Ok},
+        {filePaths[0], Result::Ok}
+    };
+    EXPECT_EQ(recorder.completions, expected);
+    EXPECT_EQ(assets[3]->GetState(), AudioAssetState::Unloaded);
+    EXPECT_EQ(assets[2]->GetFrames(), 100u);
+    for (const char* filePath : filePaths)
+        std::remove(filePath);
+}
+
+class CacheTests : public ::testing::Test
+{
+};
+
+TEST_F(CacheTests, EvictsLeastRecentlyUsedUnpinnedAssets)
+{
+    const char* filePaths[] = {"cachetests0.wav", "cachetests1.wav", "cachetests2.wav"};
+    for (const char* filePath : filePaths)
+        ASSERT_TRUE(WriteRampWav(filePath, 1000));
+    // Room for two of the three assets
+    AudioSystemConfig config;
+    config.assetCacheBudget = 5000;
+    config.shareAssets = false;
+    AudioSystem system(config);
+    ASSERT_EQ(system.InitializeOffline(GetRampFormat(), 64), Result::Ok);
+    IAudioAssetCache& cache = system.GetAssetCache();
+    shared_ptr<AudioAsset> assets[3];
+    for (u32 i = 0; i < 3; ++i)
+    {
+        assets[i] = system.CreateAudioAsset(filePaths[i]);
+        ASSERT_NE(assets[i], nullptr);
+    }
+    // The loader trims once the load completed, trimming again here waits for the eviction
+    auto load = [&](u32 i)
+    {
+        ASSERT_EQ(assets[i]->Load(), Result::Ok);
+        ASSERT_TRUE(WaitForState(*assets[i], AudioAssetState::Loaded));
+        ASSERT_EQ(cache.Trim(), Result::Ok);
+    };
+
+    load(0);
+    load(1);
+    EXPECT_EQ(assets[0]->GetResidentSize(), 2000u);
+    // The first asset is the least recently used, but pinned
+    assets[0]->Pin();
+    assets[1]->Pin();
+    assets[1]->Unpin();
+    EXPECT_EQ(assets[0]->Unload(), Result::Busy);
+    EXPECT_EQ(assets[0]->GetState(), AudioAssetState::Loaded);
+    load(2);
+    EXPECT_EQ(assets[0]->GetState(), AudioAssetState::Loaded);
+    EXPECT_EQ(assets[1]->GetState(), AudioAssetState::Unloaded);
+    EXPECT_EQ(assets[2]->GetState(), AudioAssetState::Loaded);
+
+    // Unpinning uses the first asset, the third one becomes the least recently used
+    assets[0]->Unpin();
+    load(1);
+    EXPECT_EQ(assets[0]->GetState(), AudioAssetState::Loaded);
+    EXPECT_EQ(assets[1]->GetState(), AudioAssetState::Loaded);
+    EXPECT_EQ(assets[2]->GetState(), AudioAssetState::Unloaded);
+
+    EXPECT_EQ(system.CreateAudioAsset(filePaths[0]), assets[0]);
+    AudioAssetCacheStats stats;
+    ASSERT_EQ(cache.GetStats(stats), Result::Ok);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 3u);
+    EXPECT_EQ(stats.evictions, 2u);
+    EXPECT_EQ(stats.evictedBytes, 4000u);
+    EXPECT_EQ(stats.residentBytes, 4000u);
+    EXPECT_EQ(stats.budgetBytes, 5000u);
+    EXPECT_EQ(stats.assetCount, 3u);
+
+    EXPECT_EQ(assets[0]->Unload(), Result::Ok);
+    EXPECT_EQ(assets[0]->GetState(), AudioAssetState::Unloaded);
+    for (const char* filePath : filePaths)
+        std::remove(filePath);
+}
+
+class CodecTests : public ::testing::Test
+{
+};
+
+TEST_F(CodecTests, LosslessBlockRoundTrip)
+{
+    constexpr u32 channels = 2;
+    constexpr u32 frames = LosslessBlockFrames - 3;
+    vector<s16> source(frames * channels);
+    for (u32 i = 0; i < frames; ++i)
+    {
+        source[i * channels] = static_cast<s16>((i * 97) % 2000 - 1000);
+        source[i * channels + 1] = static_cast<s16>(i % 2 ? 32767 : -32768);
+    }
+    vector<u8> block;
+    EXPECT_EQ(EncodeLosslessBlock(source.data(), frames, channels, block), Result::Ok);
+    EXPECT_LT(block.size(), source.size() * sizeof(s16));
+
+    vector<s16> decoded(source.size());
+    EXPECT_EQ(DecodeLosslessBlock(block.data(), static_cast<u32>(block.size()), channels, decoded.data(), frames), Result::Ok);
+    EXPECT_EQ(decoded, source);
+}
+
+TEST_F(CodecTests, ImaAdpcmBlockDecode)
+{
+    EXPECT_EQ(GetAdpcmBlockFrames(SampleEncoding::ImaAdpcm, 256, 1), 505u);
+    EXPECT_EQ(GetAdpcmBlockFrames(SampleEncoding::ImaAdpcm, 2048, 2), 2041u);
+    // A stereo block only holds whole groups of 8 frames
+    EXPECT_EQ(GetAdpcmBlockFrames(SampleEncoding::ImaAdpcm, 20, 2), 9u);
+    EXPECT_EQ(GetAdpcmBlockFrames(SampleEncoding::ImaAdpcm, 3, 1), 0u);
+
+    // Headers of predictor, step index and a reserved byte, then 4 bytes of each channel, low nibble first
+    const u8 block[] =
+    {
+        0x64, 0x00, 0, 0, 0x38, 0xFF, 10, 0,
+        0x21, 0x47, 0x0C, 0x9F,
+        0x73, 0x58, 0xE6, 0x12
+    };
+    const s16 left[] = {100, 101, 104, 115, 133, 112, 114, 76, 60};
+    const s16 right[] = {-200, -185, -154, -158, -112, -31, -174, -77, -25};
+    ASSERT_EQ(GetAdpcmBlockFrames(SampleEncoding::ImaAdpcm, sizeof(block), 2), 9u);
+    s16 decoded[20];
+    std::fill(std::begin(decoded), std::end(decoded), s16(0x7777));
+    ASSERT_EQ(DecodeBlock(SampleEncoding::ImaAdpcm, block, sizeof(block), 2, decoded, 9), Result::Ok);
+    for (u32 frame = 0; frame < 9; ++frame)
+    {
+        EXPECT_EQ(decoded[2 * frame], left[frame]);
+        EXPECT_EQ(decoded[2 * frame + 1], right[frame]);
+    }
+    EXPECT_EQ(decoded[18], 0x7777);
+
+    // A short final block decodes only its frames
+    std::fill(std::begin(decoded), std::end(decoded), s16(0x7777));
+    ASSERT_EQ(DecodeImaAdpcmBlock(block, sizeof(block), 2, decoded, 5), Result::Ok);
+    for (u32 frame = 0; frame < 5; ++frame)
+    {
+        EXPECT_EQ(decoded[2 * frame], left[frame]);
+        EXPECT_EQ(decoded[2 * frame + 1], right[frame]);
+    }
+    EXPECT_EQ(decoded[10], 0x7777);
+    EXPECT_EQ(DecodeImaAdpcmBlock(block, sizeof(block), 2, decoded, 10), Result::InvalidParameter);
+}
+
+TEST_F(CodecTests, MsAdpcmBlockDecode)
+{
+    EXPECT_EQ(GetAdpcmBlockFrames(SampleEncoding::MsAdpcm, 256, 1), 500u);
+    EXPECT_EQ(GetAdpcmBlockFrames(SampleEncoding::MsAdpcm, 512, 2), 500u);
+    EXPECT_EQ(GetAdpcmBlockFrames(SampleEncoding::MsAdpcm, 13, 2), 0u);
+
+    // Predictor indices, deltas, first then second samples, each one per channel,
+    // then nibbles alternating between the channels, high nibble first
+    const u8 block[] =
+    {
+        1, 4,
+        20, 0, 100, 0,
+        50, 0, 0xD4, 0xFE,
+        40, 0, 0x38, 0xFF,
+        0x3D, 0x7F, 0x18
+    };
+    const s16 left[] = {40, 50, 120, 309, 538};
+    const s16 right[] = {-200, -300, -582, -635, -1228};
+    ASSERT_EQ(GetAdpcmBlockFrames(SampleEncoding::MsAdpcm, sizeof(block), 2), 5u);
+    s16 decoded[12];
+    std::fill(std::begin(decoded), std::end(decoded), s16(0x7777));
+    ASSERT_EQ(DecodeBlock(SampleEncoding::MsAdpcm, block, sizeof(block), 2, decoded, 5), Result::Ok);
+    for (u32 frame = 0; frame < 5; ++frame)
+    {
+        EXPECT_EQ(decoded[2 * frame], left[frame]);
+        EXPECT_EQ(decoded[2 * frame + 1], right[frame]);
+    }
+    EXPECT_EQ(decoded[10], 0x7777);
+
+    // A short final block decodes only its frames
+    std::fill(std::begin(decoded), std::end(decoded), s16(0x7777));
+    ASSERT_EQ(DecodeMsAdpcmBlock(block, sizeof(block), 2, decoded, 3), Result::Ok);
+    for (u32 frame = 0; frame < 3; ++frame)
+    {
+        EXPECT_EQ(decoded[2 * frame], left[frame]);
+        EXPECT_EQ(decoded[2 * frame + 1], right[frame]);
+    }
+    EXPECT_EQ(decoded[6], 0x7777);
+    EXPECT_EQ(DecodeMsAdpcmBlock(block, sizeof(block), 2, decoded, 6), Result::InvalidParameter);
+}
+
+class SoundBankTests : public ::testing::Test
+{
+};
+
+TEST_F(SoundBankTests, WriteAndMap)
+{
+    AudioAssetData data;
+    data.format.channels = 1;
+    data.format.frameRate = 48000;
+    data.format.sampleFormat = SampleFormat::Int16;
+    data.frameCount = 100;
+    data.samples.resize(data.frameCount * data.format.GetFrameSize());
+    for (size_t i = 0; i < data.samples.size(); ++i)
+        data.samples[i] = static_cast<u8>(i);
+    vector<u8> samples = data.samples;
+
+    const char* bankPath = "soundbanktests.bank";
+    SoundBankWriter writer;
+    EXPECT_EQ(writer.AddAsset("sounds/test.wav", std::move(data)), Result::Ok);
+    EXPECT_EQ(writer.AddAsset("sounds/test.wav", AudioAssetData()), Result::InvalidParameter);
+    EXPECT_EQ(writer.Write(bankPath), Result::Ok);
+
+    shared_ptr<SoundBank> bank;
+    ASSERT_EQ(SoundBank::Open(IAudioSystem::GetStub(), bankPath, bank), Result::Ok);
+    EXPECT_EQ(bank->GetAssetCount(), 1u);
+    EXPECT_FALSE(bank->Contains("sounds/missing.wav"));
+
+    shared_ptr<AudioAsset> asset;
+    ASSERT_EQ(bank->GetAsset("sounds/test.wav", asset), Result::Ok);
+    bank.reset();
+    std::remove(bankPath);
+    EXPECT_EQ(asset->GetState(), AudioAssetState::Loaded);
+    EXPECT_EQ(asset->GetFrames(), 100u);
+    EXPECT_EQ(asset->GetResidentSize(), 0u);
+    ASSERT_EQ(asset->GetData().GetSampleSize(), samples.size());
+    EXPECT_EQ(memcmp(asset->GetData().GetSamples(), samples.data(), samples.size()), 0);
+}
+
+class AssetStoreTests : public ::testing::Test
+{
+};
+
+TEST_F(AssetStoreTests, SharedDataLifetime)
+{
+    AudioAssetStore& store = AudioAssetStore::GetInstance();
+    const char* filePath = "assetstoretests.wav";
+    EXPECT_EQ(store.Find(filePath, AudioAssetStorage::Resident), nullptr);
+
+    AudioAssetData data;
+    data.format.channels = 1;
+    data.format.frameRate = 48000;
+    data.format.sampleFormat = SampleFormat::Int16;
+    data.frameCount = 4;
+    data.samples.resize(8);
+    shared_ptr<const AudioAssetData> storedData = store.Insert(filePath, AudioAssetStorage::Resident, std::move(data));
+    ASSERT_NE(storedData, nullptr);
+    EXPECT_EQ(store.Insert(filePath, AudioAssetStorage::Resident, AudioAssetData()), storedData);
+    EXPECT_EQ(store.Find(filePath, AudioAssetStorage::Compressed), nullptr);
+
+    AudioAssetData view = AudioAssetStore::CreateView(store.Find(filePath, AudioAssetStorage::Resident));
+    storedData.reset();
+    EXPECT_EQ(view.GetSamples(), static_cast<const AudioAssetData*>(view.mapping.get())->samples.data());
+    EXPECT_EQ(view.GetSampleSize(), 8u);
+    EXPECT_EQ(view.frameCount, 4u);
+
+    view = AudioAssetData();
+    EXPECT_EQ(store.Find(filePath, AudioAssetStorage::Resident), nullptr);
+}
+
+class VoiceManagerTests : public ::testing::Test
+{
+};
+
+TEST_F(VoiceManagerTests, CapsAudibleSources)
+{
+    const char* bankPath = "voicemanagertests.bank";
+    ASSERT_EQ(BuildRampBank(bankPath, "ramp", 8000), Result::Ok);
+    AudioSystemConfig config;
+    config.maxAudibleSources = 2;
+    AudioSystem system(config);
+    ASSERT_EQ(system.InitializeOffline(GetRampFormat(), 64), Result::Ok);
+    shared_ptr<SoundBank> bank;
+    ASSERT_EQ(system.LoadSoundBank(bankPath, bank), Result::Ok);
+    shared_ptr<AudioAsset> asset = system.CreateAudioAsset("ramp");
+    ASSERT_NE(asset, nullptr);
+    for (u32 i = 0; i < 5; ++i)
+    {
+        shared_ptr<AssetReaderNode> source = system.CreateAudioSource(asset, nullptr);
+        ASSERT_NE(source, nullptr);
+        EXPECT_EQ(source->Play(), Result::Ok);
+    }
+
+    // The sources over the budget fade out before going virtual
+    EXPECT_EQ(system.Update(), Result::Ok);
+    OfflineRenderer renderer;
+    OfflineRenderJob fadeJob(system, 4096);
+    EXPECT_EQ(renderer.Render(fadeJob), Result::Ok);
+    EXPECT_EQ(system.Update(), Result::Ok);
+    AudioVoiceManagerStats stats;
+    EXPECT_EQ(system.GetVoiceManager().GetStats(stats), Result::Ok);
+    EXPECT_EQ(stats.sourceCount, 5u);
+    EXPECT_EQ(stats.playingCount, 5u);
+    EXPECT_EQ(stats.audibleCount, 2u);
+    EXPECT_EQ(stats.virtualCount, 3u);
+
+    // Only two ramps are mixed
+    OfflineRenderJob job(system, 1024);
+    EXPECT_EQ(renderer.Render(job), Result::Ok);
+    vector<s16> expected(1024);
+    for (u32 i = 0; i < expected.size(); ++i)
+        expected[i] = static_cast<s16>(2 * (4096 + i));
+    ASSERT_EQ(job.output.size(), expected.size() * sizeof(s16));
+    const s16* rendered = reinterpret_cast<const s16*>(job.output.data());
+    EXPECT_EQ(vector<s16>(rendered, rendered + expected.size()), expected);
+    std::remove(bankPath);
+}
+
+TEST_F(VoiceManagerTests, VirtualSourcesKeepLooping)
+{
+    const char* bankPath = "voicemanagertests.bank";
+    ASSERT_EQ(BuildRampBank(bankPath, "loop", 100), Result::Ok);
+    AudioSystemConfig config;
+    config.maxAudibleSources = 1;
+    AudioSystem system(config);
+    ASSERT_EQ(system.InitializeOffline(GetRampFormat(), 64), Result::Ok);
+    shared_ptr<SoundBank> bank;
+    ASSERT_EQ(system.LoadSoundBank(bankPath, bank), Result::Ok);
+    shared_ptr<AudioAsset> asset = system.CreateAudioAsset("loop");
+    ASSERT_NE(asset, nullptr);
+    shared_ptr<AssetReaderNode> sources[2];
+    for (shared_ptr<AssetReaderNode>& source : sources)
+    {
+        source = system.CreateAudioSource(asset, nullptr);
+        ASSERT_NE(source, nullptr);
+        source->SetLoop(true);
+    }
+
+    // The second source is played once the first one uses up the budget, and starts virtual
+    sources[0]->SetPriority(1);
+    EXPECT_EQ(sources[0]->Play(), Result::Ok);
+    EXPECT_EQ(system.Update(), Result::Ok);
+    EXPECT_EQ(sources[1]->SeekFrame(30), Result::Ok);
+    EXPECT_EQ(sources[1]->Play(), Result::Ok);
+    EXPECT_FALSE(sources[1]->IsAudible());
+
+    // Only the first source renders while the second one moves through its loop
+    OfflineRenderer renderer;
+    OfflineRenderJob job(system, 320);
+    EXPECT_EQ(renderer.Render(job), Result::Ok);
+    vector<s16> expected(320);
+    for (u32 i = 0; i < expected.size(); ++i)
+        expected[i] = static_cast<s16>(i % 100);
+    ASSERT_EQ(job.output.size(), expected.size() * sizeof(s16));
+    const s16* rendered = reinterpret_cast<const s16*>(job.output.data());
+    EXPECT_EQ(vector<s16>(rendered, rendered + expected.size()), expected);
+    EXPECT_EQ(sources[1]->GetFramePosition(), (30u + 320u) % 100u);
+
+    // Rendering picks up from where the source would be
+    EXPECT_EQ(sources[0]->Stop(0.0f), Result::Ok);
+    EXPECT_EQ(system.Update(), Result::Ok);
+    EXPECT_TRUE(sources[1]->IsAudible());
+    EXPECT_EQ(sources[1]->GetFramePosition(), (30u + 320u) % 100u);
+    OfflineRenderJob audibleJob(system, 64);
+    EXPECT_EQ(renderer.Render(audibleJob), Result::Ok);
+    EXPECT_EQ(sources[1]->GetFramePosition(), (30u + 320u + 64u) % 100u);
+    std::remove(bankPath);
+}
+
+class ClockTests : public ::testing::Test
+{
+};
+
+TEST_F(ClockTests, FadeFollowsFrameTime)
+{
+    AudioClock clock;
+    clock.SetFrameRate(48000);
+    EXPECT_EQ(clock.SecondsToFrames(0.5f), 24000u);
+    clock.Advance(512);
+    clock.Advance(512);
+    EXPECT_EQ(clock.GetFrameTime(), 1024u);
+
+    u64 startFrame = clock.GetFrameTime();
+    Fade fade;
+    fade.Start(0.0f, 1.0f, startFrame, startFrame + clock.SecondsToFrames(0.5f));
+    EXPECT_EQ(fade.GetGain(startFrame), 0.0f);
+    EXPECT_FLOAT_EQ(fade.GetGain(startFrame + 12000), 0.5f);
+    EXPECT_FALSE(fade.IsComplete(startFrame + 12000));
+    EXPECT_EQ(fade.GetGain(startFrame + 24000), 1.0f);
+    EXPECT_TRUE(fade.IsComplete(startFrame + 24000));
+}
+
+TEST_F(ClockTests, FadeCurvesAreMonotonic)
+{
+    for (FadeCurve curve : {FadeCurve::Linear, FadeCurve::EqualPower, FadeCurve::Exponential, FadeCurve::SCurve})
+    {
+        Fade fadeIn;
+        fadeIn.Start(0.0f, 1.0f, 100, 1100, curve);
+        Fade fadeOut;
+        fadeOut.Start(1.0f, 0.0f, 100, 1100, curve);
+        float gains[FadeChunkFrames];
+        float previousGain = 0.0f;
+        for (u64 frame = 100; frame < 1100; frame += FadeChunkFrames)
+        {
+            u32 frames = static_cast<u32>(std::min<u64>(FadeChunkFrames, 1100 - frame));
+            fadeIn.GetGains(frame, frames, gains);
+            for (u32 i = 0; i < frames; ++i)
+            {
+                EXPECT_GE(gains[i], previousGain);
+                // Chunks follow the curve linearly between their ends
+                EXPECT_NEAR(gains[i], fadeIn.GetGain(frame + i), 2e-2f);
+                // A fade out mirrors the fade in
+                EXPECT_NEAR(fadeOut.GetGain(frame + i), fadeIn.GetGain(1100 - (frame + i - 100)), 1e-4f);
+                previousGain = gains[i];
+            }
+        }
+        EXPECT_EQ(fadeIn.GetGain(1100), 1.0f);
+        EXPECT_EQ(fadeOut.GetGain(1100), 0.0f);
+    }
+}
+
+class SchedulingTests : public ::testing::Test
+{
+};
+
+TEST_F(SchedulingTests, PlayAtAndStopAtWithinBuffers)
+{
+    const char* bankPath = "schedulingtests.bank";
+    ASSERT_EQ(BuildRampBank(bankPath, "ramp", 1000), Result::Ok);
+    AudioSystem system;
+    ASSERT_EQ(system.InitializeOffline(GetRampFormat(), 64), Result::Ok);
+    shared_ptr<SoundBank> bank;
+    ASSERT_EQ(system.LoadSoundBank(bankPath, bank), Result::Ok);
+    shared_ptr<AudioAsset> asset = system.CreateAudioAsset("ramp");
+    ASSERT_NE(asset, nullptr);
+    shared_ptr<AssetReaderNode> source = system.CreateAudioSource(asset, nullptr);
+    ASSERT_NE(source, nullptr);
+
+    // Neither frame falls on a buffer boundary
+    EXPECT_EQ(source->PlayAt(100), Result::Ok);
+    EXPECT_EQ(source->StopAt(300), Result::Ok);
+    OfflineRenderer renderer;
+    OfflineRenderJob job(system, 512);
+    EXPECT_EQ(renderer.Render(job), Result::Ok);
+    ASSERT_EQ(job.output.size(), 512 * sizeof(s16));
+    const s16* rendered = reinterpret_cast<const s16*>(job.output.data());
+    vector<s16> expected(512, 0);
+    for (u32 i = 100; i < 300; ++i)
+        expected[i] = static_cast<s16>(i - 100);
+    EXPECT_EQ(vector<s16>(rendered, rendered + expected.size()), expected);
+
+    // The ramp is 0 on the start frame
+    u32 firstIndex = 0;
+    while (firstIndex < 512 && rendered[firstIndex] == 0)
+        ++firstIndex;
+    u32 lastIndex = 511;
+    while (lastIndex > 0 && rendered[lastIndex] == 0)
+        --lastIndex;
+    EXPECT_EQ(firstIndex, 101u);
+    EXPECT_EQ(lastIndex, 299u);
+    EXPECT_FALSE(source->WantsToPlay());
+    std::remove(bankPath);
+}
+
+class AssetReaderTests : public ::testing::Test
+{
+};
+
+TEST_F(AssetReaderTests, LoopRegionThenEnd)
+{
+    const char* bankPath = "assetreadertests.bank";
+    ASSERT_EQ(BuildRampBank(bankPath, "loop", 100), Result::Ok);
+    shared_ptr<SoundBank> bank;
+    ASSERT_EQ(SoundBank::Open(IAudioSystem::GetStub(), bankPath, bank), Result::Ok);
+    shared_ptr<AudioAsset> asset;
+    ASSERT_EQ(bank->GetAsset("loop", asset), Result::Ok);
+
+    AssetReaderNode source(IAudioSystem::GetStub(), asset);
+    source.SetLoopRegion(20, 40);
+    source.SetLoopCount(1);
+    EXPECT_EQ(source.Play(), Result::Ok);
+
+    vector<s16> expected;
+    for (s16 i = 0; i < 40; ++i)
+        expected.push_back(i);
+    for (s16 i = 20; i < 100; ++i)
+        expected.push_back(i);
+    expected.resize(128, 0);
+    vector<s16> rendered(128, -1);
+    for (u32 offset = 0; offset < rendered.size(); offset += 64)
+    {
+        AudioBuffer buffer(nullptr, asset->GetBuffer().GetFormat(), reinterpret_cast<u8*>(rendered.data() + offset), 64 * sizeof(s16));
+        buffer.SetSize(64 * sizeof(s16));
+        EXPECT_EQ(source.Execute(buffer), Result::Ok);
+    }
+    EXPECT_EQ(rendered, expected);
+    EXPECT_FALSE(source.WantsToPlay());
+    EXPECT_EQ(source.GetFramePosition(), 0u);
+    std::remove(bankPath);
+}
+
+TEST_F(AssetReaderTests, CompressedAssetsRenderLikePcm)
+{
+    // Each file is loaded decoded and compressed. The lossless ramp has two whole blocks and a
+    // short one, the ADPCM file three whole blocks and one cut short by its fact chunk.
+    const char* filePaths[][2] =
+    {
+        {"assetreadertests0.wav", "assetreadertests1.wav"},
+        {"assetreadertests2.wav", "assetreadertests3.wav"}
+    };
+    const u32 frames[] = {2500, 1900};
+    for (const char* filePath : filePaths[0])
+        ASSERT_TRUE(WriteRampWav(filePath, frames[0]));
+    for (const char* filePath : filePaths[1])
+        ASSERT_TRUE(WriteImaAdpcmWav(filePath, 4, frames[1]));
+    AudioSystemConfig config;
+    config.shareAssets = false;
+    AudioSystem system(config);
+    ASSERT_EQ(system.InitializeOffline(GetRampFormat(), 100), Result::Ok);
+    for (u32 file = 0; file < 2; ++file)
+    {
+        shared_ptr<AudioAsset> assets[] =
+        {
+            system.CreateAudioAsset(filePaths[file][0]),
+            system.CreateAudioAsset(filePaths[file][1], AudioAssetStorage::Compressed)
+        };
+        vector<s16> rendered[2];
+        for (u32 i = 0; i < 2; ++i)
+        {
+            ASSERT_NE(assets[i], nullptr);
+            ASSERT_EQ(assets[i]->Load(), Result::Ok);
+            ASSERT_TRUE(WaitForState(*assets[i], AudioAssetState::Loaded));
+            EXPECT_EQ(assets[i]->GetFrames(), frames[file]);
+            EXPECT_EQ(assets[i]->IsEncoded(), i == 1);
+            AssetReaderNode source(system, assets[i]);
+            ASSERT_EQ(source.Play(), Result::Ok);
+            // Buffers straddle every block boundary, then the end of the asset
+            ASSERT_EQ(RenderSource(source, 2600, 100, rendered[i]), Result::Ok);
+            EXPECT_FALSE(source.WantsToPlay());
+        }
+        EXPECT_EQ(rendered[1], rendered[0]) << filePaths[file][1];
+        EXPECT_GT(std::count_if(rendered[1].begin(), rendered[1].begin() + frames[file], [](s16 sample) { return sample != 0; }), frames[file] / 2);
+        for (u32 i = frames[file]; i < 2600; ++i)
+            ASSERT_EQ(rendered[1][i], 0);
+        if (file == 0)
+        {
+            for (u32 i = 0; i < frames[file]; ++i)
+                ASSERT_EQ(rendered[1][i], static_cast<s16>(i));
+        }
+        for (const char* filePath : filePaths[file])
+            std::remove(filePath);
+    }
+}
+
+TEST_F(AssetReaderTests, LoopCrossfadeSeams)
+{
+    const char* bankPath = "assetreadertests.bank";
+    ASSERT_EQ(BuildRampBank(bankPath, "loop", 100), Result::Ok);
+    shared_ptr<SoundBank> bank;
+    ASSERT_EQ(SoundBank::Open(IAudioSystem::GetStub(), bankPath, bank), Result::Ok);
+    shared_ptr<AudioAsset> asset;
+    ASSERT_EQ(bank->GetAsset("loop", asset), Result::Ok);
+    const float* table = GetFadeTable(FadeCurve::EqualPower);
+    constexpr u32 FadeFrames = 8;
+
+    // The frames before the loop start fade in over the loop end, the loop resumes at its start
+    AssetReaderNode source(IAudioSystem::GetStub(), asset);
+    source.SetLoopRegion(20, 60);
+    source.SetLoopCount(1);
+    source.SetLoopCrossfade(FadeFrames);
+    EXPECT_EQ(source.Play(), Result::Ok);
+    vector<s16> rendered;
+    ASSERT_EQ(RenderSource(source, 192, 64, rendered), Result::Ok);
+    for (u32 i = 0; i < 60 - FadeFrames; ++i)
+        EXPECT_EQ(rendered[i], static_cast<s16>(i));
+    for (u32 i = 0; i < FadeFrames; ++i)
+    {
+        u32 index = i * FadeTableSize / FadeFrames;
+        float expected = (52.0f + i) * table[FadeTableSize - index] + (12.0f + i) * table[index];
+        EXPECT_NEAR(rendered[52 + i], expected, 1.0f) << "frame " << i;
+    }
+    for (u32 i = 60; i < 140; ++i)
+        EXPECT_EQ(rendered[i], static_cast<s16>(i - 40));
+    for (u32 i = 140; i < 192; ++i)
+        EXPECT_EQ(rendered[i], 0);
+
+    // Without frames before it, a whole asset loop fades in its head and resumes after it
+    AssetReaderNode wholeSource(IAudioSystem::GetStub(), asset);
+    wholeSource.SetLoopRegion(0, 0);
+    wholeSource.SetLoopCount(1);
+    wholeSource.SetLoopCrossfade(FadeFrames);
+    EXPECT_EQ(wholeSource.Play(), Result::Ok);
+    rendered.clear();
+    ASSERT_EQ(RenderSource(wholeSource, 256, 64, rendered), Result::Ok);
+    for (u32 i = 0; i < 100 - FadeFrames; ++i)
+        EXPECT_EQ(rendered[i], static_cast<s16>(i));
+    for (u32 i = 0; i < FadeFrames; ++i)
+    {
+        u32 index = i * FadeTableSize / FadeFrames;
+        float expected = (92.0f + i) * table[FadeTableSize - index] + static_cast<float>(i) * table[index];
+        EXPECT_NEAR(rendered[92 + i], expected, 1.0f) << "frame " << i;
+    }
+    for (u32 i = 100; i < 192; ++i)
+        EXPECT_EQ(rendered[i], static_cast<s16>(i - 92));
+    for (u32 i = 192; i < 256; ++i)
+        EXPECT_EQ(rendered[i], 0);
+    EXPECT_FALSE(wholeSource.WantsToPlay());
+    std::remove(bankPath);
+}
+
+TEST_F(AssetReaderTests, SeekCrossfadesPlayingSources)
+{
+    const char* filePaths[] = {"assetreadertests0.wav", "assetreadertests1.wav"};
+    for (const char* filePath : filePaths)
+        ASSERT_TRUE(WriteRampWav(filePath, 3000));
+    AudioSystemConfig config;
+    config.shareAssets = false;
+    AudioSystem system(config);
+    ASSERT_EQ(system.InitializeOffline(GetRampFormat(), 100), Result::Ok);
+    // The compressed ramp is held in blocks of LosslessBlockFrames
+    shared_ptr<AudioAsset> assets[] =
+    {
+        system.CreateAudioAsset(filePaths[0]),
+        system.CreateAudioAsset(filePaths[1], AudioAssetStorage::Compressed)
+    };
+    const float* table = GetFadeTable(FadeCurve::EqualPower);
+    for (shared_ptr<AudioAsset>& asset : assets)
+    {
+        ASSERT_NE(asset, nullptr);
+        ASSERT_EQ(asset->Load(), Result::Ok);
+        ASSERT_TRUE(WaitForState(*asset, AudioAssetState::Loaded));
+        EXPECT_EQ(asset->IsEncoded(), asset == assets[1]);
+        AssetReaderNode source(system, asset);
+        ASSERT_EQ(source.Play(), Result::Ok);
+
+        // Applied by the next buffer, the fade ends in the middle of its third buffer
+        vector<s16> rendered;
+        ASSERT_EQ(RenderSource(source, 1000, 100, rendered), Result::Ok);
+        ASSERT_EQ(source.SeekFrame(2000), Result::Ok);
+        EXPECT_EQ(source.GetFramePosition(), 1000u);
+        ASSERT_EQ(RenderSource(source, 300, 100, rendered), Result::Ok);
+        for (u32 i = 0; i < 1000; ++i)
+            ASSERT_EQ(rendered[i], static_cast<s16>(i));
+        // The frames that would have followed fade out while the new position fades in,
+        // from block 0 into block 1 and across the start of block 2
+        for (u32 i = 0; i < AssetReaderNode::SeekFadeFrames; ++i)
+        {
+            u32 index = i * FadeTableSize / AssetReaderNode::SeekFadeFrames;
+            float expected = (2000.0f + i) * table[index] + (1000.0f + i) * table[FadeTableSize - index];
+            EXPECT_NEAR(rendered[1000 + i], expected, 1.0f) << "frame " << i;
+        }
+        EXPECT_GT(rendered[1000 + AssetReaderNode::SeekFadeFrames / 2], 2000);
+        for (u32 i = AssetReaderNode::SeekFadeFrames; i < 300; ++i)
+            EXPECT_EQ(rendered[1000 + i], static_cast<s16>(2000 + i));
+        EXPECT_EQ(source.GetFramePosition(), 2300u);
+    }
+    for (const char* filePath : filePaths)
+        std::remove(filePath);
+}
+
+class OfflineRendererTests : public ::testing::Test
+{
+};
+
+TEST_F(OfflineRendererTests, MixesSourcesIntoMemory)
+{
+    AudioFormat format = GetRampFormat();
+    const char* bankPath = "offlinerenderertests.bank";
+    ASSERT_EQ(BuildRampBank(bankPath, "ramp", 100), Result::Ok);
+
+    // Two systems rendering two sources each, on two threads
+    AudioSystem systems[2];
+    vector<OfflineRenderJob> jobs;
+    for (AudioSystem& system : systems)
+    {
+        ASSERT_EQ(system.InitializeOffline(format, 64), Result::Ok);
+        shared_ptr<SoundBank> bank;
+        ASSERT_EQ(system.LoadSoundBank(bankPath, bank), Result::Ok);
+        shared_ptr<AudioAsset> asset = system.CreateAudioAsset("ramp");
+        ASSERT_NE(asset, nullptr);
+        for (u32 i = 0; i < 2; ++i)
+        {
+            shared_ptr<AssetReaderNode> source = system.CreateAudioSource(asset, nullptr);
+            ASSERT_NE(source, nullptr);
+            EXPECT_EQ(source->Play(), Result::Ok);
+        }
+        jobs.emplace_back(system, 160);
+    }
+    OfflineRenderer renderer(2);
+    EXPECT_EQ(renderer.Render(jobs), Result::Ok);
+
+    vector<s16> expected(160, 0);
+    for (s16 i = 0; i < 100; ++i)
+        expected[i] = 2 * i;
+    for (OfflineRenderJob& job : jobs)
+    {
+        ASSERT_EQ(job.output.size(), expected.size() * sizeof(s16));
+        const s16* rendered = reinterpret_cast<const s16*>(job.output.data());
+        EXPECT_EQ(vector<s16>(rendered, rendered + expected.size()), expected);
+        EXPECT_EQ(job.stats.renderedBuffers, 3u);
+        EXPECT_EQ(job.system.GetClock().GetFrameTime(), 160u);
+    }
+    EXPECT_EQ(renderer.GetStats().renderedFrames, 320u);
+    EXPECT_GT(renderer.GetStats().framesPerSecond, 0.0);
+    std::remove(bankPath);
+}
+
+TEST_F(OfflineRendererTests, RejectsSystemsWithoutFormat)
+{
+    AudioSystem system;
+    OfflineRenderer renderer;
+    OfflineRenderJob job(system, 64);
+    EXPECT_EQ(renderer.Render(job), Result::NotReady);
+    EXPECT_TRUE(job.output.empty());
+    EXPECT_EQ(job.stats.renderedFrames, 0u);
+}
+
+class DeviceTests : public ::testing::Test
+{
+};
+
+TEST_F(DeviceTests, WavFileDeviceWritesRenderedBuffers)
+{
+    AudioSystemConfig config;
+    config.deviceManager = AudioDeviceManagerType::WavFile;
+    config.deviceFilePath = "devicetests.wav";
+    config.deviceBufferFrames = 256;
+    {
+        AudioSystem system(config);
+        ASSERT_EQ(system.Initialize(), Result::Ok);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        system.Shutdown();
+        EXPECT_GT(system.GetClock().GetFrameTime(), 0u);
+    }
+
+    WavFileReader reader;
+    ASSERT_EQ(reader.Open(config.deviceFilePath.c_str()), Result::Ok);
+    EXPECT_EQ(reader.GetFormat().channels, config.deviceChannels);
+    EXPECT_EQ(reader.GetFormat().frameRate, config.deviceFrameRate);
+    EXPECT_EQ(reader.GetFormat().sampleFormat, SampleFormat::Float32);
+    EXPECT_GT(reader.GetFrameCount(), 0u);
+    EXPECT_EQ(reader.GetFrameCount() % config.deviceBufferFrames, 0u);
+    vector<float> samples(reader.GetFrameCount() * config.deviceChannels, 1.0f);
+    u32 framesRead = 0;
+    EXPECT_EQ(reader.ReadFrames(reinterpret_cast<u8*>(samples.data()), reader.GetFrameCount(), framesRead), Result::Ok);
+    EXPECT_EQ(std::count(samples.begin(), samples.end(), 0.0f), static_cast<long>(samples.size()));
+    reader.Close();
+    std::remove(config.deviceFilePath.c_str());
+}
+
+class BufferPoolTests : public ::testing::Test
+{
+};
+
+TEST_F(BufferPoolTests, ReleaseOutOfOrder)
+{
+    AudioFormat format;
+    format.channels = 1;
+    format.frameRate = 48000;
+    format.sampleFormat = SampleFormat::Float32;
+    AudioSystem system;
+    ASSERT_EQ(system.InitializeOffline(format, 16), Result::Ok);
+    IAudioBufferProvider& bufferProvider = system.GetBufferProvider();
+
+    // Enough buffers to go through a pool expansion
+    vector<AudioBuffer> buffers(AudioBufferPool::BlockSize + 8);
+    for (AudioBuffer& buffer : buffers)
+        ASSERT_EQ(bufferProvider.AllocateBuffer(buffer), Result::Ok);
+    for (size_t i = 0; i < buffers.size(); i += 2)
+        buffers[i].Release();
+    set<u8*> allocated;
+    for (size_t i = 1; i < buffers.size(); i += 2)
+        allocated.insert(buffers[i].GetData());
+    for (size_t i = 0; i < buffers.size(); i += 2)
+    {
+        ASSERT_EQ(bufferProvider.AllocateBuffer(buffers[i]), Result::Ok);
+        EXPECT_TRUE(allocated.insert(buffers[i].GetData()).second);
+    }
+}
+
+class ProfilerTests : public ::testing::Test
+{
+};
+
+class SleepingNode : public TestNode
+{
+public:
+    SleepingNode(IAudioSystem& system)
+        : TestNode(system)
+    {
+    }
+
+    Result Execute(AudioBuffer&)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return Result::Ok;
+    }
+
+    const char* GetName() const
+    {
+        return "SleepingNode";
+    }
+};
+
+TEST_F(ProfilerTests, RecordsNodesAndOverruns)
+{
+    for (u64 value : {0ull, 3ull, 4ull, 9ull, 1000ull, 123456789ull})
+    {
+        u32 bucket = AudioProfilerHistogram::GetBucket(value);
+        EXPECT_LE(value, AudioProfilerHistogram::GetBucketUpperBound(bucket));
+        if (bucket > 0)
+        {
+            EXPECT_GT(value, AudioProfilerHistogram::GetBucketUpperBound(bucket - 1));
+        }
+    }
+
+    AudioSystemConfig config;
+    config.enableProfiler = true;
+    AudioSystem system(config);
+    AudioFormat format;
+    format.channels = 1;
+    format.frameRate = 48000;
+    format.sampleFormat = SampleFormat::Float32;
+    // 16 frames last a third of a millisecond, less than the sleeping node takes
+    ASSERT_EQ(system.InitializeOffline(format, 16), Result::Ok);
+    IAudioGraph& graph = system.GetGraph();
+    AudioNodePtr master = graph.CreateNode<MixerNode>();
+    AudioNodePtr sleeping = graph.CreateNode<SleepingNode>();
+    AudioNodePtr idle = graph.CreateNode<TestNode>();
+    ASSERT_EQ(graph.ConnectNodes(sleeping, master), Result::Ok);
+    ASSERT_EQ(graph.ConnectNodes(idle, master), Result::Ok);
+    OfflineRenderJob job(system, 64);
+    OfflineRenderer renderer;
+    ASSERT_EQ(renderer.Render(job), Result::Ok);
+
+    AudioProfilerSnapshot snapshot;
+    ASSERT_EQ(graph.GetProfiler().GetSnapshot(snapshot), Result::Ok);
+    EXPECT_EQ(snapshot.callbacks.count, 4u);
+    EXPECT_EQ(snapshot.overruns, 4u);
+    EXPECT_EQ(snapshot.deadlineNanoseconds, 333333u);
+    ASSERT_EQ(snapshot.nodes.size(), 3u);
+    map<string, AudioNodeProfile> profiles;
+    for (const AudioNodeProfile& profile : snapshot.nodes)
+        profiles[profile.name] = profile;
+    EXPECT_EQ(profiles["SleepingNode"].self.count, 4u);
+    EXPECT_GE(profiles["SleepingNode"].self.p50Nanoseconds, 1000000u);
+    // The master includes its inputs in its total, but not in its own time
+    EXPECT_GE(profiles["MixingNode"].total.totalNanoseconds, profiles["SleepingNode"].total.totalNanoseconds);
+    EXPECT_LT(profiles["MixingNode"].self.totalNanoseconds, profiles["SleepingNode"].self.totalNanoseconds);
+    EXPECT_EQ(profiles["TestNode"].total.count, 4u);
+
+    ASSERT_EQ(graph.RemoveNode(idle), Result::Ok);
+    ASSERT_EQ(renderer.Render(job), Result::Ok);
+    ASSERT_EQ(graph.GetProfiler().GetSnapshot(snapshot), Result::Ok);
+    EXPECT_EQ(snapshot.nodes.size(), 2u);
+    EXPECT_EQ(snapshot.callbacks.count, 8u);
+}
+
+class TracerTests : public ::testing::Test
+{
+};
+
+TEST_F(TracerTests, WritesChromeTrace)
+{
+    AudioTracer& tracer = AudioTracer::GetInstance();
+    tracer.Clear();
+    tracer.Start();
+    AudioFormat format;
+    format.channels = 1;
+    format.frameRate = 48000;
+    format.sampleFormat = SampleFormat::Float32;
+    AudioSystem systems[2];
+    vector<OfflineRenderJob> jobs;
+    for (AudioSystem& system : systems)
+    {
+        ASSERT_EQ(system.InitializeOffline(format, 16), Result::Ok);
+        IAudioGraph& graph = system.GetGraph();
+        AudioNodePtr master = graph.CreateNode<MixerNode>();
+        AudioNodePtr node = graph.CreateNode<TestNode>();
+        ASSERT_EQ(graph.ConnectNodes(node, master), Result::Ok);
+        jobs.emplace_back(system, 64);
+    }
+    OfflineRenderer renderer(2);
+    ASSERT_EQ(renderer.Render(jobs), Result::Ok);
+    tracer.Stop();
+
+    const char* tracePath = "tracertests.json";
+    ASSERT_EQ(tracer.WriteChromeTrace(tracePath), Result::Ok);
+    string trace;
+    FILE* file = fopen(tracePath, "r");
+    ASSERT_NE(file, nullptr);
+    for (int c = fgetc(file); c != EOF; c = fgetc(file))
+        trace.push_back(static_cast<char>(c));
+    fclose(file);
+    std::remove(tracePath);
+    auto countOf = [&trace](const string& text)
+    {
+        size_t count = 0;
+        for (size_t position = trace.find(text); position != string::npos; position = trace.find(text, position + 1))
+            ++count;
+        return count;
+    };
+    EXPECT_EQ(trace.find("{\"displayTimeUnit\": \"ns\", \"traceEvents\": ["), 0u);
+    // Depending on scheduling, a single worker may render both jobs
+    EXPECT_GE(countOf("\"args\": {\"name\": \"Loom offline renderer\"}"), 1u);
+    EXPECT_GE(countOf("\"name\": \"ExpandPool\""), 2u);
+    // Two systems rendering four buffers each
+    EXPECT_EQ(countOf("\"name\": \"Execute\", \"cat\": \"Graph\", \"ph\": \"B\""), 8u);
+    EXPECT_EQ(countOf("\"name\": \"Execute\", \"cat\": \"Graph\", \"ph\": \"E\""), 8u);
+    EXPECT_EQ(countOf("\"name\": \"TestNode\", \"cat\": \"Node\", \"ph\": \"B\""), 8u);
+    EXPECT_EQ(countOf("\"ph\": \"B\""), countOf("\"ph\": \"E\""));
+}
+
+class LoggerTests : public ::testing::Test
+{
+};
+
+TEST_F(LoggerTests, RateLimitsCallSites)
+{
+    LogRateLimiter rateLimiter;
+    u32 suppressed = 0;
+    for (u32 i = 0; i < LogRateLimiter::MaxMessagesPerWindow; ++i)
+        EXPECT_TRUE(rateLimiter.Acquire(LogRateLimiter::WindowNanoseconds, suppressed));
+    EXPECT_FALSE(rateLimiter.Acquire(LogRateLimiter::WindowNanoseconds, suppressed));
+    EXPECT_FALSE(rateLimiter.Acquire(LogRateLimiter::WindowNanoseconds, suppressed));
+    EXPECT_TRUE(rateLimiter.Acquire(2 * LogRateLimiter::WindowNanoseconds, suppressed));
+    EXPECT_EQ(suppressed, 2u);
+
+    // A storm from a single call site only prints the first messages of the window
+    Logger::Flush();
+    ::testing::internal::CaptureStdout();
+    for (int i = 0; i < 100; ++i)
+        LOOM_LOG("Storm %d", i);
+    Logger::Flush();
+    string output = ::testing::internal::GetCapturedStdout();
+    EXPECT_NE(output.find("Storm 0\n"), string::npos);
+    EXPECT_NE(output.find("Storm 9\n"), string::npos);
+    EXPECT_EQ(output.find("Storm 10\n"), string::npos);
+}
+
+class RealtimeSanitizerTests : public ::testing::Test
+{
+};
+
+TEST_F(RealtimeSanitizerTests, ReportsAllocationsInRealtimeScopes)
+{
+    RealtimeSanitizer::Reset();
+    bool realtime = false;
+    bool exempted = true;
+    {
+        RealtimeScope realtimeScope(true);
+        {
+            RealtimeScope exemptScope(false);
+            exempted = !RealtimeSanitizer::IsRealtimeThread();
+            int* volatile exemptValue = new int(1);
+            delete exemptValue;
+        }
+        realtime = RealtimeSanitizer::IsRealtimeThread();
+        int* volatile value = new int(2);
+        delete value;
+    }
+    EXPECT_TRUE(realtime);
+    EXPECT_TRUE(exempted);
+    EXPECT_FALSE(RealtimeSanitizer::IsRealtimeThread());
+    int* volatile value = new int(3);
+    delete value;
+
+    vector<RealtimeViolation> violations;
+    EXPECT_EQ(RealtimeSanitizer::GetViolations(violations), Result::Ok);
+    if (!RealtimeSanitizer::IsAvailable())
+    {
+        EXPECT_EQ(RealtimeSanitizer::GetViolationCount(), 0u);
+        EXPECT_TRUE(violations.empty());
+        return;
+    }
+    // Only the allocation made outside of the exempt scope
+    EXPECT_EQ(RealtimeSanitizer::GetViolationCount(), 2u);
+    ASSERT_EQ(violations.size(), 2u);
+    for (const RealtimeViolation& violation : violations)
+    {
+        EXPECT_EQ(violation.count, 1u);
+        EXPECT_TRUE(violation.kind == RealtimeViolationKind::Allocation || violation.kind == RealtimeViolationKind::Deallocation);
+    }
+    RealtimeSanitizer::Reset();
+    EXPECT_EQ(RealtimeSanitizer::GetViolationCount(), 0u);
+}
+
+class SineNode : public TestNode
+{
+public:
+    SineNode(IAudioSystem& system, float frequency, float amplitude)
+        : TestNode(system)
+        , _Frequency(frequency)
+        , _Amplitude(amplitude)
+        , _Frame(0)
+    {
+    }
+
+    Result Execute(AudioBuffer& buffer)
+    {
+        float* samples = buffer.GetData<float>();
+        for (u32 frame = 0; frame < buffer.GetFrameCount(); ++frame, ++_Frame)
+        {
+            float sample = _Amplitude * std::sin(2.0f * 3.14159265f * _Frequency * (_Frame % buffer.GetFrameRate()) / buffer.GetFrameRate());
+            for (u32 channel = 0; channel < buffer.GetChannels(); ++channel)
+                samples[frame * buffer.GetChannels() + channel] = sample;
+        }
+        return Result::Ok;
+    }
+
+    const char* GetName() const
+    {
+        return "SineNode";
+    }
+
+private:
+    float _Frequency;
+    float _Amplitude;
+    u64 _Frame;
+};
+
+class BiquadTests : public ::testing::Test
+{
+};
+
+TEST_F(BiquadTests, VectorizedFiltersMatchScalarReference)
+{
+    auto filterReference = [](const BiquadCoefficients& c, vector<float> samples)
+    {
+        float z1 = 0.0f;
+        float z2 = 0.0f;
+        for (float& sample : samples)
+        {
+            float y = c.b0 * sample + z1;
+            z1 = c.b1 * sample - c.a1 * y + z2;
+            z2 = c.b2 * sample - c.a2 * y;
+            sample = y;
+        }
+        return samples;
+    };
+    auto signal = [](u32 seed, u32 frames)
+    {
+        vector<float> samples(frames);
+        for (u32 i = 0; i < frames; ++i)
+            samples[i] = std::sin(0.05f * (i + 1) * (seed + 1)) + ((i * 7919 + seed * 104729) % 17) / 17.0f - 0.5f;
+        return samples;
+    };
+
+    // Unity gain at DC, silence at Nyquist
+    BiquadCoefficients lowPass = BiquadCoefficients::Compute(BiquadFilterType::LowPass, 48000.0f, 1000.0f, 0.7071f);
+    EXPECT_NEAR((lowPass.b0 + lowPass.b1 + lowPass.b2) / (1.0f + lowPass.a1 + lowPass.a2), 1.0f, 1e-4f);
+    EXPECT_NEAR((lowPass.b0 - lowPass.b1 + lowPass.b2) / (1.0f - lowPass.a1 + lowPass.a2), 0.0f, 1e-4f);
+    BiquadCoefficients peak = BiquadCoefficients::Compute(BiquadFilterType::Peak, 48000.0f, 12000.0f, 1.0f, 6.0f);
+    float cosine = std::cos(2.0f * 3.14159265f * 12000.0f / 48000.0f);
+    EXPECT_NEAR(cosine, 0.0f, 1e-6f);
+    // At a quarter of the frame rate, the response is (b0 - b2 - j b1) / (1 - a2 - j a1)
+    float peakGain = std::hypot(peak.b0 - peak.b2, peak.b1) / std::hypot(1.0f - peak.a2, peak.a1);
+    EXPECT_NEAR(20.0f * std::log10(peakGain), 6.0f, 1e-2f);
+
+    // Six interleaved channels, a full lane group and a partial one
+    constexpr u32 Channels = 6;
+    constexpr u32 Frames = 101;
+    BiquadFilter filter;
+    filter.SetCoefficients(lowPass);
+    vector<float> interleaved(Frames * Channels);
+    for (u32 channel = 0; channel < Channels; ++channel)
+    {
+        vector<float> samples = signal(channel, Frames);
+        for (u32 i = 0; i < Frames; ++i)
+            interleaved[i * Channels + channel] = samples[i];
+    }
+    EXPECT_EQ(filter.Process(interleaved.data(), 40, Channels), Result::Ok);
+    EXPECT_EQ(filter.Process(interleaved.data() + 40 * Channels, Frames - 40, Channels), Result::Ok);
+    for (u32 channel = 0; channel < Channels; ++channel)
+    {
+        vector<float> expected = filterReference(lowPass, signal(channel, Frames));
+        for (u32 i = 0; i < Frames; ++i)
+            EXPECT_NEAR(interleaved[i * Channels + channel], expected[i], 1e-5f);
+    }
+    EXPECT_EQ(filter.Process(interleaved.data(), Frames, BiquadFilter::MaxChannels + 1), Result::InvalidParameter);
+
+    // Seven voices with cutoffs of their own, processed in two calls with an odd frame count
+    constexpr u32 Voices = 7;
+    BiquadFilterBank bank(Voices);
+    vector<vector<float>> voices;
+    vector<BiquadCoefficients> coefficients;
+    for (u32 voice = 0; voice < Voices; ++voice)
+    {
+        coefficients.push_back(BiquadCoefficients::Compute(BiquadFilterType::LowPass, 48000.0f, 500.0f + 1500.0f * voice, 0.7071f));
+        EXPECT_EQ(bank.SetCoefficients(voice, coefficients.back()), Result::Ok);
+        voices.push_back(signal(voice + Channels, Frames));
+    }
+    vector<float*> pointers;
+    for (vector<float>& voice : voices)
+        pointers.push_back(voice.data());
+    EXPECT_EQ(bank.Process(pointers.data(), Voices, 50), Result::Ok);
+    for (float*& pointer : pointers)
+        pointer += 50;
+    EXPECT_EQ(bank.Process(pointers.data(), Voices, Frames - 50), Result::Ok);
+    for (u32 voice = 0; voice < Voices; ++voice)
+    {
+        vector<float> expected = filterReference(coefficients[voice], signal(voice + Channels, Frames));
+        for (u32 i = 0; i < Frames; ++i)
+            EXPECT_NEAR(voices[voice][i], expected[i], 1e-5f);
+    }
+    EXPECT_EQ(bank.SetCoefficients(Voices, lowPass), Result::InvalidParameter);
+}
+
+TEST_F(BiquadTests, FilterNodesInTheGraph)
+{
+    auto sine = [](float frequency, float amplitude, u32 frames)
+    {
+        vector<float> samples(frames);
+        for (u32 i = 0; i < frames; ++i)
+            samples[i] = amplitude * std::sin(2.0f * 3.14159265f * frequency * i / 48000.0f);
+        return samples;
+    };
+    AudioFormat format;
+    format.channels = 1;
+    format.frameRate = 48000;
+    format.sampleFormat = SampleFormat::Float32;
+    AudioSystem system;
+    ASSERT_EQ(system.InitializeOffline(format, 64), Result::Ok);
+    IAudioGraph& graph = system.GetGraph();
+    AudioNodePtr master = graph.CreateNode<MixerNode>();
+    AudioNodePtr filter = graph.CreateNode<BiquadFilterNode>(BiquadFilterType::LowPass, 1000.0f);
+    AudioNodePtr tone = graph.CreateNode<SineNode>(3000.0f, 0.5f);
+    ASSERT_EQ(graph.ConnectNodes(tone, filter), Result::Ok);
+    ASSERT_EQ(graph.ConnectNodes(filter, master), Result::Ok);
+
+    // The cutoff parameter changes between two renders, the filter state carries over
+    OfflineRenderer renderer;
+    OfflineRenderJob job(system, 256);
+    ASSERT_EQ(renderer.Render(job), Result::Ok);
+    BiquadFilterNode& filterNode = static_cast<BiquadFilterNode&>(*filter);
+    EXPECT_EQ(filterNode.SetFrequency(6000.0f), Result::Ok);
+    OfflineRenderJob secondJob(system, 256);
+    ASSERT_EQ(renderer.Render(secondJob), Result::Ok);
+    vector<float> expected = sine(3000.0f, 0.5f, 512);
+    BiquadFilter reference;
+    reference.SetCoefficients(BiquadCoefficients::Compute(BiquadFilterType::LowPass, 48000.0f, 1000.0f, 0.7071f));
+    reference.Process(expected.data(), 256, 1);
+    reference.SetCoefficients(BiquadCoefficients::Compute(BiquadFilterType::LowPass, 48000.0f, 6000.0f, 0.7071f));
+    reference.Process(expected.data() + 256, 256, 1);
+    const float* rendered[] = {reinterpret_cast<const float*>(job.output.data()), reinterpret_cast<const float*>(secondJob.output.data())};
+    for (u32 i = 0; i < 512; ++i)
+        EXPECT_NEAR(rendered[i / 256][i % 256], expected[i], 1e-4f) << "frame " << i;
+
+    // Only float buffers are filtered
+    vector<s16> samples(64);
+    AudioBuffer buffer(nullptr, GetRampFormat(), reinterpret_cast<u8*>(samples.data()), 64 * sizeof(s16));
+    buffer.SetSize(64 * sizeof(s16));
+    EXPECT_EQ(filter->Execute(buffer), Result::BufferFormatMismatch);
+
+    // Each input of a bank node has a filter of its own, or none, before they are mixed
+    ASSERT_EQ(graph.RemoveNode(filter), Result::Ok);
+    ASSERT_EQ(graph.RemoveNode(tone), Result::Ok);
+    AudioNodePtr bankNode = graph.CreateNode<BiquadFilterBankNode>(4u);
+    AudioNodePtr tones[] = {graph.CreateNode<SineNode>(300.0f, 0.25f), graph.CreateNode<SineNode>(5000.0f, 0.25f), graph.CreateNode<SineNode>(9000.0f, 0.25f)};
+    for (AudioNodePtr& input : tones)
+        ASSERT_EQ(graph.ConnectNodes(input, bankNode), Result::Ok);
+    ASSERT_EQ(graph.ConnectNodes(bankNode, master), Result::Ok);
+    BiquadFilterBankNode& bankFilter = static_cast<BiquadFilterBankNode&>(*bankNode);
+    EXPECT_EQ(bankFilter.SetInputFilter(tones[0], BiquadFilterType::HighPass, 2000.0f), Result::Ok);
+    EXPECT_EQ(bankFilter.SetInputFilter(tones[1], BiquadFilterType::LowPass, 8000.0f), Result::Ok);
+    EXPECT_EQ(bankFilter.SetInputFilter(tones[1], BiquadFilterType::LowPass, 1000.0f), Result::Ok);
+    EXPECT_EQ(bankFilter.RemoveInputFilter(tones[2]), Result::CannotFind);
+    EXPECT_EQ(bankFilter.SetInputFilter(nullptr, BiquadFilterType::LowPass, 1000.0f), Result::Nullptr);
+    OfflineRenderJob bankJob(system, 256);
+    ASSERT_EQ(renderer.Render(bankJob), Result::Ok);
+    vector<float> voices[] = {sine(300.0f, 0.25f, 256), sine(5000.0f, 0.25f, 256), sine(9000.0f, 0.25f, 256)};
+    BiquadFilter highPass;
+    highPass.SetCoefficients(BiquadCoefficients::Compute(BiquadFilterType::HighPass, 48000.0f, 2000.0f, 0.7071f));
+    highPass.Process(voices[0].data(), 256, 1);
+    BiquadFilter lowPass;
+    lowPass.SetCoefficients(BiquadCoefficients::Compute(BiquadFilterType::LowPass, 48000.0f, 1000.0f, 0.7071f));
+    lowPass.Process(voices[1].data(), 256, 1);
+    const float* bankRendered = reinterpret_cast<const float*>(bankJob.output.data());
+    for (u32 i = 0; i < 256; ++i)
+        EXPECT_NEAR(bankRendered[i], voices[0][i] + voices[1][i] + voices[2][i], 1e-4f) << "frame " << i;
+}
+
+class ConvolutionTests : public ::testing::Test
+{
+};
+
+TEST_F(ConvolutionTests, PartitionedMatchesDirectConvolution)
+{
+    constexpr u32 BlockFrames = 16;
+    constexpr u32 Channels = 2;
+    // Head, and tail partitions of 256 frames, the last one partial
+    constexpr u32 ImpulseFrames = 1500;
+    constexpr u32 Frames = 3000;
+    vector<float> impulse(ImpulseFrames);
+    for (u32 i = 0; i < ImpulseFrames; ++i)
+        impulse[i] = std::exp(-0.002f * i) * std::sin(0.3f * i + 0.5f);
+    vector<float> input(Frames * Channels);
+    for (u32 i = 0; i < input.size(); ++i)
+        input[i] = std::sin(0.011f * i * i) * ((i % 2) == 0 ? 1.0f : 0.5f);
+
+    for (bool backgroundTail : {true, false})
+    {
+        Convolver convolver;
+        ASSERT_EQ(convolver.Initialize(impulse.data(), ImpulseFrames, 1, Channels, BlockFrames, backgroundTail), Result::Ok);
+        EXPECT_EQ(convolver.GetLatency(), BlockFrames);
+        vector<float> output = input;
+        // Callbacks not aligned with the blocks
+        for (u32 frame = 0; frame < Frames; frame += 37)
+            EXPECT_EQ(convolver.Process(output.data() + frame * Channels, std::min(37u, Frames - frame)), Result::Ok);
+
+        float maxError = 0.0f;
+        for (u32 frame = BlockFrames; frame < Frames; ++frame)
+        {
+            for (u32 channel = 0; channel < Channels; ++channel)
+            {
+                double expected = 0.0;
+                u32 delayed = frame - BlockFrames;
+                for (u32 k = 0; k < ImpulseFrames && k <= delayed; ++k)
+                    expected += impulse[k] * input[(delayed - k) * Channels + channel];
+                maxError = std::max(maxError, std::abs(output[frame * Channels + channel] - static_cast<float>(expected)));
+            }
+        }
+        EXPECT_LT(maxError, 1e-3f);
+        for (u32 frame = 0; frame < BlockFrames; ++frame)
+            EXPECT_EQ(output[frame * Channels], 0.0f);
+    }
+
+    Convolver convolver;
+    EXPECT_EQ(convolver.Process(input.data(), Frames), Result::NotReady);
+    EXPECT_EQ(convolver.Initialize(impulse.data(), ImpulseFrames, 1, Channels, 24), Result::InvalidParameter);
+}
+
+class SpectrumAnalyzerTests : public ::testing::Test
+{
+};
+
+TEST_F(SpectrumAnalyzerTests, PublishesSpectrumAndLevels)
+{
+    // The transforms match a direct evaluation for radix-2 and radix-4 sizes
+    for (u32 size : {64u, 128u, 2048u})
+    {
+        FFT fft;
+        ASSERT_EQ(fft.Initialize(size), Result::Ok);
+        vector<float> data(2 * size);
+        for (u32 i = 0; i < data.size(); ++i)
+            data[i] = std::cos(0.7f * i) + 0.25f * (i % 3);
+        vector<float> transformed = data;
+        fft.Forward(transformed.data());
+        for (u32 k : {0u, 1u, 5u, size / 2 + 3})
+        {
+            double real = 0.0;
+            double imaginary = 0.0;
+            for (u32 n = 0; n < size; ++n)
+            {
+                double angle = -2.0 * 3.14159265358979 * k * n / size;
+                real += data[2 * n] * std::cos(angle) - data[2 * n + 1] * std::sin(angle);
+                imaginary += data[2 * n] * std::sin(angle) + data[2 * n + 1] * std::cos(angle);
+            }
+            EXPECT_NEAR(transformed[2 * k], real, 2e-3 * size);
+            EXPECT_NEAR(transformed[2 * k + 1], imaginary, 2e-3 * size);
+        }
+        fft.Inverse(transformed.data());
+        for (u32 i = 0; i < data.size(); ++i)
+            EXPECT_NEAR(transformed[i] / size, data[i], 1e-4f);
+    }
+    EXPECT_EQ(FFT().Initialize(48), Result::InvalidParameter);
+
+    AudioSystem system;
+    AudioFormat format;
+    format.channels = 2;
+    format.frameRate = 48000;
+    format.sampleFormat = SampleFormat::Float32;
+    ASSERT_EQ(system.InitializeOffline(format, 256), Result::Ok);
+    IAudioGraph& graph = system.GetGraph();
+    AudioNodePtr master = graph.CreateNode<MixerNode>();
+    AudioNodePtr analyzer = graph.CreateNode<SpectrumAnalyzerNode>(1024);
+    // Exactly bin 64 of 1024
+    AudioNodePtr sine = graph.CreateNode<SineNode>(3000.0f, 0.5f);
+    ASSERT_EQ(graph.ConnectNodes(sine, analyzer), Result::Ok);
+    ASSERT_EQ(graph.ConnectNodes(analyzer, master), Result::Ok);
+    OfflineRenderJob job(system, 256 * 16);
+    OfflineRenderer renderer;
+    ASSERT_EQ(renderer.Render(job), Result::Ok);
+
+    SpectrumAnalyzerNode& node = static_cast<SpectrumAnalyzerNode&>(*analyzer);
+    SpectrumAnalysis analysis;
+    ASSERT_TRUE(node.ReadAnalysis(analysis));
+    EXPECT_FALSE(node.ReadAnalysis(analysis));
+    // One analysis every two buffers
+    EXPECT_EQ(analysis.sequence, 7u);
+    ASSERT_EQ(analysis.magnitudes.size(), 513u);
+    u32 loudest = static_cast<u32>(std::max_element(analysis.magnitudes.begin(), analysis.magnitudes.end()) - analysis.magnitudes.begin());
+    EXPECT_EQ(loudest, 64u);
+    EXPECT_NEAR(analysis.GetBinFrequency(loudest), 3000.0f, 1e-3f);
+    EXPECT_NEAR(analysis.magnitudes[64], 0.5f, 1e-3f);
+    EXPECT_LT(analysis.magnitudes[200], 1e-3f);
+    EXPECT_EQ(analysis.channels, 2u);
+    EXPECT_NEAR(analysis.peak[1], 0.5f, 1e-3f);
+    EXPECT_NEAR(analysis.rms[0], 0.5f / std::sqrt(2.0f), 1e-3f);
+
+    // Without inputs the analyses keep coming and decay to silence once the window drains
+    ASSERT_EQ(graph.RemoveNode(sine), Result::Ok);
+    OfflineRenderJob silentJob(system, 256 * 8);
+    ASSERT_EQ(renderer.Render(silentJob), Result::Ok);
+    ASSERT_TRUE(node.ReadAnalysis(analysis));
+    EXPECT_EQ(analysis.sequence, 11u);
+    EXPECT_EQ(analysis.peak[0], 0.0f);
+    EXPECT_EQ(analysis.rms[1], 0.0f);
+    EXPECT_LT(*std::max_element(analysis.magnitudes.begin(), analysis.magnitudes.end()), 1e-6f);
+}
+
+class SpatializerTests : public ::testing::Test
+{
+};
+
+TEST_F(SpatializerTests, BatchedGainsAttenuationAndDoppler)
+{
+    // Seven sources, the last lane group is partial
+    Spatializer stereo(7);
+    stereo.SetListener(Transform{{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f, 0.0f}}, Vector3{0.0f, 0.0f, 0.0f});
+    Vector3 still = {0.0f, 0.0f, 0.0f};
+    ASSERT_EQ(stereo.SetSourcePosition(0, Vector3{0.0f, 0.0f, 1.0f}, still), Result::Ok);
+    ASSERT_EQ(stereo.SetSourcePosition(1, Vector3{1.0f, 0.0f, 0.0f}, still), Result::Ok);
+    ASSERT_EQ(stereo.SetSourcePosition(2, Vector3{-1.0f, 0.0f, 0.0f}, still), Result::Ok);
+    ASSERT_EQ(stereo.SetSourcePosition(3, Vector3{0.0f, 0.0f, 4.0f}, still), Result::Ok);
+    ASSERT_EQ(stereo.SetSourcePosition(4, Vector3{0.0f, 0.0f, 6.0f}, still), Result::Ok);
+    ASSERT_EQ(stereo.SetSourceAttenuation(4, DistanceModel::Linear, 1.0f, 11.0f), Result::Ok);
+    // Approaching and receding at a tenth of the speed of sound
+    ASSERT_EQ(stereo.SetSourcePosition(5, Vector3{0.0f, 0.0f, 10.0f}, Vector3{0.0f, 0.0f, -34.3f}), Result::Ok);
+    ASSERT_EQ(stereo.SetSourcePosition(6, Vector3{0.0f, 0.0f, 10.0f}, Vector3{0.0f, 0.0f, 34.3f}), Result::Ok);
+    ASSERT_EQ(stereo.SetSourceAttenuation(6, DistanceModel::None, 1.0f, 100.0f), Result::Ok);
+    ASSERT_EQ(stereo.Update(7), Result::Ok);
+
+    float center = std::sqrt(0.5f);
+    EXPECT_NEAR(stereo.GetGain(0, 0), center, 1e-4f);
+    EXPECT_NEAR(stereo.GetGain(0, 1), center, 1e-4f);
+    EXPECT_NEAR(stereo.GetGain(1, 0), 0.0f, 1e-3f);
+    EXPECT_NEAR(stereo.GetGain(1, 1), 1.0f, 1e-4f);
+    EXPECT_NEAR(stereo.GetGain(2, 0), 1.0f, 1e-4f);
+    EXPECT_NEAR(stereo.GetGain(2, 1), 0.0f, 1e-3f);
+    EXPECT_NEAR(stereo.GetAttenuation(3), 0.25f, 1e-5f);
+    EXPECT_NEAR(stereo.GetAttenuation(4), 0.5f, 1e-5f);
+    EXPECT_NEAR(stereo.GetAttenuation(6), 1.0f, 1e-5f);
+    EXPECT_NEAR(stereo.GetDopplerRatio(0), 1.0f, 1e-5f);
+    EXPECT_NEAR(stereo.GetDopplerRatio(5), 1.0f / 0.9f, 1e-4f);
+    EXPECT_NEAR(stereo.GetDopplerRatio(6), 1.0f / 1.1f, 1e-4f);
+
+    // Turned a quarter to the right, the source on the right is in front
+    float halfTurn = std::sqrt(0.5f);
+    stereo.SetListener(Transform{{0.0f, 0.0f, 0.0f}, {halfTurn, 0.0f, halfTurn, 0.0f}}, Vector3{0.0f, 0.0f, 0.0f});
+    ASSERT_EQ(stereo.Update(7), Result::Ok);
+    EXPECT_NEAR(stereo.GetGain(1, 0), center, 1e-4f);
+    EXPECT_NEAR(stereo.GetGain(1, 1), center, 1e-4f);
+    EXPECT_NEAR(stereo.GetGain(0, 0), 1.0f, 1e-4f);
+
+    // The gains ramp from the previous update over the mixed frames
+    float input[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    float output[8] = {};
+    ASSERT_EQ(stereo.Mix(1, input, 4, output), Result::Ok);
+    EXPECT_NEAR(output[6], center, 1e-4f);
+    EXPECT_NEAR(output[7], center, 1e-4f);
+    // Frames past the last whole vector ramp the same way
+    float ramp[10];
+    float rampOutput[20] = {};
+    for (u32 frame = 0; frame < 10; ++frame)
+        ramp[frame] = 0.1f * (frame + 1);
+    ASSERT_EQ(stereo.Mix(1, ramp, 10, rampOutput), Result::Ok);
+    for (u32 frame = 0; frame < 10; ++frame)
+    {
+        float progress = (frame + 1) / 10.0f;
+        EXPECT_NEAR(rampOutput[frame * 2], ramp[frame] * center * progress, 1e-4f);
+        EXPECT_NEAR(rampOutput[frame * 2 + 1], ramp[frame] * (1.0f + (center - 1.0f) * progress), 1e-4f);
+    }
+
+    // VBAP, on a speaker only that speaker plays and between two speakers the power is kept
+    Spatializer surround(2, SpeakerLayout::Surround51);
+    ASSERT_EQ(surround.GetChannels(), 6u);
+    ASSERT_EQ(surround.SetSourcePosition(0, Vector3{0.5f, 0.0f, std::sqrt(0.75f)}, still), Result::Ok);
+    ASSERT_EQ(surround.SetSourcePosition(1, Vector3{0.0f, 0.0f, -1.0f}, still), Result::Ok);
+    ASSERT_EQ(surround.Update(2), Result::Ok);
+    for (u32 channel = 0; channel < 6; ++channel)
+        EXPECT_NEAR(surround.GetGain(0, channel), channel == 1 ? 1.0f : 0.0f, 1e-4f);
+    EXPECT_NEAR(surround.GetGain(1, 4), center, 1e-4f);
+    EXPECT_NEAR(surround.GetGain(1, 5), center, 1e-4f);
+    EXPECT_NEAR(surround.GetGain(1, 3), 0.0f, 1e-6f);
+    float surroundOutput[60] = {};
+    ASSERT_EQ(surround.Mix(1, ramp, 10, surroundOutput), Result::Ok);
+    for (u32 frame = 0; frame < 10; ++frame)
+    {
+        for (u32 channel = 0; channel < 6; ++channel)
+            EXPECT_NEAR(surroundOutput[frame * 6 + channel], ramp[frame] * surround.GetGain(1, channel) * (frame + 1) / 10.0f, 1e-4f);
+    }
+}
+
+TEST_F(SpatializerTests, NodeMixesSourcesAtTheirPositions)
+{
+    const char* bankPath = "spatializertests.bank";
+    AudioAssetData data;
+    data.format.channels = 1;
+    data.format.frameRate = 48000;
+    data.format.sampleFormat = SampleFormat::Float32;
+    data.frameCount = 1000;
+    data.samples.resize(data.frameCount * sizeof(float));
+    std::fill_n(reinterpret_cast<float*>(data.samples.data()), data.frameCount, 0.5f);
+    SoundBankWriter writer;
+    ASSERT_EQ(writer.AddAsset("tone", std::move(data)), Result::Ok);
+    ASSERT_EQ(writer.Write(bankPath), Result::Ok);
+
+    AudioFormat format;
+    format.channels = 2;
+    format.frameRate = 48000;
+    format.sampleFormat = SampleFormat::Float32;
+    AudioSystem system;
+    ASSERT_EQ(system.InitializeOffline(format, 64), Result::Ok);
+    shared_ptr<SoundBank> bank;
+    ASSERT_EQ(system.LoadSoundBank(bankPath, bank), Result::Ok);
+    shared_ptr<AudioAsset> asset = system.CreateAudioAsset("tone");
+    ASSERT_NE(asset, nullptr);
+    shared_ptr<SpatializerNode> spatializer = shared_ptr_cast<SpatializerNode>(system.GetGraph().CreateNode<SpatializerNode>(4u));
+    ASSERT_NE(spatializer, nullptr);
+    shared_ptr<AssetReaderNode> right = system.CreateAudioSource(asset, spatializer);
+    shared_ptr<AssetReaderNode> front = system.CreateAudioSource(asset, spatializer);
+    ASSERT_NE(right, nullptr);
+    ASSERT_NE(front, nullptr);
+    EXPECT_EQ(right->SetPosition(Vector3{1.0f, 0.0f, 0.0f}), Result::Ok);
+    EXPECT_EQ(front->SetPosition(Vector3{0.0f, 0.0f, 2.0f}), Result::Ok);
+    EXPECT_EQ(right->Play(), Result::Ok);
+    EXPECT_EQ(front->Play(), Result::Ok);
+
+    // The gains ramp in over the first buffer, the source in front is attenuated by half
+    float center = std::sqrt(0.5f);
+    OfflineRenderer renderer;
+    OfflineRenderJob job(system, 128);
+    EXPECT_EQ(renderer.Render(job), Result::Ok);
+    ASSERT_EQ(job.output.size(), 128 * 2 * sizeof(float));
+    const float* rendered = reinterpret_cast<const float*>(job.output.data());
+    for (u32 frame = 64; frame < 128; ++frame)
+    {
+        EXPECT_NEAR(rendered[frame * 2], 0.5f * center * 0.5f, 1e-4f);
+        EXPECT_NEAR(rendered[frame * 2 + 1], 0.5f + 0.5f * center * 0.5f, 1e-4f);
+    }
+
+    EXPECT_EQ(spatializer->SetAttenuation(DistanceModel::None, 1.0f, 100.0f), Result::Ok);
+    OfflineRenderJob unattenuatedJob(system, 128);
+    EXPECT_EQ(renderer.Render(unattenuatedJob), Result::Ok);
+    rendered = reinterpret_cast<const float*>(unattenuatedJob.output.data());
+    EXPECT_NEAR(rendered[127 * 2], 0.5f * center, 1e-4f);
+    EXPECT_NEAR(rendered[127 * 2 + 1], 0.5f + 0.5f * center, 1e-4f);
+    std::remove(bankPath);
+}
@@ -0,0 +1,53 @@
+#include "loom/file.h"
+#include "loom/soundbank.h"
+#include "loom/wavcodec.h"
+
+using namespace Loom;
+
+// Packs wav files into a sound bank, assets are named after their input path
+// bankbuilder [--compress] <output.bank> <input.wav>...
+int main(int argc, char** argv)
+{
+    AudioAssetStorage storage = AudioAssetStorage::Resident;
+    int argument = 1;
+    if (argument < argc && strcmp(argv[argument], "--compress") == 0)
+    {
+        storage = AudioAssetStorage::Compressed;
+        ++argument;
+    }
+    if (argc - argument < 2)
+    {
+        fprintf(stderr, "Usage: %s [--compress] <output.bank> <input.wav>...\n", argv[0]);
+        return 1;
+    }
+
+    const char* outputPath = argv[argument++];
+    WavCodec codec(IAudioSystem::GetStub());
+    SoundBankWriter writer;
+    for (; argument < argc; ++argument)
+    {
+        string name(argv[argument]);
+        std::replace(name.begin(), name.end(), '\\', '/');
+
+        vector<u8> fileData;
+        AudioAssetData data;
+        Result result = ReadFile(argv[argument], fileData);
+        if (Ok(result))
+            result = codec.DecodeAsset(fileData.data(), fileData.size(), storage, data);
+        if (Ok(result))
+            result = writer.AddAsset(name.c_str(), std::move(data));
+        if (!Ok(result))
+        {
+            fprintf(stderr, "Unable to add %s to the bank: %s\n", argv[argument], ResultToString(result));
+            return 1;
+        }
+    }
+
+    Result result = writer.Write(outputPath);
+    if (!Ok(result))
+    {
+        fprintf(stderr, "Unable to write %s: %s\n", outputPath, ResultToString(result));
+        return 1;
+    }
+    return 0;
+}